@@ -216,6 +216,7 @@ AudioFile::visitAttachedPictures(std::function<void(const Picture&)> func) const
 		}
 
 		Picture picture;
+		picture.streamIndex = i;
 
 		auto itMime = codecMimeMap.find(avstream->codecpar->codec_id);
 		if (itMime != codecMimeMap.end())
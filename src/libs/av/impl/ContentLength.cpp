@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ContentLength.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace Av
+{
+	namespace
+	{
+		struct ContainerOverhead
+		{
+			std::size_t headerSize;		// codec headers, tags, seek index
+			std::size_t bytesPerSecond;	// page or block headers, given the codec packet rate
+		};
+
+		ContainerOverhead
+		getContainerOverhead(Format format)
+		{
+			switch (format)
+			{
+				// no Xing frame written for constant bitrate: only the ID3v2 header remains
+				case Format::MP3:			return {64, 0};
+				// 50 packets per second: one lacing byte per packet, one page per second
+				case Format::OGG_OPUS:		return {160, 80};
+				// 50 packets per second: one block header per packet, clusters and cues
+				case Format::MATROSKA_OPUS:	return {640, 370};
+				// big setup header (codebooks), about 43 packets per second
+				case Format::OGG_VORBIS:	return {4096, 72};
+				case Format::WEBM_VORBIS:	return {4608, 320};
+			}
+
+			throw Exception {"Invalid encoding"};
+		}
+	}
+
+	std::size_t
+	estimateTranscodeContentLength(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters)
+	{
+		const std::chrono::milliseconds duration {std::max(inputFileParameters.duration - transcodeParameters.offset, std::chrono::milliseconds {0})};
+		const std::size_t durationMs {static_cast<std::size_t>(duration.count())};
+		const ContainerOverhead overhead {getContainerOverhead(transcodeParameters.format)};
+
+		return overhead.headerSize + (transcodeParameters.bitrate / 8 + overhead.bytesPerSecond) * durationMs / 1000;
+	}
+
+	ContentLengthWriter::ContentLengthWriter(std::optional<std::size_t> contentLength)
+		: _contentLength {contentLength}
+	{
+	}
+
+	bool
+	ContentLengthWriter::write(std::ostream& os, const std::byte* data, std::size_t size)
+	{
+		if (_contentLength)
+			size = std::min(size, *_contentLength - _writtenByteCount);
+
+		os.write(reinterpret_cast<const char*>(data), size);
+		_writtenByteCount += size;
+
+		return !_contentLength || _writtenByteCount < *_contentLength;
+	}
+
+	void
+	ContentLengthWriter::pad(std::ostream& os)
+	{
+		if (!_contentLength)
+			return;
+
+		static const std::array<char, 4096> zeros {};
+		while (_writtenByteCount < *_contentLength)
+		{
+			const std::size_t size {std::min(zeros.size(), *_contentLength - _writtenByteCount)};
+			os.write(zeros.data(), size);
+			_writtenByteCount += size;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <ostream>
+
+#include "av/TranscodeParameters.hpp"
+
+namespace Av
+{
+	// Expected size of the transcoded output, container overhead included
+	// Only accurate for constant bitrate transcodes
+	std::size_t estimateTranscodeContentLength(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters);
+
+	// Makes sure exactly the declared content length is written, if any:
+	// the output is truncated if longer, or padded with zeros if shorter
+	class ContentLengthWriter
+	{
+		public:
+			ContentLengthWriter(std::optional<std::size_t> contentLength);
+
+			// Returns false once the content length is reached: the remaining data is discarded
+			bool write(std::ostream& os, const std::byte* data, std::size_t size);
+			void pad(std::ostream& os);
+
+			std::size_t getWrittenByteCount() const { return _writtenByteCount; }
+
+		private:
+			const std::optional<std::size_t> _contentLength;
+			std::size_t _writtenByteCount {};
+	};
+}
@@ -18,31 +18,45 @@
  */
 
 #include "TranscodeResourceHandler.hpp"
+
+#include <Wt/Http/Response.h>
+#include <Wt/Http/ResponseContinuation.h>
+
+#include "av/Types.hpp"
 #include "utils/Logger.hpp"
+#include "utils/Service.hpp"
 
 namespace Av
 {
 	namespace
 	{
-		std::size_t
-		doEstimateContentLength(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters)
+		TranscodeParameters
+		getTranscodeParameters(const TranscodeParameters& transcodeParameters, bool estimateContentLength)
 		{
-			const std::size_t estimatedContentLength {transcodeParameters.bitrate / 8 * static_cast<std::size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(inputFileParameters.duration).count()) / 1000};
-			return estimatedContentLength;
+			TranscodeParameters res {transcodeParameters};
+
+			// the closer the output size to the estimation, the less is truncated or padded
+			if (estimateContentLength)
+				res.constantBitrate = true;
+
+			return res;
 		}
 	}
 
 	std::unique_ptr<IResourceHandler>
-	createTranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters, bool estimateContentLength)
+	createTranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters, const ITranscodeScheduler::Request& schedulingRequest, bool estimateContentLength)
 	{
-		return std::make_unique<TranscodeResourceHandler>(inputFileParameters, transcodeParameters, estimateContentLength);
+		return std::make_unique<TranscodeResourceHandler>(inputFileParameters, transcodeParameters, schedulingRequest, estimateContentLength);
 	}
 
 	// TODO set some nice HTTP return code
 
-	TranscodeResourceHandler::TranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters, bool estimateContentLength)
-		: _estimatedContentLength {estimateContentLength ? std::make_optional(doEstimateContentLength(inputFileParameters, transcodeParameters)) : std::nullopt}
-		, _transcoder {inputFileParameters, transcodeParameters}
+	TranscodeResourceHandler::TranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters, const ITranscodeScheduler::Request& schedulingRequest, bool estimateContentLength)
+		: _inputFileParameters {inputFileParameters}
+		, _transcodeParameters {getTranscodeParameters(transcodeParameters, estimateContentLength)}
+		, _schedulingRequest {schedulingRequest}
+		, _estimatedContentLength {estimateContentLength ? std::make_optional(estimateTranscodeContentLength(inputFileParameters, _transcodeParameters)) : std::nullopt}
+		, _writer {_estimatedContentLength}
 	{
 		if (_estimatedContentLength)
 			LMS_LOG(TRANSCODE, DEBUG) << "Estimated content length = " << *_estimatedContentLength;
@@ -55,20 +69,91 @@ namespace Av
 	{
 		if (_estimatedContentLength)
 			response.setContentLength(*_estimatedContentLength);
-		response.setMimeType(_transcoder.getOutputMimeType());
+		response.setMimeType(std::string {formatToMimetype(_transcodeParameters.format)});
+
+		if (!_transcoder)
+		{
+			if (ITranscodeScheduler* scheduler {Service<ITranscodeScheduler>::get()})
+			{
+				if (!_slotState)
+				{
+					_slotState = std::make_shared<SlotState>();
+
+					auto onSlot {[weakSlotState = std::weak_ptr<SlotState> {_slotState}](std::shared_ptr<ITranscodeScheduler::Slot> slot)
+					{
+						// handler already gone: the slot is released right away
+						const std::shared_ptr<SlotState> slotState {weakSlotState.lock()};
+						if (!slotState)
+							return;
+
+						Wt::Http::ResponseContinuationPtr continuation;
+						{
+							std::scoped_lock lock {slotState->mutex};
+							slotState->ready = true;
+							slotState->slot = std::move(slot);
+							continuation = std::move(slotState->continuation);
+						}
+
+						// the request may have been cancelled while queued
+						if (continuation && continuation->isWaitingForMoreData())
+							continuation->haveMoreData();
+					}};
+
+					if (!scheduler->requestSlot(_schedulingRequest, onSlot))
+					{
+						response.setStatus(503);
+						return {};
+					}
+				}
+
+				{
+					std::scoped_lock lock {_slotState->mutex};
+					if (!_slotState->ready)
+					{
+						LMS_LOG(TRANSCODE, DEBUG) << "Waiting for a transcode slot";
+
+						Wt::Http::ResponseContinuation* continuation {response.createContinuation()};
+						continuation->waitForMoreData();
+						_slotState->continuation = continuation->shared_from_this();
+
+						return continuation;
+					}
+
+					_slot = std::move(_slotState->slot);
+				}
+
+				if (!_slot)
+				{
+					LMS_LOG(TRANSCODE, DEBUG) << "Transcode superseded while queued";
+					return {};
+				}
+			}
+
+			_transcoder.emplace(_inputFileParameters, _transcodeParameters);
+		}
+		else if (_slot && _slot->isCancelled())
+		{
+			LMS_LOG(TRANSCODE, DEBUG) << "Transcode superseded. Total served byte count = " << _writer.getWrittenByteCount();
+			return {};
+		}
 
 		if (_bytesReadyCount > 0)
 		{
-			response.out().write(reinterpret_cast<const char *>(&_buffer[0]), _bytesReadyCount);
-			_totalServedByteCount += _bytesReadyCount;
+			const bool contentLengthReached {!_writer.write(response.out(), _buffer.data(), _bytesReadyCount)};
 			_bytesReadyCount = 0;
+
+			if (contentLengthReached)
+			{
+				LMS_LOG(TRANSCODE, DEBUG) << "Estimated content length reached, truncating. Total served byte count = " << _writer.getWrittenByteCount();
+				return {};
+			}
 		}
 
-		if (!_transcoder.finished())
+		if (!_transcoder->finished())
 		{
 			Wt::Http::ResponseContinuation *continuation {response.createContinuation()};
 			continuation->waitForMoreData();
-			_transcoder.asyncRead(_buffer.data(), _buffer.size(), [=](std::size_t nbBytesRead)
+			_transcoder->asyncRead(_buffer.data(), _buffer.size(), [=](std::size_t nbBytesRead)
 			{
 				assert(_bytesReadyCount == 0);
 				_bytesReadyCount = nbBytesRead;
@@ -80,19 +165,13 @@ namespace Av
 		else
 		{
 			// pad with 0 if necessary as duration may not be accurate
-			if (_estimatedContentLength && *_estimatedContentLength > _totalServedByteCount)
+			if (_estimatedContentLength && *_estimatedContentLength > _writer.getWrittenByteCount())
 			{
-				const std::size_t padSize {*_estimatedContentLength - _totalServedByteCount};
-
-				LMS_LOG(TRANSCODE, DEBUG) << "Adding " << padSize << " padding bytes";
-
-				for (std::size_t i {}; i < padSize; ++i)
-					response.out().put(0);
-
-				_totalServedByteCount += padSize;
+				LMS_LOG(TRANSCODE, DEBUG) << "Adding " << (*_estimatedContentLength - _writer.getWrittenByteCount()) << " padding bytes";
+				_writer.pad(response.out());
 			}
 
-			LMS_LOG(TRANSCODE, DEBUG) << "Transcoding finished. Total served byte count = " << _totalServedByteCount;
+			LMS_LOG(TRANSCODE, DEBUG) << "Transcoding finished. Total served byte count = " << _writer.getWrittenByteCount();
 		}
 
 		return {};
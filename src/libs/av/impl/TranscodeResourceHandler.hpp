@@ -21,10 +21,16 @@
 
 #include <array>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <optional>
 
+#include <Wt/Http/ResponseContinuation.h>
+
+#include "av/ITranscodeScheduler.hpp"
 #include "av/TranscodeParameters.hpp"
 #include "utils/IResourceHandler.hpp"
+#include "ContentLength.hpp"
 #include "Transcoder.hpp"
 
 namespace Av
@@ -32,17 +38,31 @@ namespace Av
 	class TranscodeResourceHandler final : public IResourceHandler
 	{
 		public:
-			TranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& parameters, bool estimateContentLength);
+			TranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& parameters, const ITranscodeScheduler::Request& schedulingRequest, bool estimateContentLength);
 
 		private:
 			Wt::Http::ResponseContinuation* processRequest(const Wt::Http::Request& request, Wt::Http::Response& reponse) override;
 
+			// Shared with the scheduler callback, that may outlive the handler
+			struct SlotState
+			{
+				std::mutex										mutex;
+				bool											ready {};
+				std::shared_ptr<ITranscodeScheduler::Slot>		slot;
+				Wt::Http::ResponseContinuationPtr				continuation;
+			};
+
 			static constexpr std::size_t _chunkSize {32768};
+			const InputFileParameters _inputFileParameters;
+			const TranscodeParameters _transcodeParameters;
+			const ITranscodeScheduler::Request _schedulingRequest;
 			std::optional<std::size_t> _estimatedContentLength;
 			std::array<std::byte, _chunkSize> _buffer;
 			std::size_t _bytesReadyCount {};
-			std::size_t _totalServedByteCount {};
-			Transcoder _transcoder;
+			ContentLengthWriter _writer;
+			std::shared_ptr<SlotState> _slotState;
+			std::shared_ptr<ITranscodeScheduler::Slot> _slot;
+			std::optional<Transcoder> _transcoder;
 	};
 }
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TranscodeScheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "utils/Logger.hpp"
+
+namespace Av
+{
+	std::unique_ptr<ITranscodeScheduler>
+	createTranscodeScheduler(std::size_t maxRunningCount, std::size_t maxRunningCountPerUser, std::size_t maxQueueSize)
+	{
+		return std::make_unique<TranscodeScheduler>(maxRunningCount, maxRunningCountPerUser, maxQueueSize);
+	}
+
+	TranscodeScheduler::SlotImpl::SlotImpl(TranscodeScheduler& scheduler, const Request& request)
+		: _scheduler {scheduler}
+		, _request {request}
+	{
+	}
+
+	TranscodeScheduler::SlotImpl::~SlotImpl()
+	{
+		_scheduler.release(*this);
+	}
+
+	TranscodeScheduler::TranscodeScheduler(std::size_t maxRunningCount, std::size_t maxRunningCountPerUser, std::size_t maxQueueSize)
+		: _maxRunningCount {maxRunningCount}
+		, _maxRunningCountPerUser {maxRunningCountPerUser}
+		, _maxQueueSize {maxQueueSize}
+	{
+		assert(_maxRunningCount > 0 && _maxRunningCountPerUser > 0);
+
+		_stats.maxRunningCount = _maxRunningCount;
+		_stats.maxRunningCountPerUser = _maxRunningCountPerUser;
+		_stats.maxQueueSize = _maxQueueSize;
+
+		LMS_LOG(TRANSCODE, INFO) << "Max running transcodes = " << _maxRunningCount << ", per user = " << _maxRunningCountPerUser << ", max queued = " << _maxQueueSize;
+	}
+
+	TranscodeScheduler::~TranscodeScheduler()
+	{
+		assert(_runningSlots.empty());
+	}
+
+	bool
+	TranscodeScheduler::requestSlot(const Request& request, SlotCallback callback)
+	{
+		std::vector<SlotCallback> supersededCallbacks;
+		std::vector<Admission> admissions;
+		bool accepted {};
+
+		{
+			std::scoped_lock lock {_mutex};
+
+			auto isSuperseded {[&](const Request& other) { return other.client == request.client && other.supersedeKey == request.supersedeKey; }};
+
+			for (auto it {std::begin(_queue)}; it != std::end(_queue);)
+			{
+				if (isSuperseded(it->request))
+				{
+					supersededCallbacks.push_back(std::move(it->callback));
+					it = _queue.erase(it);
+					_stats.supersededCount++;
+				}
+				else
+					++it;
+			}
+
+			for (SlotImpl* slot : _runningSlots)
+			{
+				if (!slot->isCancelled() && isSuperseded(slot->getRequest()))
+				{
+					slot->cancel();
+					_stats.supersededCount++;
+				}
+			}
+
+			if (_queue.size() < _maxQueueSize)
+			{
+				QueuedRequest queuedRequest {request, std::move(callback), std::chrono::steady_clock::now()};
+				if (request.priority == Priority::Playing)
+				{
+					// The most recent request of a client is the one being played: its older queued requests are demoted
+					for (QueuedRequest& other : _queue)
+					{
+						if (other.request.client == request.client)
+							other.request.priority = Priority::Prefetch;
+					}
+					std::stable_partition(std::begin(_queue), std::end(_queue), [](const QueuedRequest& other) { return other.request.priority == Priority::Playing; });
+
+					auto itFirstPrefetch {std::find_if(std::begin(_queue), std::end(_queue), [](const QueuedRequest& other) { return other.request.priority != Priority::Playing; })};
+					_queue.insert(itFirstPrefetch, std::move(queuedRequest));
+				}
+				else
+					_queue.push_back(std::move(queuedRequest));
+
+				accepted = true;
+				admissions = admitQueuedRequests();
+			}
+			else
+			{
+				_stats.rejectedCount++;
+			}
+		}
+
+		if (!supersededCallbacks.empty())
+			LMS_LOG(TRANSCODE, DEBUG) << "Client '" << request.client << "': " << supersededCallbacks.size() << " queued transcodes superseded";
+
+		for (const SlotCallback& supersededCallback : supersededCallbacks)
+			supersededCallback(nullptr);
+
+		for (auto& [slot, admittedCallback] : admissions)
+			admittedCallback(std::move(slot));
+
+		if (!accepted)
+			LMS_LOG(TRANSCODE, INFO) << "Transcode queue full, rejecting request from client '" << request.client << "'";
+
+		return accepted;
+	}
+
+	ITranscodeScheduler::Stats
+	TranscodeScheduler::getStats() const
+	{
+		std::scoped_lock lock {_mutex};
+
+		Stats stats {_stats};
+		stats.runningCount = _runningSlots.size();
+		stats.queueSize = _queue.size();
+
+		return stats;
+	}
+
+	void
+	TranscodeScheduler::release(SlotImpl& slot)
+	{
+		std::vector<Admission> admissions;
+
+		{
+			std::scoped_lock lock {_mutex};
+
+			_runningSlots.erase(std::remove(std::begin(_runningSlots), std::end(_runningSlots), &slot), std::end(_runningSlots));
+
+			auto itUser {_runningCountByUser.find(slot.getRequest().user)};
+			assert(itUser != std::cend(_runningCountByUser));
+			if (--itUser->second == 0)
+				_runningCountByUser.erase(itUser);
+
+			admissions = admitQueuedRequests();
+		}
+
+		for (auto& [admittedSlot, admittedCallback] : admissions)
+			admittedCallback(std::move(admittedSlot));
+	}
+
+	std::vector<TranscodeScheduler::Admission>
+	TranscodeScheduler::admitQueuedRequests()
+	{
+		std::vector<Admission> admissions;
+
+		const auto now {std::chrono::steady_clock::now()};
+		for (auto it {std::begin(_queue)}; it != std::end(_queue) && _runningSlots.size() < _maxRunningCount;)
+		{
+			// users at their limit do not block the others
+			std::size_t& userRunningCount {_runningCountByUser[it->request.user]};
+			if (userRunningCount >= _maxRunningCountPerUser)
+			{
+				++it;
+				continue;
+			}
+
+			auto slot {std::make_shared<SlotImpl>(*this, it->request)};
+			_runningSlots.push_back(slot.get());
+			userRunningCount++;
+
+			const auto waitDuration {std::chrono::duration_cast<std::chrono::microseconds>(now - it->queuedTime)};
+			_stats.totalWaitDuration += waitDuration;
+			_stats.maxWaitDuration = std::max(_stats.maxWaitDuration, waitDuration);
+			_stats.admittedCount++;
+
+			admissions.emplace_back(std::move(slot), std::move(it->callback));
+			it = _queue.erase(it);
+		}
+
+		return admissions;
+	}
+} // namespace Av
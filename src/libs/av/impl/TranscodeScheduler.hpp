@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "av/ITranscodeScheduler.hpp"
+
+namespace Av
+{
+	class TranscodeScheduler final : public ITranscodeScheduler
+	{
+		public:
+			TranscodeScheduler(std::size_t maxRunningCount, std::size_t maxRunningCountPerUser, std::size_t maxQueueSize);
+			~TranscodeScheduler();
+
+			TranscodeScheduler(const TranscodeScheduler&) = delete;
+			TranscodeScheduler(TranscodeScheduler&&) = delete;
+			TranscodeScheduler& operator=(const TranscodeScheduler&) = delete;
+			TranscodeScheduler& operator=(TranscodeScheduler&&) = delete;
+
+		private:
+			class SlotImpl final : public Slot
+			{
+				public:
+					SlotImpl(TranscodeScheduler& scheduler, const Request& request);
+					~SlotImpl() override;
+
+					SlotImpl(const SlotImpl&) = delete;
+					SlotImpl(SlotImpl&&) = delete;
+					SlotImpl& operator=(const SlotImpl&) = delete;
+					SlotImpl& operator=(SlotImpl&&) = delete;
+
+					bool isCancelled() const override { return _cancelled; }
+					void cancel() { _cancelled = true; }
+
+					const Request& getRequest() const { return _request; }
+
+				private:
+					TranscodeScheduler&		_scheduler;
+					const Request			_request;
+					std::atomic<bool>		_cancelled {};
+			};
+
+			bool requestSlot(const Request& request, SlotCallback callback) override;
+			Stats getStats() const override;
+
+			void release(SlotImpl& slot);
+
+			struct QueuedRequest
+			{
+				Request									request;
+				SlotCallback							callback;
+				std::chrono::steady_clock::time_point	queuedTime;
+			};
+
+			// callbacks are called once the lock is released
+			using Admission = std::pair<std::shared_ptr<Slot>, SlotCallback>;
+			std::vector<Admission> admitQueuedRequests();
+
+			const std::size_t _maxRunningCount;
+			const std::size_t _maxRunningCountPerUser;
+			const std::size_t _maxQueueSize;
+
+			mutable std::mutex								_mutex;
+			std::deque<QueuedRequest>						_queue; // playing requests first, then FIFO
+			std::vector<SlotImpl*>							_runningSlots;
+			std::unordered_map<std::string, std::size_t>	_runningCountByUser;
+			Stats											_stats;
+	};
+} // namespace Av
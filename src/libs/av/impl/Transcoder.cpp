@@ -119,6 +119,33 @@ Transcoder::start()
 	args.emplace_back("-b:a");
 	args.emplace_back(std::to_string(_transcodeParameters.bitrate));
 
+	if (_transcodeParameters.constantBitrate)
+	{
+		switch (_transcodeParameters.format)
+		{
+			case Format::MP3:
+				// lame already uses CBR, just skip the VBR header frame
+				args.emplace_back("-write_xing");
+				args.emplace_back("0");
+				break;
+
+			case Format::OGG_OPUS:
+			case Format::MATROSKA_OPUS:
+				args.emplace_back("-vbr");
+				args.emplace_back("off");
+				break;
+
+			case Format::OGG_VORBIS:
+			case Format::WEBM_VORBIS:
+				// no real CBR for vorbis, use the managed bitrate mode instead
+				args.emplace_back("-minrate");
+				args.emplace_back(std::to_string(_transcodeParameters.bitrate));
+				args.emplace_back("-maxrate");
+				args.emplace_back(std::to_string(_transcodeParameters.bitrate));
+				break;
+		}
+	}
+
 	// Codecs and formats
 	switch (_transcodeParameters.format)
 	{
@@ -35,6 +35,7 @@ namespace Av
 {
 	struct Picture
 	{
+		std::size_t			streamIndex {};
 		std::string			mimeType;
 		const std::byte*	data {};
 		std::size_t			dataSize {};
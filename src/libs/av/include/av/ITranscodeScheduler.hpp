@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Av
+{
+	// Limits the number of transcodes running at once, globally and per user
+	// Requests exceeding the limits are queued, the currently playing tracks first
+	// A new playing request of a client demotes its older queued requests to prefetch
+	class ITranscodeScheduler
+	{
+		public:
+			enum class Priority
+			{
+				Playing,
+				Prefetch,
+			};
+
+			struct Request
+			{
+				std::string		user;
+				std::string		client;			// requests are superseded within a client only
+				std::string		supersedeKey;	// a new request cancels the ones of the same client having the same key
+				Priority		priority {Priority::Playing};
+			};
+
+			// Held during the whole transcode, releasing it admits the next queued request
+			class Slot
+			{
+				public:
+					virtual ~Slot() = default;
+
+					// Set when superseded by a newer request: the transcode should be stopped
+					virtual bool isCancelled() const = 0;
+			};
+
+			// Called once admitted, or with nullptr if superseded while queued
+			// May be called from the requestSlot call itself or from any other thread
+			using SlotCallback = std::function<void(std::shared_ptr<Slot>)>;
+
+			struct Stats
+			{
+				std::size_t					maxRunningCount {};
+				std::size_t					maxRunningCountPerUser {};
+				std::size_t					maxQueueSize {};
+				std::size_t					runningCount {};
+				std::size_t					queueSize {};
+				std::size_t					admittedCount {};
+				std::size_t					rejectedCount {};
+				std::size_t					supersededCount {};
+				std::chrono::microseconds	totalWaitDuration {};
+				std::chrono::microseconds	maxWaitDuration {};
+			};
+
+			virtual ~ITranscodeScheduler() = default;
+
+			// Returns false if rejected because the queue is full: the callback is then never called
+			[[nodiscard]] virtual bool requestSlot(const Request& request, SlotCallback callback) = 0;
+
+			virtual Stats getStats() const = 0;
+	};
+
+	// Slots must be released before the scheduler is destroyed
+	std::unique_ptr<ITranscodeScheduler> createTranscodeScheduler(std::size_t maxRunningCount, std::size_t maxRunningCountPerUser, std::size_t maxQueueSize);
+} // namespace Av
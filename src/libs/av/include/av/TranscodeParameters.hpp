@@ -40,6 +40,7 @@ namespace Av
 		std::optional<std::size_t>	stream; // Id of the stream to be transcoded (auto detect by default)
 		std::chrono::milliseconds	offset {0};
 		bool 						stripMetadata {true};
+		bool						constantBitrate {}; // makes the output size predictable
 	};
 } // namespace Av
 
@@ -21,6 +21,7 @@
 
 #include <memory>
 
+#include "av/ITranscodeScheduler.hpp"
 #include "utils/IResourceHandler.hpp"
 
 namespace Av
@@ -28,6 +29,7 @@ namespace Av
 	struct InputFileParameters;
 	struct TranscodeParameters;
 
-	std::unique_ptr<IResourceHandler> createTranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& parameters, bool estimateContentLength);
+	// The transcode only starts once admitted by the transcode scheduler service, if any
+	std::unique_ptr<IResourceHandler> createTranscodeResourceHandler(const InputFileParameters& inputFileParameters, const TranscodeParameters& parameters, const ITranscodeScheduler::Request& schedulingRequest, bool estimateContentLength);
 }
 
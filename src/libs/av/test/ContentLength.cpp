@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <gtest/gtest.h>
+
+#include "utils/IChildProcessManager.hpp"
+#include "utils/IConfig.hpp"
+#include "utils/Service.hpp"
+#include "ContentLength.hpp"
+#include "Transcoder.hpp"
+
+using namespace Av;
+
+namespace
+{
+	constexpr Format formats[] {Format::MP3, Format::OGG_OPUS, Format::MATROSKA_OPUS, Format::OGG_VORBIS, Format::WEBM_VORBIS};
+
+	std::vector<std::byte> generateOutput(std::size_t size)
+	{
+		std::vector<std::byte> output(size);
+		for (std::size_t i {}; i < size; ++i)
+			output[i] = static_cast<std::byte>(1 + i % 255);
+
+		return output;
+	}
+
+	// Simulates the transcoder output read chunk by chunk
+	std::string writeOutput(ContentLengthWriter& writer, const std::vector<std::byte>& output)
+	{
+		constexpr std::size_t chunkSize {32768};
+
+		std::ostringstream oss;
+		for (std::size_t offset {}; offset < output.size(); offset += chunkSize)
+		{
+			if (!writer.write(oss, output.data() + offset, std::min(chunkSize, output.size() - offset)))
+				break;
+		}
+		writer.pad(oss);
+
+		return oss.str();
+	}
+
+	// Only default values, as used by the transcoder
+	class TestConfig final : public IConfig
+	{
+		public:
+			std::string_view getString(std::string_view, std::string_view def) override { return def; }
+			void visitStrings(std::string_view, std::function<void(std::string_view)> func, std::initializer_list<std::string_view> def) override
+			{
+				for (std::string_view value : def)
+					func(value);
+			}
+			std::filesystem::path getPath(std::string_view, const std::filesystem::path& def) override { return def; }
+			unsigned long getULong(std::string_view, unsigned long def) override { return def; }
+			long getLong(std::string_view, long def) override { return def; }
+			bool getBool(std::string_view, bool def) override { return def; }
+	};
+
+	const std::filesystem::path ffmpegPath {"/usr/bin/ffmpeg"}; // transcoder default
+
+	std::string_view getEncoderName(Format format)
+	{
+		switch (format)
+		{
+			case Format::MP3:			return "libmp3lame";
+			case Format::OGG_OPUS:
+			case Format::MATROSKA_OPUS:	return "libopus";
+			case Format::OGG_VORBIS:
+			case Format::WEBM_VORBIS:	return "libvorbis";
+		}
+		return "";
+	}
+
+	bool runFFmpeg(const std::string& args)
+	{
+		const std::string command {ffmpegPath.string() + " -loglevel quiet -nostdin " + args + " > /dev/null 2>&1"};
+		return std::system(command.c_str()) == 0;
+	}
+
+	std::size_t getTranscodedSize(boost::asio::io_context& ioContext, const InputFileParameters& inputFileParameters, const TranscodeParameters& transcodeParameters)
+	{
+		Transcoder transcoder {inputFileParameters, transcodeParameters};
+
+		std::array<std::byte, 65536> buffer;
+		std::size_t size {};
+
+		std::function<void()> readNext;
+		readNext = [&]
+		{
+			transcoder.asyncRead(buffer.data(), buffer.size(), [&](std::size_t nbBytesRead)
+			{
+				size += nbBytesRead;
+				if (!transcoder.finished())
+					readNext();
+			});
+		};
+		readNext();
+
+		ioContext.restart();
+		ioContext.run();
+
+		return size;
+	}
+}
+
+TEST(ContentLength, estimate)
+{
+	for (const Format format : formats)
+	{
+		for (const std::size_t bitrate : {64000, 128000, 320000})
+		{
+			InputFileParameters inputFileParameters;
+			inputFileParameters.duration = std::chrono::minutes {3};
+
+			TranscodeParameters transcodeParameters;
+			transcodeParameters.format = format;
+			transcodeParameters.bitrate = bitrate;
+
+			// audio payload plus a few percents of container overhead
+			const std::size_t payloadSize {bitrate / 8 * 180};
+			const std::size_t estimatedSize {estimateTranscodeContentLength(inputFileParameters, transcodeParameters)};
+			EXPECT_GE(estimatedSize, payloadSize);
+			EXPECT_LE(estimatedSize, payloadSize + payloadSize / 20);
+
+			// offset skips part of the track
+			transcodeParameters.offset = std::chrono::minutes {1};
+			EXPECT_LT(estimateTranscodeContentLength(inputFileParameters, transcodeParameters), estimatedSize);
+
+			// only the headers remain
+			transcodeParameters.offset = std::chrono::minutes {4};
+			EXPECT_LE(estimateTranscodeContentLength(inputFileParameters, transcodeParameters), 4608);
+		}
+	}
+}
+
+TEST(ContentLength, declaredMatchesWritten)
+{
+	for (const Format format : formats)
+	{
+		for (const std::chrono::milliseconds duration : {std::chrono::milliseconds {0}, std::chrono::milliseconds {1500}, std::chrono::milliseconds {200000}})
+		{
+			InputFileParameters inputFileParameters;
+			inputFileParameters.duration = duration;
+
+			TranscodeParameters transcodeParameters;
+			transcodeParameters.format = format;
+
+			const std::size_t declaredSize {estimateTranscodeContentLength(inputFileParameters, transcodeParameters)};
+
+			// actual output shorter, exact and longer than estimated
+			for (const std::size_t actualSize : {std::size_t {}, declaredSize / 2, declaredSize - 1, declaredSize, declaredSize + 1, declaredSize + declaredSize / 10 + 32768})
+			{
+				const std::vector<std::byte> output {generateOutput(actualSize)};
+
+				ContentLengthWriter writer {declaredSize};
+				const std::string written {writeOutput(writer, output)};
+
+				ASSERT_EQ(written.size(), declaredSize);
+				EXPECT_EQ(writer.getWrittenByteCount(), declaredSize);
+
+				const std::size_t dataSize {std::min(actualSize, declaredSize)};
+				EXPECT_EQ(std::memcmp(written.data(), output.data(), dataSize), 0);
+				EXPECT_EQ(written.find_first_not_of('\0', dataSize), std::string::npos);
+			}
+		}
+	}
+}
+
+TEST(ContentLength, noDeclaredLength)
+{
+	const std::vector<std::byte> output {generateOutput(100000)};
+
+	ContentLengthWriter writer {std::nullopt};
+	const std::string written {writeOutput(writer, output)};
+
+	ASSERT_EQ(written.size(), output.size());
+	EXPECT_EQ(writer.getWrittenByteCount(), output.size());
+	EXPECT_EQ(std::memcmp(written.data(), output.data(), output.size()), 0);
+}
+
+TEST(ContentLength, transcodedMatchesEstimate)
+{
+	if (!std::filesystem::exists(ffmpegPath))
+		GTEST_SKIP() << "'" << ffmpegPath.string() << "' not found";
+
+	Service<IConfig> config {std::make_unique<TestConfig>()};
+	boost::asio::io_context ioContext;
+	Service<IChildProcessManager> childProcessManager {createChildProcessManager(ioContext)};
+
+	InputFileParameters inputFileParameters;
+	inputFileParameters.trackPath = std::string {std::tmpnam(nullptr)} + ".flac";
+	inputFileParameters.duration = std::chrono::seconds {20};
+	ASSERT_TRUE(runFFmpeg("-f lavfi -i sine=frequency=440:sample_rate=44100:duration=20 -ac 2 -y " + inputFileParameters.trackPath.string()));
+
+	for (const Format format : formats)
+	{
+		if (!runFFmpeg("-f lavfi -i anullsrc -t 0.1 -c:a " + std::string {getEncoderName(format)} + " -f null -"))
+		{
+			ADD_FAILURE() << "ffmpeg has no '" << getEncoderName(format) << "' encoder";
+			continue;
+		}
+
+		for (const std::size_t bitrate : {64000, 320000})
+		{
+			TranscodeParameters transcodeParameters;
+			transcodeParameters.format = format;
+			transcodeParameters.bitrate = bitrate;
+			transcodeParameters.constantBitrate = true;
+
+			const std::size_t estimatedSize {estimateTranscodeContentLength(inputFileParameters, transcodeParameters)};
+			const std::size_t actualSize {getTranscodedSize(ioContext, inputFileParameters, transcodeParameters)};
+
+			// the estimation drives truncation and padding: stay within 2%
+			EXPECT_NEAR(static_cast<double>(actualSize), static_cast<double>(estimatedSize), estimatedSize * 0.02) << "format = " << formatToMimetype(format) << ", bitrate = " << bitrate;
+		}
+	}
+
+	std::filesystem::remove(inputFileParameters.trackPath);
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "av/ITranscodeScheduler.hpp"
+
+using namespace Av;
+
+namespace
+{
+	struct Client
+	{
+		ITranscodeScheduler& scheduler;
+		std::vector<std::string>& admissions;
+		std::vector<std::shared_ptr<ITranscodeScheduler::Slot>>& slots;
+
+		bool request(const std::string& user, const std::string& client, const std::string& key, ITranscodeScheduler::Priority priority = ITranscodeScheduler::Priority::Playing)
+		{
+			return scheduler.requestSlot({user, client, key, priority}, [this, key](std::shared_ptr<ITranscodeScheduler::Slot> slot)
+			{
+				admissions.push_back(slot ? key : "superseded " + key);
+				if (slot)
+					slots.push_back(std::move(slot));
+			});
+		}
+
+		void release(std::size_t index)
+		{
+			// releasing may admit other requests, that push new slots
+			std::shared_ptr<ITranscodeScheduler::Slot> slot {std::move(slots[index])};
+			slots.erase(std::begin(slots) + index);
+			slot.reset();
+		}
+	};
+}
+
+TEST(TranscodeScheduler, limits)
+{
+	auto scheduler {createTranscodeScheduler(2, 1, 10)};
+	std::vector<std::string> admissions;
+	std::vector<std::shared_ptr<ITranscodeScheduler::Slot>> slots;
+	Client client {*scheduler, admissions, slots};
+
+	EXPECT_TRUE(client.request("user1", "client1", "a"));
+	EXPECT_TRUE(client.request("user1", "client1", "b")); // user limit
+	EXPECT_TRUE(client.request("user2", "client2", "c"));
+	EXPECT_TRUE(client.request("user3", "client3", "d")); // global limit
+	EXPECT_EQ(admissions, (std::vector<std::string> {"a", "c"}));
+	EXPECT_EQ(scheduler->getStats().runningCount, 2);
+	EXPECT_EQ(scheduler->getStats().queueSize, 2);
+
+	// "b" cannot be admitted as user1 already runs "a"
+	client.release(1);
+	EXPECT_EQ(admissions.back(), "d");
+
+	client.release(0);
+	EXPECT_EQ(admissions.back(), "b");
+
+	while (!slots.empty())
+		client.release(0);
+
+	const ITranscodeScheduler::Stats stats {scheduler->getStats()};
+	EXPECT_EQ(stats.runningCount, 0);
+	EXPECT_EQ(stats.queueSize, 0);
+	EXPECT_EQ(stats.admittedCount, 4);
+}
+
+TEST(TranscodeScheduler, priority)
+{
+	auto scheduler {createTranscodeScheduler(1, 1, 10)};
+	std::vector<std::string> admissions;
+	std::vector<std::shared_ptr<ITranscodeScheduler::Slot>> slots;
+	Client client {*scheduler, admissions, slots};
+
+	EXPECT_TRUE(client.request("user1", "client1", "a"));
+	EXPECT_TRUE(client.request("user2", "client2", "b", ITranscodeScheduler::Priority::Prefetch));
+	EXPECT_TRUE(client.request("user3", "client3", "c", ITranscodeScheduler::Priority::Playing));
+
+	client.release(0);
+	EXPECT_EQ(admissions.back(), "c");
+	client.release(0);
+	EXPECT_EQ(admissions.back(), "b");
+	client.release(0);
+}
+
+TEST(TranscodeScheduler, mostRecentWins)
+{
+	auto scheduler {createTranscodeScheduler(1, 1, 10)};
+	std::vector<std::string> admissions;
+	std::vector<std::shared_ptr<ITranscodeScheduler::Slot>> slots;
+	Client client {*scheduler, admissions, slots};
+
+	EXPECT_TRUE(client.request("user1", "client1", "a"));
+	EXPECT_TRUE(client.request("user2", "client2", "b"));
+	EXPECT_TRUE(client.request("user2", "client2", "c")); // b demoted
+	EXPECT_TRUE(client.request("user3", "client3", "d"));
+	EXPECT_TRUE(client.request("user2", "client2", "e", ITranscodeScheduler::Priority::Prefetch)); // c kept
+
+	while (!slots.empty())
+		client.release(0);
+	EXPECT_EQ(admissions, (std::vector<std::string> {"a", "c", "d", "b", "e"}));
+}
+
+TEST(TranscodeScheduler, queueFull)
+{
+	auto scheduler {createTranscodeScheduler(1, 1, 1)};
+	std::vector<std::string> admissions;
+	std::vector<std::shared_ptr<ITranscodeScheduler::Slot>> slots;
+	Client client {*scheduler, admissions, slots};
+
+	EXPECT_TRUE(client.request("user1", "client1", "a"));
+	EXPECT_TRUE(client.request("user2", "client2", "b"));
+	EXPECT_FALSE(client.request("user3", "client3", "c"));
+	EXPECT_EQ(scheduler->getStats().rejectedCount, 1);
+
+	while (!slots.empty())
+		client.release(0);
+	EXPECT_EQ(admissions, (std::vector<std::string> {"a", "b"}));
+}
+
+TEST(TranscodeScheduler, supersede)
+{
+	auto scheduler {createTranscodeScheduler(1, 1, 10)};
+	std::vector<std::string> admissions;
+	std::vector<std::shared_ptr<ITranscodeScheduler::Slot>> slots;
+	Client client {*scheduler, admissions, slots};
+
+	EXPECT_TRUE(client.request("user1", "client1", "a"));
+	EXPECT_TRUE(client.request("user1", "client1", "b"));
+	EXPECT_EQ(scheduler->getStats().queueSize, 1);
+
+	// queued request superseded
+	EXPECT_TRUE(client.request("user1", "client1", "b"));
+	EXPECT_EQ(admissions.back(), "superseded b");
+	EXPECT_EQ(scheduler->getStats().queueSize, 1);
+
+	// same key on another client: not superseded
+	EXPECT_TRUE(client.request("user2", "client2", "a"));
+	EXPECT_FALSE(slots[0]->isCancelled());
+
+	// running request superseded
+	EXPECT_TRUE(client.request("user1", "client1", "a"));
+	EXPECT_TRUE(slots[0]->isCancelled());
+
+	while (!slots.empty())
+		client.release(0);
+
+	EXPECT_EQ(scheduler->getStats().supersededCount, 2);
+	EXPECT_EQ(scheduler->getStats().runningCount, 0);
+}
@@ -27,14 +27,14 @@
 
 namespace Image
 {
-	std::unique_ptr<IRawImage> decodeImage(const std::byte* encodedData, std::size_t encodedDataSize)
+	std::unique_ptr<IRawImage> decodeImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize)
 	{
-		return std::make_unique<GraphicsMagick::RawImage>(encodedData, encodedDataSize);
+		return std::make_unique<GraphicsMagick::RawImage>(encodedData, encodedDataSize, targetSize);
 	}
 
-	std::unique_ptr<IRawImage> decodeImage(const std::filesystem::path& path)
+	std::unique_ptr<IRawImage> decodeImage(const std::filesystem::path& path, ImageSize targetSize)
 	{
-		return std::make_unique<GraphicsMagick::RawImage>(path);
+		return std::make_unique<GraphicsMagick::RawImage>(path, targetSize);
 	}
 
 	void
@@ -59,10 +59,12 @@ namespace Image
 namespace Image::GraphicsMagick
 {
 
-RawImage::RawImage(const std::byte* encodedData, std::size_t encodedDataSize)
+RawImage::RawImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize)
 {
 	try
 	{
+		setSizeHint(targetSize);
+
 		Magick::Blob blob {encodedData, encodedDataSize};
 		_image.read(blob);
 	}
@@ -82,10 +84,12 @@ RawImage::RawImage(const std::byte* encodedData, std::size_t encodedDataSize)
 	}
 }
 
-RawImage::RawImage(const std::filesystem::path& p)
+RawImage::RawImage(const std::filesystem::path& p, ImageSize targetSize)
 {
 	try
 	{
+		setSizeHint(targetSize);
+
 		_image.read(p.string().c_str());
 	}
 	catch (Magick::WarningCoder& e)
@@ -124,6 +128,14 @@ RawImage::encodeToJPEG(unsigned quality) const
 	return std::make_unique<JPEGImage>(*this, quality);
 }
 
+void
+RawImage::setSizeHint(ImageSize targetSize)
+{
+	// The JPEG coder uses it to decode at a reduced scale (the result is still at least this size)
+	if (targetSize)
+		_image.size(Magick::Geometry {static_cast<unsigned int>(targetSize), static_cast<unsigned int>(targetSize)});
+}
+
 Magick::Image
 RawImage::getMagickImage() const
 {
@@ -36,8 +36,8 @@ namespace Image::GraphicsMagick
 	class RawImage : public IRawImage
 	{
 		public:
-			RawImage(const std::byte* encodedData, std::size_t encodedDataSize);
-			RawImage(const std::filesystem::path& path);
+			RawImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize);
+			RawImage(const std::filesystem::path& path, ImageSize targetSize);
 
 			void resize(ImageSize width) override;
 			std::unique_ptr<IEncodedImage> encodeToJPEG(unsigned quality) const override;
@@ -45,6 +45,7 @@ namespace Image::GraphicsMagick
 		private:
 			friend class JPEGImage;
 			Magick::Image getMagickImage() const;
+			void setSizeHint(ImageSize targetSize);
 
 			Magick::Image _image;
 	};
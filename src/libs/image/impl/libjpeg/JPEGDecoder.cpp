@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JPEGDecoder.hpp"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+
+#include <jpeglib.h>
+
+namespace Image::LibJPEG
+{
+	namespace
+	{
+		struct ErrorManager
+		{
+			jpeg_error_mgr	pub;
+			std::jmp_buf	jumpBuffer;
+		};
+
+		void
+		onError(j_common_ptr cinfo)
+		{
+			std::longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->jumpBuffer, 1);
+		}
+
+		void
+		onMessage(j_common_ptr)
+		{
+			// corrupt data warnings: too verbose for our use
+		}
+
+		unsigned
+		computeScaleDenom(unsigned width, unsigned height, ImageSize targetSize)
+		{
+			if (targetSize == 0)
+				return 1;
+
+			const unsigned maxSide {std::max(width, height)};
+			for (const unsigned denom : {8, 4, 2})
+			{
+				if ((maxSide + denom - 1) / denom >= targetSize)
+					return denom;
+			}
+
+			return 1;
+		}
+
+		// No object with a non trivial destructor must live in this function, because of longjmp
+		unsigned char*
+		decodeRGB(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize, int& width, int& height)
+		{
+			jpeg_decompress_struct cinfo;
+			ErrorManager errorManager;
+			unsigned char* volatile output {};
+
+			cinfo.err = jpeg_std_error(&errorManager.pub);
+			errorManager.pub.error_exit = onError;
+			errorManager.pub.output_message = onMessage;
+
+			if (setjmp(errorManager.jumpBuffer))
+			{
+				jpeg_destroy_decompress(&cinfo);
+				std::free(output);
+				return nullptr;
+			}
+
+			jpeg_create_decompress(&cinfo);
+			jpeg_mem_src(&cinfo, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(encodedData)), encodedDataSize);
+			jpeg_read_header(&cinfo, TRUE);
+
+			cinfo.out_color_space = JCS_RGB;
+			cinfo.scale_num = 1;
+			cinfo.scale_denom = computeScaleDenom(cinfo.image_width, cinfo.image_height, targetSize);
+
+			jpeg_start_decompress(&cinfo);
+
+			const std::size_t rowSize {static_cast<std::size_t>(cinfo.output_width) * cinfo.output_components};
+			output = static_cast<unsigned char*>(std::malloc(rowSize * cinfo.output_height));
+			if (!output)
+			{
+				jpeg_destroy_decompress(&cinfo);
+				return nullptr;
+			}
+
+			while (cinfo.output_scanline < cinfo.output_height)
+			{
+				JSAMPROW row {output + cinfo.output_scanline * rowSize};
+				jpeg_read_scanlines(&cinfo, &row, 1);
+			}
+
+			width = cinfo.output_width;
+			height = cinfo.output_height;
+
+			jpeg_finish_decompress(&cinfo);
+			jpeg_destroy_decompress(&cinfo);
+
+			return output;
+		}
+	}
+
+	bool
+	isJPEG(const std::byte* encodedData, std::size_t encodedDataSize)
+	{
+		return encodedDataSize >= 3
+			&& encodedData[0] == std::byte {0xFF}
+			&& encodedData[1] == std::byte {0xD8}
+			&& encodedData[2] == std::byte {0xFF};
+	}
+
+	std::optional<DecodedImage>
+	decode(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize)
+	{
+		std::optional<DecodedImage> res;
+
+		int width {};
+		int height {};
+		if (unsigned char* data {decodeRGB(encodedData, encodedDataSize, targetSize, width, height)})
+		{
+			res = DecodedImage {};
+			res->data.reset(data);
+			res->width = width;
+			res->height = height;
+		}
+
+		return res;
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef LMS_SUPPORT_IMAGE_LIBJPEG
+#error "Bad configuration"
+#endif
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+
+#include "image/IEncodedImage.hpp"
+
+namespace Image::LibJPEG
+{
+	struct DecodedImage
+	{
+		std::unique_ptr<unsigned char, decltype(&std::free)> data {nullptr, std::free}; // 8-bit RGB
+		int width {};
+		int height {};
+	};
+
+	bool isJPEG(const std::byte* encodedData, std::size_t encodedDataSize);
+
+	// Uses DCT scaling (1/2, 1/4 or 1/8) when targetSize allows it, the largest side of the result is never smaller than targetSize
+	// std::nullopt if libjpeg cannot decode the data
+	std::optional<DecodedImage> decode(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize);
+}
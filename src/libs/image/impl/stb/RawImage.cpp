@@ -28,20 +28,28 @@
 #include <stb/stb_image.h>
 #include <stb/stb_image_resize.h>
 
+#if LMS_SUPPORT_IMAGE_LIBJPEG
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "libjpeg/JPEGDecoder.hpp"
+#endif
+
 #include "JPEGImage.hpp"
 
 #include "image/Exception.hpp"
 
 namespace Image
 {
-	std::unique_ptr<IRawImage> decodeImage(const std::byte* encodedData, std::size_t encodedDataSize)
+	std::unique_ptr<IRawImage> decodeImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize)
 	{
-		return std::make_unique<STB::RawImage>(encodedData, encodedDataSize);
+		return std::make_unique<STB::RawImage>(encodedData, encodedDataSize, targetSize);
 	}
 
-	std::unique_ptr<IRawImage> decodeImage(const std::filesystem::path& path)
+	std::unique_ptr<IRawImage> decodeImage(const std::filesystem::path& path, ImageSize targetSize)
 	{
-		return std::make_unique<STB::RawImage>(path);
+		return std::make_unique<STB::RawImage>(path, targetSize);
 	}
 
 	void
@@ -52,18 +60,55 @@ namespace Image
 
 namespace Image::STB
 {
-	RawImage::RawImage(const std::byte* encodedData, std::size_t encodedDataSize)
+	RawImage::RawImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize)
+	{
+		decode(encodedData, encodedDataSize, targetSize);
+	}
+
+	RawImage::RawImage(const std::filesystem::path& p, ImageSize targetSize)
 	{
+#if LMS_SUPPORT_IMAGE_LIBJPEG
+		// Load the whole file so that JPEG files can be decoded at a reduced scale
+		std::ifstream ifs {p, std::ios::binary};
+		if (!ifs)
+			throw ImageException {"Cannot open image file"};
+
+		const std::vector<char> encodedData {std::istreambuf_iterator<char> {ifs}, std::istreambuf_iterator<char> {}};
+		if (ifs.bad())
+			throw ImageException {"Cannot read image file"};
+
+		decode(reinterpret_cast<const std::byte*>(encodedData.data()), encodedData.size(), targetSize);
+#else
+		(void)targetSize;
+
 		int n;
-		_data = UniquePtrFree {stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encodedData), encodedDataSize, &_width, &_height, &n, 3), std::free};
+		_data = UniquePtrFree {stbi_load(p.string().c_str(), &_width, &_height, &n, 3), std::free};
 		if (!_data)
 			throw ImageException {"Cannot load image from memory"};
+#endif
 	}
 
-	RawImage::RawImage(const std::filesystem::path& p)
+	void
+	RawImage::decode(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize)
 	{
+#if LMS_SUPPORT_IMAGE_LIBJPEG
+		if (LibJPEG::isJPEG(encodedData, encodedDataSize))
+		{
+			// Fall back on stb in case of error (unsupported color space, etc.)
+			if (std::optional<LibJPEG::DecodedImage> decodedImage {LibJPEG::decode(encodedData, encodedDataSize, targetSize)})
+			{
+				_data = std::move(decodedImage->data);
+				_width = decodedImage->width;
+				_height = decodedImage->height;
+				return;
+			}
+		}
+#else
+		(void)targetSize;
+#endif
+
 		int n;
-		_data = UniquePtrFree {stbi_load(p.string().c_str(), &_width, &_height, &n, 3), std::free};
+		_data = UniquePtrFree {stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encodedData), encodedDataSize, &_width, &_height, &n, 3), std::free};
 		if (!_data)
 			throw ImageException {"Cannot load image from memory"};
 	}
@@ -34,8 +34,8 @@ namespace Image::STB
 	class RawImage : public IRawImage
 	{
 		public:
-			RawImage(const std::byte* encodedData, std::size_t encodedDataSize);
-			RawImage(const std::filesystem::path& path);
+			RawImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize);
+			RawImage(const std::filesystem::path& path, ImageSize targetSize);
 
 			void resize(ImageSize width) override;
 			std::unique_ptr<IEncodedImage> encodeToJPEG(unsigned quality) const override;
@@ -45,6 +45,8 @@ namespace Image::STB
 			const std::byte* getData() const;
 
 		private:
+			void decode(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize);
+
 			int _width;
 			int _height;
 			using UniquePtrFree = std::unique_ptr<unsigned char, decltype(&std::free)>;
@@ -35,7 +35,9 @@ namespace Image
 	};
 
 	void init(const std::filesystem::path& path);
-	std::unique_ptr<IRawImage> decodeImage(const std::byte* encodedData, std::size_t encodedDataSize);
-	std::unique_ptr<IRawImage> decodeImage(const std::filesystem::path& path);
+
+	// targetSize is a hint: when set, the decoder may produce a smaller image than the original one (but never smaller than targetSize on its largest side)
+	std::unique_ptr<IRawImage> decodeImage(const std::byte* encodedData, std::size_t encodedDataSize, ImageSize targetSize = 0);
+	std::unique_ptr<IRawImage> decodeImage(const std::filesystem::path& path, ImageSize targetSize = 0);
 }
 
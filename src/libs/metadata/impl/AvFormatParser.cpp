@@ -124,119 +124,134 @@ getArtists(const Av::IAudioFile::MetadataMap& metadataMap)
 	return artists;
 }
 
-std::optional<Track>
-AvFormatParser::parse(const std::filesystem::path& p, bool debug)
+std::optional<RawTrack>
+AvFormatParser::readRawTrack(const std::filesystem::path& p, bool debug)
 {
-	Track track;
+	RawTrack track;
 
 	try
 	{
 		const auto mediaFile {Av::parseAudioFile(p)};
 
 		// Stream info
-		{
-			std::vector<AudioStream> audioStreams;
-
-			for (auto stream : mediaFile->getStreamInfo())
-			{
-				MetaData::AudioStream audioStream {static_cast<unsigned>(stream.bitrate)};
-				track.audioStreams.emplace_back(audioStream);
-			}
-		}
+		for (auto stream : mediaFile->getStreamInfo())
+			track.audioStreamBitRates.push_back(static_cast<unsigned>(stream.bitrate));
 
 		track.duration = mediaFile->getDuration();
 		track.hasCover = mediaFile->hasAttachedPictures();
 
-		MetaData::Clusters clusters;
-
-		const Av::IAudioFile::MetadataMap metadataMap {mediaFile->getMetaData()};
-
-		for (const auto& [tag, value] : metadataMap)
+		for (const auto& [tag, value] : mediaFile->getMetaData())
 		{
 			if (debug)
 				std::cout << "TAG = " << tag << ", VAL = " << value << std::endl;
 
-			if (tag == "TITLE")
-				track.title = value;
-			else if (tag == "TRACK")
-			{
-				// Expecting 'Number/Total'
-				const std::vector<std::string_view> strings {StringUtils::splitString(value, "/") };
-				if (strings.size() > 0)
-				{
-					track.trackNumber = StringUtils::readAs<std::size_t>(strings[0]);
-
-					if (strings.size() > 1)
-						track.totalTrack = StringUtils::readAs<std::size_t>(strings[1]);
-				}
-			}
-			else if (tag == "DISC")
-			{
-				// Expecting 'Number/Total'
-				const std::vector<std::string_view> strings {StringUtils::splitString(value, "/")};
-				if (strings.size() > 0)
-				{
-					track.discNumber = StringUtils::readAs<std::size_t>(strings[0]);
-
-					if (strings.size() > 1)
-						track.totalDisc = StringUtils::readAs<std::size_t>(strings[1]);
-				}
-			}
-			else if (tag == "DATE"
-					|| tag == "YEAR"
-					|| tag == "WM/Year")
-			{
-				track.date = Utils::parseDate(value);
-			}
-			else if (tag == "TDOR"	// Original release time (ID3v2 2.4)
-					|| tag == "TORY")	// Original release year
-			{
-				track.originalDate = Utils::parseDate(value);
-			}
-			else if (tag == "ACOUSTID ID")
-			{
-				track.acoustID = UUID::fromString(value);
-			}
-			else if (tag == "MUSICBRAINZ RELEASE TRACK ID"
-					|| tag == "MUSICBRAINZ_RELEASETRACKID")
-			{
-				track.trackMBID = UUID::fromString(value);
-			}
-			else if (tag == "MUSICBRAINZ_TRACKID"
-					|| tag == "MUSICBRAINZ/TRACK ID")
+			track.tags.emplace_back(tag, std::vector<std::string> {value});
+		}
+	}
+	catch(Av::Exception& e)
+	{
+		return std::nullopt;
+	}
+
+	return track;
+}
+
+Track
+AvFormatParser::parseRawTrack(const RawTrack& rawTrack, bool)
+{
+	Track track;
+
+	for (const unsigned bitRate : rawTrack.audioStreamBitRates)
+		track.audioStreams.emplace_back(AudioStream {bitRate});
+
+	track.duration = rawTrack.duration;
+	track.hasCover = rawTrack.hasCover;
+
+	Av::IAudioFile::MetadataMap metadataMap;
+	for (const auto& [tag, values] : rawTrack.tags)
+	{
+		if (!values.empty())
+			metadataMap.emplace(tag, values.front());
+	}
+
+	for (const auto& [tag, value] : metadataMap)
+	{
+		if (tag == "TITLE")
+			track.title = value;
+		else if (tag == "TRACK")
+		{
+			// Expecting 'Number/Total'
+			const std::vector<std::string_view> strings {StringUtils::splitString(value, "/") };
+			if (strings.size() > 0)
 			{
-				track.recordingMBID = UUID::fromString(value);
+				track.trackNumber = StringUtils::readAs<std::size_t>(strings[0]);
+
+				if (strings.size() > 1)
+					track.totalTrack = StringUtils::readAs<std::size_t>(strings[1]);
 			}
-			else if (tag == "TSST"
-					|| tag == "DISCSUBTITLE"
-					|| tag == "SETSUBTITLE")
+		}
+		else if (tag == "DISC")
+		{
+			// Expecting 'Number/Total'
+			const std::vector<std::string_view> strings {StringUtils::splitString(value, "/")};
+			if (strings.size() > 0)
 			{
-				track.discSubtitle = value;
+				track.discNumber = StringUtils::readAs<std::size_t>(strings[0]);
+
+				if (strings.size() > 1)
+					track.totalDisc = StringUtils::readAs<std::size_t>(strings[1]);
 			}
-			else if (_clusterTypeNames.find(tag) != _clusterTypeNames.end())
+		}
+		else if (tag == "DATE"
+				|| tag == "YEAR"
+				|| tag == "WM/Year")
+		{
+			track.date = Utils::parseDate(value);
+		}
+		else if (tag == "TDOR"	// Original release time (ID3v2 2.4)
+				|| tag == "TORY")	// Original release year
+		{
+			track.originalDate = Utils::parseDate(value);
+		}
+		else if (tag == "ACOUSTID ID")
+		{
+			track.acoustID = UUID::fromString(value);
+		}
+		else if (tag == "MUSICBRAINZ RELEASE TRACK ID"
+				|| tag == "MUSICBRAINZ_RELEASETRACKID")
+		{
+			track.trackMBID = UUID::fromString(value);
+		}
+		else if (tag == "MUSICBRAINZ_TRACKID"
+				|| tag == "MUSICBRAINZ/TRACK ID")
+		{
+			track.recordingMBID = UUID::fromString(value);
+		}
+		else if (tag == "TSST"
+				|| tag == "DISCSUBTITLE"
+				|| tag == "SETSUBTITLE")
+		{
+			track.discSubtitle = value;
+		}
+		else if (_clusterTypeNames.find(tag) != _clusterTypeNames.end())
+		{
+			const std::vector<std::string_view> clusterNames {StringUtils::splitString(value, "/,;")};
+
+			if (!clusterNames.empty())
 			{
-				const std::vector<std::string_view> clusterNames {StringUtils::splitString(value, "/,;")};
-
-				if (!clusterNames.empty())
-				{
-					std::set<std::string> values;
-					std::transform(std::cbegin(clusterNames), std::cend(clusterNames),
-							std::inserter(values, std::begin(values)),
-							[](std::string_view clusterName) { return std::string {clusterName}; });
-					track.clusters[tag] = std::move(values);
-				}
+				std::set<std::string> values;
+				std::transform(std::cbegin(clusterNames), std::cend(clusterNames),
+						std::inserter(values, std::begin(values)),
+						[](std::string_view clusterName) { return std::string {clusterName}; });
+				track.clusters[tag] = std::move(values);
 			}
 		}
-
-		track.artists = getArtists(metadataMap);
-		track.album = getAlbum(metadataMap);
-		track.albumArtists = getAlbumArtists(metadataMap);
-	}
-	catch(Av::Exception& e)
-	{
-		return std::nullopt;
 	}
 
+	track.artists = getArtists(metadataMap);
+	track.album = getAlbum(metadataMap);
+	track.albumArtists = getAlbumArtists(metadataMap);
+
 	return track;
 }
 
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metadata/RawTrack.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+namespace MetaData
+{
+	namespace
+	{
+		// To be bumped each time the encoding or the contents of RawTrack change
+		constexpr std::uint8_t formatVersion {1};
+
+		class Writer
+		{
+			public:
+				void writeU8(std::uint8_t value) { _data.push_back(value); }
+
+				void writeU32(std::uint32_t value)
+				{
+					for (std::size_t i {}; i < 4; ++i)
+						_data.push_back(static_cast<unsigned char>(value >> (8 * i)));
+				}
+
+				void writeU64(std::uint64_t value)
+				{
+					for (std::size_t i {}; i < 8; ++i)
+						_data.push_back(static_cast<unsigned char>(value >> (8 * i)));
+				}
+
+				void writeString(std::string_view str)
+				{
+					writeU32(static_cast<std::uint32_t>(str.size()));
+					_data.insert(std::end(_data), std::cbegin(str), std::cend(str));
+				}
+
+				std::vector<unsigned char> release() { return std::move(_data); }
+
+			private:
+				std::vector<unsigned char> _data;
+		};
+
+		// All reads fail once the data is exhausted
+		class Reader
+		{
+			public:
+				Reader(const std::vector<unsigned char>& data) : _data {data} {}
+
+				bool readU8(std::uint8_t& value)
+				{
+					if (_data.size() - _offset < 1)
+						return false;
+
+					value = _data[_offset++];
+					return true;
+				}
+
+				bool readU32(std::uint32_t& value)
+				{
+					if (_data.size() - _offset < 4)
+						return false;
+
+					value = 0;
+					for (std::size_t i {}; i < 4; ++i)
+						value |= static_cast<std::uint32_t>(_data[_offset++]) << (8 * i);
+					return true;
+				}
+
+				bool readU64(std::uint64_t& value)
+				{
+					if (_data.size() - _offset < 8)
+						return false;
+
+					value = 0;
+					for (std::size_t i {}; i < 8; ++i)
+						value |= static_cast<std::uint64_t>(_data[_offset++]) << (8 * i);
+					return true;
+				}
+
+				bool readString(std::string& str)
+				{
+					std::uint32_t size;
+					if (!readU32(size) || _data.size() - _offset < size)
+						return false;
+
+					str.assign(reinterpret_cast<const char*>(_data.data()) + _offset, size);
+					_offset += size;
+					return true;
+				}
+
+				// sizes are checked against the remaining data to avoid huge allocations on corrupted inputs
+				bool readCount(std::uint32_t& count)
+				{
+					return readU32(count) && count <= _data.size() - _offset;
+				}
+
+				bool isEnd() const { return _offset == _data.size(); }
+
+			private:
+				const std::vector<unsigned char>& _data;
+				std::size_t _offset {};
+		};
+	}
+
+	std::vector<unsigned char>
+	serializeRawTrack(const RawTrack& rawTrack)
+	{
+		Writer writer;
+
+		writer.writeU8(formatVersion);
+		writer.writeU64(static_cast<std::uint64_t>(rawTrack.duration.count()));
+		writer.writeU8(rawTrack.hasCover);
+
+		writer.writeU32(static_cast<std::uint32_t>(rawTrack.audioStreamBitRates.size()));
+		for (const unsigned bitRate : rawTrack.audioStreamBitRates)
+			writer.writeU32(bitRate);
+
+		writer.writeU32(static_cast<std::uint32_t>(rawTrack.tags.size()));
+		for (const auto& [tag, values] : rawTrack.tags)
+		{
+			writer.writeString(tag);
+			writer.writeU32(static_cast<std::uint32_t>(values.size()));
+			for (const std::string& value : values)
+				writer.writeString(value);
+		}
+
+		return writer.release();
+	}
+
+	std::optional<RawTrack>
+	deserializeRawTrack(const std::vector<unsigned char>& data)
+	{
+		Reader reader {data};
+
+		std::uint8_t version;
+		if (!reader.readU8(version) || version != formatVersion)
+			return std::nullopt;
+
+		RawTrack rawTrack;
+
+		std::uint64_t duration;
+		std::uint8_t hasCover;
+		if (!reader.readU64(duration) || !reader.readU8(hasCover))
+			return std::nullopt;
+
+		rawTrack.duration = std::chrono::milliseconds {static_cast<std::chrono::milliseconds::rep>(duration)};
+		rawTrack.hasCover = hasCover;
+
+		std::uint32_t streamCount;
+		if (!reader.readCount(streamCount))
+			return std::nullopt;
+
+		rawTrack.audioStreamBitRates.resize(streamCount);
+		for (unsigned& bitRate : rawTrack.audioStreamBitRates)
+		{
+			std::uint32_t value;
+			if (!reader.readU32(value))
+				return std::nullopt;
+			bitRate = value;
+		}
+
+		std::uint32_t tagCount;
+		if (!reader.readCount(tagCount))
+			return std::nullopt;
+
+		rawTrack.tags.resize(tagCount);
+		for (auto& [tag, values] : rawTrack.tags)
+		{
+			std::uint32_t valueCount;
+			if (!reader.readString(tag) || !reader.readCount(valueCount))
+				return std::nullopt;
+
+			values.resize(valueCount);
+			for (std::string& value : values)
+			{
+				if (!reader.readString(value))
+					return std::nullopt;
+			}
+		}
+
+		if (!reader.isEnd())
+			return std::nullopt;
+
+		return rawTrack;
+	}
+} // namespace MetaData
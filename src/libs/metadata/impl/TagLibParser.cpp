@@ -327,8 +327,8 @@ TagLibParser::processTag(Track& track, const std::string& tag, const TagLib::Str
 	}
 }
 
-std::optional<Track>
-TagLibParser::parse(const std::filesystem::path& p, bool debug)
+std::optional<RawTrack>
+TagLibParser::readRawTrack(const std::filesystem::path& p, bool debug)
 {
 	TagLib::FileRef f {p.string().c_str(),
 		true, // read audio properties
@@ -346,15 +346,13 @@ TagLibParser::parse(const std::filesystem::path& p, bool debug)
 		return std::nullopt;
 	}
 
-	Track track;
+	RawTrack track;
 
 	{
 		const TagLib::AudioProperties *properties {f.audioProperties() };
 
 		track.duration = std::chrono::milliseconds {properties->lengthInMilliseconds()};
-
-		MetaData::AudioStream audioStream {static_cast<unsigned>(properties->bitrate() * 1000)};
-		track.audioStreams = {std::move(audioStream)};
+		track.audioStreamBitRates = {static_cast<unsigned>(properties->bitrate() * 1000)};
 	}
 
 	TagLib::PropertyMap properties {f.file()->properties()};
@@ -458,6 +456,39 @@ TagLibParser::parse(const std::filesystem::path& p, bool debug)
 			track.hasCover = true;
 	}
 
+	track.tags.reserve(properties.size());
+	for (const auto& [tag, values] : properties)
+	{
+		std::vector<std::string> strValues;
+		strValues.reserve(values.size());
+		std::transform(values.begin(), values.end(), std::back_inserter(strValues), [](const TagLib::String& value) { return value.to8Bit(true); });
+
+		track.tags.emplace_back(tag.to8Bit(true), std::move(strValues));
+	}
+
+	return track;
+}
+
+Track
+TagLibParser::parseRawTrack(const RawTrack& rawTrack, bool debug)
+{
+	Track track;
+
+	track.duration = rawTrack.duration;
+	std::transform(std::cbegin(rawTrack.audioStreamBitRates), std::cend(rawTrack.audioStreamBitRates), std::back_inserter(track.audioStreams),
+			[](unsigned bitRate) { return AudioStream {bitRate}; });
+	track.hasCover = rawTrack.hasCover;
+
+	TagLib::PropertyMap properties;
+	for (const auto& [tag, values] : rawTrack.tags)
+	{
+		TagLib::StringList tagValues;
+		for (const std::string& value : values)
+			tagValues.append(TagLib::String {value, TagLib::String::UTF8});
+
+		properties.insert(TagLib::String {tag, TagLib::String::UTF8}, tagValues);
+	}
+
 	for (const auto& [tag, values] : properties)
 		processTag(track, tag.upper().to8Bit(true), values, debug);
 
@@ -37,7 +37,8 @@ class TagLibParser : public IParser
 		TagLibParser(ParserReadStyle readStyle);
 
 	private:
-		std::optional<Track> parse(const std::filesystem::path& p, bool debug = false) override;
+		std::optional<RawTrack> readRawTrack(const std::filesystem::path& p, bool debug = false) override;
+		Track parseRawTrack(const RawTrack& rawTrack, bool debug = false) override;
 		void processTag(Track& track, const std::string& tag, const TagLib::StringList& values, bool debug);
 
 		const TagLib::AudioProperties::ReadStyle _readStyle;
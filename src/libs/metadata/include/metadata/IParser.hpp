@@ -29,6 +29,7 @@
 #include <vector>
 
 #include <Wt/WDate.h>
+#include "metadata/RawTrack.hpp"
 #include "utils/UUID.hpp"
 
 namespace MetaData
@@ -96,7 +97,18 @@ namespace MetaData
 		public:
 			virtual ~IParser() = default;
 
-			virtual std::optional<Track> parse(const std::filesystem::path& p, bool debug = false) = 0;
+			std::optional<Track> parse(const std::filesystem::path& p, bool debug = false)
+			{
+				std::optional<RawTrack> rawTrack {readRawTrack(p, debug)};
+				if (!rawTrack)
+					return std::nullopt;
+
+				return parseRawTrack(*rawTrack, debug);
+			}
+
+			// Reading the file is the costly part: the raw track can be kept and parsed again later
+			virtual std::optional<RawTrack> readRawTrack(const std::filesystem::path& p, bool debug = false) = 0;
+			virtual Track parseRawTrack(const RawTrack& rawTrack, bool debug = false) = 0;
 
 			void setClusterTypeNames(const std::set<std::string>& clusterTypeNames) { _clusterTypeNames = clusterTypeNames; }
 
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MetaData
+{
+	// What a parser reads from an audio file
+	// A Track can be built again from it without accessing the file
+	struct RawTrack
+	{
+		std::chrono::milliseconds	duration {};
+		std::vector<unsigned>		audioStreamBitRates;
+		bool						hasCover {};
+		std::vector<std::pair<std::string, std::vector<std::string>>>	tags; // parser specific names, in read order
+	};
+
+	// Compact binary encoding, suitable for persistent storage
+	std::vector<unsigned char>	serializeRawTrack(const RawTrack& rawTrack);
+	std::optional<RawTrack>		deserializeRawTrack(const std::vector<unsigned char>& data); // nullopt if corrupted or in an older format
+} // namespace MetaData
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "metadata/RawTrack.hpp"
+
+TEST(MetaData, rawTrackSerialization)
+{
+	using namespace MetaData;
+
+	RawTrack rawTrack;
+	rawTrack.duration = std::chrono::milliseconds {123456};
+	rawTrack.audioStreamBitRates = {320000, 128000};
+	rawTrack.hasCover = true;
+	rawTrack.tags = {
+		{"ARTIST", {"MyArtist1", "MyArtist2"}},
+		{"EMPTY", {}},
+		{"TITLE", {"Ma chanson \xc3\xa9t\xc3\xa9"}},
+		{"NULLVALUE", {""}},
+	};
+
+	const std::vector<unsigned char> data {serializeRawTrack(rawTrack)};
+
+	const std::optional<RawTrack> res {deserializeRawTrack(data)};
+	ASSERT_TRUE(res);
+	EXPECT_EQ(res->duration, rawTrack.duration);
+	EXPECT_EQ(res->audioStreamBitRates, rawTrack.audioStreamBitRates);
+	EXPECT_EQ(res->hasCover, rawTrack.hasCover);
+	EXPECT_EQ(res->tags, rawTrack.tags);
+
+	// truncated data must not be accepted
+	for (std::size_t size {}; size < data.size(); ++size)
+		EXPECT_FALSE(deserializeRawTrack(std::vector<unsigned char>(std::cbegin(data), std::cbegin(data) + size))) << "size = " << size;
+
+	// trailing data must not be accepted either
+	std::vector<unsigned char> longerData {data};
+	longerData.push_back(0);
+	EXPECT_FALSE(deserializeRawTrack(longerData));
+}
+
+TEST(MetaData, rawTrackSerializationBadVersion)
+{
+	using namespace MetaData;
+
+	std::vector<unsigned char> data {serializeRawTrack(RawTrack {})};
+	ASSERT_FALSE(data.empty());
+	EXPECT_TRUE(deserializeRawTrack(data));
+
+	data[0] += 1;
+	EXPECT_FALSE(deserializeRawTrack(data));
+}
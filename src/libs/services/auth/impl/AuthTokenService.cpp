@@ -76,8 +76,18 @@ namespace Auth
 		const std::string secretHash {sha1Function.compute(std::string {secret}, {})};
 
 		Database::Session& session {getDbSession()};
+
+		// Unknown tokens are the common case under attack: only take the writer lock if the token has to be consumed
+		{
+			auto transaction {session.createSharedTransaction()};
+
+			if (!Database::AuthToken::find(session, secretHash))
+				return std::nullopt;
+		}
+
 		auto transaction {session.createUniqueTransaction()};
 
+		// may have been consumed in the meantime
 		Database::AuthToken::pointer authToken {Database::AuthToken::find(session, secretHash)};
 		if (!authToken)
 			return std::nullopt;
@@ -100,30 +110,24 @@ namespace Auth
 	AuthTokenService::processAuthToken(const boost::asio::ip::address& clientAddress, std::string_view tokenValue)
 	{
 		// Do not waste too much resource on brute force attacks (optim)
-		{
-			std::shared_lock lock {_mutex};
-
-			if (_loginThrottler.isClientThrottled(clientAddress))
-				return AuthTokenProcessResult {AuthTokenProcessResult::State::Throttled};
-		}
+		if (_loginThrottler.isClientThrottled(clientAddress))
+			return AuthTokenProcessResult {AuthTokenProcessResult::State::Throttled};
 
 		auto res {processAuthToken(tokenValue)};
-		{
-			std::unique_lock lock {_mutex};
 
-			if (_loginThrottler.isClientThrottled(clientAddress))
-				return AuthTokenProcessResult {AuthTokenProcessResult::State::Throttled};
+		// Another attempt may have throttled the client in the meantime
+		if (_loginThrottler.isClientThrottled(clientAddress))
+			return AuthTokenProcessResult {AuthTokenProcessResult::State::Throttled};
 
-			if (!res)
-			{
-				_loginThrottler.onBadClientAttempt(clientAddress);
-				return AuthTokenProcessResult {AuthTokenProcessResult::State::Denied};
-			}
-
-			_loginThrottler.onGoodClientAttempt(clientAddress);
-			onUserAuthenticated(res->userId);
-			return AuthTokenProcessResult {AuthTokenProcessResult::State::Granted, std::move(*res)};
+		if (!res)
+		{
+			_loginThrottler.onBadClientAttempt(clientAddress);
+			return AuthTokenProcessResult {AuthTokenProcessResult::State::Denied};
 		}
+
+		_loginThrottler.onGoodClientAttempt(clientAddress);
+		onUserAuthenticated(res->userId);
+		return AuthTokenProcessResult {AuthTokenProcessResult::State::Granted, std::move(*res)};
 	}
 
 	void
@@ -19,8 +19,6 @@
 
 #pragma once
 
-#include <shared_mutex>
-
 #include "services/auth/IAuthTokenService.hpp"
 #include "AuthServiceBase.hpp"
 #include "LoginThrottler.hpp"
@@ -49,7 +47,6 @@ namespace Auth
 
 			std::optional<AuthTokenService::AuthTokenProcessResult::AuthTokenInfo> processAuthToken(std::string_view secret);
 
-			std::shared_mutex	_mutex;
 			LoginThrottler		_loginThrottler;
 	};
 }
@@ -17,12 +17,12 @@
  * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-/* This file contains some classes in order to get info from file using the libavconv */
-
 #include "LoginThrottler.hpp"
 
+#include <algorithm>
+#include <cassert>
+
 #include "utils/Logger.hpp"
-#include "utils/Random.hpp"
 
 namespace Auth {
 
@@ -32,7 +32,7 @@ getAddressWithMask(const boost::asio::ip::address_v6& address, std::size_t prefi
 {
 	assert(prefix % 8 == 0);
 
-	std::array<uint8_t, 16> truncatedBytes;
+	std::array<uint8_t, 16> truncatedBytes {};
 
 	auto bytes {address.to_bytes()};
 	std::copy(std::cbegin(bytes), std::next(std::cbegin(bytes), prefix / 8), truncatedBytes.begin());
@@ -47,56 +47,129 @@ getAddressToThrottle(const boost::asio::ip::address& address)
 	return address.is_v6() ? getAddressWithMask(address.to_v6(), 64) : address;
 }
 
-void
-LoginThrottler::removeOutdatedEntries()
+LoginThrottler::LoginThrottler(std::size_t maxEntries, Clock::duration throttleDuration)
+	: _throttleDuration {throttleDuration}
+{
+	const std::size_t setCount {std::max(maxEntries / (shardCount * wayCount), std::size_t {1})};
+
+	for (Shard& shard : _shards)
+		shard.sets = std::vector<Set>(setCount);
+}
+
+LoginThrottler::Key
+LoginThrottler::computeKey(const boost::asio::ip::address& address)
 {
-	const Wt::WDateTime now {Wt::WDateTime::currentDateTime()};
+	Key key {};
 
-	for (auto it {std::begin(_attemptsInfo)}; it != std::end(_attemptsInfo); )
+	// IPv6 addresses are throttled by /64 blocks: the first 8 bytes are enough
+	const boost::asio::ip::address addressToThrottle {getAddressToThrottle(address)};
+	if (addressToThrottle.is_v4())
 	{
-		if (it->second <= now)
-			it = _attemptsInfo.erase(it);
-		else
-			++it;
+		key = (Key {0xFFFFFFFF} << 32) | addressToThrottle.to_v4().to_uint();
 	}
+	else
+	{
+		const auto bytes {addressToThrottle.to_v6().to_bytes()};
+		for (std::size_t i {}; i < 8; ++i)
+			key = (key << 8) | bytes[i];
+	}
+
+	// splitmix64 finalizer, to spread the bits over shards and sets
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+	key = key ^ (key >> 31);
+
+	return key ? key : 1;
 }
 
-void
-LoginThrottler::onBadClientAttempt(const boost::asio::ip::address& address)
+LoginThrottler::Set&
+LoginThrottler::getSet(Key key)
 {
-	const boost::asio::ip::address clientAddress {getAddressToThrottle(address)};
+	Shard& shard {_shards[key % shardCount]};
+	return shard.sets[(key / shardCount) % shard.sets.size()];
+}
 
-	const Wt::WDateTime now {Wt::WDateTime::currentDateTime()};
+const LoginThrottler::Set&
+LoginThrottler::getSet(Key key) const
+{
+	const Shard& shard {_shards[key % shardCount]};
+	return shard.sets[(key / shardCount) % shard.sets.size()];
+}
 
-	if (_attemptsInfo.size() >= _maxEntries)
-		removeOutdatedEntries();
-	if (_attemptsInfo.size() >= _maxEntries)
-		_attemptsInfo.erase(Random::pickRandom(_attemptsInfo));
+void
+LoginThrottler::onBadClientAttempt(const boost::asio::ip::address& address)
+{
+	const Key key {computeKey(address)};
+	const Clock::rep throttledUntil {(Clock::now() + _throttleDuration).time_since_epoch().count()};
 
-	_attemptsInfo[address] = now.addSecs(3);
+	Set& set {getSet(key)};
+	{
+		std::scoped_lock lock {_shards[key % shardCount].mutex};
+
+		// Reuse the client entry if any, otherwise evict the entry that expires first (expired or empty ones first)
+		Entry* entry {};
+		for (Entry& candidate : set)
+		{
+			if (candidate.key.load(std::memory_order_relaxed) == key)
+			{
+				entry = &candidate;
+				break;
+			}
+
+			if (!entry || candidate.throttledUntil.load(std::memory_order_relaxed) < entry->throttledUntil.load(std::memory_order_relaxed))
+				entry = &candidate;
+		}
+
+		// Evicting: clear the expiry before changing the key, so that readers never see the new expiry with the evicted key
+		if (entry->key.load(std::memory_order_relaxed) != key)
+		{
+			entry->throttledUntil.store(0, std::memory_order_relaxed);
+			entry->key.store(key, std::memory_order_release);
+		}
+		entry->throttledUntil.store(throttledUntil, std::memory_order_release);
+	}
 
-	LMS_LOG(AUTH, DEBUG) << "Registering bad attempt for '" << clientAddress.to_string() << "'";
+	LMS_LOG(AUTH, DEBUG) << "Registering bad attempt for '" << getAddressToThrottle(address).to_string() << "'";
 }
 
 void
 LoginThrottler::onGoodClientAttempt(const boost::asio::ip::address& address)
 {
-	const boost::asio::ip::address clientAddress {getAddressToThrottle(address)};
+	const Key key {computeKey(address)};
 
-	_attemptsInfo.erase(clientAddress);
+	Set& set {getSet(key)};
+
+	// Most clients have never been throttled: no need to lock
+	if (std::none_of(std::cbegin(set), std::cend(set), [&](const Entry& entry) { return entry.key.load(std::memory_order_acquire) == key; }))
+		return;
+
+	std::scoped_lock lock {_shards[key % shardCount].mutex};
+
+	for (Entry& entry : set)
+	{
+		if (entry.key.load(std::memory_order_relaxed) == key)
+		{
+			entry.throttledUntil.store(0, std::memory_order_relaxed);
+			entry.key.store(0, std::memory_order_release);
+		}
+	}
 }
 
 bool
 LoginThrottler::isClientThrottled(const boost::asio::ip::address& address) const
 {
-	const boost::asio::ip::address clientAddress {getAddressToThrottle(address)};
+	const Key key {computeKey(address)};
+	const Clock::rep now {Clock::now().time_since_epoch().count()};
 
-	auto it {_attemptsInfo.find(clientAddress)};
-	if (it == _attemptsInfo.end())
-		return false;
+	const Set& set {getSet(key)};
+	return std::any_of(std::cbegin(set), std::cend(set), [&](const Entry& entry)
+	{
+		if (entry.key.load(std::memory_order_acquire) != key)
+			return false;
 
-	return it->second > Wt::WDateTime::currentDateTime();
+		// The key is checked again in case the entry has been evicted meanwhile
+		return entry.throttledUntil.load(std::memory_order_acquire) > now && entry.key.load(std::memory_order_relaxed) == key;
+	});
 }
 
 } // Auth
-
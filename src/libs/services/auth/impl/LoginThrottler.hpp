@@ -19,33 +19,60 @@
 
 #pragma once
 
-#include <shared_mutex>
-#include <string>
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 
-#include <Wt/WDateTime.h>
-
-#include "utils/NetAddress.hpp"
-#include "utils/Exception.hpp"
+#include <boost/asio/ip/address.hpp>
 
 namespace Auth
 {
+	// Fixed capacity, set associative table of throttled clients
+	// Lookups are lock-free, updates only lock the shard of the client
 	class LoginThrottler
 	{
 		public:
-			LoginThrottler(std::size_t maxEntries) : _maxEntries {maxEntries} {}
+			using Clock = std::chrono::steady_clock;
+
+			LoginThrottler(std::size_t maxEntries, Clock::duration throttleDuration = std::chrono::seconds {3});
 
-			// user must lock these calls to avoid races
+			LoginThrottler(const LoginThrottler&) = delete;
+			LoginThrottler& operator=(const LoginThrottler&) = delete;
+
+			// thread safe
 			bool isClientThrottled(const boost::asio::ip::address& address) const;
 			void onBadClientAttempt(const boost::asio::ip::address& address);
 			void onGoodClientAttempt(const boost::asio::ip::address& address);
 
 		private:
-			void removeOutdatedEntries();
+			using Key = std::uint64_t; // hash of the throttled address, 0 means empty
+
+			static constexpr std::size_t shardCount {16};
+			static constexpr std::size_t wayCount {4};
 
-			const std::size_t _maxEntries;
+			// Writers publish the expiry (release) after the key
+			// Readers load the key, the expiry (acquire), then check the key again
+			struct Entry
+			{
+				std::atomic<Key>		key {};
+				std::atomic<Clock::rep>	throttledUntil {};
+			};
+			using Set = std::array<Entry, wayCount>;
 
-			std::unordered_map<boost::asio::ip::address, Wt::WDateTime>	_attemptsInfo;
+			struct alignas(64) Shard
+			{
+				std::mutex			mutex;	// updates only
+				std::vector<Set>	sets;
+			};
+
+			static Key computeKey(const boost::asio::ip::address& address);
+			Set& getSet(Key key);
+			const Set& getSet(Key key) const;
+
+			const Clock::duration			_throttleDuration;
+			std::array<Shard, shardCount>	_shards;
 	};
 } // Auth
-
@@ -64,33 +64,27 @@ namespace Auth
 		LMS_LOG(AUTH, DEBUG) << "Checking password for user '" << loginName << "'";
 
 		// Do not waste too much resource on brute force attacks (optim)
+		if (_loginThrottler.isClientThrottled(clientAddress))
+			return {CheckResult::State::Throttled};
+
+		const bool match {checkUserPassword(loginName, password)};
+
+		// Another attempt may have throttled the client in the meantime
+		if (_loginThrottler.isClientThrottled(clientAddress))
+			return {CheckResult::State::Throttled};
+
+		if (match)
 		{
-			std::shared_lock lock {_mutex};
+			_loginThrottler.onGoodClientAttempt(clientAddress);
 
-			if (_loginThrottler.isClientThrottled(clientAddress))
-				return {CheckResult::State::Throttled};
+			const Database::UserId userId {getOrCreateUser(loginName)};
+			onUserAuthenticated(userId);
+			return {CheckResult::State::Granted, userId};
 		}
-
-		const bool match {checkUserPassword(loginName, password)};
+		else
 		{
-			std::unique_lock lock {_mutex};
-
-			if (_loginThrottler.isClientThrottled(clientAddress))
-				return {CheckResult::State::Throttled};
-
-			if (match)
-			{
-				_loginThrottler.onGoodClientAttempt(clientAddress);
-
-				const Database::UserId userId {getOrCreateUser(loginName)};
-				onUserAuthenticated(userId);
-				return {CheckResult::State::Granted, userId};
-			}
-			else
-			{
-				_loginThrottler.onBadClientAttempt(clientAddress);
-				return {CheckResult::State::Denied};
-			}
+			_loginThrottler.onBadClientAttempt(clientAddress);
+			return {CheckResult::State::Denied};
 		}
 	}
 } // namespace Auth
@@ -19,8 +19,6 @@
 
 #pragma once
 
-#include <shared_mutex>
-
 #include "services/auth/IPasswordService.hpp"
 #include "AuthServiceBase.hpp"
 #include "LoginThrottler.hpp"
@@ -54,7 +52,6 @@ namespace Auth
 												std::string_view loginName,
 												std::string_view password) override;
 
-			std::shared_mutex			_mutex;
 			LoginThrottler				_loginThrottler;
 			IAuthTokenService&			_authTokenService;
 	};
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "LoginThrottler.hpp"
+
+using namespace Auth;
+
+namespace
+{
+	boost::asio::ip::address
+	makeV4Address(std::uint32_t index)
+	{
+		return boost::asio::ip::address_v4 {0x0A000000 + index};
+	}
+}
+
+TEST(LoginThrottler, throttle)
+{
+	LoginThrottler throttler {1000};
+	const auto address {boost::asio::ip::make_address("192.168.1.1")};
+	const auto otherAddress {boost::asio::ip::make_address("192.168.1.2")};
+
+	EXPECT_FALSE(throttler.isClientThrottled(address));
+
+	throttler.onBadClientAttempt(address);
+	EXPECT_TRUE(throttler.isClientThrottled(address));
+	EXPECT_FALSE(throttler.isClientThrottled(otherAddress));
+}
+
+TEST(LoginThrottler, ipv6Prefix)
+{
+	LoginThrottler throttler {1000};
+
+	throttler.onBadClientAttempt(boost::asio::ip::make_address("2001:db8:0:1::1"));
+	EXPECT_TRUE(throttler.isClientThrottled(boost::asio::ip::make_address("2001:db8:0:1::2")));
+	EXPECT_FALSE(throttler.isClientThrottled(boost::asio::ip::make_address("2001:db8:0:2::1")));
+}
+
+TEST(LoginThrottler, expiry)
+{
+	LoginThrottler throttler {1000, std::chrono::milliseconds {50}};
+	const auto address {boost::asio::ip::make_address("192.168.1.1")};
+
+	throttler.onBadClientAttempt(address);
+	EXPECT_TRUE(throttler.isClientThrottled(address));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds {100});
+	EXPECT_FALSE(throttler.isClientThrottled(address));
+
+	throttler.onBadClientAttempt(address);
+	EXPECT_TRUE(throttler.isClientThrottled(address));
+}
+
+TEST(LoginThrottler, resetOnSuccess)
+{
+	LoginThrottler throttler {1000};
+	const auto address {boost::asio::ip::make_address("192.168.1.1")};
+	const auto otherAddress {boost::asio::ip::make_address("192.168.1.2")};
+
+	throttler.onBadClientAttempt(address);
+	throttler.onBadClientAttempt(otherAddress);
+
+	throttler.onGoodClientAttempt(address);
+	EXPECT_FALSE(throttler.isClientThrottled(address));
+	EXPECT_TRUE(throttler.isClientThrottled(otherAddress));
+
+	// Never throttled
+	throttler.onGoodClientAttempt(boost::asio::ip::make_address("192.168.1.3"));
+	EXPECT_TRUE(throttler.isClientThrottled(otherAddress));
+}
+
+TEST(LoginThrottler, eviction)
+{
+	// Smallest table: one set of 4 entries per shard
+	LoginThrottler throttler {1};
+	constexpr std::size_t capacity {16 * 4};
+	constexpr std::uint32_t addressCount {1000};
+
+	for (std::uint32_t i {}; i < addressCount; ++i)
+	{
+		throttler.onBadClientAttempt(makeV4Address(i));
+
+		// The last client is always tracked
+		ASSERT_TRUE(throttler.isClientThrottled(makeV4Address(i)));
+	}
+
+	std::size_t throttledCount {};
+	for (std::uint32_t i {}; i < addressCount; ++i)
+	{
+		if (throttler.isClientThrottled(makeV4Address(i)))
+			throttledCount++;
+	}
+	EXPECT_LE(throttledCount, capacity);
+	EXPECT_GT(throttledCount, 0);
+}
+
+TEST(LoginThrottler, evictExpiredFirst)
+{
+	LoginThrottler throttler {1, std::chrono::milliseconds {50}};
+	constexpr std::uint32_t addressCount {1000};
+
+	const auto address {boost::asio::ip::make_address("192.168.1.1")};
+	for (std::uint32_t i {}; i < addressCount; ++i)
+		throttler.onBadClientAttempt(makeV4Address(i));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds {100});
+
+	// All the entries have expired: the new client takes the place of an expired one and the others are not throttled
+	throttler.onBadClientAttempt(address);
+	EXPECT_TRUE(throttler.isClientThrottled(address));
+	for (std::uint32_t i {}; i < addressCount; ++i)
+		EXPECT_FALSE(throttler.isClientThrottled(makeV4Address(i)));
+}
+
+TEST(LoginThrottler, concurrentEviction)
+{
+	// Readers check expired clients while writers evict their entries: they must never see an evicted key with a new expiry
+	LoginThrottler throttler {1, std::chrono::milliseconds {50}};
+	constexpr std::uint32_t expiredAddressCount {1000};
+	constexpr std::uint32_t writerAddressCount {10000};
+
+	for (std::uint32_t i {}; i < expiredAddressCount; ++i)
+		throttler.onBadClientAttempt(makeV4Address(i));
+	std::this_thread::sleep_for(std::chrono::milliseconds {100});
+
+	std::atomic<bool> done {};
+	std::atomic<std::size_t> falsePositiveCount {};
+
+	std::vector<std::thread> readers;
+	for (std::size_t i {}; i < 2; ++i)
+	{
+		readers.emplace_back([&]
+		{
+			while (!done)
+			{
+				for (std::uint32_t j {}; j < expiredAddressCount; ++j)
+				{
+					if (throttler.isClientThrottled(makeV4Address(j)))
+						falsePositiveCount++;
+				}
+			}
+		});
+	}
+
+	std::vector<std::thread> writers;
+	for (std::uint32_t i {}; i < 2; ++i)
+	{
+		writers.emplace_back([&, i]
+		{
+			for (std::uint32_t j {i}; j < writerAddressCount; j += 2)
+				throttler.onBadClientAttempt(makeV4Address(expiredAddressCount + j));
+		});
+	}
+
+	for (std::thread& writer : writers)
+		writer.join();
+	done = true;
+	for (std::thread& reader : readers)
+		reader.join();
+
+	EXPECT_EQ(falsePositiveCount, 0);
+}
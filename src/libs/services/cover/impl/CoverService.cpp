@@ -19,6 +19,8 @@
 
 #include "CoverService.hpp"
 
+#include <algorithm>
+
 #include "av/IAudioFile.hpp"
 
 #include "services/database/Db.hpp"
@@ -41,7 +43,9 @@ namespace
 		bool hasCover {};
 		bool isMultiDisc {};
 		std::filesystem::path trackPath;
+		Database::CoverSource coverSource;
 		std::optional<Database::ReleaseId> releaseId;
+		bool releaseCoverSourceResolved {};
 	};
 
 	std::optional<TrackInfo>
@@ -59,10 +63,12 @@ namespace
 
 		res->hasCover = track->hasCover();
 		res->trackPath = track->getPath();
+		res->coverSource = track->getCoverSource();
 
 		if (const Database::Release::pointer& release {track->getRelease()})
 		{
 			res->releaseId = release->getId();
+			res->releaseCoverSourceResolved = release->getCoverSource().type != Database::CoverSourceType::Unknown;
 			if (release->getTotalDisc() > 1)
 				res->isMultiDisc = true;
 		}
@@ -70,17 +76,29 @@ namespace
 		return res;
 	}
 
-	std::vector<std::string> constructPreferredFileNames()
+	std::unique_ptr<Cover::ThumbnailStore> createThumbnailStore()
 	{
-		std::vector<std::string> res;
+		std::vector<Image::ImageSize> sizes;
+		Service<IConfig>::get()->visitStrings("cover-thumbnail-sizes", [&](std::string_view str)
+		{
+			if (const std::optional<Image::ImageSize> size {StringUtils::readAs<Image::ImageSize>(str)}; size && *size > 0)
+				sizes.push_back(*size);
+			else
+				LMS_LOG(COVER, ERROR) << "Skipping invalid thumbnail size '" << str << "'";
+		});
 
-		Service<IConfig>::get()->visitStrings("cover-preferred-file-names",
-				[&res](std::string_view fileName)
-				{
-					res.emplace_back(fileName);
-				}, {"cover", "front"});
+		if (sizes.empty())
+			return nullptr;
 
-		return res;
+		try
+		{
+			return std::make_unique<Cover::ThumbnailStore>(Service<IConfig>::get()->getPath("working-dir") / "cache" / "covers", std::move(sizes));
+		}
+		catch (const std::filesystem::filesystem_error& e)
+		{
+			LMS_LOG(COVER, ERROR) << "Cannot create thumbnail directory: " << e.what();
+			return nullptr;
+		}
 	}
 }
 
@@ -88,13 +106,6 @@ namespace Cover {
 
 using namespace Image;
 
-static
-bool
-isFileSupported(const std::filesystem::path& file, const std::vector<std::filesystem::path>& extensions)
-{
-	return (std::find(std::cbegin(extensions), std::cend(extensions), file.extension()) != std::cend(extensions));
-}
-
 std::unique_ptr<ICoverService>
 createCoverService(Database::Db& db, const std::filesystem::path& execPath, const std::filesystem::path& defaultCoverPath)
 {
@@ -107,16 +118,21 @@ CoverService::CoverService(Database::Db& db,
 	: _db {db}
 	, _defaultCoverPath {defaultCoverPath}
 	, _maxCacheSize {Service<IConfig>::get()->getULong("cover-max-cache-size", 30) * 1000 * 1000}
-	, _maxFileSize {Service<IConfig>::get()->getULong("cover-max-file-size", 10) * 1000 * 1000}
-	, _preferredFileNames {constructPreferredFileNames()}
-
+	, _thumbnailStore {createThumbnailStore()}
 {
 	setJpegQuality(Service<IConfig>::get()->getULong("cover-jpeg-quality", 75));
 
 	LMS_LOG(COVER, INFO) << "Default cover path = '" << _defaultCoverPath.string() << "'";
 	LMS_LOG(COVER, INFO) << "Max cache size = " << _maxCacheSize;
-	LMS_LOG(COVER, INFO) << "Max file size = " << _maxFileSize;
-	LMS_LOG(COVER, INFO) << "Preferred file names: " << StringUtils::joinStrings(_preferredFileNames, ",");
+	LMS_LOG(COVER, INFO) << "Max file size = " << _coverSourceResolver.getMaxFileSize();
+	LMS_LOG(COVER, INFO) << "Preferred file names: " << StringUtils::joinStrings(_coverSourceResolver.getPreferredFileNames(), ",");
+	if (_thumbnailStore)
+	{
+		std::vector<std::string> sizes;
+		for (const ImageSize size : _thumbnailStore->getSizes())
+			sizes.push_back(std::to_string(size));
+		LMS_LOG(COVER, INFO) << "Thumbnail sizes: " << StringUtils::joinStrings(sizes, ",");
+	}
 
 #if LMS_SUPPORT_IMAGE_GM
 	GraphicsMagick::init(execPath);
@@ -146,7 +162,7 @@ CoverService::getFromAvMediaFile(const Av::IAudioFile& input, ImageSize width) c
 
 		try
 		{
-			std::unique_ptr<IRawImage> rawImage {decodeImage(picture.data, picture.dataSize)};
+			std::unique_ptr<IRawImage> rawImage {decodeImage(picture.data, picture.dataSize, width)};
 			rawImage->resize(width);
 			image = rawImage->encodeToJPEG(_jpegQuality);
 		}
@@ -166,7 +182,7 @@ CoverService::getFromCoverFile(const std::filesystem::path& p, ImageSize width)
 
 	try
 	{
-		std::unique_ptr<IRawImage> rawImage {decodeImage(p)};
+		std::unique_ptr<IRawImage> rawImage {decodeImage(p, width)};
 		rawImage->resize(width);
 		image = rawImage->encodeToJPEG(_jpegQuality);
 	}
@@ -205,37 +221,13 @@ CoverService::getDefault(ImageSize width)
 std::unique_ptr<IEncodedImage>
 CoverService::getFromDirectory(const std::filesystem::path& directory, ImageSize width) const
 {
-	const std::multimap<std::string, std::filesystem::path> coverPaths {getCoverPaths(directory)};
-
-	auto tryLoadImageFromFilename = [&](std::string_view fileName)
-	{
-		std::unique_ptr<IEncodedImage> image;
-
-		auto range {coverPaths.equal_range(std::string {fileName})};
-		for (auto it {range.first}; it != range.second; ++it)
-		{
-			image = getFromCoverFile(it->second, width);
-			if (image)
-				break;
-		}
-		return image;
-	};
-
 	std::unique_ptr<IEncodedImage> image;
 
-	for (std::string_view filename : _preferredFileNames)
-	{
-		image = tryLoadImageFromFilename(filename);
-		if (image)
-			return image;
-	}
-
-	// Just pick one
-	for (const auto& [filename, coverPath] : coverPaths)
+	for (const std::filesystem::path& coverPath : _coverSourceResolver.getSortedCoverPaths(directory))
 	{
 		image = getFromCoverFile(coverPath, width);
 		if (image)
-			return image;
+			break;
 	}
 
 	return image;
@@ -246,14 +238,8 @@ CoverService::getFromSameNamedFile(const std::filesystem::path& filePath, ImageS
 {
 	std::unique_ptr<IEncodedImage> res;
 
-	std::filesystem::path coverPath {filePath};
-	for (const std::filesystem::path& extension : _fileExtensions)
+	for (const std::filesystem::path& coverPath : _coverSourceResolver.getSameNamedCoverPaths(filePath))
 	{
-		coverPath.replace_extension(extension);
-
-		if (!checkCoverFile(coverPath))
-			continue;
-
 		res = getFromCoverFile(coverPath, width);
 		if (res)
 			break;
@@ -262,48 +248,57 @@ CoverService::getFromSameNamedFile(const std::filesystem::path& filePath, ImageS
 	return res;
 }
 
-bool
-CoverService::checkCoverFile(const std::filesystem::path& filePath) const
+std::unique_ptr<IEncodedImage>
+CoverService::getFromCoverSource(const Database::CoverSource& coverSource, ImageSize width) const
 {
-	std::error_code ec;
-
-	if (!isFileSupported(filePath, _fileExtensions))
-		return false;
-
-	if (!std::filesystem::exists(filePath, ec))
-		return false;
-
-	if (!std::filesystem::is_regular_file(filePath, ec))
-		return false;
+	std::unique_ptr<IEncodedImage> image;
 
-	if (std::filesystem::file_size(filePath, ec) > _maxFileSize && !ec)
+	const bool hasFile {coverSource.type == Database::CoverSourceType::Embedded || coverSource.type == Database::CoverSourceType::ExternalFile};
+	if (hasFile && _thumbnailStore && _thumbnailStore->hasSize(width))
 	{
-		LMS_LOG(COVER, INFO) << "Cover file '" << filePath.string() << " is too big (" << std::filesystem::file_size(filePath, ec) << "), limit is " << _maxFileSize;
-		return false;
+		image = _thumbnailStore->load(coverSource, width, _jpegQuality);
+		if (image)
+			return image;
 	}
 
-	return true;
-}
-
-std::multimap<std::string, std::filesystem::path>
-CoverService::getCoverPaths(const std::filesystem::path& directoryPath) const
-{
-	std::multimap<std::string, std::filesystem::path> res;
-	std::error_code ec;
-
-	std::filesystem::directory_iterator itPath(directoryPath, ec);
-	std::filesystem::directory_iterator itEnd;
-	while (!ec && itPath != itEnd)
+	switch (coverSource.type)
 	{
-		const std::filesystem::path& path {*itPath};
+		case Database::CoverSourceType::Unknown:
+		case Database::CoverSourceType::None:
+			break;
 
-		if (checkCoverFile(path))
-			res.emplace(std::filesystem::path{ path }.filename().replace_extension("").string(), path);
+		case Database::CoverSourceType::ExternalFile:
+			image = getFromCoverFile(coverSource.path, width);
+			break;
 
-		itPath.increment(ec);
+		case Database::CoverSourceType::Embedded:
+			try
+			{
+				Av::parseAudioFile(coverSource.path)->visitAttachedPictures([&](const Av::Picture& picture)
+				{
+					if (picture.streamIndex != coverSource.streamIndex)
+						return;
+
+					try
+					{
+						std::unique_ptr<IRawImage> rawImage {decodeImage(picture.data, picture.dataSize, width)};
+						rawImage->resize(width);
+						image = rawImage->encodeToJPEG(_jpegQuality);
+					}
+					catch (const Image::ImageException& e)
+					{
+						LMS_LOG(COVER, ERROR) << "Cannot read embedded cover: " << e.what();
+					}
+				});
+			}
+			catch (Av::Exception& e)
+			{
+				LMS_LOG(COVER, ERROR) << "Cannot get covers from track " << coverSource.path.string() << ": " << e.what();
+			}
+			break;
 	}
 
-	return res;
+	return image;
 }
 
 std::unique_ptr<IEncodedImage>
@@ -332,55 +327,75 @@ CoverService::getFromTrack(Database::TrackId trackId, ImageSize width)
 std::shared_ptr<IEncodedImage>
 CoverService::getFromTrack(Database::Session& dbSession, Database::TrackId trackId, ImageSize width, bool allowReleaseFallback)
 {
-	using namespace Database;
-
-	const CacheEntryDesc cacheEntryDesc {trackId, width};
+	return getOrCompute(CacheEntryDesc {trackId, width}, [&]
+	{
+		std::shared_ptr<IEncodedImage> cover {computeFromTrack(dbSession, trackId, width, allowReleaseFallback)};
+		if (!cover)
+			cover = getDefault(width);
 
-	std::shared_ptr<IEncodedImage> cover {loadFromCache(cacheEntryDesc)};
-	if (cover)
 		return cover;
+	});
+}
+
+std::shared_ptr<IEncodedImage>
+CoverService::computeFromTrack(Database::Session& dbSession, Database::TrackId trackId, ImageSize width, bool allowReleaseFallback)
+{
+	std::shared_ptr<IEncodedImage> cover;
 
 	if (const std::optional<TrackInfo> trackInfo {getTrackInfo(dbSession, trackId)})
 	{
-		if (trackInfo->hasCover)
-			cover = getFromTrack(trackInfo->trackPath, width);
+		const bool useCoverSource {_coverSourceResolver.isCoverSourceUpToDate(trackInfo->coverSource)};
 
-		if (!cover)
-			cover = getFromSameNamedFile(trackInfo->trackPath, width);
+		if (useCoverSource)
+			cover = getFromCoverSource(trackInfo->coverSource, width);
+
+		// Cover source not resolved yet, outdated or not readable: look for it
+		if (!cover && !(useCoverSource && trackInfo->coverSource.type == Database::CoverSourceType::None))
+		{
+			if (trackInfo->hasCover)
+				cover = getFromTrack(trackInfo->trackPath, width);
+
+			if (!cover)
+				cover = getFromSameNamedFile(trackInfo->trackPath, width);
+		}
 
 		if (!cover && trackInfo->releaseId && allowReleaseFallback)
 			cover = getFromRelease(*trackInfo->releaseId, width);
 
-		if (!cover && trackInfo->isMultiDisc)
+		// Already part of the release cover source
+		if (!cover && trackInfo->isMultiDisc && !trackInfo->releaseCoverSourceResolved)
 		{
 			if (trackInfo->trackPath.parent_path().has_parent_path())
 				cover = getFromDirectory(trackInfo->trackPath.parent_path().parent_path(), width);
 		}
 	}
 
-	if (!cover)
-		cover = getDefault(width);
-
-	if (cover)
-		saveToCache(cacheEntryDesc, cover);
-
 	return cover;
 }
 
 std::shared_ptr<IEncodedImage>
 CoverService::getFromRelease(Database::ReleaseId releaseId, ImageSize width)
 {
-	using namespace Database;
-	const CacheEntryDesc cacheEntryDesc {releaseId, width};
+	return getOrCompute(CacheEntryDesc {releaseId, width}, [&]
+	{
+		std::shared_ptr<IEncodedImage> cover {computeFromRelease(releaseId, width)};
+		if (!cover)
+			cover = getDefault(width);
 
-	std::shared_ptr<IEncodedImage> cover {loadFromCache(cacheEntryDesc)};
-	if (cover)
 		return cover;
+	});
+}
+
+std::shared_ptr<IEncodedImage>
+CoverService::computeFromRelease(Database::ReleaseId releaseId, ImageSize width)
+{
+	using namespace Database;
 
 	struct ReleaseInfo
 	{
 		TrackId firstTrackId;
 		std::filesystem::path releaseDirectory;
+		CoverSource coverSource;
 	};
 
 	Session& session {_db.getTLSSession()};
@@ -391,6 +406,10 @@ CoverService::getFromRelease(Database::ReleaseId releaseId, ImageSize width)
 
 		auto transaction {session.createSharedTransaction()};
 
+		const Release::pointer release {Release::find(session, releaseId)};
+		if (!release)
+			return res;
+
 		const auto tracks {Track::find(session, Track::FindParameters {}.setRelease(releaseId).setRange({0, 1}).setSortMethod(TrackSortMethod::Release))};
 
 		if (!tracks.results.empty())
@@ -400,26 +419,110 @@ CoverService::getFromRelease(Database::ReleaseId releaseId, ImageSize width)
 				res = ReleaseInfo {};
 				res->firstTrackId = track->getId();
 				res->releaseDirectory = track->getPath().parent_path();
+				res->coverSource = release->getCoverSource();
 			}
 		}
 
 		return res;
 	}};
 
+	std::shared_ptr<IEncodedImage> cover;
+
 	if (const std::optional<ReleaseInfo> releaseInfo {getReleaseInfo()})
 	{
+		if (_coverSourceResolver.isCoverSourceUpToDate(releaseInfo->coverSource))
+		{
+			if (releaseInfo->coverSource.type == CoverSourceType::None)
+				return cover;
+
+			cover = getFromCoverSource(releaseInfo->coverSource, width);
+			if (cover)
+				return cover;
+		}
+
+		// Cover source not resolved yet, outdated or not readable: look for it
 		cover = getFromDirectory(releaseInfo->releaseDirectory, width);
+		// Do not go through the track cache entry here: it is computed with release fallback, and may itself be waiting for this release
 		if (!cover)
-			cover = getFromTrack(session, releaseInfo->firstTrackId, width, false /* no release fallback */);
+			cover = computeFromTrack(session, releaseInfo->firstTrackId, width, false /* no release fallback */);
 	}
 
-	if (!cover)
-		cover = getDefault(width);
+	return cover;
+}
 
-	if (cover)
-		saveToCache(cacheEntryDesc, cover);
+std::unique_ptr<IRawImage>
+CoverService::decodeCoverSource(const Database::CoverSource& coverSource, ImageSize targetSize) const
+{
+	std::unique_ptr<IRawImage> rawImage;
 
-	return cover;
+	switch (coverSource.type)
+	{
+		case Database::CoverSourceType::Unknown:
+		case Database::CoverSourceType::None:
+			break;
+
+		case Database::CoverSourceType::ExternalFile:
+			rawImage = decodeImage(coverSource.path, targetSize);
+			break;
+
+		case Database::CoverSourceType::Embedded:
+			Av::parseAudioFile(coverSource.path)->visitAttachedPictures([&](const Av::Picture& picture)
+			{
+				if (picture.streamIndex == coverSource.streamIndex)
+					rawImage = decodeImage(picture.data, picture.dataSize, targetSize);
+			});
+			break;
+	}
+
+	return rawImage;
+}
+
+bool
+CoverService::isThumbnailGenerationEnabled() const
+{
+	return _thumbnailStore != nullptr;
+}
+
+void
+CoverService::generateThumbnails(const Database::CoverSource& coverSource)
+{
+	if (!_thumbnailStore)
+		return;
+
+	const std::vector<ImageSize>& sizes {_thumbnailStore->getSizes()};
+	if (std::all_of(std::cbegin(sizes), std::cend(sizes), [&](ImageSize size) { return _thumbnailStore->contains(coverSource, size, _jpegQuality); }))
+		return;
+
+	try
+	{
+		// Decode once, then resize step by step, from the largest size to the smallest one
+		std::unique_ptr<IRawImage> rawImage {decodeCoverSource(coverSource, sizes.front())};
+		if (!rawImage)
+			return;
+
+		for (const ImageSize size : sizes)
+		{
+			rawImage->resize(size);
+			_thumbnailStore->store(coverSource, size, _jpegQuality, *rawImage->encodeToJPEG(_jpegQuality));
+		}
+	}
+	catch (const Image::ImageException& e)
+	{
+		LMS_LOG(COVER, ERROR) << "Cannot generate thumbnails for '" << coverSource.path.string() << "': " << e.what();
+	}
+	catch (const Av::Exception& e)
+	{
+		LMS_LOG(COVER, ERROR) << "Cannot generate thumbnails for '" << coverSource.path.string() << "': " << e.what();
+	}
+}
+
+void
+CoverService::removeOutdatedThumbnails(const std::vector<Database::CoverSource>& activeCoverSources)
+{
+	if (!_thumbnailStore)
+		return;
+
+	_thumbnailStore->removeAllExcept(activeCoverSources, _jpegQuality);
 }
 
 void
@@ -427,9 +530,10 @@ CoverService::flushCache()
 {
 	std::unique_lock lock {_cacheMutex};
 
-	LMS_LOG(COVER, DEBUG) << "Cache stats: hits = " << _cacheHits << ", misses = " << _cacheMisses << ", nb entries = " << _cache.size() << ", size = " << _cacheSize;
+	LMS_LOG(COVER, DEBUG) << "Cache stats: hits = " << _cacheHits << ", misses = " << _cacheMisses << ", in flight waits = " << _inFlightWaits << ", nb entries = " << _cache.size() << ", size = " << _cacheSize;
 	_cacheHits = 0;
 	_cacheMisses = 0;
+	_inFlightWaits = 0;
 	_cacheSize = 0;
 	_cache.clear();
 }
@@ -458,6 +562,73 @@ CoverService::saveToCache(const CacheEntryDesc& entryDesc, std::shared_ptr<IEnco
 	_cache[entryDesc] = image;
 }
 
+std::shared_ptr<IEncodedImage>
+CoverService::findInCache(const CacheEntryDesc& entryDesc)
+{
+	std::shared_lock lock {_cacheMutex};
+
+	auto it {_cache.find(entryDesc)};
+	return it != std::cend(_cache) ? it->second : nullptr;
+}
+
+std::shared_ptr<IEncodedImage>
+CoverService::getOrCompute(const CacheEntryDesc& entryDesc, ComputeFunc computeFunc)
+{
+	if (std::shared_ptr<IEncodedImage> cover {loadFromCache(entryDesc)})
+		return cover;
+
+	std::promise<std::shared_ptr<IEncodedImage>> promise;
+	std::shared_future<std::shared_ptr<IEncodedImage>> future;
+
+	{
+		std::unique_lock lock {_inFlightMutex};
+
+		if (auto it {_inFlight.find(entryDesc)}; it != std::cend(_inFlight))
+		{
+			future = it->second;
+		}
+		else
+		{
+			// The previous computation may have completed since our cache lookup
+			if (std::shared_ptr<IEncodedImage> cover {findInCache(entryDesc)})
+				return cover;
+
+			_inFlight.emplace(entryDesc, promise.get_future().share());
+		}
+	}
+
+	if (future.valid())
+	{
+		++_inFlightWaits;
+		return future.get();
+	}
+
+	std::shared_ptr<IEncodedImage> cover;
+	try
+	{
+		cover = computeFunc();
+		if (cover)
+			saveToCache(entryDesc, cover);
+
+		promise.set_value(cover);
+	}
+	catch (...)
+	{
+		promise.set_exception(std::current_exception());
+
+		std::unique_lock lock {_inFlightMutex};
+		_inFlight.erase(entryDesc);
+		throw;
+	}
+
+	{
+		std::unique_lock lock {_inFlightMutex};
+		_inFlight.erase(entryDesc);
+	}
+
+	return cover;
+}
+
 std::shared_ptr<IEncodedImage>
 CoverService::loadFromCache(const CacheEntryDesc& entryDesc)
 {
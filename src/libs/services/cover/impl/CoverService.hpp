@@ -21,7 +21,10 @@
 
 #include <atomic>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <string_view>
@@ -31,7 +34,10 @@
 
 #include "services/cover/ICoverService.hpp"
 #include "image/IEncodedImage.hpp"
+#include "services/database/CoverSource.hpp"
 #include "services/database/Types.hpp"
+#include "CoverSourceResolver.hpp"
+#include "ThumbnailStore.hpp"
 
 namespace Database
 {
@@ -43,6 +49,11 @@ namespace Av
 	class IAudioFile;
 }
 
+namespace Image
+{
+	class IRawImage;
+}
+
 namespace Cover
 {
 	struct CacheEntryDesc
@@ -100,18 +111,23 @@ namespace Cover
 			std::shared_ptr<Image::IEncodedImage>	getFromRelease(Database::ReleaseId releaseId, Image::ImageSize width) override;
 			void							flushCache() override;
 			void							setJpegQuality(unsigned quality) override;
+			unsigned						getJpegQuality() const override { return _jpegQuality; }
+			bool							isThumbnailGenerationEnabled() const override;
+			void							generateThumbnails(const Database::CoverSource& coverSource) override;
+			void							removeOutdatedThumbnails(const std::vector<Database::CoverSource>& activeCoverSources) override;
 
 			std::shared_ptr<Image::IEncodedImage>	getFromTrack(Database::Session& dbSession, Database::TrackId trackId, Image::ImageSize width, bool allowReleaseFallback);
+			std::shared_ptr<Image::IEncodedImage>	computeFromTrack(Database::Session& dbSession, Database::TrackId trackId, Image::ImageSize width, bool allowReleaseFallback);
+			std::shared_ptr<Image::IEncodedImage>	computeFromRelease(Database::ReleaseId releaseId, Image::ImageSize width);
 			std::unique_ptr<Image::IEncodedImage>	getFromAvMediaFile(const Av::IAudioFile& input, Image::ImageSize width) const;
 			std::unique_ptr<Image::IEncodedImage>	getFromCoverFile(const std::filesystem::path& p, Image::ImageSize width) const;
 
 			std::unique_ptr<Image::IEncodedImage>	getFromTrack(const std::filesystem::path& path, Image::ImageSize width) const;
-			std::multimap<std::string, std::filesystem::path>	getCoverPaths(const std::filesystem::path& directoryPath) const;
 			std::unique_ptr<Image::IEncodedImage>	getFromDirectory(const std::filesystem::path& directory, Image::ImageSize width) const;
 			std::unique_ptr<Image::IEncodedImage>	getFromSameNamedFile(const std::filesystem::path& filePath, Image::ImageSize width) const;
+			std::unique_ptr<Image::IEncodedImage>	getFromCoverSource(const Database::CoverSource& coverSource, Image::ImageSize width) const;
 			std::shared_ptr<Image::IEncodedImage>	getDefault(Image::ImageSize width);
-
-			bool							checkCoverFile(const std::filesystem::path& directoryPath) const;
+			std::unique_ptr<Image::IRawImage>		decodeCoverSource(const Database::CoverSource& coverSource, Image::ImageSize targetSize) const;
 
 			Database::Db&				_db;
 
@@ -124,12 +140,20 @@ namespace Cover
 
 			void saveToCache(const CacheEntryDesc& entryDesc, std::shared_ptr<Image::IEncodedImage> image);
 			std::shared_ptr<Image::IEncodedImage> loadFromCache(const CacheEntryDesc& entryDesc);
+			std::shared_ptr<Image::IEncodedImage> findInCache(const CacheEntryDesc& entryDesc);
+
+			// Concurrent misses on the same entry wait for the first one to compute the image
+			using ComputeFunc = std::function<std::shared_ptr<Image::IEncodedImage>()>;
+			std::shared_ptr<Image::IEncodedImage> getOrCompute(const CacheEntryDesc& entryDesc, ComputeFunc computeFunc);
+
+			std::mutex _inFlightMutex;
+			std::unordered_map<CacheEntryDesc, std::shared_future<std::shared_ptr<Image::IEncodedImage>>> _inFlight;
+			std::atomic<std::size_t>	_inFlightWaits {};
 
 			const std::filesystem::path _defaultCoverPath;
 			const std::size_t _maxCacheSize;
-			static inline const std::vector<std::filesystem::path> _fileExtensions {".jpg", ".jpeg", ".png", ".bmp"}; // TODO parametrize
-			const std::size_t _maxFileSize;
-			const std::vector<std::string> _preferredFileNames;
+			const CoverSourceResolver _coverSourceResolver;
+			std::unique_ptr<ThumbnailStore> _thumbnailStore; // only if thumbnail generation is enabled
 			unsigned _jpegQuality;
 	};
 
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CoverSourceResolver.hpp"
+
+#include "av/IAudioFile.hpp"
+#include "utils/Exception.hpp"
+#include "utils/IConfig.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Path.hpp"
+#include "utils/Service.hpp"
+
+namespace
+{
+	std::vector<std::string> constructPreferredFileNames()
+	{
+		std::vector<std::string> res;
+
+		Service<IConfig>::get()->visitStrings("cover-preferred-file-names",
+				[&res](std::string_view fileName)
+				{
+					res.emplace_back(fileName);
+				}, {"cover", "front"});
+
+		return res;
+	}
+
+	bool
+	isFileSupported(const std::filesystem::path& file, const std::vector<std::filesystem::path>& extensions)
+	{
+		return (std::find(std::cbegin(extensions), std::cend(extensions), file.extension()) != std::cend(extensions));
+	}
+
+	std::optional<std::pair<std::size_t, Wt::WDateTime>>
+	getFileStats(const std::filesystem::path& file)
+	{
+		std::optional<std::pair<std::size_t, Wt::WDateTime>> res;
+
+		std::error_code ec;
+		const std::uintmax_t fileSize {std::filesystem::file_size(file, ec)};
+		if (ec)
+			return res;
+
+		try
+		{
+			res.emplace(fileSize, getLastWriteTime(file));
+		}
+		catch (const LmsException& e)
+		{
+			LMS_LOG(COVER, ERROR) << e.what();
+		}
+
+		return res;
+	}
+}
+
+namespace Cover
+{
+	using namespace Database;
+
+	std::unique_ptr<ICoverSourceResolver>
+	createCoverSourceResolver()
+	{
+		return std::make_unique<CoverSourceResolver>();
+	}
+
+	CoverSourceResolver::CoverSourceResolver()
+		: _maxFileSize {Service<IConfig>::get()->getULong("cover-max-file-size", 10) * 1000 * 1000}
+		, _preferredFileNames {constructPreferredFileNames()}
+	{
+	}
+
+	CoverSource
+	CoverSourceResolver::resolveTrackCoverSource(const std::filesystem::path& trackPath, bool hasEmbeddedCover) const
+	{
+		std::optional<CoverSource> res;
+
+		if (hasEmbeddedCover)
+			res = resolveFromMediaFile(trackPath);
+
+		if (!res)
+		{
+			for (const std::filesystem::path& coverPath : getSameNamedCoverPaths(trackPath))
+			{
+				res = resolveFromFile(coverPath);
+				if (res)
+					break;
+			}
+		}
+
+		return res ? *res : CoverSource {CoverSourceType::None};
+	}
+
+	CoverSource
+	CoverSourceResolver::resolveReleaseCoverSource(const std::filesystem::path& firstTrackPath, bool firstTrackHasEmbeddedCover, bool isMultiDisc) const
+	{
+		std::optional<CoverSource> res {resolveFromDirectory(firstTrackPath.parent_path())};
+
+		if (!res)
+		{
+			const CoverSource trackCoverSource {resolveTrackCoverSource(firstTrackPath, firstTrackHasEmbeddedCover)};
+			if (trackCoverSource.type != CoverSourceType::None)
+				res = trackCoverSource;
+		}
+
+		if (!res && isMultiDisc && firstTrackPath.parent_path().has_parent_path())
+			res = resolveFromDirectory(firstTrackPath.parent_path().parent_path());
+
+		return res ? *res : CoverSource {CoverSourceType::None};
+	}
+
+	bool
+	CoverSourceResolver::isCoverSourceUpToDate(const CoverSource& coverSource) const
+	{
+		switch (coverSource.type)
+		{
+			case CoverSourceType::Unknown:
+				return false;
+
+			case CoverSourceType::None:
+				return true;
+
+			case CoverSourceType::Embedded:
+			case CoverSourceType::ExternalFile:
+				if (const auto fileStats {getFileStats(coverSource.path)})
+					return fileStats->first == coverSource.fileSize && fileStats->second == coverSource.lastWriteTime;
+				return false;
+		}
+
+		return false;
+	}
+
+	std::optional<CoverSource>
+	CoverSourceResolver::resolveFromDirectory(const std::filesystem::path& directoryPath) const
+	{
+		std::optional<CoverSource> res;
+
+		for (const std::filesystem::path& coverPath : getSortedCoverPaths(directoryPath))
+		{
+			res = resolveFromFile(coverPath);
+			if (res)
+				break;
+		}
+
+		return res;
+	}
+
+	std::optional<CoverSource>
+	CoverSourceResolver::resolveFromFile(const std::filesystem::path& filePath) const
+	{
+		std::optional<CoverSource> res;
+
+		if (const auto fileStats {getFileStats(filePath)})
+			res = CoverSource {CoverSourceType::ExternalFile, filePath, 0, fileStats->first, fileStats->second};
+
+		return res;
+	}
+
+	std::optional<CoverSource>
+	CoverSourceResolver::resolveFromMediaFile(const std::filesystem::path& mediaFilePath) const
+	{
+		std::optional<CoverSource> res;
+
+		try
+		{
+			std::optional<std::size_t> streamIndex;
+			Av::parseAudioFile(mediaFilePath)->visitAttachedPictures([&](const Av::Picture& picture)
+			{
+				if (!streamIndex)
+					streamIndex = picture.streamIndex;
+			});
+
+			if (!streamIndex)
+				return res;
+
+			if (const auto fileStats {getFileStats(mediaFilePath)})
+				res = CoverSource {CoverSourceType::Embedded, mediaFilePath, *streamIndex, fileStats->first, fileStats->second};
+		}
+		catch (const Av::Exception& e)
+		{
+			LMS_LOG(COVER, ERROR) << "Cannot get covers from track " << mediaFilePath.string() << ": " << e.what();
+		}
+
+		return res;
+	}
+
+	std::vector<std::filesystem::path>
+	CoverSourceResolver::getSortedCoverPaths(const std::filesystem::path& directoryPath) const
+	{
+		std::multimap<std::string, std::filesystem::path> coverPaths {getCoverPaths(directoryPath)};
+		std::vector<std::filesystem::path> res;
+		res.reserve(coverPaths.size());
+
+		for (const std::string& fileName : _preferredFileNames)
+		{
+			auto range {coverPaths.equal_range(fileName)};
+			for (auto it {range.first}; it != range.second; ++it)
+				res.push_back(it->second);
+
+			coverPaths.erase(range.first, range.second);
+		}
+
+		// Then just pick any
+		for (const auto& [fileName, coverPath] : coverPaths)
+			res.push_back(coverPath);
+
+		return res;
+	}
+
+	std::vector<std::filesystem::path>
+	CoverSourceResolver::getSameNamedCoverPaths(const std::filesystem::path& filePath) const
+	{
+		std::vector<std::filesystem::path> res;
+
+		std::filesystem::path coverPath {filePath};
+		for (const std::filesystem::path& extension : _fileExtensions)
+		{
+			coverPath.replace_extension(extension);
+
+			if (checkCoverFile(coverPath))
+				res.push_back(coverPath);
+		}
+
+		return res;
+	}
+
+	bool
+	CoverSourceResolver::checkCoverFile(const std::filesystem::path& filePath) const
+	{
+		std::error_code ec;
+
+		if (!isFileSupported(filePath, _fileExtensions))
+			return false;
+
+		if (!std::filesystem::exists(filePath, ec))
+			return false;
+
+		if (!std::filesystem::is_regular_file(filePath, ec))
+			return false;
+
+		if (std::filesystem::file_size(filePath, ec) > _maxFileSize && !ec)
+		{
+			LMS_LOG(COVER, INFO) << "Cover file '" << filePath.string() << " is too big (" << std::filesystem::file_size(filePath, ec) << "), limit is " << _maxFileSize;
+			return false;
+		}
+
+		return true;
+	}
+
+	std::multimap<std::string, std::filesystem::path>
+	CoverSourceResolver::getCoverPaths(const std::filesystem::path& directoryPath) const
+	{
+		std::multimap<std::string, std::filesystem::path> res;
+		std::error_code ec;
+
+		std::filesystem::directory_iterator itPath(directoryPath, ec);
+		std::filesystem::directory_iterator itEnd;
+		while (!ec && itPath != itEnd)
+		{
+			const std::filesystem::path& path {*itPath};
+
+			if (checkCoverFile(path))
+				res.emplace(std::filesystem::path{ path }.filename().replace_extension("").string(), path);
+
+			itPath.increment(ec);
+		}
+
+		return res;
+	}
+
+} // namespace Cover
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "services/cover/ICoverSourceResolver.hpp"
+
+namespace Cover
+{
+	class CoverSourceResolver : public ICoverSourceResolver
+	{
+		public:
+			CoverSourceResolver();
+
+			Database::CoverSource	resolveTrackCoverSource(const std::filesystem::path& trackPath, bool hasEmbeddedCover) const override;
+			Database::CoverSource	resolveReleaseCoverSource(const std::filesystem::path& firstTrackPath, bool firstTrackHasEmbeddedCover, bool isMultiDisc) const override;
+			bool					isCoverSourceUpToDate(const Database::CoverSource& coverSource) const override;
+
+			// Candidate image files in a directory, keyed by file name without extension
+			std::multimap<std::string, std::filesystem::path>	getCoverPaths(const std::filesystem::path& directoryPath) const;
+			// Candidate image files, ordered by preference
+			std::vector<std::filesystem::path>	getSortedCoverPaths(const std::filesystem::path& directoryPath) const;
+			std::vector<std::filesystem::path>	getSameNamedCoverPaths(const std::filesystem::path& filePath) const;
+			bool								checkCoverFile(const std::filesystem::path& filePath) const;
+
+			std::size_t							getMaxFileSize() const { return _maxFileSize; }
+			const std::vector<std::string>&		getPreferredFileNames() const { return _preferredFileNames; }
+
+		private:
+			std::optional<Database::CoverSource>	resolveFromDirectory(const std::filesystem::path& directoryPath) const;
+			std::optional<Database::CoverSource>	resolveFromFile(const std::filesystem::path& filePath) const;
+			std::optional<Database::CoverSource>	resolveFromMediaFile(const std::filesystem::path& mediaFilePath) const;
+
+			static inline const std::vector<std::filesystem::path> _fileExtensions {".jpg", ".jpeg", ".png", ".bmp"}; // TODO parametrize
+			const std::size_t _maxFileSize;
+			const std::vector<std::string> _preferredFileNames;
+	};
+
+} // namespace Cover
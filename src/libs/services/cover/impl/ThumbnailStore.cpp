@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThumbnailStore.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+
+#include "utils/Logger.hpp"
+
+namespace Cover
+{
+	namespace
+	{
+		class StoredImage : public Image::IEncodedImage
+		{
+			public:
+				StoredImage(std::vector<std::byte> data) : _data {std::move(data)} {}
+
+			private:
+				const std::byte* getData() const override { return _data.data(); }
+				std::size_t getDataSize() const override { return _data.size(); }
+				std::string_view getMimeType() const override { return "image/jpeg"; }
+
+				const std::vector<std::byte> _data;
+		};
+
+		std::string
+		computeKey(const Database::CoverSource& coverSource, unsigned jpegQuality)
+		{
+			std::ostringstream oss;
+			oss << coverSource.path.string()
+				<< '\n' << coverSource.streamIndex
+				<< '\n' << coverSource.fileSize
+				<< '\n' << coverSource.lastWriteTime.toTime_t()
+				<< '\n' << jpegQuality;
+
+			std::ostringstream key;
+			key << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string> {}(oss.str());
+			return key.str();
+		}
+
+		std::string
+		getFileName(const std::string& key, Image::ImageSize size)
+		{
+			return key + "-" + std::to_string(size) + ".jpg";
+		}
+	}
+
+	ThumbnailStore::ThumbnailStore(const std::filesystem::path& directory, std::vector<Image::ImageSize> sizes)
+		: _directory {directory}
+		, _sizes {[&]
+			{
+				std::sort(std::begin(sizes), std::end(sizes), std::greater<Image::ImageSize> {});
+				sizes.erase(std::unique(std::begin(sizes), std::end(sizes)), std::end(sizes));
+				return sizes;
+			}()}
+	{
+		std::filesystem::create_directories(_directory);
+	}
+
+	bool
+	ThumbnailStore::hasSize(Image::ImageSize size) const
+	{
+		return std::find(std::cbegin(_sizes), std::cend(_sizes), size) != std::cend(_sizes);
+	}
+
+	bool
+	ThumbnailStore::contains(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality) const
+	{
+		std::error_code ec;
+		return std::filesystem::exists(getFilePath(coverSource, size, jpegQuality), ec);
+	}
+
+	std::unique_ptr<Image::IEncodedImage>
+	ThumbnailStore::load(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality) const
+	{
+		std::ifstream ifs {getFilePath(coverSource, size, jpegQuality), std::ios::binary};
+		if (!ifs)
+			return nullptr;
+
+		std::vector<char> data {std::istreambuf_iterator<char> {ifs}, std::istreambuf_iterator<char> {}};
+		if (ifs.bad() || data.empty())
+			return nullptr;
+
+		std::vector<std::byte> image(data.size());
+		std::transform(std::cbegin(data), std::cend(data), std::begin(image), [](char c) { return static_cast<std::byte>(c); });
+
+		return std::make_unique<StoredImage>(std::move(image));
+	}
+
+	void
+	ThumbnailStore::store(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality, const Image::IEncodedImage& image) const
+	{
+		const std::filesystem::path filePath {getFilePath(coverSource, size, jpegQuality)};
+		std::filesystem::path tmpFilePath {filePath};
+		tmpFilePath += ".tmp";
+
+		{
+			std::ofstream ofs {tmpFilePath, std::ios::binary | std::ios::trunc};
+			ofs.write(reinterpret_cast<const char*>(image.getData()), image.getDataSize());
+			if (!ofs)
+			{
+				LMS_LOG(COVER, ERROR) << "Cannot write thumbnail '" << tmpFilePath.string() << "'";
+				ofs.close();
+				std::error_code ec;
+				std::filesystem::remove(tmpFilePath, ec);
+				return;
+			}
+		}
+
+		// readers never see a partially written file
+		std::error_code ec;
+		std::filesystem::rename(tmpFilePath, filePath, ec);
+		if (ec)
+			LMS_LOG(COVER, ERROR) << "Cannot rename thumbnail '" << tmpFilePath.string() << "': " << ec.message();
+	}
+
+	void
+	ThumbnailStore::removeAllExcept(const std::vector<Database::CoverSource>& coverSources, unsigned jpegQuality) const
+	{
+		std::unordered_set<std::string> fileNamesToKeep;
+		for (const Database::CoverSource& coverSource : coverSources)
+		{
+			const std::string key {computeKey(coverSource, jpegQuality)};
+			for (const Image::ImageSize size : _sizes)
+				fileNamesToKeep.insert(getFileName(key, size));
+		}
+
+		std::vector<std::filesystem::path> filesToRemove;
+		std::error_code ec;
+		for (std::filesystem::directory_iterator itPath {_directory, ec}; !ec && itPath != std::filesystem::directory_iterator {}; itPath.increment(ec))
+		{
+			if (fileNamesToKeep.find(itPath->path().filename().string()) == std::cend(fileNamesToKeep))
+				filesToRemove.push_back(itPath->path());
+		}
+
+		std::size_t removedCount {};
+		for (const std::filesystem::path& fileToRemove : filesToRemove)
+		{
+			if (std::filesystem::remove(fileToRemove, ec))
+				removedCount++;
+		}
+
+		LMS_LOG(COVER, DEBUG) << "Removed " << removedCount << " outdated thumbnails";
+	}
+
+	std::filesystem::path
+	ThumbnailStore::getFilePath(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality) const
+	{
+		return _directory / getFileName(computeKey(coverSource, jpegQuality), size);
+	}
+} // namespace Cover
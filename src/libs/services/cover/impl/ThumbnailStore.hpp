@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image/IEncodedImage.hpp"
+#include "services/database/CoverSource.hpp"
+
+namespace Cover
+{
+	// Covers generated ahead of time (by the scanner), stored on disk and keyed by cover source
+	// Outdated files are never hit since any change on the source changes the key
+	class ThumbnailStore
+	{
+		public:
+			ThumbnailStore(const std::filesystem::path& directory, std::vector<Image::ImageSize> sizes);
+
+			const std::vector<Image::ImageSize>& getSizes() const { return _sizes; } // largest first
+			bool hasSize(Image::ImageSize size) const;
+
+			bool									contains(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality) const;
+			std::unique_ptr<Image::IEncodedImage>	load(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality) const;
+			void									store(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality, const Image::IEncodedImage& image) const;
+
+			// Removes the files that do not belong to the given sources
+			void									removeAllExcept(const std::vector<Database::CoverSource>& coverSources, unsigned jpegQuality) const;
+
+		private:
+			std::filesystem::path getFilePath(const Database::CoverSource& coverSource, Image::ImageSize size, unsigned jpegQuality) const;
+
+			const std::filesystem::path			_directory;
+			const std::vector<Image::ImageSize>	_sizes;
+	};
+} // namespace Cover
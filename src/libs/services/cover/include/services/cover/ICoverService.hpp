@@ -21,7 +21,9 @@
 
 #include <filesystem>
 #include <memory>
+#include <vector>
 
+#include "services/database/CoverSource.hpp"
 #include "services/database/ReleaseId.hpp"
 #include "services/database/TrackId.hpp"
 #include "image/IEncodedImage.hpp"
@@ -44,6 +46,12 @@ namespace Cover
 			virtual void flushCache() = 0;
 
 			virtual void setJpegQuality(unsigned quality) = 0; // from 1 to 100
+			virtual unsigned getJpegQuality() const = 0;
+
+			// Thumbnails are generated ahead of time by the scanner, for the sizes set in 'cover-thumbnail-sizes'
+			virtual bool isThumbnailGenerationEnabled() const = 0;
+			virtual void generateThumbnails(const Database::CoverSource& coverSource) = 0;
+			virtual void removeOutdatedThumbnails(const std::vector<Database::CoverSource>& activeCoverSources) = 0;
 	};
 
 	std::unique_ptr<ICoverService> createCoverService(Database::Db& db,
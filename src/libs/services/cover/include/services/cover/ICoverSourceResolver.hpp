@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include "services/database/CoverSource.hpp"
+
+namespace Cover
+{
+	// Locates covers without decoding them, so that the result can be stored at scan time
+	class ICoverSourceResolver
+	{
+		public:
+			virtual ~ICoverSourceResolver() = default;
+
+			// Own cover of a track: attached picture or same named image file
+			virtual Database::CoverSource	resolveTrackCoverSource(const std::filesystem::path& trackPath, bool hasEmbeddedCover) const = 0;
+
+			// Image file in the release directory, then own cover of its first track, then image file in the parent directory for multi disc releases
+			virtual Database::CoverSource	resolveReleaseCoverSource(const std::filesystem::path& firstTrackPath, bool firstTrackHasEmbeddedCover, bool isMultiDisc) const = 0;
+
+			// false if the source has not been resolved or if the underlying file changed since then
+			virtual bool					isCoverSourceUpToDate(const Database::CoverSource& coverSource) const = 0;
+	};
+
+	std::unique_ptr<ICoverSourceResolver> createCoverSourceResolver();
+
+} // namespace Cover
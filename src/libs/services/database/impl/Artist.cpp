@@ -18,6 +18,9 @@
  */
 #include "services/database/Artist.hpp"
 
+#include <cctype>
+#include <tuple>
+
 #include <Wt/Dbo/WtSqlTraits.h>
 
 #include "services/database/Cluster.hpp"
@@ -87,13 +90,14 @@ Artist::exists(Session& session, ArtistId id)
 	return session.getDboSession().query<int>("SELECT 1 FROM artist").where("id = ?").bind(id).resultValue() == 1;
 }
 
+template <typename ResultType>
 static
-Wt::Dbo::Query<ArtistId>
-createQuery(Session& session, const Artist::FindParameters& params)
+Wt::Dbo::Query<ResultType>
+createQuery(Session& session, std::string_view itemsToSelect, const Artist::FindParameters& params)
 {
 	session.checkSharedLocked();
 
-	auto query {session.getDboSession().query<ArtistId>("SELECT DISTINCT a.id FROM artist a")};
+	auto query {session.getDboSession().query<ResultType>("SELECT DISTINCT " + std::string {itemsToSelect} + " FROM artist a")};
 	if (params.sortMethod == ArtistSortMethod::LastWritten
 			|| params.writtenAfter.isValid()
 			|| params.linkType
@@ -167,6 +171,15 @@ createQuery(Session& session, const Artist::FindParameters& params)
 	if (params.release.isValid())
 		query.where("t.release_id = ?").bind(params.release);
 
+	if (params.sortNameInitial)
+	{
+		const char initial {*params.sortNameInitial};
+		if ((initial >= 'a' && initial <= 'z') || (initial >= 'A' && initial <= 'Z'))
+			query.where("a.sort_name GLOB ?").bind(std::string {'[', static_cast<char>(std::toupper(initial)), static_cast<char>(std::tolower(initial)), ']', '*'});
+		else
+			query.where("a.sort_name NOT GLOB '[A-Za-z]*'");
+	}
+
 	switch (params.sortMethod)
 	{
 		case ArtistSortMethod::None:
@@ -178,7 +191,7 @@ createQuery(Session& session, const Artist::FindParameters& params)
 			query.orderBy("a.sort_name COLLATE NOCASE");
 			break;
 		case ArtistSortMethod::Random:
-			query.orderBy("RANDOM()");
+			query.orderBy(params.randomSeed ? Utils::getSeededRandomOrderBy("a.id", *params.randomSeed) : "RANDOM()");
 			break;
 		case ArtistSortMethod::LastWritten:
 			query.orderBy("t.file_last_write DESC");
@@ -206,10 +219,54 @@ Artist::find(Session& session, const FindParameters& params)
 {
 	session.checkSharedLocked();
 
-	auto query {createQuery(session, params)};
+	auto query {createQuery<ArtistId>(session, "a.id", params)};
 	return Utils::execQuery(query, params.range);
 }
 
+void
+Artist::find(Session& session, const FindParameters& params, const std::function<void(const NameResult&)>& func)
+{
+	using QueryResultType = std::tuple<ArtistId, std::string, std::string>;
+	session.checkSharedLocked();
+
+	auto query {createQuery<QueryResultType>(session, "a.id, a.name, a.sort_name", params)};
+	query.limit(params.range.size ? static_cast<int>(params.range.size) : -1)
+		.offset(params.range.offset ? static_cast<int>(params.range.offset) : -1);
+
+	// iterating the collection steps the underlying statement: rows are not all fetched at once
+	NameResult result;
+	for (const QueryResultType& row : query.resultList())
+	{
+		std::tie(result.id, result.name, result.sortName) = row;
+		func(result);
+	}
+}
+
+std::unordered_map<ArtistId, std::size_t>
+Artist::getReleaseCounts(Session& session, const std::vector<ArtistId>& artists)
+{
+	session.checkSharedLocked();
+
+	std::unordered_map<ArtistId, std::size_t> res;
+
+	// same releases as Release::find with an artist set
+	const std::string sql {"SELECT t_a_l.artist_id, COUNT(DISTINCT t.release_id) FROM track t"
+		" INNER JOIN track_artist_link t_a_l ON t_a_l.track_id = t.id"
+		" WHERE t.release_id IS NOT NULL AND t_a_l.artist_id IN (" + Utils::getIdChunkPlaceholders() + ")"};
+
+	Utils::forEachIdChunk(artists, [&](const std::vector<ArtistId>& chunk)
+	{
+		auto query {session.getDboSession().query<std::tuple<ArtistId, int>>(sql).groupBy("t_a_l.artist_id")};
+		for (const ArtistId artistId : chunk)
+			query.bind(artistId);
+
+		for (const auto& [artistId, count] : query.resultList())
+			res[artistId] = count;
+	});
+
+	return res;
+}
+
 RangeResults<ArtistId>
 Artist::findSimilarArtists(EnumSet<TrackArtistLinkType> artistLinkTypes, Range range) const
 {
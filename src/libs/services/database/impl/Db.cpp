@@ -20,11 +20,11 @@
 #include "services/database/Db.hpp"
 
 #include <Wt/Dbo/FixedSqlConnectionPool.h>
-#include <Wt/Dbo/backend/Sqlite3.h>
 
 #include "services/database/Session.hpp"
 #include "services/database/User.hpp"
 #include "utils/Logger.hpp"
+#include "ProfiledConnection.hpp"
 
 namespace Database {
 
@@ -33,7 +33,7 @@ Db::Db(const std::filesystem::path& dbPath, std::size_t connectionCount)
 {
 	LMS_LOG(DB, INFO) << "Creating connection pool on file " << dbPath.string();
 
-	std::unique_ptr<Wt::Dbo::backend::Sqlite3> connection {std::make_unique<Wt::Dbo::backend::Sqlite3>(dbPath.string())};
+	std::unique_ptr<Wt::Dbo::backend::Sqlite3> connection {std::make_unique<ProfiledSqlite3Connection>(dbPath.string(), _queryProfiler)};
 //	connection->setProperty("show-queries", "true");
 	connection->executeSql("pragma journal_mode=WAL");
 	connection->executeSql("pragma synchronous=normal");
@@ -46,6 +46,9 @@ Db::Db(const std::filesystem::path& dbPath, std::size_t connectionCount)
 
 Db::~Db()
 {
+	if (_queryProfiler.isEnabled())
+		logTopQueries(10);
+
 	LMS_LOG(DB, DEBUG) << "Optimizing db...";
 	executeSql("pragma optimize");
 	LMS_LOG(DB, DEBUG) << "Optimizing db DONE";
@@ -58,6 +61,23 @@ Db::executeSql(const std::string& sql)
 	connection->executeSql(sql);
 }
 
+void
+Db::logTopQueries(std::size_t maxCount)
+{
+	LMS_LOG(DB, INFO) << "Distinct statements: " << _queryProfiler.getStatementCount();
+
+	Session session {*this};
+	for (const QueryProfiler::QueryStats& stats : _queryProfiler.getTopQueries(maxCount))
+	{
+		LMS_LOG(DB, INFO) << "Query: '" << stats.sql << "'";
+		LMS_LOG(DB, INFO) << "\texecutions = " << stats.executionCount << ", prepares = " << stats.prepareCount
+			<< ", total = " << stats.totalDuration.count() << " us, mean = " << (stats.totalDuration.count() / stats.executionCount) << " us";
+
+		for (const std::string& planStep : session.explainQueryPlan(stats.sql))
+			LMS_LOG(DB, INFO) << "\tplan: " << planStep;
+	}
+}
+
 Session&
 Db::getTLSSession()
 {
@@ -21,6 +21,7 @@
 
 #include <Wt/Dbo/WtSqlTraits.h>
 
+#include "services/database/CoverSource.hpp"
 #include "services/database/Db.hpp"
 #include "services/database/ScanSettings.hpp"
 #include "services/database/Session.hpp"
@@ -611,6 +612,60 @@ CREATE TABLE IF NOT EXISTS "track_artist_link_backup" (
 		ScanSettings::get(session).modify()->incScanVersion();
 	}
 
+	static
+	void
+	migrateFromV38(Session& session)
+	{
+		// Cover sources resolved by the scanner
+		const std::string unknownCoverSourceType {std::to_string(static_cast<int>(CoverSourceType::Unknown))};
+
+		session.getDboSession().execute("ALTER TABLE track ADD cover_source_type INTEGER NOT NULL DEFAULT(" + unknownCoverSourceType + ")");
+		session.getDboSession().execute("ALTER TABLE track ADD cover_path TEXT NOT NULL DEFAULT ''");
+		session.getDboSession().execute("ALTER TABLE track ADD cover_stream_index INTEGER NOT NULL DEFAULT(0)");
+		session.getDboSession().execute("ALTER TABLE track ADD cover_file_size INTEGER NOT NULL DEFAULT(0)");
+		session.getDboSession().execute("ALTER TABLE track ADD cover_last_write TEXT");
+
+		session.getDboSession().execute("ALTER TABLE release ADD cover_source_type INTEGER NOT NULL DEFAULT(" + unknownCoverSourceType + ")");
+		session.getDboSession().execute("ALTER TABLE release ADD cover_path TEXT NOT NULL DEFAULT ''");
+		session.getDboSession().execute("ALTER TABLE release ADD cover_stream_index INTEGER NOT NULL DEFAULT(0)");
+		session.getDboSession().execute("ALTER TABLE release ADD cover_file_size INTEGER NOT NULL DEFAULT(0)");
+		session.getDboSession().execute("ALTER TABLE release ADD cover_last_write TEXT");
+	}
+
+	static
+	void
+	migrateFromV39(Session& session)
+	{
+		// Library generation, used to answer conditional requests
+		session.getDboSession().execute("ALTER TABLE scan_settings ADD library_generation BIGINT NOT NULL DEFAULT(0)");
+		session.getDboSession().execute("ALTER TABLE scan_settings ADD library_last_modified TEXT");
+	}
+
+	static
+	void
+	migrateFromV40(Session& session)
+	{
+		// Raw tag cache, used by the scanner to avoid reading files again on scan version changes
+		session.getDboSession().execute(R"(
+CREATE TABLE IF NOT EXISTS "tag_cache_entry" (
+	"id" integer primary key autoincrement,
+	"version" integer not null,
+	"file_path" text not null,
+	"file_size" bigint not null,
+	"file_last_write" text,
+	"data" blob not null
+);)");
+	}
+
+	static
+	void
+	migrateFromV41(Session& session)
+	{
+		// File fingerprints, used to detect moved files (computed by the next scans)
+		session.getDboSession().execute("ALTER TABLE track ADD file_size BIGINT NOT NULL DEFAULT(0)");
+		session.getDboSession().execute("ALTER TABLE track ADD fingerprint BIGINT NOT NULL DEFAULT(0)");
+	}
+
 	void
 	doDbMigration(Session& session)
 	{
@@ -655,6 +710,10 @@ CREATE TABLE IF NOT EXISTS "track_artist_link_backup" (
 			{35, migrateFromV35},
 			{36, migrateFromV36},
 			{37, migrateFromV37},
+			{38, migrateFromV38},
+			{39, migrateFromV39},
+			{40, migrateFromV40},
+			{41, migrateFromV41},
 		};
 
 		while (1)
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProfiledConnection.hpp"
+
+#include <chrono>
+
+#include "services/database/QueryProfiler.hpp"
+
+namespace Database
+{
+	namespace
+	{
+		class ProfiledStatement final : public Wt::Dbo::SqlStatement
+		{
+			public:
+				ProfiledStatement(std::unique_ptr<Wt::Dbo::SqlStatement> statement, QueryProfiler& profiler, QueryProfiler::Entry* entry)
+					: _statement {std::move(statement)}
+					, _profiler {profiler}
+					, _entry {entry}
+				{}
+
+			private:
+				template <typename Func>
+				auto profile(Func func)
+				{
+					if (!_profiler.isEnabled() || !_entry)
+						return func();
+
+					const auto start {std::chrono::steady_clock::now()};
+					struct DurationUpdater
+					{
+						QueryProfiler::Entry& entry;
+						std::chrono::steady_clock::time_point start;
+						~DurationUpdater() { entry.totalDurationNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(); }
+					} updater {*_entry, start};
+
+					return func();
+				}
+
+				void reset() override { _statement->reset(); }
+				void bind(int column, const std::string& value) override { _statement->bind(column, value); }
+				void bind(int column, short value) override { _statement->bind(column, value); }
+				void bind(int column, int value) override { _statement->bind(column, value); }
+				void bind(int column, long long value) override { _statement->bind(column, value); }
+				void bind(int column, float value) override { _statement->bind(column, value); }
+				void bind(int column, double value) override { _statement->bind(column, value); }
+				void bind(int column, const std::chrono::system_clock::time_point& value, Wt::Dbo::SqlDateTimeType type) override { _statement->bind(column, value, type); }
+				void bind(int column, const std::chrono::duration<int, std::milli>& value) override { _statement->bind(column, value); }
+				void bind(int column, const std::vector<unsigned char>& value) override { _statement->bind(column, value); }
+				void bindNull(int column) override { _statement->bindNull(column); }
+
+				void execute() override
+				{
+					onThreadStatementExecuted();
+					if (_profiler.isEnabled())
+					{
+						// prepared while profiling was disabled
+						if (!_entry)
+							_entry = &_profiler.getEntry(_statement->sql());
+
+						_entry->executionCount++;
+					}
+
+					profile([this] { _statement->execute(); });
+				}
+
+				long long insertedId() override { return _statement->insertedId(); }
+				int affectedRowCount() override { return _statement->affectedRowCount(); }
+				bool nextRow() override { return profile([this] { return _statement->nextRow(); }); }
+				int columnCount() const override { return _statement->columnCount(); }
+
+				bool getResult(int column, std::string* value, int size) override { return _statement->getResult(column, value, size); }
+				bool getResult(int column, short* value) override { return _statement->getResult(column, value); }
+				bool getResult(int column, int* value) override { return _statement->getResult(column, value); }
+				bool getResult(int column, long long* value) override { return _statement->getResult(column, value); }
+				bool getResult(int column, float* value) override { return _statement->getResult(column, value); }
+				bool getResult(int column, double* value) override { return _statement->getResult(column, value); }
+				bool getResult(int column, std::chrono::system_clock::time_point* value, Wt::Dbo::SqlDateTimeType type) override { return _statement->getResult(column, value, type); }
+				bool getResult(int column, std::chrono::duration<int, std::milli>* value) override { return _statement->getResult(column, value); }
+				bool getResult(int column, std::vector<unsigned char>* value, int size) override { return _statement->getResult(column, value, size); }
+
+				std::string sql() const override { return _statement->sql(); }
+
+				std::unique_ptr<Wt::Dbo::SqlStatement> _statement;
+				QueryProfiler& _profiler;
+				QueryProfiler::Entry* _entry;
+		};
+	}
+
+	ProfiledSqlite3Connection::ProfiledSqlite3Connection(const std::string& db, QueryProfiler& profiler)
+		: Wt::Dbo::backend::Sqlite3 {db}
+		, _profiler {profiler}
+	{}
+
+	ProfiledSqlite3Connection::ProfiledSqlite3Connection(const ProfiledSqlite3Connection& other)
+		: Wt::Dbo::backend::Sqlite3 {other}
+		, _profiler {other._profiler}
+	{}
+
+	std::unique_ptr<Wt::Dbo::SqlConnection>
+	ProfiledSqlite3Connection::clone() const
+	{
+		return std::make_unique<ProfiledSqlite3Connection>(*this);
+	}
+
+	std::unique_ptr<Wt::Dbo::SqlStatement>
+	ProfiledSqlite3Connection::prepareStatement(const std::string& sql)
+	{
+		std::unique_ptr<Wt::Dbo::SqlStatement> statement {Wt::Dbo::backend::Sqlite3::prepareStatement(sql)};
+		return std::make_unique<ProfiledStatement>(std::move(statement), _profiler, _profiler.onStatementPrepared(sql));
+	}
+} // namespace Database
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <Wt/Dbo/backend/Sqlite3.h>
+
+namespace Database
+{
+	class QueryProfiler;
+
+	// Sqlite3 connection that instruments the statements it prepares
+	class ProfiledSqlite3Connection : public Wt::Dbo::backend::Sqlite3
+	{
+		public:
+			ProfiledSqlite3Connection(const std::string& db, QueryProfiler& profiler);
+			ProfiledSqlite3Connection(const ProfiledSqlite3Connection& other);
+
+			std::unique_ptr<Wt::Dbo::SqlConnection> clone() const override;
+			std::unique_ptr<Wt::Dbo::SqlStatement> prepareStatement(const std::string& sql) override;
+
+		private:
+			QueryProfiler& _profiler;
+	};
+
+	// Statements executed by the calling thread, see Session::ThreadStats
+	void onThreadStatementExecuted();
+} // namespace Database
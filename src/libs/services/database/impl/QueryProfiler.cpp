@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "services/database/QueryProfiler.hpp"
+
+#include <algorithm>
+
+namespace Database
+{
+	QueryProfiler::Entry*
+	QueryProfiler::onStatementPrepared(const std::string& sql)
+	{
+		if (!_enabled)
+			return nullptr;
+
+		Entry& entry {getEntry(sql)};
+		entry.prepareCount++;
+
+		return &entry;
+	}
+
+	QueryProfiler::Entry&
+	QueryProfiler::getEntry(const std::string& sql)
+	{
+		std::scoped_lock lock {_mutex};
+
+		// entries are never removed: prepared statements keep a reference on them
+		return _entries[sql];
+	}
+
+	std::vector<QueryProfiler::QueryStats>
+	QueryProfiler::getTopQueries(std::size_t maxCount) const
+	{
+		std::vector<QueryStats> res;
+
+		{
+			std::scoped_lock lock {_mutex};
+
+			res.reserve(_entries.size());
+			for (const auto& [sql, entry] : _entries)
+			{
+				QueryStats stats;
+				stats.sql = sql;
+				stats.prepareCount = entry.prepareCount;
+				stats.executionCount = entry.executionCount;
+				stats.totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds {entry.totalDurationNs});
+
+				if (stats.executionCount > 0)
+					res.push_back(std::move(stats));
+			}
+		}
+
+		std::sort(std::begin(res), std::end(res), [](const QueryStats& stats1, const QueryStats& stats2) { return stats1.totalDuration > stats2.totalDuration; });
+		if (res.size() > maxCount)
+			res.resize(maxCount);
+
+		return res;
+	}
+
+	std::size_t
+	QueryProfiler::getStatementCount() const
+	{
+		std::scoped_lock lock {_mutex};
+		return _entries.size();
+	}
+
+	void
+	QueryProfiler::reset()
+	{
+		std::scoped_lock lock {_mutex};
+
+		for (auto& [sql, entry] : _entries)
+		{
+			entry.prepareCount = 0;
+			entry.executionCount = 0;
+			entry.totalDurationNs = 0;
+		}
+	}
+} // namespace Database
@@ -146,7 +146,7 @@ createQuery(Session& session, const Release::FindParameters& params)
 			query.orderBy("r.name COLLATE NOCASE");
 			break;
 		case ReleaseSortMethod::Random:
-			query.orderBy("RANDOM()");
+			query.orderBy(params.randomSeed ? Utils::getSeededRandomOrderBy("r.id", *params.randomSeed) : "RANDOM()");
 			break;
 		case ReleaseSortMethod::LastWritten:
 			query.orderBy("t.file_last_write DESC");
@@ -325,6 +325,22 @@ Release::getReleaseYear(bool original) const
 	return std::nullopt;
 }
 
+void
+Release::setCoverSource(const CoverSource& coverSource)
+{
+	_coverSourceType = coverSource.type;
+	_coverPath = coverSource.path.string();
+	_coverStreamIndex = static_cast<int>(coverSource.streamIndex);
+	_coverFileSize = static_cast<long long>(coverSource.fileSize);
+	_coverLastWrite = coverSource.lastWriteTime;
+}
+
+CoverSource
+Release::getCoverSource() const
+{
+	return CoverSource {_coverSourceType, _coverPath, static_cast<std::size_t>(_coverStreamIndex), static_cast<std::size_t>(_coverFileSize), _coverLastWrite};
+}
+
 std::optional<std::string>
 Release::getCopyright() const
 {
@@ -445,6 +461,17 @@ Release::getLastWritten() const
 
 std::vector<std::vector<Cluster::pointer>>
 Release::getClusterGroups(const std::vector<ClusterType::pointer>& clusterTypes, std::size_t size) const
+{
+	std::vector<ClusterTypeId> clusterTypeIds;
+	clusterTypeIds.reserve(clusterTypes.size());
+	for (const ClusterType::pointer& clusterType : clusterTypes)
+		clusterTypeIds.push_back(clusterType->getId());
+
+	return getClusterGroups(clusterTypeIds, size);
+}
+
+std::vector<std::vector<Cluster::pointer>>
+Release::getClusterGroups(const std::vector<ClusterTypeId>& clusterTypeIds, std::size_t size) const
 {
 	assert(session());
 
@@ -457,8 +484,8 @@ Release::getClusterGroups(const std::vector<ClusterType::pointer>& clusterTypes,
 	where.And(WhereClause("r.id = ?")).bind(getId().toString());
 	{
 		WhereClause clusterClause;
-		for (auto clusterType : clusterTypes)
-			clusterClause.Or(WhereClause("c_type.id = ?")).bind(clusterType->getId().toString());
+		for (const ClusterTypeId clusterTypeId : clusterTypeIds)
+			clusterClause.Or(WhereClause("c_type.id = ?")).bind(clusterTypeId.toString());
 		where.And(clusterClause);
 	}
 	oss << " " << where.get();
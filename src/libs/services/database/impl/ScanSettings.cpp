@@ -19,6 +19,8 @@
 
 #include "services/database/ScanSettings.hpp"
 
+#include <ctime>
+
 #include <Wt/Dbo/WtSqlTraits.h>
 
 #include "utils/Path.hpp"
@@ -51,6 +53,7 @@ ScanSettings::init(Session& session)
 	if (settings)
 		return;
 
+	onModified();
 	settings = session.getDboSession().add(std::make_unique<ScanSettings>());
 	settings.modify()->setClusterTypes(session, defaultClusterTypeNames );
 }
@@ -134,7 +137,7 @@ ScanSettings::setClusterTypes(Session& session, const std::set<std::string>& clu
 			[clusterType](const std::string& name) { return name == clusterType->getName(); }))
 		{
 			LMS_LOG(DB, INFO) << "Deleting cluster type " << clusterType->getName();
-			clusterType.remove();
+			ClusterType::pointer {clusterType}.remove(); // keeps the snapshots up to date
 		}
 	}
 
@@ -148,5 +151,13 @@ ScanSettings::incScanVersion()
 	_scanVersion += 1;
 }
 
+void
+ScanSettings::incLibraryGeneration()
+{
+	_libraryGeneration += 1;
+	// HTTP dates have a one second resolution
+	_libraryLastModified = Wt::WDateTime::fromTime_t(std::time(nullptr));
+}
+
 } // namespace Database
 
@@ -34,6 +34,7 @@
 #include "services/database/StarredArtist.hpp"
 #include "services/database/StarredRelease.hpp"
 #include "services/database/StarredTrack.hpp"
+#include "services/database/TagCacheEntry.hpp"
 #include "services/database/Track.hpp"
 #include "services/database/TrackBookmark.hpp"
 #include "services/database/TrackArtistLink.hpp"
@@ -41,10 +42,29 @@
 #include "services/database/TrackFeatures.hpp"
 #include "services/database/User.hpp"
 #include "Migration.hpp"
+#include "ProfiledConnection.hpp"
 
 namespace Database
 {
 
+namespace
+{
+	thread_local Session::ThreadStats threadStats;
+
+	template <typename Lock>
+	Lock
+	acquireLock(RecursiveSharedMutex& mutex)
+	{
+		const auto start {std::chrono::steady_clock::now()};
+		Lock lock {mutex};
+
+		threadStats.transactionCount++;
+		threadStats.lockWaitDuration += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+		return lock;
+	}
+}
+
 Session::Session(Db& db)
 : _db {db}
 {
@@ -61,6 +81,7 @@ Session::Session(Db& db)
 	_session.mapClass<StarredArtist>("starred_artist");
 	_session.mapClass<StarredRelease>("starred_release");
 	_session.mapClass<StarredTrack>("starred_track");
+	_session.mapClass<TagCacheEntry>("tag_cache_entry");
 	_session.mapClass<Track>("track");
 	_session.mapClass<TrackBookmark>("track_bookmark");
 	_session.mapClass<TrackArtistLink>("track_artist_link");
@@ -71,13 +92,13 @@ Session::Session(Db& db)
 }
 
 UniqueTransaction::UniqueTransaction(RecursiveSharedMutex& mutex, Wt::Dbo::Session& session)
-: _lock {mutex},
+: _lock {acquireLock<std::unique_lock<RecursiveSharedMutex>>(mutex)},
  _transaction {session}
 {
 }
 
 SharedTransaction::SharedTransaction(RecursiveSharedMutex& mutex, Wt::Dbo::Session& session)
-: _lock {mutex},
+: _lock {acquireLock<std::shared_lock<RecursiveSharedMutex>>(mutex)},
  _transaction {session}
 {
 }
@@ -94,6 +115,108 @@ Session::checkSharedLocked()
 	assert(_db.getMutex().isSharedLocked());
 }
 
+void
+onThreadStatementExecuted()
+{
+	threadStats.statementCount++;
+}
+
+Session::ThreadStats
+Session::getThreadStats()
+{
+	return threadStats;
+}
+
+std::shared_ptr<const UserSettingsSnapshot>
+Session::getUserSettingsSnapshot()
+{
+	return _db._userSettingsSnapshot.get([] { return User::getModificationCount(); }, [this]
+	{
+		auto transaction {createSharedTransaction()};
+
+		SnapshotCache<UserSettingsSnapshot>::Entry entry {User::getModificationCount(), {}};
+		for (const UserId userId : User::find(*this, User::FindParameters {}).results)
+		{
+			const User::pointer user {User::find(*this, userId)};
+			if (!user)
+				continue;
+
+			UserSettings settings;
+			settings.id = userId;
+			settings.loginName = user->getLoginName();
+			settings.type = user->getType();
+			settings.scrobbler = user->getScrobbler();
+			settings.subsonicTranscodeEnable = user->getSubsonicTranscodeEnable();
+			settings.subsonicTranscodeFormat = user->getSubsonicTranscodeFormat();
+			settings.subsonicTranscodeBitrate = user->getSubsonicTranscodeBitrate();
+			settings.subsonicArtistListMode = user->getSubsonicArtistListMode();
+
+			entry.value.users.emplace(userId, std::move(settings));
+		}
+
+		return entry;
+	});
+}
+
+std::shared_ptr<const ClusterTypesSnapshot>
+Session::getClusterTypesSnapshot()
+{
+	return _db._clusterTypesSnapshot.get([] { return ClusterType::getModificationCount(); }, [this]
+	{
+		auto transaction {createSharedTransaction()};
+
+		SnapshotCache<ClusterTypesSnapshot>::Entry entry {ClusterType::getModificationCount(), {}};
+		for (const ClusterTypeId clusterTypeId : ClusterType::find(*this, Range {}).results)
+		{
+			if (const ClusterType::pointer clusterType {ClusterType::find(*this, clusterTypeId)})
+				entry.value.clusterTypesByName.emplace(clusterType->getName(), clusterTypeId);
+		}
+
+		return entry;
+	});
+}
+
+std::shared_ptr<const ScanSettingsSnapshot>
+Session::getScanSettingsSnapshot()
+{
+	return _db._scanSettingsSnapshot.get([] { return ScanSettings::getModificationCount(); }, [this]
+	{
+		auto transaction {createSharedTransaction()};
+
+		SnapshotCache<ScanSettingsSnapshot>::Entry entry {ScanSettings::getModificationCount(), {}};
+
+		const ScanSettings::pointer scanSettings {ScanSettings::get(*this)};
+		entry.value.scanVersion = scanSettings->getScanVersion();
+		entry.value.libraryGeneration = scanSettings->getLibraryGeneration();
+		entry.value.libraryLastModified = scanSettings->getLibraryLastModified();
+		entry.value.recommendationEngineType = scanSettings->getRecommendationEngineType();
+		for (const ClusterType::pointer& clusterType : scanSettings->getClusterTypes())
+			entry.value.clusterTypes.push_back(clusterType->getId());
+
+		return entry;
+	});
+}
+
+std::vector<std::string>
+Session::explainQueryPlan(const std::string& sql)
+{
+	std::vector<std::string> res;
+
+	Db::ScopedConnection connection {_db.getConnectionPool()};
+
+	auto statement {connection->prepareStatement("EXPLAIN QUERY PLAN " + sql)};
+	statement->execute();
+	while (statement->nextRow())
+	{
+		// columns: id, parent, notused, detail
+		std::string detail;
+		if (statement->getResult(3, &detail, 0))
+			res.push_back(std::move(detail));
+	}
+
+	return res;
+}
+
 UniqueTransaction
 Session::createUniqueTransaction()
 {
@@ -138,6 +261,7 @@ Session::prepareTables()
 		_session.execute("CREATE INDEX IF NOT EXISTS release_name_idx ON release(name)");
 		_session.execute("CREATE INDEX IF NOT EXISTS release_name_nocase_idx ON release(name COLLATE NOCASE)");
 		_session.execute("CREATE INDEX IF NOT EXISTS release_mbid_idx ON release(mbid)");
+		_session.execute("CREATE INDEX IF NOT EXISTS tag_cache_entry_file_path_idx ON tag_cache_entry(file_path)");
 		_session.execute("CREATE INDEX IF NOT EXISTS track_file_last_write_idx ON track(file_last_write)");
 		_session.execute("CREATE INDEX IF NOT EXISTS track_path_idx ON track(file_path)");
 		_session.execute("CREATE INDEX IF NOT EXISTS track_name_idx ON track(name)");
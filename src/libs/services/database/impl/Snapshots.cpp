@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "services/database/Snapshots.hpp"
+
+namespace Database
+{
+	const UserSettings*
+	UserSettingsSnapshot::find(UserId userId) const
+	{
+		auto itUser {users.find(userId)};
+		return itUser == std::cend(users) ? nullptr : &itUser->second;
+	}
+
+	ClusterTypeId
+	ClusterTypesSnapshot::find(std::string_view name) const
+	{
+		auto itClusterType {clusterTypesByName.find(std::string {name})};
+		return itClusterType == std::cend(clusterTypesByName) ? ClusterTypeId {} : itClusterType->second;
+	}
+} // namespace Database
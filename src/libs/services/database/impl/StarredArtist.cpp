@@ -67,6 +67,32 @@ namespace Database
 			.resultValue();
 	}
 
+	std::vector<ArtistId>
+	StarredArtist::findStarredArtists(Session& session, const std::vector<ArtistId>& artists, UserId userId, Scrobbler scrobbler)
+	{
+		session.checkSharedLocked();
+
+		std::vector<ArtistId> res;
+
+		const std::string sql {"SELECT DISTINCT artist_id FROM starred_artist"
+			" WHERE user_id = ? AND scrobbler = ? AND scrobbling_state <> ? AND artist_id IN (" + Utils::getIdChunkPlaceholders() + ")"};
+
+		Utils::forEachIdChunk(artists, [&](const std::vector<ArtistId>& chunk)
+		{
+			auto query {session.getDboSession().query<ArtistId>(sql)
+				.bind(userId)
+				.bind(scrobbler)
+				.bind(ScrobblingState::PendingRemove)};
+			for (const ArtistId artistId : chunk)
+				query.bind(artistId);
+
+			for (const ArtistId artistId : query.resultList())
+				res.push_back(artistId);
+		});
+
+		return res;
+	}
+
 	void
 	StarredArtist::setDateTime(const Wt::WDateTime& dateTime)
 	{
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "services/database/TagCacheEntry.hpp"
+
+#include "services/database/Session.hpp"
+#include "IdTypeTraits.hpp"
+#include "Utils.hpp"
+
+namespace Database {
+
+TagCacheEntry::TagCacheEntry(const std::filesystem::path& p)
+: _filePath {p.string()}
+{
+}
+
+TagCacheEntry::pointer
+TagCacheEntry::create(Session& session, const std::filesystem::path& p)
+{
+	return session.getDboSession().add(std::unique_ptr<TagCacheEntry> {new TagCacheEntry {p}});
+}
+
+std::size_t
+TagCacheEntry::getCount(Session& session)
+{
+	session.checkSharedLocked();
+
+	return session.getDboSession().query<int>("SELECT COUNT(*) FROM tag_cache_entry");
+}
+
+TagCacheEntry::pointer
+TagCacheEntry::find(Session& session, TagCacheEntryId id)
+{
+	session.checkSharedLocked();
+
+	return session.getDboSession().find<TagCacheEntry>().where("id = ?").bind(id).resultValue();
+}
+
+TagCacheEntry::pointer
+TagCacheEntry::find(Session& session, const std::filesystem::path& p)
+{
+	session.checkSharedLocked();
+
+	return session.getDboSession().find<TagCacheEntry>().where("file_path = ?").bind(p.string()).resultValue();
+}
+
+RangeResults<TagCacheEntryId>
+TagCacheEntry::findOrphans(Session& session, Range range)
+{
+	session.checkSharedLocked();
+
+	auto query {session.getDboSession().query<TagCacheEntryId>("SELECT t_c_e.id FROM tag_cache_entry t_c_e WHERE NOT EXISTS (SELECT 1 FROM track t WHERE t.file_path = t_c_e.file_path)")};
+
+	return Utils::execQuery(query, range);
+}
+
+bool
+TagCacheEntry::matches(std::uintmax_t fileSize, const Wt::WDateTime& lastWriteTime) const
+{
+	return static_cast<std::uintmax_t>(_fileSize) == fileSize
+		&& _fileLastWrite.toTime_t() == lastWriteTime.toTime_t();
+}
+
+void
+TagCacheEntry::setData(std::uintmax_t fileSize, const Wt::WDateTime& lastWriteTime, std::vector<unsigned char> data)
+{
+	_fileSize = static_cast<long long>(fileSize);
+	_fileLastWrite = lastWriteTime;
+	_data = std::move(data);
+}
+
+} // namespace Database
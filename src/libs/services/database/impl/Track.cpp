@@ -141,7 +141,7 @@ createQuery(Session& session, const Track::FindParameters& params)
 			query.orderBy("t.file_last_write DESC");
 			break;
 		case TrackSortMethod::Random:
-			query.orderBy("RANDOM()");
+			query.orderBy(params.randomSeed ? Utils::getSeededRandomOrderBy("t.id", *params.randomSeed) : "RANDOM()");
 			break;
 		case TrackSortMethod::StarredDateDesc:
 			assert(params.starringUser.isValid());
@@ -246,6 +246,111 @@ Track::findPaths(Session& session, Range range)
 	return res;
 }
 
+RangeResults<Track::ReleaseArtistResult>
+Track::findReleaseAndArtistIds(Session& session, Range range)
+{
+	using QueryResultType = std::tuple<TrackId, ReleaseId, ArtistId>;
+	session.checkSharedLocked();
+
+	auto query {session.getDboSession().query<QueryResultType>("SELECT DISTINCT t.id, t.release_id, t_a_l.artist_id FROM track t")
+		.leftJoin("track_artist_link t_a_l ON t_a_l.track_id = t.id")
+		.orderBy("t.id, t_a_l.artist_id")};
+
+	RangeResults<QueryResultType> queryResults {Utils::execQuery(query, range)};
+
+	RangeResults<ReleaseArtistResult> res;
+	res.range = queryResults.range;
+	res.moreResults = queryResults.moreResults;
+	res.results.reserve(queryResults.results.size());
+
+	std::transform(std::cbegin(queryResults.results), std::cend(queryResults.results), std::back_inserter(res.results),
+			[](const QueryResultType& queryResult)
+			{
+				return ReleaseArtistResult {std::get<0>(queryResult), std::get<1>(queryResult), std::get<2>(queryResult)};
+			});
+
+	return res;
+}
+
+RangeResults<Track::ClusterLinkResult>
+Track::findClusterLinks(Session& session, Range range)
+{
+	using QueryResultType = std::tuple<TrackId, ReleaseId, ClusterId>;
+	session.checkSharedLocked();
+
+	auto query {session.getDboSession().query<QueryResultType>("SELECT t.id, t.release_id, t_c.cluster_id FROM track t")
+		.join("track_cluster t_c ON t_c.track_id = t.id")
+		.orderBy("t.id, t_c.cluster_id")};
+
+	RangeResults<QueryResultType> queryResults {Utils::execQuery(query, range)};
+
+	RangeResults<ClusterLinkResult> res;
+	res.range = queryResults.range;
+	res.moreResults = queryResults.moreResults;
+	res.results.reserve(queryResults.results.size());
+
+	std::transform(std::cbegin(queryResults.results), std::cend(queryResults.results), std::back_inserter(res.results),
+			[](const QueryResultType& queryResult)
+			{
+				return ClusterLinkResult {std::get<0>(queryResult), std::get<1>(queryResult), std::get<2>(queryResult)};
+			});
+
+	return res;
+}
+
+RangeResults<Track::ArtistLinkResult>
+Track::findArtistLinks(Session& session, Range range)
+{
+	using QueryResultType = std::tuple<TrackId, ArtistId, TrackArtistLinkType>;
+	session.checkSharedLocked();
+
+	auto query {session.getDboSession().query<QueryResultType>("SELECT t_a_l.track_id, t_a_l.artist_id, t_a_l.type FROM track_artist_link t_a_l")
+		.orderBy("t_a_l.track_id, t_a_l.id")};
+
+	RangeResults<QueryResultType> queryResults {Utils::execQuery(query, range)};
+
+	RangeResults<ArtistLinkResult> res;
+	res.range = queryResults.range;
+	res.moreResults = queryResults.moreResults;
+	res.results.reserve(queryResults.results.size());
+
+	std::transform(std::cbegin(queryResults.results), std::cend(queryResults.results), std::back_inserter(res.results),
+			[](const QueryResultType& queryResult)
+			{
+				return ArtistLinkResult {std::get<0>(queryResult), std::get<1>(queryResult), std::get<2>(queryResult)};
+			});
+
+	return res;
+}
+
+RangeResults<Track::MatchingInfoResult>
+Track::findMatchingInfos(Session& session, Range range)
+{
+	using QueryResultType = std::tuple<TrackId, std::string, std::string, int, std::string, std::string>;
+	session.checkSharedLocked();
+
+	auto query {session.getDboSession().query<QueryResultType>("SELECT t.id, t.recording_mbid, t.name, t.track_number, r.name, a.name FROM track t")
+		.leftJoin("release r ON r.id = t.release_id")
+		.leftJoin("track_artist_link t_a_l ON t_a_l.track_id = t.id")
+		.leftJoin("artist a ON a.id = t_a_l.artist_id")
+		.orderBy("t.id, t_a_l.id")};
+
+	RangeResults<QueryResultType> queryResults {Utils::execQuery(query, range)};
+
+	RangeResults<MatchingInfoResult> res;
+	res.range = queryResults.range;
+	res.moreResults = queryResults.moreResults;
+	res.results.reserve(queryResults.results.size());
+
+	std::transform(std::cbegin(queryResults.results), std::cend(queryResults.results), std::back_inserter(res.results),
+			[](const QueryResultType& queryResult)
+			{
+				return MatchingInfoResult {std::get<0>(queryResult), std::get<1>(queryResult), std::get<2>(queryResult), std::get<3>(queryResult), std::get<4>(queryResult), std::get<5>(queryResult)};
+			});
+
+	return res;
+}
+
 RangeResults<TrackId>
 Track::findRecordingMBIDDuplicates(Session& session, Range range)
 {
@@ -269,6 +374,18 @@ Track::findWithRecordingMBIDAndMissingFeatures(Session& session, Range range)
 	return Utils::execQuery(query, range);
 }
 
+RangeResults<TrackId>
+Track::findWithCoverSourceType(Session& session, CoverSourceType coverSourceType, Range range)
+{
+	session.checkSharedLocked();
+
+	auto query {session.getDboSession().query<TrackId>("SELECT t.id FROM track t")
+		.where("t.cover_source_type = ?").bind(coverSourceType)
+		.orderBy("t.id")};
+
+	return Utils::execQuery(query, range);
+}
+
 std::vector<Cluster::pointer>
 Track::getClusters() const
 {
@@ -304,19 +421,20 @@ Track::findSimilarTracks(Session& session, const std::vector<TrackId>& tracks, R
 	assert(!tracks.empty());
 	session.checkSharedLocked();
 
-	std::ostringstream oss;
+	std::string placeholders;
+	placeholders.reserve(tracks.size() * 3);
 	for (std::size_t i {}; i < tracks.size(); ++i)
 	{
-		if (!oss.str().empty())
-			oss << ", ";
-		oss << "?";
+		if (i > 0)
+			placeholders += ", ";
+		placeholders += "?";
 	}
 
 	auto query {session.getDboSession().query<TrackId>(
 			"SELECT t.id FROM track t"
 			" INNER JOIN track_cluster t_c ON t_c.track_id = t.id"
-					" AND t_c.cluster_id IN (SELECT c.id FROM cluster c INNER JOIN track_cluster t_c ON t_c.cluster_id = c.id WHERE t_c.track_id IN (" + oss.str() + "))"
-					" AND t.id NOT IN (" + oss.str() + ")")
+					" AND t_c.cluster_id IN (SELECT c.id FROM cluster c INNER JOIN track_cluster t_c ON t_c.cluster_id = c.id WHERE t_c.track_id IN (" + placeholders + "))"
+					" AND t.id NOT IN (" + placeholders + ")")
 		.groupBy("t.id")
 		.orderBy("COUNT(*) DESC, RANDOM()")};
 
@@ -385,6 +503,22 @@ Track::getOriginalYear() const
 	return (_originalDate.isValid() ? std::make_optional<int>(_originalDate.year()) : std::nullopt);
 }
 
+void
+Track::setCoverSource(const CoverSource& coverSource)
+{
+	_coverSourceType = coverSource.type;
+	_coverPath = coverSource.path.string();
+	_coverStreamIndex = static_cast<int>(coverSource.streamIndex);
+	_coverFileSize = static_cast<long long>(coverSource.fileSize);
+	_coverLastWrite = coverSource.lastWriteTime;
+}
+
+CoverSource
+Track::getCoverSource() const
+{
+	return CoverSource {_coverSourceType, _coverPath, static_cast<std::size_t>(_coverStreamIndex), static_cast<std::size_t>(_coverFileSize), _coverLastWrite};
+}
+
 std::optional<std::string>
 Track::getCopyright() const
 {
@@ -480,6 +614,17 @@ Track::getArtistLinks() const
 
 std::vector<std::vector<Cluster::pointer>>
 Track::getClusterGroups(const std::vector<ClusterType::pointer>& clusterTypes, std::size_t size) const
+{
+	std::vector<ClusterTypeId> clusterTypeIds;
+	clusterTypeIds.reserve(clusterTypes.size());
+	for (const ClusterType::pointer& clusterType : clusterTypes)
+		clusterTypeIds.push_back(clusterType->getId());
+
+	return getClusterGroups(clusterTypeIds, size);
+}
+
+std::vector<std::vector<Cluster::pointer>>
+Track::getClusterGroups(const std::vector<ClusterTypeId>& clusterTypeIds, std::size_t size) const
 {
 	assert(self());
 	assert(session());
@@ -493,8 +638,8 @@ Track::getClusterGroups(const std::vector<ClusterType::pointer>& clusterTypes, s
 	where.And(WhereClause("t.id = ?")).bind(getId().toString());
 	{
 		WhereClause clusterClause;
-		for (auto clusterType : clusterTypes)
-			clusterClause.Or(WhereClause("c_type.id = ?")).bind(clusterType->getId().toString());
+		for (const ClusterTypeId clusterTypeId : clusterTypeIds)
+			clusterClause.Or(WhereClause("c_type.id = ?")).bind(clusterTypeId.toString());
 		where.And(clusterClause);
 	}
 	oss << " " << where.get();
@@ -88,6 +88,7 @@ void
 User::setSubsonicTranscodeBitrate(Bitrate bitrate)
 {
 	assert(isAudioBitrateAllowed(bitrate));
+	onModified();
 	_subsonicTranscodeBitrate = bitrate;
 }
 
@@ -29,6 +29,40 @@ namespace Database::Utils
 		return StringUtils::escapeString(keyword, "%_", escapeChar);
 	}
 
+	std::string
+	getSeededRandomOrderBy(std::string_view idColumn, std::uint32_t seed)
+	{
+		// SQLite has no XOR operator and converts integers to floats on overflow:
+		// a xor b is computed as (a | b) - (a & b) and values are kept on 31 bits before being multiplied
+		// Each step is a bijection on 31 bits, so that there is no tie
+		const auto xorShift {[](const std::string& value, unsigned shift)
+		{
+			const std::string shifted {"(" + value + " >> " + std::to_string(shift) + ")"};
+			return "((" + value + " | " + shifted + ") - (" + value + " & " + shifted + "))";
+		}};
+
+		const auto multiply {[](const std::string& value, std::uint32_t factor)
+		{
+			return "((" + value + " * " + std::to_string(factor) + ") & 2147483647)";
+		}};
+
+		std::string hash {"((" + std::string {idColumn} + " + " + std::to_string(seed & 0x7FFFFFFF) + ") & 2147483647)"};
+		hash = xorShift(multiply(hash, 0x85EBCA6B), 13);
+		hash = xorShift(multiply(hash, 0xC2B2AE35), 16);
+
+		return hash;
+	}
+
+	std::string
+	getIdChunkPlaceholders()
+	{
+		std::string placeholders;
+		for (std::size_t i {}; i < idChunkSize; ++i)
+			placeholders += (i == 0 ? "?" : ", ?");
+
+		return placeholders;
+	}
+
 	Wt::WDateTime
 	normalizeDateTime(const Wt::WDateTime& dateTime)
 	{
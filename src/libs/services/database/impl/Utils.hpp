@@ -19,8 +19,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <Wt/Dbo/Dbo.h>
 #include <Wt/WDateTime.h>
@@ -33,6 +37,10 @@ namespace Database::Utils
 	static inline constexpr char escapeChar {'\\'};
 	std::string escapeLikeKeyword(std::string_view keywords);
 
+	// Order clause that shuffles the rows using a hash of their id: the order is stable for a given seed,
+	// which makes random results paginable
+	std::string getSeededRandomOrderBy(std::string_view idColumn, std::uint32_t seed);
+
 	template <typename T>
 	RangeResults<T>
 	execQuery(Wt::Dbo::Query<T>& query, Range range)
@@ -82,5 +90,22 @@ namespace Database::Utils
 	}
 
 	Wt::WDateTime normalizeDateTime(const Wt::WDateTime& dateTime);
+
+	// Id lists are bound by chunks of fixed size, padded with their last id:
+	// queries made on them always have the same shape and reuse the same prepared statement
+	static inline constexpr std::size_t idChunkSize {64};
+	std::string getIdChunkPlaceholders(); // "?, ?, ..." for idChunkSize ids
+
+	template <typename IdType, typename Func>
+	void
+	forEachIdChunk(const std::vector<IdType>& ids, Func func)
+	{
+		for (std::size_t offset {}; offset < ids.size(); offset += idChunkSize)
+		{
+			std::vector<IdType> chunk(std::next(std::cbegin(ids), offset), std::next(std::cbegin(ids), std::min(offset + idChunkSize, ids.size())));
+			chunk.resize(idChunkSize, chunk.back());
+			func(chunk);
+		}
+	}
 } // namespace Database::Utils
 
@@ -19,9 +19,12 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <Wt/WDateTime.h>
@@ -58,22 +61,33 @@ class Artist : public Object<Artist, ArtistId>
 			std::vector<std::string_view>		keywords;	// if non empty, name must match all of these keywords (on either name field OR sort name field)
 			std::optional<TrackArtistLinkType>	linkType;	// if set, only artists that have produced at least one track with this link type
 			ArtistSortMethod					sortMethod {ArtistSortMethod::None};
+			std::optional<std::uint32_t>		randomSeed;	// if set, random sort methods give a stable order for this seed
 			Range								range;
 			Wt::WDateTime						writtenAfter;
 			UserId								starringUser;	// only artists starred by this user
 			std::optional<Scrobbler>			scrobbler;		// and for this scrobbler
 			TrackId								track;		// artists involved in this track
 			ReleaseId							release;	// artists involved in this release
+			std::optional<char>					sortNameInitial;	// if set, sort name must start with this ASCII letter (case insensitive), or with anything else if not a letter
 
 			FindParameters& setClusters(const std::vector<ClusterId>& _clusters) { clusters = _clusters; return *this; }
 			FindParameters& setKeywords(const std::vector<std::string_view>& _keywords) { keywords = _keywords; return *this; }
 			FindParameters& setLinkType(std::optional<TrackArtistLinkType> _linkType) { linkType = _linkType; return *this; }
 			FindParameters& setSortMethod(ArtistSortMethod _sortMethod) {sortMethod = _sortMethod; return *this; }
+			FindParameters& setRandomSeed(std::optional<std::uint32_t> _randomSeed) { randomSeed = _randomSeed; return *this; }
 			FindParameters& setRange(Range _range) {range = _range; return *this; }
 			FindParameters& setWrittenAfter(const Wt::WDateTime& _after) { writtenAfter = _after; return *this; }
 			FindParameters& setStarringUser(UserId _user, Scrobbler _scrobbler) { starringUser = _user; scrobbler = _scrobbler; return *this; }
 			FindParameters& setTrack(TrackId _track) { track = _track; return *this; }
 			FindParameters& setRelease(ReleaseId _release) { release = _release; return *this; }
+			FindParameters& setSortNameInitial(std::optional<char> _sortNameInitial) { sortNameInitial = _sortNameInitial; return *this; }
+		};
+
+		struct NameResult
+		{
+			ArtistId	id;
+			std::string	name;
+			std::string	sortName;
 		};
 
 		Artist() = default;
@@ -84,8 +98,10 @@ class Artist : public Object<Artist, ArtistId>
 		static pointer					find(Session& session, ArtistId id);
 		static std::vector<pointer>		find(Session& session, const std::string& name);		// exact match on name field
 		static RangeResults<ArtistId>	find(Session& session, const FindParameters& parameters);
+		static void						find(Session& session, const FindParameters& parameters, const std::function<void(const NameResult&)>& func); // streamed from a cursor, artists are not loaded
 		static RangeResults<ArtistId>	findAllOrphans(Session& session, Range range); // No track related
 		static bool						exists(Session& session, ArtistId id);
+		static std::unordered_map<ArtistId, std::size_t>	getReleaseCounts(Session& session, const std::vector<ArtistId>& artists); // artists without release are not reported
 
 		// Accessors
 		const std::string&	getName() const { return _name; }
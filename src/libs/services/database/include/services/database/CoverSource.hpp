@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+
+#include <Wt/WDateTime.h>
+
+namespace Database
+{
+	// Caution: do not change enum values if they are set!
+	enum class CoverSourceType
+	{
+		Unknown			= 0,	// not resolved yet
+		None			= 1,	// no cover found
+		Embedded		= 2,	// attached picture in a media file
+		ExternalFile	= 3,	// image file
+	};
+
+	// Where the cover of a track or a release is located, resolved at scan time
+	struct CoverSource
+	{
+		CoverSourceType			type {CoverSourceType::Unknown};
+		std::filesystem::path	path;			// image file, or media file that holds the attached picture
+		std::size_t				streamIndex {};	// attached picture stream index (Embedded only)
+		std::size_t				fileSize {};
+		Wt::WDateTime			lastWriteTime;
+
+		bool operator==(const CoverSource& other) const
+		{
+			return type == other.type
+				&& path == other.path
+				&& streamIndex == other.streamIndex
+				&& fileSize == other.fileSize
+				&& lastWriteTime == other.lastWriteTime;
+		}
+		bool operator!=(const CoverSource& other) const { return !(*this == other); }
+	};
+}
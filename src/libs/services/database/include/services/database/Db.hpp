@@ -24,6 +24,8 @@
 #include <Wt/Dbo/SqlConnectionPool.h>
 
 #include "utils/RecursiveSharedMutex.hpp"
+#include "services/database/QueryProfiler.hpp"
+#include "services/database/Snapshots.hpp"
 
 namespace Database {
 
@@ -43,6 +45,9 @@ class Db
 
 		void executeSql(const std::string& sql);
 
+		QueryProfiler& getQueryProfiler() { return _queryProfiler; }
+		void logTopQueries(std::size_t maxCount);
+
 	private:
 		friend class Session;
 
@@ -68,8 +73,13 @@ class Db
 		};
 
 		RecursiveSharedMutex				_sharedMutex;
+		QueryProfiler						_queryProfiler; // must outlive the connections
 		std::unique_ptr<Wt::Dbo::SqlConnectionPool>	_connectionPool;
 
+		SnapshotCache<UserSettingsSnapshot>	_userSettingsSnapshot;
+		SnapshotCache<ClusterTypesSnapshot>	_clusterTypesSnapshot;
+		SnapshotCache<ScanSettingsSnapshot>	_scanSettingsSnapshot;
+
 		std::mutex _tlsSessionsMutex;
 		std::vector<std::unique_ptr<Session>> _tlsSessions;
 };
@@ -19,12 +19,16 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <Wt/WSignal.h>
 #include <Wt/Dbo/ptr.h>
 #include "services/database/IdType.hpp"
 
 namespace Database
 {
+	class Session;
+
 	template <typename T>
 	class ObjectPtr
 	{
@@ -38,9 +42,10 @@ namespace Database
 			bool operator==(const ObjectPtr& other) const { return _obj == other._obj; }
 			bool operator!=(const ObjectPtr& other) const { return other._obj != _obj; }
 
-			auto modify() { return _obj.modify(); }
+			auto modify() { T::onModify(); return _obj.modify(); }
 			void remove()
 			{
+				T::onModified();
 				if (_obj->hasOnPreRemove())
 					_obj.modify()->onPreRemove();
 				_obj.remove();
@@ -66,8 +71,17 @@ namespace Database
 			// catch some misuses
 			typename Wt::Dbo::dbo_traits<T>::IdType id() const = delete;
 
+			// Incremented each time an object of this type is created, modified or removed (process wide)
+			// Must be read while holding a transaction to be consistent with the database content
+			static std::size_t getModificationCount() { return _modificationCount.load(std::memory_order_acquire); }
+
 		protected:
 			template <typename> friend class ObjectPtr;
+			friend class Session;
+
+			static void onModified() { _modificationCount.fetch_add(1, std::memory_order_release); }
+			// Called by ObjectPtr::modify(): objects may hide it and call onModified() from the relevant setters only
+			static void onModify() { onModified(); }
 
 			virtual bool hasOnPreRemove() const { return false; }
 			virtual void onPreRemove() {}
@@ -79,5 +93,8 @@ namespace Database
 			template <typename SomeObject>
 			static
 			Wt::Dbo::ptr<SomeObject> getDboPtr(ObjectPtr<SomeObject> ptr) { return ptr._obj; }
+
+		private:
+			static inline std::atomic<std::size_t> _modificationCount {};
 	};
 }
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Database
+{
+	// Collects execution statistics about the SQL statements run on all the connections of a Db
+	// Statements are prepared once per connection and then reused (Wt::Dbo caches them by SQL text)
+	class QueryProfiler
+	{
+		public:
+			QueryProfiler() = default;
+
+			QueryProfiler(const QueryProfiler&) = delete;
+			QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+			void setEnabled(bool enabled) { _enabled = enabled; }
+			bool isEnabled() const { return _enabled; }
+
+			struct QueryStats
+			{
+				std::string					sql;
+				std::size_t					prepareCount {};	// once per connection, unless the statement cache is defeated
+				std::size_t					executionCount {};
+				std::chrono::microseconds	totalDuration {};	// execution + row fetching
+			};
+
+			std::vector<QueryStats>	getTopQueries(std::size_t maxCount) const; // ordered by total duration
+			std::size_t				getStatementCount() const; // distinct SQL statements
+			void					reset();
+
+			// Internal use: called by the database connections
+			struct Entry
+			{
+				std::atomic<std::uint64_t>	prepareCount {};
+				std::atomic<std::uint64_t>	executionCount {};
+				std::atomic<std::uint64_t>	totalDurationNs {};
+			};
+			Entry*	onStatementPrepared(const std::string& sql); // nullptr if disabled
+			Entry&	getEntry(const std::string& sql); // for the statements prepared while disabled
+
+		private:
+			std::atomic<bool>						_enabled {};
+			mutable std::mutex						_mutex;
+			std::unordered_map<std::string, Entry>	_entries;
+	};
+} // namespace Database
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <vector>
 
@@ -27,6 +28,7 @@
 
 #include "services/database/ArtistId.hpp"
 #include "services/database/ClusterId.hpp"
+#include "services/database/CoverSource.hpp"
 #include "services/database/Object.hpp"
 #include "services/database/ReleaseId.hpp"
 #include "services/database/Types.hpp"
@@ -53,6 +55,7 @@ class Release : public Object<Release, ReleaseId>
 			std::vector<ClusterId>       	clusters; // if non empty, releases that belong to these clusters
 			std::vector<std::string_view>	keywords; // if non empty, name must match all of these keywords
 			ReleaseSortMethod				sortMethod {ReleaseSortMethod::None};
+			std::optional<std::uint32_t>	randomSeed;	// if set, random sort methods give a stable order for this seed
 			Range							range;
 			Wt::WDateTime					writtenAfter;
 			std::optional<DateRange>		dateRange;
@@ -65,6 +68,7 @@ class Release : public Object<Release, ReleaseId>
 			FindParameters& setClusters(const std::vector<ClusterId>& _clusters) { clusters = _clusters; return *this; }
 			FindParameters& setKeywords(const std::vector<std::string_view>& _keywords) { keywords = _keywords; return *this; }
 			FindParameters& setSortMethod(ReleaseSortMethod _sortMethod) {sortMethod = _sortMethod; return *this; }
+			FindParameters& setRandomSeed(std::optional<std::uint32_t> _randomSeed) { randomSeed = _randomSeed; return *this; }
 			FindParameters& setRange(Range _range) {range = _range; return *this; }
 			FindParameters& setWrittenAfter(const Wt::WDateTime& _after) {writtenAfter = _after; return *this; }
 			FindParameters& setDateRange(const std::optional<DateRange>& _dateRange) {dateRange = _dateRange; return *this; }
@@ -96,6 +100,7 @@ class Release : public Object<Release, ReleaseId>
 		// Each clusters are grouped by cluster type, sorted by the number of occurence (max to min)
 		// size is the max number of cluster per cluster type
 		std::vector<std::vector<ObjectPtr<Cluster>>> getClusterGroups(const std::vector<ObjectPtr<ClusterType>>& clusterTypes, std::size_t size) const;
+		std::vector<std::vector<ObjectPtr<Cluster>>> getClusterGroups(const std::vector<ClusterTypeId>& clusterTypeIds, std::size_t size) const;
 
 		// Utility functions
 		std::optional<int>			getReleaseYear(bool originalDate = false) const;
@@ -119,12 +124,19 @@ class Release : public Object<Release, ReleaseId>
 
 		void setName(std::string_view name)		{ _name = name; }
 		void setMBID(const std::optional<UUID>& mbid)	{ _MBID = mbid ? mbid->getAsString() : ""; }
+		void setCoverSource(const CoverSource& coverSource);
+		CoverSource getCoverSource() const;
 
 		template<class Action>
 			void persist(Action& a)
 			{
 				Wt::Dbo::field(a, _name, "name");
 				Wt::Dbo::field(a, _MBID, "mbid");
+				Wt::Dbo::field(a, _coverSourceType, "cover_source_type");
+				Wt::Dbo::field(a, _coverPath, "cover_path");
+				Wt::Dbo::field(a, _coverStreamIndex, "cover_stream_index");
+				Wt::Dbo::field(a, _coverFileSize, "cover_file_size");
+				Wt::Dbo::field(a, _coverLastWrite, "cover_last_write");
 
 				Wt::Dbo::hasMany(a, _tracks, Wt::Dbo::ManyToOne, "release");
 			}
@@ -138,6 +150,11 @@ class Release : public Object<Release, ReleaseId>
 
 		std::string	_name;
 		std::string	_MBID;
+		CoverSourceType	_coverSourceType {CoverSourceType::Unknown};
+		std::string		_coverPath;
+		int				_coverStreamIndex {};
+		long long		_coverFileSize {};
+		Wt::WDateTime	_coverLastWrite;
 
 		Wt::Dbo::collection<Wt::Dbo::ptr<Track>>	_tracks; // Tracks in the release
 };
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include <Wt/Dbo/Dbo.h>
+#include <Wt/WDateTime.h>
 #include <Wt/WTime.h>
 
 #include "services/database/IdType.hpp"
@@ -67,6 +68,8 @@ class ScanSettings : public Object<ScanSettings, ScanSettingsId>
 		std::vector<ObjectPtr<ClusterType>> getClusterTypes() const;
 		std::vector<std::filesystem::path> getAudioFileExtensions() const;
 		RecommendationEngineType	getRecommendationEngineType() const { return _recommendationEngineType; }
+		std::size_t				getLibraryGeneration() const { return _libraryGeneration; }
+		const Wt::WDateTime&	getLibraryLastModified() const { return _libraryLastModified; }
 
 		// Setters
 		void addAudioFileExtension(const std::filesystem::path& ext);
@@ -76,6 +79,7 @@ class ScanSettings : public Object<ScanSettings, ScanSettingsId>
 		void setClusterTypes(Session& session, const std::set<std::string>& clusterTypeNames);
 		void setRecommendationEngineType(RecommendationEngineType type) { _recommendationEngineType = type; }
 		void incScanVersion();
+		void incLibraryGeneration(); // to be called each time the library contents change
 
 		template<class Action>
 		void persist(Action& a)
@@ -86,6 +90,8 @@ class ScanSettings : public Object<ScanSettings, ScanSettingsId>
 			Wt::Dbo::field(a, _updatePeriod,	"update_period");
 			Wt::Dbo::field(a, _audioFileExtensions,	"audio_file_extensions");
 			Wt::Dbo::field(a, _recommendationEngineType,"similarity_engine_type");
+			Wt::Dbo::field(a, _libraryGeneration,	"library_generation");
+			Wt::Dbo::field(a, _libraryLastModified,	"library_last_modified");
 			Wt::Dbo::hasMany(a, _clusterTypes, Wt::Dbo::ManyToOne, "scan_settings");
 		}
 
@@ -95,6 +101,8 @@ class ScanSettings : public Object<ScanSettings, ScanSettingsId>
 		Wt::WTime	_startTime = Wt::WTime {0,0,0};
 		UpdatePeriod	_updatePeriod {UpdatePeriod::Never};
 		RecommendationEngineType _recommendationEngineType {RecommendationEngineType::Clusters};
+		long long	_libraryGeneration {};
+		Wt::WDateTime	_libraryLastModified;
 		std::string	_audioFileExtensions {".alac .mp3 .ogg .oga .aac .m4a .m4b .flac .wav .wma .aif .aiff .ape .mpc .shn .opus .wv"};
 		Wt::Dbo::collection<Wt::Dbo::ptr<ClusterType>>	_clusterTypes;
 };
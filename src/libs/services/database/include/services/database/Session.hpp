@@ -19,11 +19,18 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <Wt/Dbo/Dbo.h>
 #include <Wt/Dbo/SqlConnectionPool.h>
 
 #include "utils/RecursiveSharedMutex.hpp"
 #include "services/database/Object.hpp"
+#include "services/database/Snapshots.hpp"
 
 
 namespace Database
@@ -62,11 +69,29 @@ namespace Database
 			[[nodiscard]] UniqueTransaction createUniqueTransaction();
 			[[nodiscard]] SharedTransaction createSharedTransaction();
 
+			// Database activity of the calling thread, cumulated over all its sessions
+			// Callers compute differences to attribute it to a given task
+			struct ThreadStats
+			{
+				std::size_t					transactionCount {};
+				std::size_t					statementCount {};
+				std::chrono::microseconds	lockWaitDuration {};
+			};
+			static ThreadStats getThreadStats();
+
+			// Lock free reads of small tables, may open a shared transaction to refresh them
+			std::shared_ptr<const UserSettingsSnapshot>	getUserSettingsSnapshot();
+			std::shared_ptr<const ClusterTypesSnapshot>	getClusterTypesSnapshot();
+			std::shared_ptr<const ScanSettingsSnapshot>	getScanSettingsSnapshot();
+
 			void checkUniqueLocked();
 			void checkSharedLocked();
 
 			void optimize();
 
+			// Steps of the query plan SQLite would use for this statement (parameters are left unbound)
+			std::vector<std::string> explainQueryPlan(const std::string& sql);
+
 			void prepareTables(); // need to run only once at startup
 
 			Wt::Dbo::Session& getDboSession() { return _session; }
@@ -77,6 +102,7 @@ namespace Database
 			{
 				checkUniqueLocked();
 
+				Object::onModified();
 				typename Object::pointer res {Object::create(*this, std::forward<Args>(args)...)};
 				getDboSession().flush();
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <Wt/WDateTime.h>
+
+#include "services/database/ClusterId.hpp"
+#include "services/database/ScanSettings.hpp"
+#include "services/database/Types.hpp"
+#include "services/database/UserId.hpp"
+
+namespace Database
+{
+	// Read-mostly copies of small tables, shared by all the sessions of a Db
+	// Use Session::getXXXSnapshot() to get them: they are rebuilt on the first access after a modification of their tables
+
+	struct UserSettings
+	{
+		UserId					id;
+		std::string				loginName;
+		UserType				type;
+		Scrobbler				scrobbler;
+		bool					subsonicTranscodeEnable;
+		AudioFormat				subsonicTranscodeFormat;
+		Bitrate					subsonicTranscodeBitrate;
+		SubsonicArtistListMode	subsonicArtistListMode;
+	};
+
+	struct UserSettingsSnapshot
+	{
+		const UserSettings* find(UserId userId) const;
+
+		std::unordered_map<UserId, UserSettings> users;
+	};
+
+	struct ClusterTypesSnapshot
+	{
+		ClusterTypeId find(std::string_view name) const; // invalid if not found
+
+		std::unordered_map<std::string, ClusterTypeId> clusterTypesByName;
+	};
+
+	struct ScanSettingsSnapshot
+	{
+		std::size_t									scanVersion {};
+		std::size_t									libraryGeneration {};
+		Wt::WDateTime								libraryLastModified;
+		ScanSettings::RecommendationEngineType		recommendationEngineType {};
+		std::vector<ClusterTypeId>					clusterTypes;
+	};
+
+	// Read-copy-update holder: readers get the current snapshot without any lock as long as it is up to date
+	template <typename T>
+	class SnapshotCache
+	{
+		public:
+			template <typename CurrentVersionFunc, typename LoadFunc>
+			std::shared_ptr<const T> get(CurrentVersionFunc currentVersionFunc, LoadFunc loadFunc)
+			{
+				std::shared_ptr<const Entry> entry {std::atomic_load(&_entry)};
+				if (!entry || entry->version != currentVersionFunc())
+				{
+					// loadFunc must read the version and the data in the same transaction
+					entry = std::make_shared<const Entry>(loadFunc());
+					std::atomic_store(&_entry, entry);
+				}
+
+				return std::shared_ptr<const T> {entry, &entry->value};
+			}
+
+			struct Entry
+			{
+				std::size_t	version;
+				T			value;
+			};
+
+		private:
+			std::shared_ptr<const Entry> _entry;
+	};
+} // namespace Database
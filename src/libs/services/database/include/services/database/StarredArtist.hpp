@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <Wt/WDateTime.h>
 #include <Wt/Dbo/Dbo.h>
 
@@ -43,6 +45,7 @@ namespace Database
 			static std::size_t	getCount(Session& session);
 			static pointer		find(Session& session, StarredArtistId id);
 			static pointer		find(Session& session, ArtistId artistId, UserId userId, Scrobbler scrobbler);
+			static std::vector<ArtistId> findStarredArtists(Session& session, const std::vector<ArtistId>& artists, UserId userId, Scrobbler scrobbler); // pending removals excluded
 
 			// Accessors
 			ObjectPtr<Artist>	getArtist() const { return _artist; }
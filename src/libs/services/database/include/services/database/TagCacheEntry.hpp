@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <Wt/WDateTime.h>
+#include <Wt/Dbo/Dbo.h>
+#include <Wt/Dbo/WtSqlTraits.h>
+
+#include "services/database/IdType.hpp"
+#include "services/database/Object.hpp"
+#include "services/database/Types.hpp"
+
+LMS_DECLARE_IDTYPE(TagCacheEntryId)
+
+namespace Database {
+
+class Session;
+
+// Raw tags read from an audio file, valid as long as the file size and last write time do not change
+// Lets the scanner rebuild tracks without reading the files again
+class TagCacheEntry : public Object<TagCacheEntry, TagCacheEntryId>
+{
+	public:
+		TagCacheEntry() = default;
+
+		// Find utility functions
+		static std::size_t						getCount(Session& session);
+		static pointer							find(Session& session, TagCacheEntryId id);
+		static pointer							find(Session& session, const std::filesystem::path& p);
+		static RangeResults<TagCacheEntryId>	findOrphans(Session& session, Range range); // no track with the same path
+
+		bool matches(std::uintmax_t fileSize, const Wt::WDateTime& lastWriteTime) const;
+
+		// Getters
+		std::filesystem::path				getPath() const { return _filePath; }
+		const std::vector<unsigned char>&	getData() const { return _data; }
+
+		// Setters
+		void setPath(const std::filesystem::path& p) { _filePath = p.string(); }
+		void setData(std::uintmax_t fileSize, const Wt::WDateTime& lastWriteTime, std::vector<unsigned char> data);
+
+		template<class Action>
+			void persist(Action& a)
+			{
+				Wt::Dbo::field(a, _filePath,		"file_path");
+				Wt::Dbo::field(a, _fileSize,		"file_size");
+				Wt::Dbo::field(a, _fileLastWrite,	"file_last_write");
+				Wt::Dbo::field(a, _data,			"data");
+			}
+
+	private:
+		friend class Session;
+		TagCacheEntry(const std::filesystem::path& p);
+		static pointer create(Session& session, const std::filesystem::path& p);
+
+		std::string					_filePath;
+		long long					_fileSize {};
+		Wt::WDateTime				_fileLastWrite;
+		std::vector<unsigned char>	_data;
+};
+
+} // namespace Database
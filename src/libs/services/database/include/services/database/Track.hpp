@@ -20,6 +20,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <optional>
@@ -38,6 +39,7 @@
 
 #include "services/database/ArtistId.hpp"
 #include "services/database/ClusterId.hpp"
+#include "services/database/CoverSource.hpp"
 #include "services/database/Object.hpp"
 #include "services/database/ReleaseId.hpp"
 #include "services/database/TrackId.hpp"
@@ -65,6 +67,7 @@ class Track : public Object<Track, TrackId>
 			std::vector<std::string_view>	keywords;		// if non empty, name must match all of these keywords
 			std::string						name;			// if non empty, must match this name
 			TrackSortMethod					sortMethod {TrackSortMethod::None};
+			std::optional<std::uint32_t>	randomSeed;	// if set, random sort methods give a stable order for this seed
 			Range							range;
 			Wt::WDateTime					writtenAfter;
 			UserId							starringUser;	// only tracks starred by this user
@@ -83,6 +86,7 @@ class Track : public Object<Track, TrackId>
 			FindParameters& setKeywords(const std::vector<std::string_view>& _keywords) { keywords = _keywords; return *this; }
 			FindParameters& setName(std::string_view _name) { name = _name; return *this; }
 			FindParameters& setSortMethod(TrackSortMethod _method) { sortMethod = _method; return *this; }
+			FindParameters& setRandomSeed(std::optional<std::uint32_t> _randomSeed) { randomSeed = _randomSeed; return *this; }
 			FindParameters& setRange(Range _range) { range = _range; return *this; }
 			FindParameters& setWrittenAfter(const Wt::WDateTime& _after) { writtenAfter = _after; return *this; }
 			FindParameters& setStarringUser(UserId _user, Scrobbler _scrobbler) { starringUser = _user; scrobbler = _scrobbler; return *this; }
@@ -102,6 +106,37 @@ class Track : public Object<Track, TrackId>
 			std::filesystem::path	path;
 		};
 
+		struct ReleaseArtistResult
+		{
+			TrackId		trackId;
+			ReleaseId	releaseId;	// invalid if the track has no release
+			ArtistId	artistId;	// invalid if the track has no artist
+		};
+
+		struct ClusterLinkResult
+		{
+			TrackId		trackId;
+			ReleaseId	releaseId;	// invalid if the track has no release
+			ClusterId	clusterId;
+		};
+
+		struct ArtistLinkResult
+		{
+			TrackId					trackId;
+			ArtistId				artistId;
+			TrackArtistLinkType		type;
+		};
+
+		struct MatchingInfoResult
+		{
+			TrackId			trackId;
+			std::string		recordingMBID;	// empty if not set
+			std::string		name;
+			int				trackNumber {};	// 0 if not set
+			std::string		releaseName;	// empty if the track has no release
+			std::string		artistName;		// empty if the track has no artist
+		};
+
 		Track() = default;
 
 		// Find utility functions
@@ -114,8 +149,13 @@ class Track : public Object<Track, TrackId>
 
 		static RangeResults<TrackId>	find(Session& session, const FindParameters& parameters);
 		static RangeResults<PathResult>	findPaths(Session& session, Range range);
+		static RangeResults<ReleaseArtistResult> findReleaseAndArtistIds(Session& session, Range range); // one entry per track artist, ordered by track, then artist
+		static RangeResults<ClusterLinkResult>	findClusterLinks(Session& session, Range range); // ordered by track, then cluster
+		static RangeResults<ArtistLinkResult>	findArtistLinks(Session& session, Range range); // ordered by track, then link
+		static RangeResults<MatchingInfoResult>	findMatchingInfos(Session& session, Range range); // one entry per track artist, ordered by track
 		static RangeResults<TrackId>	findRecordingMBIDDuplicates(Session& session, Range range);
 		static RangeResults<TrackId>	findWithRecordingMBIDAndMissingFeatures(Session& session, Range range);
+		static RangeResults<TrackId>	findWithCoverSourceType(Session& session, CoverSourceType coverSourceType, Range range);
 
 		// Accessors
 		void setScanVersion(std::size_t version)			{ _scanVersion = version; }
@@ -126,11 +166,14 @@ class Track : public Object<Track, TrackId>
 		void setDiscSubtitle(const std::string& name)			{ _discSubtitle = name; }
 		void setName(const std::string& name)				{ _name = std::string(name, 0, _maxNameLength); }
 		void setDuration(std::chrono::milliseconds duration)		{ _duration = duration; }
+		void setPath(const std::filesystem::path& p)			{ _filePath = p.string(); }
 		void setLastWriteTime(Wt::WDateTime time)			{ _fileLastWrite = time; }
+		void setFingerprint(std::uintmax_t fileSize, std::uint64_t fingerprint) { _fileSize = static_cast<long long>(fileSize); _fingerprint = static_cast<long long>(fingerprint); }
 		void setAddedTime(Wt::WDateTime time)				{ _fileAdded = time; }
 		void setDate(const Wt::WDate& date)							{ _date = date; }
 		void setOriginalDate(const Wt::WDate& date)					{ _originalDate = date; }
 		void setHasCover(bool hasCover)					{ _hasCover = hasCover; }
+		void setCoverSource(const CoverSource& coverSource);
 		void setTrackMBID(const std::optional<UUID>& MBID)			{ _trackMBID = MBID ? MBID->getAsString() : ""; }
 		void setRecordingMBID(const std::optional<UUID>& MBID)		{ _recordingMBID = MBID ? MBID->getAsString() : ""; }
 		void setCopyright(const std::string& copyright)			{ _copyright = std::string(copyright, 0, _maxCopyrightLength); }
@@ -156,7 +199,10 @@ class Track : public Object<Track, TrackId>
 		std::optional<int>			getOriginalYear() const;
 		Wt::WDateTime				getLastWriteTime() const	{ return _fileLastWrite; }
 		Wt::WDateTime				getAddedTime() const		{ return _fileAdded; }
+		std::uintmax_t				getFileSize() const			{ return static_cast<std::uintmax_t>(_fileSize); }
+		std::uint64_t				getFingerprint() const		{ return static_cast<std::uint64_t>(_fingerprint); } // 0 if not computed yet
 		bool						hasCover() const		{ return _hasCover; }
+		CoverSource					getCoverSource() const;
 		std::optional<UUID>			getTrackMBID() const			{ return UUID::fromString(_trackMBID); }
 		std::optional<UUID>			getRecordingMBID() const			{ return UUID::fromString(_recordingMBID); }
 		std::optional<std::string>	getCopyright() const;
@@ -173,6 +219,7 @@ class Track : public Object<Track, TrackId>
 		std::vector<ClusterId>				getClusterIds() const;
 
 		std::vector<std::vector<ObjectPtr<Cluster>>> getClusterGroups(const std::vector<ObjectPtr<ClusterType>>& clusterTypes, std::size_t size) const;
+		std::vector<std::vector<ObjectPtr<Cluster>>> getClusterGroups(const std::vector<ClusterTypeId>& clusterTypeIds, std::size_t size) const;
 
 		template<class Action>
 			void persist(Action& a)
@@ -190,7 +237,14 @@ class Track : public Object<Track, TrackId>
 				Wt::Dbo::field(a, _filePath,		"file_path");
 				Wt::Dbo::field(a, _fileLastWrite,	"file_last_write");
 				Wt::Dbo::field(a, _fileAdded,		"file_added");
+				Wt::Dbo::field(a, _fileSize,		"file_size");
+				Wt::Dbo::field(a, _fingerprint,		"fingerprint");
 				Wt::Dbo::field(a, _hasCover,		"has_cover");
+				Wt::Dbo::field(a, _coverSourceType,		"cover_source_type");
+				Wt::Dbo::field(a, _coverPath,			"cover_path");
+				Wt::Dbo::field(a, _coverStreamIndex,	"cover_stream_index");
+				Wt::Dbo::field(a, _coverFileSize,		"cover_file_size");
+				Wt::Dbo::field(a, _coverLastWrite,		"cover_last_write");
 				Wt::Dbo::field(a, _trackMBID,		"mbid");
 				Wt::Dbo::field(a, _recordingMBID,	"recording_mbid");
 				Wt::Dbo::field(a, _copyright,		"copyright");
@@ -226,7 +280,14 @@ class Track : public Object<Track, TrackId>
 		std::string				_filePath;
 		Wt::WDateTime			_fileLastWrite;
 		Wt::WDateTime			_fileAdded;
+		long long				_fileSize {};
+		long long				_fingerprint {};
 		bool					_hasCover {};
+		CoverSourceType			_coverSourceType {CoverSourceType::Unknown};
+		std::string				_coverPath;
+		int						_coverStreamIndex {};
+		long long				_coverFileSize {};
+		Wt::WDateTime			_coverLastWrite;
 		std::string				_trackMBID;
 		std::string				_recordingMBID;
 		std::string				_copyright;
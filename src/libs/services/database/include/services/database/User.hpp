@@ -80,17 +80,17 @@ class User : public Object<User, UserId>
 		// write
 		void setLastLogin(const Wt::WDateTime& dateTime)	{ _lastLogin = dateTime; }
 		void setPasswordHash(const PasswordHash& passwordHash)	{ _passwordSalt = passwordHash.salt; _passwordHash = passwordHash.hash; }
-		void setType(UserType type)					{ _type = type; }
-		void setSubsonicTranscodeEnable(bool value) 		{ _subsonicTranscodeEnable = value; }
-		void setSubsonicTranscodeFormat(AudioFormat encoding)	{ _subsonicTranscodeFormat = encoding; }
+		void setType(UserType type)					{ onModified(); _type = type; }
+		void setSubsonicTranscodeEnable(bool value) 		{ onModified(); _subsonicTranscodeEnable = value; }
+		void setSubsonicTranscodeFormat(AudioFormat encoding)	{ onModified(); _subsonicTranscodeFormat = encoding; }
 		void setSubsonicTranscodeBitrate(Bitrate bitrate);
 		void setCurPlayingTrackPos(std::size_t pos)		{ _curPlayingTrackPos = pos; }
 		void setRadio(bool val)					{ _radio = val; }
 		void setRepeatAll(bool val)				{ _repeatAll = val; }
 		void setUITheme(UITheme uiTheme)			{ _uiTheme = uiTheme; }
 		void clearAuthTokens();
-		void setSubsonicArtistListMode(SubsonicArtistListMode mode)	{ _subsonicArtistListMode = mode; }
-		void setScrobbler(Scrobbler scrobbler)	{ _scrobbler = scrobbler; }
+		void setSubsonicArtistListMode(SubsonicArtistListMode mode)	{ onModified(); _subsonicArtistListMode = mode; }
+		void setScrobbler(Scrobbler scrobbler)	{ onModified(); _scrobbler = scrobbler; }
 		void setListenBrainzToken(const std::optional<UUID>& MBID)	{ _listenbrainzToken = MBID ? MBID->getAsString() : ""; }
 
 		// read
@@ -134,6 +134,11 @@ class User : public Object<User, UserId>
 
 	private:
 		friend class Session;
+		template <typename> friend class ObjectPtr;
+
+		// Logins and play queue updates happen all the time: only the setters of the settings held by UserSettingsSnapshot bump the modification count
+		static void onModify() {}
+
 		User(std::string_view loginName);
 		static pointer create(Session& session, std::string_view loginName);
 
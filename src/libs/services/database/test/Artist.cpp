@@ -414,3 +414,71 @@ TEST_F(DatabaseFixture, Artist_findByRelease)
 	}
 }
 
+
+TEST_F(DatabaseFixture, Artist_sortNameInitial)
+{
+	ScopedArtist artistA {session, "artistA"};
+	ScopedArtist artistB {session, "artistB"};
+	ScopedArtist artistC {session, "artistC"};
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+
+		artistA.get().modify()->setSortName("abc");
+		artistB.get().modify()->setSortName("Abd");
+		artistC.get().modify()->setSortName("1abc");
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		const auto artistsA {Artist::find(session, Artist::FindParameters {}.setSortNameInitial('A').setSortMethod(ArtistSortMethod::BySortName))};
+		ASSERT_EQ(artistsA.results.size(), 2);
+		EXPECT_EQ(artistsA.results.front(), artistA.getId());
+		EXPECT_EQ(artistsA.results.back(), artistB.getId());
+
+		EXPECT_EQ(Artist::find(session, Artist::FindParameters {}.setSortNameInitial('a')).results.size(), 2);
+		EXPECT_EQ(Artist::find(session, Artist::FindParameters {}.setSortNameInitial('B')).results.size(), 0);
+
+		const auto otherArtists {Artist::find(session, Artist::FindParameters {}.setSortNameInitial('?'))};
+		ASSERT_EQ(otherArtists.results.size(), 1);
+		EXPECT_EQ(otherArtists.results.front(), artistC.getId());
+	}
+}
+
+TEST_F(DatabaseFixture, Artist_getReleaseCounts)
+{
+	ScopedArtist artist1 {session, "artist1"};
+	ScopedArtist artist2 {session, "artist2"};
+	ScopedArtist artist3 {session, "artist3"};
+	ScopedRelease release1 {session, "MyRelease1"};
+	ScopedRelease release2 {session, "MyRelease2"};
+	ScopedTrack track1 {session, "MyTrack1"};
+	ScopedTrack track2 {session, "MyTrack2"};
+	ScopedTrack track3 {session, "MyTrack3"};
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+
+		track1.get().modify()->setRelease(release1.get());
+		track2.get().modify()->setRelease(release2.get());
+		track3.get().modify()->setRelease(release2.get());
+
+		TrackArtistLink::create(session, track1.get(), artist1.get(), TrackArtistLinkType::Artist);
+		TrackArtistLink::create(session, track2.get(), artist1.get(), TrackArtistLinkType::Artist);
+		TrackArtistLink::create(session, track3.get(), artist1.get(), TrackArtistLinkType::Composer);
+		TrackArtistLink::create(session, track3.get(), artist2.get(), TrackArtistLinkType::Artist);
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		const auto releaseCounts {Artist::getReleaseCounts(session, {artist1.getId(), artist2.getId(), artist3.getId()})};
+		EXPECT_EQ(releaseCounts.size(), 2);
+		EXPECT_EQ(releaseCounts.at(artist1.getId()), 2);
+		EXPECT_EQ(releaseCounts.at(artist2.getId()), 1);
+		EXPECT_EQ(releaseCounts.count(artist3.getId()), 0);
+
+		EXPECT_TRUE(Artist::getReleaseCounts(session, {}).empty());
+	}
+}
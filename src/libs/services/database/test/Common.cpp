@@ -96,6 +96,7 @@ DatabaseFixture::testDatabaseEmpty()
 	EXPECT_EQ(StarredArtist::getCount(session), 0);
 	EXPECT_EQ(StarredRelease::getCount(session), 0);
 	EXPECT_EQ(StarredTrack::getCount(session), 0);
+	EXPECT_EQ(TagCacheEntry::getCount(session), 0);
 	EXPECT_EQ(Track::getCount(session), 0);
 	EXPECT_EQ(TrackBookmark::getCount(session), 0);
 	EXPECT_EQ(TrackList::getCount(session), 0);
@@ -31,6 +31,7 @@
 #include "services/database/Release.hpp"
 #include "services/database/ScanSettings.hpp"
 #include "services/database/Session.hpp"
+#include "services/database/TagCacheEntry.hpp"
 #include "services/database/Track.hpp"
 #include "services/database/TrackArtistLink.hpp"
 #include "services/database/TrackBookmark.hpp"
@@ -102,6 +103,7 @@ using ScopedArtist = ScopedEntity<Database::Artist>;
 using ScopedCluster = ScopedEntity<Database::Cluster>;
 using ScopedClusterType = ScopedEntity<Database::ClusterType>;
 using ScopedRelease = ScopedEntity<Database::Release>;
+using ScopedTagCacheEntry = ScopedEntity<Database::TagCacheEntry>;
 using ScopedTrack = ScopedEntity<Database::Track>;
 using ScopedTrackList = ScopedEntity<Database::TrackList>;
 using ScopedUser = ScopedEntity<Database::User>;
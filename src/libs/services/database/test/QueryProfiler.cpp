@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <list>
+
+#include "services/database/QueryProfiler.hpp"
+#include "Common.hpp"
+
+using namespace Database;
+
+// Runs the hottest queries (lookups by id/name/path made for each request or scanned file) and reports their cost
+TEST_F(DatabaseFixture, QueryProfiler_hotQueries)
+{
+	constexpr std::size_t trackCount {100};
+	constexpr std::size_t iterationCount {10};
+
+	ScopedClusterType clusterType {session, "MyClusterType"};
+	ScopedCluster cluster {session, clusterType.lockAndGet(), "MyCluster"};
+	ScopedArtist artist {session, "MyArtist"};
+	ScopedRelease release {session, "MyRelease"};
+	ScopedUser user {session, "MyUser"};
+
+	std::list<ScopedTrack> tracks;
+	for (std::size_t i {}; i < trackCount; ++i)
+	{
+		tracks.emplace_back(session, "/tmp/MyTrack" + std::to_string(i));
+
+		auto transaction {session.createUniqueTransaction()};
+
+		TrackArtistLink::create(session, tracks.back().get(), artist.get(), TrackArtistLinkType::Artist);
+		tracks.back().get().modify()->setRelease(release.get());
+		cluster.get().modify()->addTrack(tracks.back().get());
+	}
+
+	QueryProfiler& profiler {session.getDb().getQueryProfiler()};
+	profiler.reset();
+
+	// first iteration prepares the statements, profiling the next ones
+	for (std::size_t i {}; i < iterationCount + 1; ++i)
+	{
+		if (i == 1)
+			profiler.setEnabled(true);
+
+		auto transaction {session.createSharedTransaction()};
+
+		for (std::size_t trackIndex {}; trackIndex < trackCount; ++trackIndex)
+		{
+			EXPECT_TRUE(Track::findByPath(session, "/tmp/MyTrack" + std::to_string(trackIndex)));
+		}
+
+		for (const ScopedTrack& track : tracks)
+		{
+			const Track::pointer dbTrack {Track::find(session, track.getId())};
+			ASSERT_TRUE(dbTrack);
+			EXPECT_EQ(dbTrack->getRelease()->getId(), release.getId());
+		}
+
+		EXPECT_TRUE(User::find(session, user.getId()));
+		EXPECT_TRUE(User::find(session, "MyUser"));
+		EXPECT_TRUE(ClusterType::find(session, "MyClusterType"));
+		EXPECT_TRUE(Cluster::find(session, cluster.getId()));
+		EXPECT_TRUE(Artist::find(session, artist.getId()));
+		EXPECT_TRUE(Release::find(session, release.getId()));
+		EXPECT_EQ(Track::find(session, Track::FindParameters {}.setRelease(release.getId())).results.size(), trackCount);
+		EXPECT_EQ(Release::find(session, Release::FindParameters {}.setArtist(artist.getId())).results.size(), 1);
+		EXPECT_EQ(Track::find(session, Track::FindParameters {}.setClusters({cluster.getId()})).results.size(), trackCount);
+	}
+
+	profiler.setEnabled(false);
+
+	const std::vector<QueryProfiler::QueryStats> topQueries {profiler.getTopQueries(10)};
+	ASSERT_FALSE(topQueries.empty());
+	EXPECT_LE(topQueries.size(), 10);
+
+	for (std::size_t i {}; i < topQueries.size(); ++i)
+	{
+		const QueryProfiler::QueryStats& stats {topQueries[i]};
+
+		EXPECT_GE(stats.executionCount, iterationCount) << stats.sql;
+		// fixed shape statements must come from the per connection statement cache
+		EXPECT_EQ(stats.prepareCount, 0) << stats.sql;
+
+		const std::vector<std::string> queryPlan {session.explainQueryPlan(stats.sql)};
+		EXPECT_FALSE(queryPlan.empty()) << stats.sql;
+
+		const auto averageDuration {stats.executionCount ? stats.totalDuration / stats.executionCount : std::chrono::microseconds {}};
+
+		std::string plan;
+		for (const std::string& step : queryPlan)
+		{
+			if (!plan.empty())
+				plan += "; ";
+			plan += step;
+		}
+
+		const std::string prefix {"query" + std::to_string(i) + "."};
+		RecordProperty(prefix + "sql", stats.sql);
+		RecordProperty(prefix + "executionCount", std::to_string(stats.executionCount));
+		RecordProperty(prefix + "totalDurationUs", std::to_string(stats.totalDuration.count()));
+		RecordProperty(prefix + "averageDurationUs", std::to_string(averageDuration.count()));
+		RecordProperty(prefix + "plan", plan);
+
+		std::cout << "#" << i << ": " << stats.executionCount << " executions, total = " << stats.totalDuration.count() << " us, average = " << averageDuration.count() << " us" << std::endl;
+		std::cout << "  SQL: " << stats.sql << std::endl;
+		for (const std::string& step : queryPlan)
+			std::cout << "  " << step << std::endl;
+	}
+}
+
+TEST_F(DatabaseFixture, QueryProfiler_disabled)
+{
+	QueryProfiler& profiler {session.getDb().getQueryProfiler()};
+	profiler.reset();
+	ASSERT_FALSE(profiler.isEnabled());
+
+	const std::size_t statementCount {profiler.getStatementCount()};
+	{
+		auto transaction {session.createSharedTransaction()};
+		EXPECT_FALSE(Track::findByPath(session, "/tmp/MyUnprofiledTrack"));
+		EXPECT_EQ(Track::find(session, Track::FindParameters {}.setName("MyUnprofiledTrack")).results.size(), 0);
+	}
+
+	EXPECT_EQ(profiler.getStatementCount(), statementCount);
+	EXPECT_TRUE(profiler.getTopQueries(10).empty());
+}
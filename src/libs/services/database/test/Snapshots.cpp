@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+#include <algorithm>
+#include <set>
+
+using namespace Database;
+
+TEST_F(DatabaseFixture, Snapshots_users)
+{
+	{
+		auto users {session.getUserSettingsSnapshot()};
+		EXPECT_TRUE(users->users.empty());
+	}
+
+	ScopedUser user {session, "MyUser"};
+	{
+		auto users {session.getUserSettingsSnapshot()};
+		const UserSettings* settings {users->find(user.getId())};
+		ASSERT_NE(settings, nullptr);
+		EXPECT_EQ(settings->loginName, "MyUser");
+		EXPECT_EQ(settings->type, UserType::REGULAR);
+	}
+
+	auto oldUsers {session.getUserSettingsSnapshot()};
+	{
+		auto transaction {session.createUniqueTransaction()};
+		user.get().modify()->setType(UserType::ADMIN);
+	}
+
+	{
+		auto users {session.getUserSettingsSnapshot()};
+		const UserSettings* settings {users->find(user.getId())};
+		ASSERT_NE(settings, nullptr);
+		EXPECT_EQ(settings->type, UserType::ADMIN);
+
+		// previous snapshots remain valid and unchanged
+		EXPECT_EQ(oldUsers->find(user.getId())->type, UserType::REGULAR);
+	}
+
+	// no modification: same snapshot
+	EXPECT_EQ(session.getUserSettingsSnapshot(), session.getUserSettingsSnapshot());
+}
+
+TEST_F(DatabaseFixture, Snapshots_usersLogin)
+{
+	ScopedUser user {session, "MyUser"};
+
+	const auto users {session.getUserSettingsSnapshot()};
+	{
+		auto transaction {session.createUniqueTransaction()};
+		user.get().modify()->setLastLogin(Wt::WDateTime::currentDateTime());
+		user.get().modify()->setCurPlayingTrackPos(3);
+	}
+
+	// logins and play queue updates do not rebuild the snapshot
+	EXPECT_EQ(session.getUserSettingsSnapshot(), users);
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+		user.get().modify()->setSubsonicArtistListMode(SubsonicArtistListMode::TrackArtists);
+	}
+
+	const auto newUsers {session.getUserSettingsSnapshot()};
+	EXPECT_NE(newUsers, users);
+	EXPECT_EQ(newUsers->find(user.getId())->subsonicArtistListMode, SubsonicArtistListMode::TrackArtists);
+}
+
+TEST_F(DatabaseFixture, Snapshots_clusterTypes)
+{
+	EXPECT_FALSE(session.getClusterTypesSnapshot()->find("MyType").isValid());
+
+	{
+		ScopedClusterType clusterType {session, "MyType"};
+
+		const ClusterTypeId clusterTypeId {session.getClusterTypesSnapshot()->find("MyType")};
+		EXPECT_EQ(clusterTypeId, clusterType.getId());
+	}
+
+	EXPECT_FALSE(session.getClusterTypesSnapshot()->find("MyType").isValid());
+}
+
+TEST_F(DatabaseFixture, Snapshots_clusterTypesFromScanSettings)
+{
+	std::set<std::string> clusterTypeNames;
+	{
+		auto transaction {session.createSharedTransaction()};
+		for (const ClusterType::pointer& clusterType : ScanSettings::get(session)->getClusterTypes())
+			clusterTypeNames.insert(clusterType->getName());
+	}
+
+	{
+		std::set<std::string> newClusterTypeNames {clusterTypeNames};
+		newClusterTypeNames.insert("MyType");
+
+		auto transaction {session.createUniqueTransaction()};
+		ScanSettings::get(session).modify()->setClusterTypes(session, newClusterTypeNames);
+	}
+
+	const ClusterTypeId clusterTypeId {session.getClusterTypesSnapshot()->find("MyType")};
+	EXPECT_TRUE(clusterTypeId.isValid());
+	{
+		const auto scanSettings {session.getScanSettingsSnapshot()};
+		EXPECT_NE(std::find(std::cbegin(scanSettings->clusterTypes), std::cend(scanSettings->clusterTypes), clusterTypeId), std::cend(scanSettings->clusterTypes));
+	}
+
+	// removed cluster type must no longer be served
+	{
+		auto transaction {session.createUniqueTransaction()};
+		ScanSettings::get(session).modify()->setClusterTypes(session, clusterTypeNames);
+	}
+
+	EXPECT_FALSE(session.getClusterTypesSnapshot()->find("MyType").isValid());
+	{
+		const auto scanSettings {session.getScanSettingsSnapshot()};
+		EXPECT_EQ(std::find(std::cbegin(scanSettings->clusterTypes), std::cend(scanSettings->clusterTypes), clusterTypeId), std::cend(scanSettings->clusterTypes));
+	}
+}
+
+TEST_F(DatabaseFixture, Snapshots_scanSettings)
+{
+	const std::size_t generation {session.getScanSettingsSnapshot()->libraryGeneration};
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+		ScanSettings::get(session).modify()->incLibraryGeneration();
+	}
+
+	EXPECT_EQ(session.getScanSettingsSnapshot()->libraryGeneration, generation + 1);
+}
@@ -17,6 +17,8 @@
  * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <list>
+
 #include "Common.hpp"
 #include "services/database/StarredArtist.hpp"
 
@@ -125,3 +127,36 @@ TEST_F(DatabaseFixture, StarredArtist_dateTime)
 		EXPECT_EQ(artists.results[1], starredArtist1->getArtist()->getId());
 	}
 }
+
+TEST_F(DatabaseFixture, StarredArtist_findStarredArtists)
+{
+	ScopedUser user {session, "MyUser"};
+
+	// more artists than the size of a query chunk
+	std::list<ScopedArtist> artists;
+	for (std::size_t i {}; i < 100; ++i)
+		artists.emplace_back(session, "MyArtist" + std::to_string(i));
+
+	std::list<ScopedStarredArtist> starredArtists;
+	std::vector<ArtistId> artistIds;
+	std::size_t i {};
+	for (ScopedArtist& artist : artists)
+	{
+		artistIds.push_back(artist.getId());
+		if (i++ % 3 == 0)
+			starredArtists.emplace_back(session, artist.lockAndGet(), user.lockAndGet(), Scrobbler::Internal);
+	}
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+		starredArtists.front().get().modify()->setScrobblingState(ScrobblingState::PendingRemove);
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		const std::vector<ArtistId> starred {StarredArtist::findStarredArtists(session, artistIds, user.getId(), Scrobbler::Internal)};
+		EXPECT_EQ(starred.size(), starredArtists.size() - 1);
+		EXPECT_TRUE(StarredArtist::findStarredArtists(session, artistIds, user.getId(), Scrobbler::ListenBrainz).empty());
+	}
+}
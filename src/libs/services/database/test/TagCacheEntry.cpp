@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.hpp"
+
+using namespace Database;
+
+TEST_F(DatabaseFixture, TagCacheEntry)
+{
+	const std::filesystem::path path {"/tmp/MyTrack.mp3"};
+	const Wt::WDateTime lastWriteTime {Wt::WDate {2022, 1, 2}, Wt::WTime {3, 4, 5}};
+
+	{
+		auto transaction {session.createSharedTransaction()};
+		EXPECT_FALSE(TagCacheEntry::find(session, path));
+	}
+
+	ScopedTagCacheEntry entry {session, path};
+	{
+		auto transaction {session.createUniqueTransaction()};
+
+		EXPECT_EQ(TagCacheEntry::getCount(session), 1);
+
+		TagCacheEntry::pointer dbEntry {TagCacheEntry::find(session, path)};
+		ASSERT_TRUE(dbEntry);
+		EXPECT_EQ(dbEntry->getId(), entry.getId());
+		EXPECT_EQ(dbEntry->getPath(), path);
+
+		dbEntry.modify()->setData(1024, lastWriteTime, {1, 2, 3});
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		TagCacheEntry::pointer dbEntry {TagCacheEntry::find(session, path)};
+		ASSERT_TRUE(dbEntry);
+		EXPECT_TRUE(dbEntry->matches(1024, lastWriteTime));
+		EXPECT_FALSE(dbEntry->matches(1025, lastWriteTime));
+		EXPECT_FALSE(dbEntry->matches(1024, lastWriteTime.addSecs(1)));
+		EXPECT_EQ(dbEntry->getData(), (std::vector<unsigned char> {1, 2, 3}));
+	}
+}
+
+TEST_F(DatabaseFixture, TagCacheEntry_orphans)
+{
+	const std::filesystem::path path {"/tmp/MyTrack.mp3"};
+
+	ScopedTagCacheEntry entry {session, path};
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		const auto orphans {TagCacheEntry::findOrphans(session, Range {})};
+		ASSERT_EQ(orphans.results.size(), 1);
+		EXPECT_EQ(orphans.results.front(), entry.getId());
+	}
+
+	{
+		ScopedTrack track {session, path};
+
+		auto transaction {session.createSharedTransaction()};
+		EXPECT_TRUE(TagCacheEntry::findOrphans(session, Range {}).results.empty());
+	}
+}
@@ -20,6 +20,7 @@
 #include "Common.hpp"
 
 #include <algorithm>
+#include <list>
 
 using namespace Database;
 
@@ -60,6 +61,30 @@ TEST_F(DatabaseFixture, MultipleTracks)
 	}
 }
 
+TEST_F(DatabaseFixture, MultipleTracks_seededRandom)
+{
+	std::list<ScopedTrack> tracks;
+	for (std::size_t i {}; i < 10; ++i)
+		tracks.emplace_back(session, "MyTrackFile" + std::to_string(i));
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		const auto allTracks {Track::find(session, Track::FindParameters {}.setSortMethod(TrackSortMethod::Random).setRandomSeed(42))};
+		ASSERT_EQ(allTracks.results.size(), tracks.size());
+		for (const ScopedTrack& track : tracks)
+			EXPECT_NE(std::find(std::cbegin(allTracks.results), std::cend(allTracks.results), track.getId()), std::cend(allTracks.results));
+
+		// pages are consistent for a given seed
+		const auto firstPage {Track::find(session, Track::FindParameters {}.setSortMethod(TrackSortMethod::Random).setRandomSeed(42).setRange({0, 5}))};
+		const auto secondPage {Track::find(session, Track::FindParameters {}.setSortMethod(TrackSortMethod::Random).setRandomSeed(42).setRange({5, 5}))};
+		ASSERT_EQ(firstPage.results.size(), 5);
+		ASSERT_EQ(secondPage.results.size(), 5);
+		EXPECT_TRUE(std::equal(std::cbegin(firstPage.results), std::cend(firstPage.results), std::cbegin(allTracks.results)));
+		EXPECT_TRUE(std::equal(std::cbegin(secondPage.results), std::cend(secondPage.results), std::cbegin(allTracks.results) + 5));
+	}
+}
+
 TEST_F(DatabaseFixture, MultipleTracksSearchByFilter)
 {
 	ScopedTrack track1 {session, ""};
@@ -159,3 +184,139 @@ TEST_F(DatabaseFixture, Track_writtenAfter)
 	}
 }
 
+
+TEST_F(DatabaseFixture, Track_coverSource)
+{
+	ScopedTrack track {session, "MyTrack"};
+
+	{
+		auto transaction {session.createSharedTransaction()};
+		EXPECT_EQ(track->getCoverSource().type, CoverSourceType::Unknown);
+
+		const auto tracks {Track::findWithCoverSourceType(session, CoverSourceType::Unknown, Range {})};
+		ASSERT_EQ(tracks.results.size(), 1);
+		EXPECT_EQ(tracks.results.front(), track.getId());
+	}
+
+	const CoverSource coverSource {CoverSourceType::Embedded, "/foo/bar.mp3", 2, 123456, Wt::WDateTime {Wt::WDate {1950, 1, 1}, Wt::WTime {12, 30, 20}}};
+	{
+		auto transaction {session.createUniqueTransaction()};
+		track.get().modify()->setCoverSource(coverSource);
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+		EXPECT_EQ(track->getCoverSource(), coverSource);
+		EXPECT_EQ(Track::findWithCoverSourceType(session, CoverSourceType::Unknown, Range {}).results.size(), 0);
+		EXPECT_EQ(Track::findWithCoverSourceType(session, CoverSourceType::Embedded, Range {}).results.size(), 1);
+	}
+}
+
+TEST_F(DatabaseFixture, Track_findMatchingInfos)
+{
+	ScopedTrack track1 {session, "MyTrack1"};
+	ScopedTrack track2 {session, "MyTrack2"};
+	ScopedRelease release {session, "MyRelease"};
+	ScopedArtist artist1 {session, "MyArtist1"};
+	ScopedArtist artist2 {session, "MyArtist2"};
+	const UUID recordingMBID {*UUID::fromString("3fa2b5ec-2b4d-4b1c-9a36-b8c2a9f3c7a1")};
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+
+		track1.get().modify()->setRelease(release.get());
+		track1.get().modify()->setTrackNumber(3);
+		track1.get().modify()->setRecordingMBID(recordingMBID);
+		TrackArtistLink::create(session, track1.get(), artist1.get(), TrackArtistLinkType::Artist);
+		TrackArtistLink::create(session, track1.get(), artist2.get(), TrackArtistLinkType::ReleaseArtist);
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		const auto infos {Track::findMatchingInfos(session, Range {})};
+		ASSERT_EQ(infos.results.size(), 3);
+
+		EXPECT_EQ(infos.results[0].trackId, track1.getId());
+		EXPECT_EQ(infos.results[0].recordingMBID, recordingMBID.getAsString());
+		EXPECT_EQ(infos.results[0].name, "MyTrack1");
+		EXPECT_EQ(infos.results[0].trackNumber, 3);
+		EXPECT_EQ(infos.results[0].releaseName, "MyRelease");
+		EXPECT_EQ(infos.results[0].artistName, "MyArtist1");
+		EXPECT_EQ(infos.results[1].trackId, track1.getId());
+		EXPECT_EQ(infos.results[1].artistName, "MyArtist2");
+
+		EXPECT_EQ(infos.results[2].trackId, track2.getId());
+		EXPECT_EQ(infos.results[2].recordingMBID, "");
+		EXPECT_EQ(infos.results[2].name, "MyTrack2");
+		EXPECT_EQ(infos.results[2].trackNumber, 0);
+		EXPECT_EQ(infos.results[2].releaseName, "");
+		EXPECT_EQ(infos.results[2].artistName, "");
+	}
+}
+
+TEST_F(DatabaseFixture, Track_findLinksByBatch)
+{
+	ScopedTrack track1 {session, "MyTrack1"};
+	ScopedTrack track2 {session, "MyTrack2"};
+	ScopedArtist artist1 {session, "MyArtist1"};
+	ScopedArtist artist2 {session, "MyArtist2"};
+	ScopedClusterType clusterType {session, "MyClusterType"};
+	ScopedCluster cluster1 {session, clusterType.lockAndGet(), "MyCluster1"};
+	ScopedCluster cluster2 {session, clusterType.lockAndGet(), "MyCluster2"};
+	ScopedCluster cluster3 {session, clusterType.lockAndGet(), "MyCluster3"};
+
+	{
+		auto transaction {session.createUniqueTransaction()};
+
+		for (ScopedTrack* track : {&track1, &track2})
+		{
+			cluster1.get().modify()->addTrack(track->get());
+			cluster2.get().modify()->addTrack(track->get());
+			cluster3.get().modify()->addTrack(track->get());
+
+			TrackArtistLink::create(session, track->get(), artist1.get(), TrackArtistLinkType::Artist);
+			TrackArtistLink::create(session, track->get(), artist2.get(), TrackArtistLinkType::Artist);
+			TrackArtistLink::create(session, track->get(), artist1.get(), TrackArtistLinkType::Composer);
+		}
+	}
+
+	// one link per batch: each link must be returned exactly once
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		std::vector<std::pair<TrackId, ClusterId>> clusterLinks;
+		for (std::size_t offset {};; ++offset)
+		{
+			const auto links {Track::findClusterLinks(session, Range {offset, 1})};
+			for (const Track::ClusterLinkResult& link : links.results)
+				clusterLinks.emplace_back(link.trackId, link.clusterId);
+
+			if (!links.moreResults)
+				break;
+		}
+
+		ASSERT_EQ(clusterLinks.size(), 6);
+		EXPECT_TRUE(std::is_sorted(std::cbegin(clusterLinks), std::cend(clusterLinks)));
+		EXPECT_EQ(std::adjacent_find(std::cbegin(clusterLinks), std::cend(clusterLinks)), std::cend(clusterLinks));
+	}
+
+	{
+		auto transaction {session.createSharedTransaction()};
+
+		std::vector<std::tuple<TrackId, ArtistId, TrackArtistLinkType>> artistLinks;
+		for (std::size_t offset {};; ++offset)
+		{
+			const auto links {Track::findArtistLinks(session, Range {offset, 1})};
+			for (const Track::ArtistLinkResult& link : links.results)
+				artistLinks.emplace_back(link.trackId, link.artistId, link.type);
+
+			if (!links.moreResults)
+				break;
+		}
+
+		ASSERT_EQ(artistLinks.size(), 6);
+		std::sort(std::begin(artistLinks), std::end(artistLinks));
+		EXPECT_EQ(std::adjacent_find(std::cbegin(artistLinks), std::cend(artistLinks)), std::cend(artistLinks));
+	}
+}
@@ -19,7 +19,10 @@
 
 #include "PlaylistGeneratorService.hpp"
 
+#include <limits>
+
 #include "services/database/Db.hpp"
+#include "services/database/ScanSettings.hpp"
 #include "services/database/Session.hpp"
 #include "services/database/Track.hpp"
 #include "services/recommendation/IRecommendationService.hpp"
@@ -42,9 +45,6 @@ namespace Recommendation
 		: _db {db}
 	, _recommendationService {recommendationService}
 	{
-		_constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveArtists>(_db));
-		_constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveReleases>(_db));
-		_constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::DuplicateTracks>());
 	}
 
 	std::vector<TrackId>
@@ -57,8 +57,22 @@ namespace Recommendation
 
 		const std::vector<TrackId> startingTracks {getTracksFromTrackList(tracklistId)};
 
-		std::vector<TrackId> finalResult = startingTracks;
-		finalResult.reserve(startingTracks.size() + maxCount);
+		const std::shared_ptr<const PlaylistGeneratorConstraint::TrackMetadataTable> trackMetadataTable {getTrackMetadataTable()};
+
+		// constraints keep track of the last added tracks
+		std::vector<std::unique_ptr<PlaylistGeneratorConstraint::IConstraint>> constraints;
+		constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveArtists>(*trackMetadataTable));
+		constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveReleases>(*trackMetadataTable));
+		constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::DuplicateTracks>());
+
+		for (const TrackId trackId : startingTracks)
+		{
+			for (const auto& constraint : constraints)
+				constraint->onTrackAdded(trackId);
+		}
+
+		std::vector<TrackId> result;
+		result.reserve(maxCount);
 
 		std::vector<float> scores;
 		for (std::size_t i {}; i < maxCount; ++i)
@@ -66,20 +80,14 @@ namespace Recommendation
 			if (similarTracks.empty())
 				break;
 
-			scores.resize(similarTracks.size(), {});
+			scores.assign(similarTracks.size(), std::numeric_limits<float>::max());
 
 			// select the similar track that has the best score
 			for (std::size_t trackIndex {}; trackIndex < similarTracks.size(); ++trackIndex)
 			{
-				using namespace Database::Debug;
-
-				finalResult.push_back(similarTracks[trackIndex]);
-
 				scores[trackIndex] = 0;
-				for (const auto& constraint : _constraints)
-					scores[trackIndex] += constraint->computeScore(finalResult, finalResult.size() - 1);
-
-				finalResult.pop_back();
+				for (const auto& constraint : constraints)
+					scores[trackIndex] += constraint->computeScore(similarTracks[trackIndex]);
 
 				// early exit if we consider we found a track with no constraint violation (since similarTracks sorted from most to least similar)
 				if (scores[trackIndex] < 0.01)
@@ -89,12 +97,15 @@ namespace Recommendation
 			// get the best score
 			const std::size_t bestScoreIndex {static_cast<std::size_t>(std::distance(std::cbegin(scores), std::min_element(std::cbegin(scores), std::cend(scores))))};
 
-			finalResult.push_back(similarTracks[bestScoreIndex]);
+			const TrackId bestTrackId {similarTracks[bestScoreIndex]};
+			for (const auto& constraint : constraints)
+				constraint->onTrackAdded(bestTrackId);
+
+			result.push_back(bestTrackId);
 			similarTracks.erase(std::begin(similarTracks) + bestScoreIndex);
 		}
 
-		// for now, just get some more similar tracks
-		return std::vector(std::cbegin(finalResult) + startingTracks.size(), std::cend(finalResult));
+		return result;
 	}
 
 	TrackContainer
@@ -115,4 +126,23 @@ namespace Recommendation
 
 		return tracks;
 	}
+
+	std::shared_ptr<const PlaylistGeneratorConstraint::TrackMetadataTable>
+	PlaylistGeneratorService::getTrackMetadataTable() const
+	{
+		Session& dbSession {_db.getTLSSession()};
+
+		const std::size_t generation {dbSession.getScanSettingsSnapshot()->libraryGeneration};
+
+		std::scoped_lock lock {_trackMetadataTableMutex};
+
+		if (!_trackMetadataTable || _trackMetadataTableGeneration != generation)
+		{
+			LMS_LOG(RECOMMENDATION, DEBUG) << "Loading track metadata table (library generation = " << generation << ")";
+			_trackMetadataTable = std::make_shared<PlaylistGeneratorConstraint::TrackMetadataTable>(dbSession);
+			_trackMetadataTableGeneration = generation;
+		}
+
+		return _trackMetadataTable;
+	}
 }
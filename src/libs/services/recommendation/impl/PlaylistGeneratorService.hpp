@@ -19,9 +19,13 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+
 #include "services/recommendation/IPlaylistGeneratorService.hpp"
 #include "services/recommendation/IRecommendationService.hpp"
 #include "playlist-constraints/IConstraint.hpp"
+#include "playlist-constraints/TrackMetadataTable.hpp"
 
 namespace Recommendation
 {
@@ -34,9 +38,14 @@ namespace Recommendation
 			TrackContainer extendPlaylist(Database::TrackListId tracklistId, std::size_t maxCount) const override;
 
 			TrackContainer getTracksFromTrackList(Database::TrackListId tracklistId) const;
+			std::shared_ptr<const PlaylistGeneratorConstraint::TrackMetadataTable> getTrackMetadataTable() const;
 
 			Database::Db& _db;
 			Recommendation::IRecommendationService& _recommendationService;
-			std::vector<std::unique_ptr<PlaylistGeneratorConstraint::IConstraint>> _constraints;
+
+			// reloaded each time the library generation changes (set by the scanner)
+			mutable std::mutex _trackMetadataTableMutex;
+			mutable std::shared_ptr<const PlaylistGeneratorConstraint::TrackMetadataTable> _trackMetadataTable;
+			mutable std::size_t _trackMetadataTableGeneration {};
 	};
 } // namespace Radio
@@ -158,9 +158,7 @@ namespace Recommendation
 	Database::ScanSettings::RecommendationEngineType
 	getRecommendationEngineType(Database::Session& session)
 	{
-		auto transaction {session.createSharedTransaction()};
-
-		return Database::ScanSettings::get(session)->getRecommendationEngineType();
+		return session.getScanSettingsSnapshot()->recommendationEngineType;
 	}
 
 	void
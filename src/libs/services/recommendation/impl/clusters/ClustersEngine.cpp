@@ -19,32 +19,213 @@
 
 #include "ClustersEngine.hpp"
 
-#include "services/database/Artist.hpp"
-#include "services/database/Cluster.hpp"
+#include <algorithm>
+#include <tuple>
+
 #include "services/database/Db.hpp"
-#include "services/database/Release.hpp"
 #include "services/database/Session.hpp"
 #include "services/database/Track.hpp"
 #include "services/database/TrackList.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Random.hpp"
 
 namespace Recommendation {
 
 using namespace Database;
 
+namespace
+{
+	constexpr std::size_t loadBatchSize {50000};
+
+	template <typename IdType>
+	std::vector<ClusterId>
+	getClusters(const std::vector<IdType>& ids, const std::unordered_map<IdType, std::vector<ClusterId>>& objectClusters)
+	{
+		std::vector<ClusterId> res;
+
+		for (const IdType id : ids)
+		{
+			auto itClusters {objectClusters.find(id)};
+			if (itClusters != std::cend(objectClusters))
+				res.insert(std::end(res), std::cbegin(itClusters->second), std::cend(itClusters->second));
+		}
+
+		std::sort(std::begin(res), std::end(res));
+		res.erase(std::unique(std::begin(res), std::end(res)), std::end(res));
+
+		return res;
+	}
+
+	// ordered by score, ties are randomly ordered
+	template <typename IdType>
+	std::vector<IdType>
+	getBestScoredObjects(const std::unordered_map<IdType, std::size_t>& scores, std::size_t maxCount)
+	{
+		std::vector<std::pair<IdType, std::size_t>> sortedScores(std::cbegin(scores), std::cend(scores));
+		Random::shuffleContainer(sortedScores);
+
+		const std::size_t count {std::min(maxCount, sortedScores.size())};
+		std::partial_sort(std::begin(sortedScores), std::begin(sortedScores) + count, std::end(sortedScores),
+				[](const auto& score1, const auto& score2) { return score1.second > score2.second; });
+
+		std::vector<IdType> res;
+		res.reserve(count);
+		std::transform(std::cbegin(sortedScores), std::cbegin(sortedScores) + count, std::back_inserter(res), [](const auto& score) { return score.first; });
+
+		return res;
+	}
+
+	// merge postings that refer to the same object
+	template <typename PostingType, typename Equal>
+	void
+	mergePostings(std::vector<PostingType>& postings, Equal equal)
+	{
+		auto itOut {std::begin(postings)};
+		for (auto it {std::begin(postings)}; it != std::end(postings); ++it)
+		{
+			if (itOut != std::begin(postings) && equal(*std::prev(itOut), *it))
+				std::prev(itOut)->matchCount += it->matchCount;
+			else
+				*itOut++ = *it;
+		}
+
+		postings.erase(itOut, std::end(postings));
+		postings.shrink_to_fit();
+	}
+}
+
 std::unique_ptr<IEngine> createClustersEngine(Db& db)
 {
 	return std::make_unique<ClusterEngine>(db);
 }
 
+void
+ClusterEngine::load(bool, const ProgressCallback&)
+{
+	LMS_LOG(RECOMMENDATION, DEBUG) << "Building cluster index...";
+
+	loadTrackClusters();
+	if (_loadCancelled)
+		return;
+
+	loadArtistClusters();
+	if (_loadCancelled)
+		return;
+
+	LMS_LOG(RECOMMENDATION, DEBUG) << "Cluster index built: " << _clusterTracks.size() << " clusters, "
+		<< _trackClusters.size() << " tracks, " << _releaseClusters.size() << " releases, " << _artistClusters.size() << " artists";
+}
+
+void
+ClusterEngine::requestCancelLoad()
+{
+	LMS_LOG(RECOMMENDATION, DEBUG) << "Requesting init cancellation";
+	_loadCancelled = true;
+}
+
+void
+ClusterEngine::loadTrackClusters()
+{
+	Session& session {_db.getTLSSession()};
+
+	for (std::size_t offset {};; offset += loadBatchSize)
+	{
+		if (_loadCancelled)
+			return;
+
+		RangeResults<Track::ClusterLinkResult> results;
+		{
+			auto transaction {session.createSharedTransaction()};
+			results = Track::findClusterLinks(session, Range {offset, loadBatchSize});
+		}
+
+		for (const Track::ClusterLinkResult& result : results.results)
+		{
+			_trackClusters[result.trackId].push_back(result.clusterId);
+			_clusterTracks[result.clusterId].push_back(result.trackId);
+			if (result.releaseId.isValid())
+				_clusterReleases[result.clusterId].push_back({result.releaseId, 1});
+		}
+
+		if (!results.moreResults)
+			break;
+	}
+
+	for (auto& [clusterId, postings] : _clusterReleases)
+	{
+		std::sort(std::begin(postings), std::end(postings), [](const auto& posting1, const auto& posting2) { return posting1.id < posting2.id; });
+		mergePostings(postings, [](const auto& posting1, const auto& posting2) { return posting1.id == posting2.id; });
+
+		for (const auto& posting : postings)
+			_releaseClusters[posting.id].push_back(clusterId);
+	}
+}
+
+void
+ClusterEngine::loadArtistClusters()
+{
+	Session& session {_db.getTLSSession()};
+
+	for (std::size_t offset {};; offset += loadBatchSize)
+	{
+		if (_loadCancelled)
+			return;
+
+		RangeResults<Track::ArtistLinkResult> results;
+		{
+			auto transaction {session.createSharedTransaction()};
+			results = Track::findArtistLinks(session, Range {offset, loadBatchSize});
+		}
+
+		for (const Track::ArtistLinkResult& result : results.results)
+		{
+			auto itClusters {_trackClusters.find(result.trackId)};
+			if (itClusters == std::cend(_trackClusters))
+				continue;
+
+			for (const ClusterId clusterId : itClusters->second)
+				_clusterArtists[clusterId].push_back({result.artistId, result.type, 1});
+		}
+
+		if (!results.moreResults)
+			break;
+	}
+
+	for (auto& [clusterId, postings] : _clusterArtists)
+	{
+		std::sort(std::begin(postings), std::end(postings), [](const auto& posting1, const auto& posting2)
+		{
+			return std::tie(posting1.id, posting1.linkType) < std::tie(posting2.id, posting2.linkType);
+		});
+		mergePostings(postings, [](const auto& posting1, const auto& posting2) { return posting1.id == posting2.id && posting1.linkType == posting2.linkType; });
+
+		for (const auto& posting : postings)
+		{
+			std::vector<ClusterId>& clusters {_artistClusters[posting.id]};
+			if (clusters.empty() || clusters.back() != clusterId)
+				clusters.push_back(clusterId);
+		}
+	}
+}
+
 TrackContainer
 ClusterEngine::findSimilarTracks(const std::vector<TrackId>& trackIds, std::size_t maxCount) const
 {
-	Session& dbSession {_db.getTLSSession()};
+	std::unordered_map<TrackId, std::size_t> scores;
+	for (const ClusterId clusterId : getClusters(trackIds, _trackClusters))
+	{
+		auto itTracks {_clusterTracks.find(clusterId)};
+		if (itTracks == std::cend(_clusterTracks))
+			continue;
+
+		for (const TrackId trackId : itTracks->second)
+			scores[trackId]++;
+	}
 
-	auto transaction {dbSession.createSharedTransaction()};
+	for (const TrackId trackId : trackIds)
+		scores.erase(trackId);
 
-	const auto similarTrackIds {Track::findSimilarTracks(dbSession, trackIds, Range {0, maxCount})};
-	return std::move(similarTrackIds.results);
+	return getBestScoredObjects(scores, maxCount);
 }
 
 TrackContainer
@@ -52,57 +233,59 @@ ClusterEngine::findSimilarTracksFromTrackList(TrackListId tracklistId, std::size
 {
 	Session& dbSession {_db.getTLSSession()};
 
-	TrackContainer res;
-
+	std::vector<TrackId> trackIds;
 	{
 		auto transaction {dbSession.createSharedTransaction()};
 
 		const TrackList::pointer trackList {TrackList::find(dbSession, tracklistId)};
 		if (!trackList)
-			return res;
+			return {};
 
-		const auto tracks {trackList->getSimilarTracks(0, maxCount)};
-		res.reserve(tracks.size());
-		std::transform(std::cbegin(tracks), std::cend(tracks), std::back_inserter(res), [](const auto& track) { return track->getId(); });
+		trackIds = trackList->getTrackIds();
 	}
 
-	return res;
+	return findSimilarTracks(trackIds, maxCount);
 }
 
 ReleaseContainer
 ClusterEngine::getSimilarReleases(ReleaseId releaseId, std::size_t maxCount) const
 {
-	Session& dbSession {_db.getTLSSession()};
-
-	ReleaseContainer res;
+	std::unordered_map<ReleaseId, std::size_t> scores;
+	for (const ClusterId clusterId : getClusters(std::vector<ReleaseId> {releaseId}, _releaseClusters))
 	{
-		auto transaction {dbSession.createSharedTransaction()};
-
-		auto release {Release::find(dbSession, releaseId)};
-		if (!release)
-			return res;
+		auto itReleases {_clusterReleases.find(clusterId)};
+		if (itReleases == std::cend(_clusterReleases))
+			continue;
 
-		const auto releases {release->getSimilarReleases(0, maxCount)};
-		res.reserve(releases.size());
-		std::transform(std::cbegin(releases), std::cend(releases), std::back_inserter(res), [](const auto& release) { return release->getId(); });
+		for (const Posting<ReleaseId>& posting : itReleases->second)
+			scores[posting.id] += posting.matchCount;
 	}
 
-	return res;
+	scores.erase(releaseId);
+
+	return getBestScoredObjects(scores, maxCount);
 }
 
 ArtistContainer
-ClusterEngine::getSimilarArtists(ArtistId artistId, EnumSet<TrackArtistLinkType> artistLinkTypes, std::size_t maxCount) const
+ClusterEngine::getSimilarArtists(ArtistId artistId, EnumSet<TrackArtistLinkType> linkTypes, std::size_t maxCount) const
 {
-	Session& dbSession {_db.getTLSSession()};
+	std::unordered_map<ArtistId, std::size_t> scores;
+	for (const ClusterId clusterId : getClusters(std::vector<ArtistId> {artistId}, _artistClusters))
+	{
+		auto itArtists {_clusterArtists.find(clusterId)};
+		if (itArtists == std::cend(_clusterArtists))
+			continue;
 
-	auto transaction {dbSession.createSharedTransaction()};
+		for (const ArtistPosting& posting : itArtists->second)
+		{
+			if (linkTypes.empty() || linkTypes.contains(posting.linkType))
+				scores[posting.id] += posting.matchCount;
+		}
+	}
 
-	auto artist {Artist::find(dbSession, artistId)};
-	if (!artist)
-		return {};
+	scores.erase(artistId);
 
-	const auto similarArtistIds {artist->findSimilarArtists(artistLinkTypes, Range {0, maxCount})};
-	return std::move(similarArtistIds.results);
+	return getBestScoredObjects(scores, maxCount);
 }
 
 } // namespace Recommendation
@@ -19,11 +19,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "services/database/ClusterId.hpp"
 #include "IEngine.hpp"
 
 namespace Recommendation
 {
 
+	// Answers queries using an in-memory index built at load time:
+	// for each cluster, the posting list of the tracks, releases and artists that are tagged with it,
+	// and for each object, the clusters it is tagged with.
+	// Objects are scored by the number of tag matches they share with the query objects
 	class ClusterEngine : public IEngine
 	{
 		public:
@@ -35,16 +45,45 @@ namespace Recommendation
 			ClusterEngine& operator=(ClusterEngine&&) = delete;
 
 		private:
-			void load(bool, const ProgressCallback&) override {}
-			void requestCancelLoad() override {}
+			void load(bool forceReload, const ProgressCallback& progressCallback) override;
+			void requestCancelLoad() override;
 
 			TrackContainer		findSimilarTracksFromTrackList(Database::TrackListId tracklistId, std::size_t maxCount) const override;
 			TrackContainer		findSimilarTracks(const std::vector<Database::TrackId>& tracksId, std::size_t maxCount) const override;
 			ReleaseContainer	getSimilarReleases(Database::ReleaseId releaseId, std::size_t maxCount) const override;
 			ArtistContainer		getSimilarArtists(Database::ArtistId artistId, EnumSet<Database::TrackArtistLinkType> linkTypes, std::size_t maxCount) const override;
 
-			Database::Db& _db;
+			void loadTrackClusters();
+			void loadArtistClusters();
+
+			template <typename IdType>
+			struct Posting
+			{
+				IdType			id;
+				std::uint32_t	matchCount {}; // number of tracks of the object that are tagged with the cluster
+			};
+
+			struct ArtistPosting
+			{
+				Database::ArtistId				id;
+				Database::TrackArtistLinkType	linkType;
+				std::uint32_t					matchCount {};
+			};
+
+			template <typename IdType>
+			using ObjectClusters = std::unordered_map<IdType, std::vector<Database::ClusterId>>;
+			template <typename PostingType>
+			using ClusterPostings = std::unordered_map<Database::ClusterId, std::vector<PostingType>>;
+
+			Database::Db&		_db;
+			std::atomic<bool>	_loadCancelled {};
+
+			ObjectClusters<Database::TrackId>				_trackClusters;
+			ClusterPostings<Database::TrackId>				_clusterTracks;
+			ObjectClusters<Database::ReleaseId>				_releaseClusters;
+			ClusterPostings<Posting<Database::ReleaseId>>	_clusterReleases;
+			ObjectClusters<Database::ArtistId>				_artistClusters;
+			ClusterPostings<ArtistPosting>					_clusterArtists;
 	};
 
 } // namespace Recommendation
-
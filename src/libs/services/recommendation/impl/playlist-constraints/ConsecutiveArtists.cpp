@@ -21,77 +21,56 @@
 
 #include <algorithm>
 
-#include "services/database/Db.hpp"
-#include "services/database/Release.hpp"
-#include "services/database/Session.hpp"
-#include "services/database/Track.hpp"
-#include "utils/Logger.hpp"
-
 namespace Recommendation::PlaylistGeneratorConstraint
 {
 	namespace
 	{
 		std::size_t
-		countCommonArtists(const ArtistContainer& artists1, const ArtistContainer& artists2)
+		countCommonArtists(const TrackMetadataTable::ArtistRange& artists1, const TrackMetadataTable::ArtistRange& artists2)
 		{
-			ArtistContainer intersection;
-
-			std::set_intersection(std::cbegin(artists1), std::cend(artists1),
-						std::cbegin(artists2), std::cend(artists2),
-						std::back_inserter(intersection));
-
-			return intersection.size();
+			// both ranges are sorted
+			std::size_t count {};
+
+			const Database::ArtistId* it1 {artists1.begin};
+			const Database::ArtistId* it2 {artists2.begin};
+			while (it1 != artists1.end && it2 != artists2.end)
+			{
+				if (*it1 < *it2)
+					++it1;
+				else if (*it2 < *it1)
+					++it2;
+				else
+				{
+					++count;
+					++it1;
+					++it2;
+				}
+			}
+
+			return count;
 		}
 	}
 
-	ConsecutiveArtists::ConsecutiveArtists(Database::Db& db)
-		: _db {db}
+	ConsecutiveArtists::ConsecutiveArtists(const TrackMetadataTable& trackMetadataTable)
+		: _trackMetadataTable {trackMetadataTable}
 	{}
 
-	float
-	ConsecutiveArtists::computeScore(const std::vector<Database::TrackId>& trackIds, std::size_t trackIndex)
+	void
+	ConsecutiveArtists::onTrackAdded(Database::TrackId trackId)
 	{
-		assert(!trackIds.empty());
-		assert(trackIndex <= trackIds.size() - 1);
-
-		const ArtistContainer artists {getArtists(trackIds[trackIndex])};
-
-		constexpr std::size_t rangeSize{ 3 }; // check up to rangeSize tracks before/after the target track
-		static_assert(rangeSize > 0);
-
-		float score {};
-		for (std::size_t i {1}; i < rangeSize; ++i)
-		{
-			if (trackIndex >= i)
-				score += countCommonArtists(artists, getArtists(trackIds[trackIndex - i])) / static_cast<float>(i);
-
-			if (trackIndex + i < trackIds.size())
-				score += countCommonArtists(artists, getArtists(trackIds[trackIndex + i])) / static_cast<float>(i);
-		}
-
-		return score;
+		std::rotate(std::begin(_lastTracksArtists), std::prev(std::end(_lastTracksArtists)), std::end(_lastTracksArtists));
+		_lastTracksArtists.front() = _trackMetadataTable.getArtistIds(trackId);
 	}
 
-	ArtistContainer
-	ConsecutiveArtists::getArtists(Database::TrackId trackId)
+	float
+	ConsecutiveArtists::computeScore(Database::TrackId trackId) const
 	{
-		using namespace Database;
-
-		ArtistContainer res;
-
-		Session& dbSession {_db.getTLSSession()};
-		auto transaction {dbSession.createSharedTransaction()};
-
-		const Track::pointer track {Track::find(dbSession, trackId)};
-		if (!track)
-			return res;
+		const TrackMetadataTable::ArtistRange artists {_trackMetadataTable.getArtistIds(trackId)};
 
-		res = track->getArtistIds({});
-		std::sort(std::begin(res), std::end(res));
+		float score {};
+		for (std::size_t i {}; i < _lastTracksArtists.size(); ++i)
+			score += countCommonArtists(artists, _lastTracksArtists[i]) / static_cast<float>(i + 1);
 
-		return res;
+		return score;
 	}
-
-
 } // namespace Recommendation
-
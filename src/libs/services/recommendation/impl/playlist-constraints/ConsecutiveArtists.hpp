@@ -19,27 +19,26 @@
 
 #pragma once
 
-#include "IConstraint.hpp"
-
-#include "services/database/ReleaseId.hpp"
+#include <array>
 
-namespace Database
-{
-	class Db;
-}
+#include "IConstraint.hpp"
+#include "TrackMetadataTable.hpp"
 
 namespace Recommendation::PlaylistGeneratorConstraint
 {
 	class ConsecutiveArtists : public IConstraint
 	{
 		public:
-			ConsecutiveArtists(Database::Db& db);
+			ConsecutiveArtists(const TrackMetadataTable& trackMetadataTable);
 
 		private:
-			 float computeScore(const TrackContainer& trackIds, std::size_t trackIndex) override;
-			 ArtistContainer getArtists(Database::TrackId trackId);
+			void onTrackAdded(Database::TrackId trackId) override;
+			float computeScore(Database::TrackId trackId) const override;
+
+			static constexpr std::size_t rangeSize {3}; // check up to rangeSize - 1 tracks before the candidate track
+			static_assert(rangeSize > 1);
 
-			 Database::Db& _db;
+			const TrackMetadataTable& _trackMetadataTable;
+			std::array<TrackMetadataTable::ArtistRange, rangeSize - 1> _lastTracksArtists {}; // most recent first
 	};
 } // namespace Recommendation::PlaylistGeneratorConstraint
-
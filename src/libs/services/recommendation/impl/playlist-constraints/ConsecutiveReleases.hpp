@@ -19,28 +19,27 @@
 
 #pragma once
 
-#include "IConstraint.hpp"
+#include <array>
 
 #include "services/database/ReleaseId.hpp"
-
-namespace Database
-{
-	class Db;
-}
+#include "IConstraint.hpp"
+#include "TrackMetadataTable.hpp"
 
 namespace Recommendation::PlaylistGeneratorConstraint
 {
 	class ConsecutiveReleases : public IConstraint
 	{
 		public:
-			ConsecutiveReleases(Database::Db& db);
+			ConsecutiveReleases(const TrackMetadataTable& trackMetadataTable);
 
 		private:
-			 float computeScore(const std::vector<Database::TrackId>& trackIds, std::size_t trackIndex) override;
+			void onTrackAdded(Database::TrackId trackId) override;
+			float computeScore(Database::TrackId trackId) const override;
 
-			 Database::ReleaseId getReleaseId(Database::TrackId trackId);
+			static constexpr std::size_t rangeSize {3}; // check up to rangeSize - 1 tracks before the candidate track
+			static_assert(rangeSize > 1);
 
-			 Database::Db& _db;
+			const TrackMetadataTable& _trackMetadataTable;
+			std::array<Database::ReleaseId, rangeSize - 1> _lastTracksReleases; // most recent first
 	};
 } // namespace Recommendation
-
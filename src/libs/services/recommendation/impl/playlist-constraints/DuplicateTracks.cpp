@@ -19,15 +19,17 @@
 
 #include "DuplicateTracks.hpp"
 
-#include <algorithm>
-
 namespace Recommendation::PlaylistGeneratorConstraint
 {
+	void
+	DuplicateTracks::onTrackAdded(Database::TrackId trackId)
+	{
+		_trackIds.insert(trackId);
+	}
+
 	float
-	DuplicateTracks::computeScore(const std::vector<Database::TrackId>& trackIds, std::size_t trackIndex)
+	DuplicateTracks::computeScore(Database::TrackId trackId) const
 	{
-		const auto count {std::count(std::cbegin(trackIds), std::cend(trackIds), trackIds[trackIndex])};
-		return count == 1 ? 0 : 1000;
+		return _trackIds.find(trackId) == std::cend(_trackIds) ? 0 : 1000;
 	}
 } // namespace Recommendation
-
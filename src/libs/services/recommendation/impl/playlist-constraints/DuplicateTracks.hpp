@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <unordered_set>
+
 #include "IConstraint.hpp"
 
 namespace Recommendation::PlaylistGeneratorConstraint
@@ -26,7 +28,9 @@ namespace Recommendation::PlaylistGeneratorConstraint
 	class DuplicateTracks : public IConstraint
 	{
 		private:
-			float computeScore(const std::vector<Database::TrackId>& trackIds, std::size_t trackIndex) override;
+			void onTrackAdded(Database::TrackId trackId) override;
+			float computeScore(Database::TrackId trackId) const override;
+
+			std::unordered_set<Database::TrackId> _trackIds;
 	};
 } // namespace Recommendation::PlaylistGeneratorConstraints
-
@@ -25,15 +25,19 @@
 
 namespace Recommendation::PlaylistGeneratorConstraint
 {
+	// Constraints are created for each playlist to extend and keep track of its last tracks
 	class IConstraint
 	{
 		public:
 			virtual ~IConstraint() = default;
 
-			// compute the score of the track at index trackIndex
+			// the track is appended to the playlist
+			virtual void onTrackAdded(Database::TrackId trackId) = 0;
+
+			// compute the score of the track, if it were appended to the playlist
 			// 0: best
 			// 1: worst
 			// > 1 : violation
-			virtual float computeScore(const TrackContainer& trackIds, std::size_t trackIndex) = 0;
+			virtual float computeScore(Database::TrackId trackId) const = 0;
 	};
 } // namespace Recommendation
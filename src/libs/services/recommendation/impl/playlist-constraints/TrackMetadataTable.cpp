@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TrackMetadataTable.hpp"
+
+#include "services/database/Session.hpp"
+#include "services/database/Track.hpp"
+#include "utils/Logger.hpp"
+
+namespace Recommendation::PlaylistGeneratorConstraint
+{
+	TrackMetadataTable::TrackMetadataTable(Database::Session& session)
+	{
+		using namespace Database;
+
+		static constexpr std::size_t batchSize {10000};
+
+		// Results are ordered by track then artist: artists of the same track are contiguous and sorted
+		for (std::size_t offset {};; offset += batchSize)
+		{
+			RangeResults<Track::ReleaseArtistResult> results;
+			{
+				auto transaction {session.createSharedTransaction()};
+				results = Track::findReleaseAndArtistIds(session, Range {offset, batchSize});
+			}
+
+			for (const Track::ReleaseArtistResult& result : results.results)
+			{
+				auto [itEntry, inserted] {_entries.try_emplace(result.trackId, Entry {result.releaseId, static_cast<std::uint32_t>(_artistIds.size()), 0})};
+				if (result.artistId.isValid())
+				{
+					_artistIds.push_back(result.artistId);
+					itEntry->second.artistCount++;
+				}
+			}
+
+			if (!results.moreResults)
+				break;
+		}
+
+		_artistIds.shrink_to_fit();
+
+		LMS_LOG(RECOMMENDATION, DEBUG) << "Track metadata table loaded: " << _entries.size() << " tracks, " << _artistIds.size() << " artist links";
+	}
+
+	Database::ReleaseId
+	TrackMetadataTable::getReleaseId(Database::TrackId trackId) const
+	{
+		const auto itEntry {_entries.find(trackId)};
+		if (itEntry == std::cend(_entries))
+			return {};
+
+		return itEntry->second.releaseId;
+	}
+
+	TrackMetadataTable::ArtistRange
+	TrackMetadataTable::getArtistIds(Database::TrackId trackId) const
+	{
+		const auto itEntry {_entries.find(trackId)};
+		if (itEntry == std::cend(_entries))
+			return {};
+
+		const Database::ArtistId* begin {_artistIds.data() + itEntry->second.firstArtistIndex};
+		return ArtistRange {begin, begin + itEntry->second.artistCount};
+	}
+} // namespace Recommendation::PlaylistGeneratorConstraint
+
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "services/database/ArtistId.hpp"
+#include "services/database/ReleaseId.hpp"
+#include "services/database/TrackId.hpp"
+
+namespace Database
+{
+	class Session;
+}
+
+namespace Recommendation::PlaylistGeneratorConstraint
+{
+	// Compact in-memory track -> (release, sorted artists) table, to avoid querying the database for each score computation
+	class TrackMetadataTable
+	{
+		public:
+			TrackMetadataTable(Database::Session& session);
+
+			TrackMetadataTable(const TrackMetadataTable&) = delete;
+			TrackMetadataTable& operator=(const TrackMetadataTable&) = delete;
+
+			struct ArtistRange
+			{
+				const Database::ArtistId* begin {};
+				const Database::ArtistId* end {};
+			};
+
+			Database::ReleaseId	getReleaseId(Database::TrackId trackId) const;
+			ArtistRange			getArtistIds(Database::TrackId trackId) const; // sorted, unique
+
+			std::size_t			getTrackCount() const { return _entries.size(); }
+
+		private:
+			struct Entry
+			{
+				Database::ReleaseId	releaseId;
+				std::uint32_t		firstArtistIndex {};
+				std::uint32_t		artistCount {};
+			};
+
+			std::unordered_map<Database::TrackId, Entry>	_entries;
+			std::vector<Database::ArtistId>					_artistIds;
+	};
+} // namespace Recommendation::PlaylistGeneratorConstraint
+
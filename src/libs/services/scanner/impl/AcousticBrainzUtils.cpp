@@ -19,69 +19,309 @@
 
 #include "AcousticBrainzUtils.hpp"
 
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
 
-#include <Wt/WIOService.h>
 #include <Wt/Http/Client.h>
+#include <Wt/Json/Object.h>
+#include <Wt/Json/Parser.h>
+#include <Wt/Json/Serializer.h>
+#include <Wt/Json/Value.h>
 
-#include "utils/IConfig.hpp"
 #include "utils/Logger.hpp"
-#include "utils/Service.hpp"
-#include "utils/UUID.hpp"
-
+#include "utils/String.hpp"
 
 namespace AcousticBrainz
 {
 
-static
-std::string
-getJsonData(const UUID& mbid)
+namespace
 {
-	static constexpr std::string_view defaultAPIURL {"https://acousticbrainz.org"};
-
-	const std::string url {std::string {Service<IConfig>::get()->getString("acousticbrainz-api-base-url", defaultAPIURL)} + "/api/v1/" + std::string {mbid.getAsString()} + "/low-level"};
+	constexpr std::size_t maxRecordingsPerRequest {25}; // API limit
+	constexpr std::size_t maxRetryCount {2};
+	constexpr std::chrono::seconds defaultRetryWaitDuration {10};
+	constexpr std::chrono::seconds maxRetryWaitDuration {300};
+	constexpr std::chrono::seconds abortCheckPeriod {1};
 
-	boost::asio::io_service ioService;
+	template <typename T>
+	std::optional<T>
+	headerReadAs(const Wt::Http::Message& msg, const std::string& headerName)
+	{
+		std::optional<T> res;
 
-	Wt::Http::Client client {ioService};
-	client.setFollowRedirect(true);
-	client.setSslCertificateVerificationEnabled(true);
-	client.setMaximumResponseSize(256*1024);
+		if (const std::string* headerValue {msg.getHeader(headerName)})
+			res = StringUtils::readAs<T>(*headerValue);
 
-	if (!client.get(url))
-	{
-		LMS_LOG(DBUPDATER, ERROR) << "Cannot perform a GET request to url '" << url << "'";
-		return {};
+		return res;
 	}
 
-	std::string response;
-	client.done().connect([&](Wt::AsioWrapper::error_code ec, const Wt::Http::Message &msg)
+	// Each client handles one request at a time
+	// All the clients share the same io context, run by the calling thread
+	class BulkFetcher
 	{
-		if (ec)
-		{
-			LMS_LOG(DBUPDATER, ERROR) << "GET request to url '" << url << "' failed: " << ec.message();
-			return;
-		}
+		public:
+			BulkFetcher(std::string_view baseUrl, const std::vector<UUID>& recordingMBIDs, std::size_t maxConcurrentRequests, OnFeaturesFunc onFeatures, IsAbortedFunc isAborted)
+				: _baseUrl {baseUrl}
+				, _onFeatures {std::move(onFeatures)}
+				, _isAborted {std::move(isAborted)}
+			{
+				for (std::size_t offset {}; offset < recordingMBIDs.size(); offset += maxRecordingsPerRequest)
+				{
+					const auto itBegin {std::next(std::cbegin(recordingMBIDs), offset)};
+					const auto itEnd {std::next(itBegin, std::min(maxRecordingsPerRequest, recordingMBIDs.size() - offset))};
+					_pendingBatches.push_back(Batch {std::vector<UUID>(itBegin, itEnd)});
+				}
+
+				const std::size_t workerCount {std::clamp(maxConcurrentRequests, std::size_t {1}, std::max(_pendingBatches.size(), std::size_t {1}))};
+				for (std::size_t i {}; i < workerCount; ++i)
+				{
+					auto worker {std::make_unique<Worker>(_ioContext)};
+					worker->client.setFollowRedirect(true);
+					worker->client.setSslCertificateVerificationEnabled(true);
+					worker->client.setMaximumResponseSize(maxRecordingsPerRequest * 1024 * 1024);
+
+					Worker& workerRef {*worker};
+					worker->client.done().connect([this, &workerRef](Wt::AsioWrapper::error_code ec, const Wt::Http::Message& msg)
+					{
+						onRequestDone(workerRef, ec, msg);
+					});
+
+					_workers.push_back(std::move(worker));
+				}
+			}
+
+			void run()
+			{
+				for (const std::unique_ptr<Worker>& worker : _workers)
+					sendNextBatch(*worker);
+
+				_ioContext.run();
+			}
+
+		private:
+			struct Batch
+			{
+				std::vector<UUID>	recordingMBIDs;
+				std::size_t			retryCount {};
+			};
+
+			struct Worker
+			{
+				Worker(boost::asio::io_context& ioContext) : client {ioContext}, timer {ioContext} {}
+
+				Wt::Http::Client				client;
+				boost::asio::steady_timer		timer;
+				std::optional<Batch>			currentBatch;
+			};
+
+			void sendNextBatch(Worker& worker)
+			{
+				if (_pendingBatches.empty() || _isAborted())
+					return;
+
+				// Rate limited: all the workers have to wait
+				if (const auto now {std::chrono::steady_clock::now()}; now < _throttledUntil)
+				{
+					worker.timer.expires_at(_throttledUntil);
+					worker.timer.async_wait([this, &worker](const boost::system::error_code& ec)
+					{
+						if (!ec)
+							sendNextBatch(worker);
+					});
+					watchAbort();
+					return;
+				}
+
+				worker.currentBatch = std::move(_pendingBatches.front());
+				_pendingBatches.pop_front();
+
+				std::string url {_baseUrl + "/api/v1/low-level?recording_ids="};
+				for (std::size_t i {}; i < worker.currentBatch->recordingMBIDs.size(); ++i)
+				{
+					if (i != 0)
+						url += ";";
+					url += worker.currentBatch->recordingMBIDs[i].getAsString();
+				}
+
+				LMS_LOG(DBUPDATER, DEBUG) << "Fetching low level features for " << worker.currentBatch->recordingMBIDs.size() << " recordings";
+				if (!worker.client.get(url))
+				{
+					LMS_LOG(DBUPDATER, ERROR) << "Cannot perform a GET request to url '" << url << "'";
+					giveUpCurrentBatch(worker);
+					sendNextBatch(worker);
+				}
+			}
+
+			void onRequestDone(Worker& worker, Wt::AsioWrapper::error_code ec, const Wt::Http::Message& msg)
+			{
+				if (ec)
+				{
+					LMS_LOG(DBUPDATER, ERROR) << "AcousticBrainz request failed: " << ec.message();
+					if (worker.currentBatch->retryCount++ < maxRetryCount)
+					{
+						throttle(defaultRetryWaitDuration);
+						_pendingBatches.push_front(std::move(*worker.currentBatch));
+						worker.currentBatch.reset();
+					}
+					else
+						giveUpCurrentBatch(worker);
+				}
+				else if (msg.status() == 429)
+				{
+					throttle(headerReadAs<std::size_t>(msg, "X-RateLimit-Reset-In").value_or(defaultRetryWaitDuration.count()));
+					_pendingBatches.push_front(std::move(*worker.currentBatch));
+					worker.currentBatch.reset();
+				}
+				else
+				{
+					if (msg.status() == 200)
+						processResponse(worker, msg.body());
+					else
+					{
+						LMS_LOG(DBUPDATER, ERROR) << "AcousticBrainz request failed: status = " << msg.status() << ", body = " << msg.body();
+						giveUpCurrentBatch(worker);
+					}
+
+					if (headerReadAs<std::size_t>(msg, "X-RateLimit-Remaining") == std::size_t {0})
+						throttle(headerReadAs<std::size_t>(msg, "X-RateLimit-Reset-In").value_or(defaultRetryWaitDuration.count()));
+				}
+
+				sendNextBatch(worker);
+			}
 
-		if (msg.status() != 200)
-		{
-			LMS_LOG(DBUPDATER, ERROR) << "GET request to url '" << url << "' failed: status = " << msg.status() << ", body = " << msg.body();
-			return;
-		}
+			void processResponse(Worker& worker, const std::string& body)
+			{
+				std::vector<RecordingFeatures> features;
 
-		response = msg.body();
-	});
+				// { "<mbid>": { "<offset>": { <features> }, ... }, ... }
+				Wt::Json::Object root;
+				Wt::Json::ParseError error;
+				if (!Wt::Json::parse(body, root, error))
+				{
+					LMS_LOG(DBUPDATER, ERROR) << "Cannot parse AcousticBrainz response: " << error.what();
+				}
+				else
+				{
+					for (const UUID& recordingMBID : worker.currentBatch->recordingMBIDs)
+					{
+						const auto itRecording {root.find(std::string {recordingMBID.getAsString()})};
+						if (itRecording == std::cend(root) || itRecording->second.type() != Wt::Json::Type::Object)
+						{
+							LMS_LOG(DBUPDATER, DEBUG) << "No low level features for recording '" << recordingMBID.getAsString() << "'";
+							continue;
+						}
 
-	ioService.run();
+						const Wt::Json::Object& submissions {itRecording->second};
+						const auto itFirstSubmission {submissions.find("0")};
+						if (itFirstSubmission == std::cend(submissions) || itFirstSubmission->second.type() != Wt::Json::Type::Object)
+							continue;
 
-	return response;
+						features.push_back(RecordingFeatures {recordingMBID, Wt::Json::serialize(static_cast<const Wt::Json::Object&>(itFirstSubmission->second), 0)});
+					}
+				}
+
+				const std::size_t processedCount {worker.currentBatch->recordingMBIDs.size()};
+				worker.currentBatch.reset();
+				_onFeatures(processedCount, std::move(features));
+			}
+
+			void giveUpCurrentBatch(Worker& worker)
+			{
+				const std::size_t processedCount {worker.currentBatch->recordingMBIDs.size()};
+				worker.currentBatch.reset();
+				_onFeatures(processedCount, {});
+			}
+
+			// Throttled workers may wait for minutes: periodically check for abort to cancel their timers
+			void watchAbort()
+			{
+				if (_abortWatchActive)
+					return;
+
+				_abortWatchActive = true;
+				_abortWatchTimer.expires_after(abortCheckPeriod);
+				_abortWatchTimer.async_wait([this](const boost::system::error_code& ec)
+				{
+					_abortWatchActive = false;
+					if (ec)
+						return;
+
+					if (_isAborted())
+					{
+						LMS_LOG(DBUPDATER, DEBUG) << "AcousticBrainz fetch aborted, cancelling throttled requests";
+						for (const std::unique_ptr<Worker>& worker : _workers)
+							worker->timer.cancel();
+						return;
+					}
+
+					if (std::chrono::steady_clock::now() < _throttledUntil)
+						watchAbort();
+				});
+			}
+
+			void throttle(std::size_t seconds)
+			{
+				const auto duration {std::min(std::chrono::seconds {seconds}, maxRetryWaitDuration)};
+				LMS_LOG(DBUPDATER, DEBUG) << "Throttling AcousticBrainz requests for " << duration.count() << " seconds";
+
+				_throttledUntil = std::max(_throttledUntil, std::chrono::steady_clock::now() + duration);
+			}
+
+			void throttle(std::chrono::seconds duration)
+			{
+				throttle(static_cast<std::size_t>(duration.count()));
+			}
+
+			const std::string						_baseUrl;
+			OnFeaturesFunc							_onFeatures;
+			IsAbortedFunc							_isAborted;
+			boost::asio::io_context					_ioContext;
+			boost::asio::steady_timer				_abortWatchTimer {_ioContext};
+			bool									_abortWatchActive {};
+			std::deque<Batch>						_pendingBatches;
+			std::vector<std::unique_ptr<Worker>>	_workers;
+			std::chrono::steady_clock::time_point	_throttledUntil {};
+	};
 }
 
-std::string
-extractLowLevelFeatures(const UUID& recordingMBID)
+void
+fetchLowLevelFeatures(std::string_view baseUrl, const std::vector<UUID>& recordingMBIDs, std::size_t maxConcurrentRequests, OnFeaturesFunc onFeatures, IsAbortedFunc isAborted)
 {
-	return getJsonData(recordingMBID);
+	if (recordingMBIDs.empty())
+		return;
+
+	BulkFetcher fetcher {baseUrl, recordingMBIDs, maxConcurrentRequests, std::move(onFeatures), std::move(isAborted)};
+	fetcher.run();
 }
 
-} // namespace Scanner::AcousticBrainz
+std::optional<std::string>
+readLowLevelFeaturesFromDump(const std::filesystem::path& dumpDirectory, const UUID& recordingMBID)
+{
+	// Dump layout: [lowlevel/]<2 first chars>/<3rd char>/<mbid>-<submission offset>.json
+	const std::string_view mbid {recordingMBID.getAsString()};
+	const std::filesystem::path relativePath {std::filesystem::path {std::string {mbid.substr(0, 2)}} / std::string {mbid.substr(2, 1)} / (std::string {mbid} + "-0.json")};
+
+	for (const std::filesystem::path& path : {dumpDirectory / relativePath, dumpDirectory / "lowlevel" / relativePath})
+	{
+		std::ifstream ifs {path, std::ios::binary};
+		if (!ifs)
+			continue;
+
+		std::string features {std::istreambuf_iterator<char> {ifs}, std::istreambuf_iterator<char> {}};
+		if (features.empty())
+			continue;
+
+		return features;
+	}
+
+	return std::nullopt;
+}
+
+} // namespace AcousticBrainz
+
@@ -19,12 +19,32 @@
 
 #pragma once
 
+#include <filesystem>
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
-class UUID;
+#include "utils/UUID.hpp"
 
 namespace AcousticBrainz
 {
-	std::string extractLowLevelFeatures(const UUID& recordingMBID);
+	struct RecordingFeatures
+	{
+		UUID		recordingMBID;
+		std::string	jsonEncodedFeatures;
+	};
+
+	// Called each time a batch of recordings has been processed (features may be missing for some of them)
+	using OnFeaturesFunc = std::function<void(std::size_t processedCount, std::vector<RecordingFeatures>&& features)>;
+	using IsAbortedFunc = std::function<bool()>;
+
+	// Uses the bulk API, with at most maxConcurrentRequests requests in flight
+	// Blocks until all the recordings are processed or the fetch is aborted
+	void fetchLowLevelFeatures(std::string_view baseUrl, const std::vector<UUID>& recordingMBIDs, std::size_t maxConcurrentRequests, OnFeaturesFunc onFeatures, IsAbortedFunc isAborted);
+
+	// Reads the features of a recording from an extracted low level JSON dump
+	std::optional<std::string> readLowLevelFeaturesFromDump(const std::filesystem::path& dumpDirectory, const UUID& recordingMBID);
 }
 
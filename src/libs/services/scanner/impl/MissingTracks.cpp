@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MissingTracks.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace Scanner
+{
+	std::optional<std::uint64_t>
+	computeFingerprint(const std::filesystem::path& p, std::uintmax_t fileSize)
+	{
+		constexpr std::size_t blockSize {16 * 1024};
+		constexpr std::size_t blockCount {3};
+
+		std::ifstream ifs {p, std::ios::binary};
+		if (!ifs)
+			return std::nullopt;
+
+		// FNV-1a
+		std::uint64_t hash {14695981039346656037ULL};
+		auto update {[&](unsigned char byte)
+		{
+			hash ^= byte;
+			hash *= 1099511628211ULL;
+		}};
+
+		for (std::size_t i {}; i < sizeof(fileSize); ++i)
+			update(static_cast<unsigned char>(fileSize >> (8 * i)));
+
+		std::array<char, blockSize> buffer;
+		for (std::size_t i {1}; i <= blockCount && fileSize > 0; ++i)
+		{
+			const std::uintmax_t offset {fileSize > blockSize ? (fileSize - blockSize) * i / (blockCount + 1) : 0};
+
+			ifs.clear();
+			ifs.seekg(static_cast<std::streamoff>(offset));
+			ifs.read(buffer.data(), buffer.size());
+			const std::streamsize readCount {ifs.gcount()};
+			if (readCount <= 0)
+				return std::nullopt;
+
+			for (std::streamsize j {}; j < readCount; ++j)
+				update(static_cast<unsigned char>(buffer[j]));
+		}
+
+		return hash ? hash : 1;
+	}
+
+	void
+	MissingTracks::add(Database::TrackId trackId, const std::filesystem::path& path, std::uintmax_t fileSize, std::uint64_t fingerprint)
+	{
+		_tracks[{fileSize, fingerprint}].push_back(Entry {trackId, path});
+	}
+
+	std::optional<Database::TrackId>
+	MissingTracks::match(const std::filesystem::path& file, std::uintmax_t fileSize, std::uint64_t fingerprint)
+	{
+		auto itTracks {_tracks.find({fileSize, fingerprint})};
+		if (itTracks == std::end(_tracks))
+			return std::nullopt;
+
+		std::vector<Entry>& entries {itTracks->second};
+
+		auto getScore {[&](const Entry& entry)
+		{
+			int score {};
+			if (entry.path.filename() == file.filename())
+				score += 2;
+			if (entry.path.parent_path().filename() == file.parent_path().filename())
+				score += 1;
+			return score;
+		}};
+
+		auto itBest {std::max_element(std::begin(entries), std::end(entries), [&](const Entry& lhs, const Entry& rhs)
+		{
+			const int lhsScore {getScore(lhs)};
+			const int rhsScore {getScore(rhs)};
+			if (lhsScore != rhsScore)
+				return lhsScore < rhsScore;
+
+			return lhs.trackId > rhs.trackId;
+		})};
+
+		const Database::TrackId trackId {itBest->trackId};
+		entries.erase(itBest);
+		if (entries.empty())
+			_tracks.erase(itTracks);
+
+		return trackId;
+	}
+
+	std::vector<Database::TrackId>
+	MissingTracks::getTrackIds() const
+	{
+		std::vector<Database::TrackId> trackIds;
+		for (const auto& [key, entries] : _tracks)
+		{
+			for (const Entry& entry : entries)
+				trackIds.push_back(entry.trackId);
+		}
+
+		std::sort(std::begin(trackIds), std::end(trackIds));
+		return trackIds;
+	}
+}
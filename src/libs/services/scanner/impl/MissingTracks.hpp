@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "services/database/TrackId.hpp"
+
+namespace Scanner
+{
+	// Cheap content fingerprint, used to recognize moved files
+	// Hashes the file size and a few blocks spread over the file, mostly made of audio frames
+	// Never returns 0, reserved for "not computed"
+	std::optional<std::uint64_t> computeFingerprint(const std::filesystem::path& p, std::uintmax_t fileSize);
+
+	// Tracks whose file is missing, waiting to be matched with a moved file
+	class MissingTracks
+	{
+		public:
+			void add(Database::TrackId trackId, const std::filesystem::path& path, std::uintmax_t fileSize, std::uint64_t fingerprint);
+
+			// Among the tracks sharing the same content, prefers the one with the same file name, then the same parent directory name, then the lowest id
+			// The matched track is no longer missing
+			std::optional<Database::TrackId> match(const std::filesystem::path& file, std::uintmax_t fileSize, std::uint64_t fingerprint);
+
+			bool empty() const { return _tracks.empty(); }
+			void clear() { _tracks.clear(); }
+			std::vector<Database::TrackId> getTrackIds() const;
+
+		private:
+			struct Entry
+			{
+				Database::TrackId		trackId;
+				std::filesystem::path	path;
+			};
+			std::map<std::pair<std::uintmax_t, std::uint64_t>, std::vector<Entry>> _tracks;
+	};
+}
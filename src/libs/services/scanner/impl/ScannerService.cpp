@@ -20,6 +20,8 @@
 #include "ScannerService.hpp"
 
 #include <ctime>
+#include <map>
+#include <shared_mutex>
 #include <boost/asio/placeholders.hpp>
 
 #include <Wt/WLocalDateTime.h>
@@ -28,10 +30,13 @@
 #include "services/database/Cluster.hpp"
 #include "services/database/Release.hpp"
 #include "services/database/ScanSettings.hpp"
+#include "services/database/TagCacheEntry.hpp"
 #include "services/database/Track.hpp"
 #include "services/database/TrackArtistLink.hpp"
 #include "services/database/TrackFeatures.hpp"
 #include "metadata/IParser.hpp"
+#include "metadata/RawTrack.hpp"
+#include "services/cover/ICoverService.hpp"
 #include "services/recommendation/IRecommendationService.hpp"
 #include "utils/Exception.hpp"
 #include "utils/IConfig.hpp"
@@ -275,6 +280,7 @@ ScannerService::ScannerService(Db& db, Recommendation::IRecommendationService& r
 , _skipDuplicateRecordingMBID {Service<IConfig>::get()->getBool("scanner-skip-duplicate-recording-mbid", false)}
 , _dbSession {db}
 , _metadataParser {MetaData::createParser(MetaData::ParserType::TagLib, getParserReadStyle())} // For now, always use TagLib
+, _coverSourceResolver {Cover::createCoverSourceResolver()}
 {
 	LMS_LOG(DBUPDATER, INFO) << "skipDuplicateRecordingMBID = " << _skipDuplicateRecordingMBID;
 
@@ -383,6 +389,14 @@ ScannerService::getStatus() const
 	return res;
 }
 
+IScannerService::LibraryGeneration
+ScannerService::getLibraryGeneration() const
+{
+	std::shared_lock lock {_statusMutex};
+
+	return _libraryGeneration;
+}
+
 void
 ScannerService::scheduleNextScan()
 {
@@ -521,10 +535,15 @@ ScannerService::scan(bool forceScan)
 	scanMediaDirectory(_mediaDirectory, forceScan, stats);
 	LMS_LOG(DBUPDATER, INFO) << "scaning media directory '" << _mediaDirectory.string() << "' DONE";
 
+	if (!_abortScan)
+		removeUnmatchedMissingTracks(stats);
+
 	removeOrphanEntries();
 
 	if (!_abortScan)
 	{
+		resolveCoverSources(stats);
+		generateCoverThumbnails(stats);
 		checkDuplicatedAudioFiles(stats);
 		fetchTrackFeatures(stats);
 		reloadSimilarityEngine(stats);
@@ -534,6 +553,9 @@ ScannerService::scan(bool forceScan)
 
 	_dbSession.optimize();
 
+	// Even aborted scans may have changed the library
+	updateLibraryGeneration(stats);
+
 	if (!_abortScan)
 	{
 		stats.stopTime = Wt::WLocalDateTime::currentDateTime().toUTC();
@@ -560,30 +582,30 @@ ScannerService::scan(bool forceScan)
 	}
 }
 
-bool
-ScannerService::fetchTrackFeatures(TrackId trackId, const UUID& recordingMBID)
+void
+ScannerService::storeTrackFeatures(const std::unordered_map<std::string, std::vector<TrackId>>& tracksByRecordingMBID, const std::vector<AcousticBrainz::RecordingFeatures>& features, ScanStats& stats)
 {
-	std::map<std::string, double> features;
+	if (features.empty())
+		return;
 
-	LMS_LOG(DBUPDATER, INFO) << "Fetching low level features for recording '" << recordingMBID.getAsString() << "'";
-	const std::string data {AcousticBrainz::extractLowLevelFeatures(recordingMBID)};
-	if (data.empty())
-	{
-		LMS_LOG(DBUPDATER, ERROR) << "Track " << trackId.getValue() << ", recording MBID = '" << recordingMBID.getAsString() << "': cannot extract features using AcousticBrainz";
-		return false;
-	}
+	auto uniqueTransaction {_dbSession.createUniqueTransaction()};
 
+	for (const AcousticBrainz::RecordingFeatures& recordingFeatures : features)
 	{
-		auto uniqueTransaction {_dbSession.createUniqueTransaction()};
+		const auto itTracks {tracksByRecordingMBID.find(std::string {recordingFeatures.recordingMBID.getAsString()})};
+		if (itTracks == std::cend(tracksByRecordingMBID))
+			continue;
 
-		Track::pointer track {Track::find(_dbSession, trackId)};
-		if (!track)
-			return false;
+		for (const TrackId trackId : itTracks->second)
+		{
+			Track::pointer track {Track::find(_dbSession, trackId)};
+			if (!track)
+				continue;
 
-		_dbSession.create<TrackFeatures>(track, data);
+			_dbSession.create<TrackFeatures>(track, recordingFeatures.jsonEncodedFeatures);
+			stats.featuresFetched++;
+		}
 	}
-
-	return true;
 }
 
 void
@@ -596,45 +618,84 @@ ScannerService::fetchTrackFeatures(ScanStats& stats)
 
 	LMS_LOG(DBUPDATER, INFO) << "Fetching missing track features...";
 
-	struct TrackInfo
+	// Several tracks may share the same recording
+	std::unordered_map<std::string, std::vector<TrackId>> tracksByRecordingMBID;
+	std::vector<UUID> recordingMBIDs;
 	{
-		TrackId id;
-		UUID recordingMBID;
-	};
-
-	const auto tracksToFetch {[&]()
-	{
-		std::vector<TrackInfo> res;
-
 		auto transaction {_dbSession.createSharedTransaction()};
 
 		auto trackIds {Track::findWithRecordingMBIDAndMissingFeatures(_dbSession, Range {})};
 		for (const TrackId trackId : trackIds.results)
 		{
 			const Track::pointer track {Track::find(_dbSession, trackId)};
-			res.emplace_back(TrackInfo {track->getId(), *track->getRecordingMBID()});
-		}
+			const UUID recordingMBID {*track->getRecordingMBID()};
 
-		return res;
-	}()};
+			std::vector<TrackId>& trackIdsForRecording {tracksByRecordingMBID[std::string {recordingMBID.getAsString()}]};
+			if (trackIdsForRecording.empty())
+				recordingMBIDs.push_back(recordingMBID);
+			trackIdsForRecording.push_back(trackId);
+		}
+	}
 
-	stepStats.totalElems = tracksToFetch.size();
+	stepStats.totalElems = recordingMBIDs.size();
 	notifyInProgress(stepStats);
 
-	LMS_LOG(DBUPDATER, INFO) << "Found " << tracksToFetch.size() << " track(s) to fetch!";
+	LMS_LOG(DBUPDATER, INFO) << "Found " << recordingMBIDs.size() << " recording(s) to fetch!";
 
-	for (const TrackInfo& trackToFetch : tracksToFetch)
+	// Local dump first, if any
+	const std::filesystem::path dumpDirectory {Service<IConfig>::get()->getPath("acousticbrainz-dump-directory")};
+	if (!dumpDirectory.empty())
 	{
-		if (_abortScan)
-			return;
+		static constexpr std::size_t batchSize {50};
 
-		if (fetchTrackFeatures(trackToFetch.id, trackToFetch.recordingMBID))
-			stats.featuresFetched++;
+		std::vector<UUID> missingRecordingMBIDs;
+		std::vector<AcousticBrainz::RecordingFeatures> features;
 
-		stepStats.processedElems++;
-		notifyInProgressIfNeeded(stepStats);
+		for (const UUID& recordingMBID : recordingMBIDs)
+		{
+			if (_abortScan)
+				return;
+
+			std::optional<std::string> recordingFeatures {AcousticBrainz::readLowLevelFeaturesFromDump(dumpDirectory, recordingMBID)};
+			if (!recordingFeatures)
+			{
+				missingRecordingMBIDs.push_back(recordingMBID);
+				continue;
+			}
+
+			features.push_back(AcousticBrainz::RecordingFeatures {recordingMBID, std::move(*recordingFeatures)});
+			if (features.size() == batchSize)
+			{
+				storeTrackFeatures(tracksByRecordingMBID, features, stats);
+				features.clear();
+			}
+
+			stepStats.processedElems++;
+			notifyInProgressIfNeeded(stepStats);
+		}
+		storeTrackFeatures(tracksByRecordingMBID, features, stats);
+
+		LMS_LOG(DBUPDATER, INFO) << "Imported " << (recordingMBIDs.size() - missingRecordingMBIDs.size()) << " recording(s) from the AcousticBrainz dump";
+
+		recordingMBIDs = std::move(missingRecordingMBIDs);
 	}
 
+	const std::string_view baseUrl {Service<IConfig>::get()->getString("acousticbrainz-api-base-url", "https://acousticbrainz.org")};
+	const std::size_t maxConcurrentRequests {Service<IConfig>::get()->getULong("acousticbrainz-max-concurrent-requests", 4)};
+
+	AcousticBrainz::fetchLowLevelFeatures(baseUrl, recordingMBIDs, maxConcurrentRequests,
+		[&](std::size_t processedCount, std::vector<AcousticBrainz::RecordingFeatures>&& features)
+		{
+			storeTrackFeatures(tracksByRecordingMBID, features, stats);
+
+			stepStats.processedElems += processedCount;
+			notifyInProgressIfNeeded(stepStats);
+		},
+		[this] { return _abortScan.load(); });
+
+	if (_abortScan)
+		return;
+
 	notifyInProgress(stepStats);
 	LMS_LOG(DBUPDATER, INFO) << "Track features fetched!";
 }
@@ -669,6 +730,13 @@ ScannerService::refreshScanSettings()
 			[](ClusterType::pointer clusterType) { return clusterType->getName(); });
 
 	_metadataParser->setClusterTypeNames(clusterTypeNames);
+
+	{
+		std::unique_lock lock {_statusMutex};
+
+		_libraryGeneration.value = scanSettings->getLibraryGeneration();
+		_libraryGeneration.lastModified = scanSettings->getLibraryLastModified();
+	}
 }
 
 void
@@ -693,6 +761,55 @@ ScannerService::notifyInProgressIfNeeded(const ScanStepStats& stepStats)
 		notifyInProgress(stepStats);
 }
 
+std::optional<MetaData::RawTrack>
+ScannerService::getCachedRawTrack(const std::filesystem::path& file, std::uintmax_t fileSize, const Wt::WDateTime& lastWriteTime)
+{
+	std::optional<MetaData::RawTrack> rawTrack;
+
+	auto transaction {_dbSession.createSharedTransaction()};
+
+	const TagCacheEntry::pointer tagCacheEntry {TagCacheEntry::find(_dbSession, file)};
+	if (tagCacheEntry && tagCacheEntry->matches(fileSize, lastWriteTime))
+	{
+		rawTrack = MetaData::deserializeRawTrack(tagCacheEntry->getData());
+		if (rawTrack)
+			LMS_LOG(DBUPDATER, DEBUG) << "Using cached tags for '" << file.string() << "'";
+	}
+
+	return rawTrack;
+}
+
+bool
+ScannerService::reconcileMovedTrack(const std::filesystem::path& file, std::uintmax_t fileSize, std::uint64_t fingerprint, const Wt::WDateTime& lastWriteTime)
+{
+	const std::optional<TrackId> trackId {_missingTracks.match(file, fileSize, fingerprint)};
+	if (!trackId)
+		return false;
+
+	auto transaction {_dbSession.createUniqueTransaction()};
+
+	Track::pointer track {Track::find(_dbSession, *trackId)};
+	if (!track)
+		return false;
+
+	const std::filesystem::path oldPath {track->getPath()};
+	LMS_LOG(DBUPDATER, INFO) << "Moving '" << oldPath.string() << "' to '" << file.string() << "'";
+
+	track.modify()->setPath(file);
+	track.modify()->setCoverSource({}); // resolved later, as it depends on the location
+
+	if (!TagCacheEntry::find(_dbSession, file))
+	{
+		if (TagCacheEntry::pointer tagCacheEntry {TagCacheEntry::find(_dbSession, oldPath)})
+			tagCacheEntry.modify()->setPath(file);
+	}
+
+	// The title may come from the file name
+	return track->getLastWriteTime().toTime_t() == lastWriteTime.toTime_t()
+		&& track->getScanVersion() == _scanVersion
+		&& track->getName() != oldPath.filename().string();
+}
+
 void
 ScannerService::scanAudioFile(const std::filesystem::path& file, bool forceScan, ScanStats& stats)
 {
@@ -708,38 +825,101 @@ ScannerService::scanAudioFile(const std::filesystem::path& file, bool forceScan,
 		return;
 	}
 
-	if (!forceScan)
+	std::error_code ec;
+	const std::uintmax_t fileSize {std::filesystem::file_size(file, ec)};
+	if (ec)
+	{
+		LMS_LOG(DBUPDATER, ERROR) << "Cannot get file size for '" << file.string() << "': " << ec.message();
+		stats.skips++;
+		return;
+	}
+
+	bool trackExists {};
+	bool upToDate {};
+	bool hasFingerprint {};
 	{
-		// Skip file if last write is the same
 		auto transaction {_dbSession.createSharedTransaction()};
 
 		const Track::pointer track {Track::findByPath(_dbSession, file)};
+		if (track)
+		{
+			trackExists = true;
+			upToDate = track->getLastWriteTime().toTime_t() == lastWriteTime.toTime_t()
+				&& track->getScanVersion() == _scanVersion;
+			hasFingerprint = track->getFingerprint() != 0;
+		}
+	}
+
+	// Skip file if last write is the same
+	if (!forceScan && upToDate && hasFingerprint)
+	{
+		stats.skips++;
+		return;
+	}
 
-		if (track && track->getLastWriteTime().toTime_t() == lastWriteTime.toTime_t()
-				&& track->getScanVersion() == _scanVersion)
+	const std::optional<std::uint64_t> fingerprint {computeFingerprint(file, fileSize)};
+
+	if (!forceScan && upToDate)
+	{
+		// Track scanned before fingerprints were introduced
+		if (fingerprint)
 		{
-			stats.skips++;
+			auto transaction {_dbSession.createUniqueTransaction()};
+
+			if (Track::pointer track {Track::findByPath(_dbSession, file)})
+				track.modify()->setFingerprint(fileSize, *fingerprint);
+		}
+
+		stats.skips++;
+		return;
+	}
+
+	if (!trackExists && fingerprint)
+	{
+		const bool movedTrackUpToDate {reconcileMovedTrack(file, fileSize, *fingerprint, lastWriteTime)};
+		if (!forceScan && movedTrackUpToDate)
+		{
+			stats.updates++;
 			return;
 		}
 	}
 
-	std::optional<MetaData::Track> trackInfo {_metadataParser->parse(file)};
-	if (!trackInfo)
+	// Scan version changes only need the tags to be interpreted again: use the cached ones if the file did not change
+	std::optional<MetaData::RawTrack> rawTrack;
+	if (!forceScan)
+		rawTrack = getCachedRawTrack(file, fileSize, lastWriteTime);
+
+	const bool rawTrackFromCache {rawTrack.has_value()};
+	if (!rawTrack)
+		rawTrack = _metadataParser->readRawTrack(file);
+
+	if (!rawTrack)
 	{
 		stats.errors.emplace_back(file, ScanErrorType::CannotParseFile);
 		return;
 	}
 
+	const MetaData::Track trackInfo {_metadataParser->parseRawTrack(*rawTrack)};
+
 	stats.scans++;
 
 	auto uniqueTransaction {_dbSession.createUniqueTransaction()};
 
+	if (!rawTrackFromCache)
+	{
+		TagCacheEntry::pointer tagCacheEntry {TagCacheEntry::find(_dbSession, file)};
+		if (!tagCacheEntry)
+			tagCacheEntry = _dbSession.create<TagCacheEntry>(file);
+
+		tagCacheEntry.modify()->setData(fileSize, lastWriteTime, MetaData::serializeRawTrack(*rawTrack));
+	}
+
 	Track::pointer track {Track::findByPath(_dbSession, file) };
 
 	// Skip duplicate recording MBID
-	if (trackInfo->recordingMBID && _skipDuplicateRecordingMBID)
+	if (trackInfo.recordingMBID && _skipDuplicateRecordingMBID)
 	{
-		for (Track::pointer otherTrack : Track::findByRecordingMBID(_dbSession, *trackInfo->recordingMBID))
+		for (Track::pointer otherTrack : Track::findByRecordingMBID(_dbSession, *trackInfo.recordingMBID))
 		{
 			if (track && track->getId() == otherTrack->getId())
 				continue;
@@ -758,7 +938,7 @@ ScannerService::scanAudioFile(const std::filesystem::path& file, bool forceScan,
 	// We estimate this is an audio file if:
 	// - we found a least one audio stream
 	// - the duration is not null
-	if (trackInfo->audioStreams.empty())
+	if (trackInfo.audioStreams.empty())
 	{
 		LMS_LOG(DBUPDATER, INFO) << "Skipped '" << file.string() << "' (no audio stream found)";
 
@@ -771,7 +951,7 @@ ScannerService::scanAudioFile(const std::filesystem::path& file, bool forceScan,
 		stats.errors.emplace_back(ScanError {file, ScanErrorType::NoAudioTrack});
 		return;
 	}
-	if (trackInfo->duration == std::chrono::milliseconds::zero())
+	if (trackInfo.duration == std::chrono::milliseconds::zero())
 	{
 		LMS_LOG(DBUPDATER, INFO) << "Skipped '" << file.string() << "' (duration is 0)";
 
@@ -787,8 +967,8 @@ ScannerService::scanAudioFile(const std::filesystem::path& file, bool forceScan,
 
 	// ***** Title
 	std::string title;
-	if (!trackInfo->title.empty())
-		title = trackInfo->title;
+	if (!trackInfo.title.empty())
+		title = trackInfo.title;
 	else
 	{
 		// TODO parse file name guess track etc.
@@ -817,69 +997,72 @@ ScannerService::scanAudioFile(const std::filesystem::path& file, bool forceScan,
 
 	track.modify()->clearArtistLinks();
 	// Do not fallback on artists with the same name but having a MBID for artist and releaseArtists, as it may be corrected by properly tagging files
-	for (const Artist::pointer& artist : getOrCreateArtists(_dbSession, trackInfo->artists, false))
+	for (const Artist::pointer& artist : getOrCreateArtists(_dbSession, trackInfo.artists, false))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, artist, TrackArtistLinkType::Artist));
 
-	for (const Artist::pointer& releaseArtist : getOrCreateArtists(_dbSession, trackInfo->albumArtists, false))
+	for (const Artist::pointer& releaseArtist : getOrCreateArtists(_dbSession, trackInfo.albumArtists, false))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, releaseArtist, TrackArtistLinkType::ReleaseArtist));
 
 	// Allow fallbacks on artists with the same name even if they have MBID, since there is no tag to indicate the MBID of these artists
 	// We could ask MusicBrainz to get all the information, but that would heavily slow down the import process
-	for (const Artist::pointer& conductor : getOrCreateArtists(_dbSession, trackInfo->conductorArtists, true))
+	for (const Artist::pointer& conductor : getOrCreateArtists(_dbSession, trackInfo.conductorArtists, true))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, conductor, TrackArtistLinkType::Conductor));
 
-	for (const Artist::pointer& composer : getOrCreateArtists(_dbSession, trackInfo->composerArtists, true))
+	for (const Artist::pointer& composer : getOrCreateArtists(_dbSession, trackInfo.composerArtists, true))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, composer, TrackArtistLinkType::Composer));
 
-	for (const Artist::pointer& lyricist : getOrCreateArtists(_dbSession, trackInfo->lyricistArtists, true))
+	for (const Artist::pointer& lyricist : getOrCreateArtists(_dbSession, trackInfo.lyricistArtists, true))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, lyricist, TrackArtistLinkType::Lyricist));
 
-	for (const Artist::pointer& mixer : getOrCreateArtists(_dbSession, trackInfo->mixerArtists, true))
+	for (const Artist::pointer& mixer : getOrCreateArtists(_dbSession, trackInfo.mixerArtists, true))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, mixer, TrackArtistLinkType::Mixer));
 
-	for (const auto& [role, performers] : trackInfo->performerArtists)
+	for (const auto& [role, performers] : trackInfo.performerArtists)
 	{
 		for (const Artist::pointer& performer : getOrCreateArtists(_dbSession, performers, true))
 			track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, performer, TrackArtistLinkType::Performer, role));
 	}
 
-	for (const Artist::pointer& producer : getOrCreateArtists(_dbSession, trackInfo->producerArtists, true))
+	for (const Artist::pointer& producer : getOrCreateArtists(_dbSession, trackInfo.producerArtists, true))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, producer, TrackArtistLinkType::Producer));
 
-	for (const Artist::pointer& remixer : getOrCreateArtists(_dbSession, trackInfo->remixerArtists, true))
+	for (const Artist::pointer& remixer : getOrCreateArtists(_dbSession, trackInfo.remixerArtists, true))
 		track.modify()->addArtistLink(TrackArtistLink::create(_dbSession, track, remixer, TrackArtistLinkType::Remixer));
 
 	track.modify()->setScanVersion(_scanVersion);
-	if (trackInfo->album)
-		track.modify()->setRelease(getOrCreateRelease(_dbSession, *trackInfo->album));
+	if (trackInfo.album)
+		track.modify()->setRelease(getOrCreateRelease(_dbSession, *trackInfo.album));
 	else
 		track.modify()->setRelease({});
-	track.modify()->setClusters(getOrCreateClusters(_dbSession, trackInfo->clusters));
+	track.modify()->setClusters(getOrCreateClusters(_dbSession, trackInfo.clusters));
 	track.modify()->setLastWriteTime(lastWriteTime);
+	if (fingerprint)
+		track.modify()->setFingerprint(fileSize, *fingerprint);
 	track.modify()->setName(title);
-	track.modify()->setDuration(trackInfo->duration);
+	track.modify()->setDuration(trackInfo.duration);
 	track.modify()->setAddedTime(Wt::WLocalDateTime::currentServerDateTime().toUTC());
-	track.modify()->setTrackNumber(trackInfo->trackNumber ? *trackInfo->trackNumber : 0);
-	track.modify()->setDiscNumber(trackInfo->discNumber ? *trackInfo->discNumber : 0);
-	track.modify()->setTotalTrack(trackInfo->totalTrack);
-	track.modify()->setTotalDisc(trackInfo->totalDisc);
-	track.modify()->setDiscSubtitle(trackInfo->discSubtitle);
-	track.modify()->setDate(trackInfo->date);
-	track.modify()->setOriginalDate(trackInfo->originalDate);
+	track.modify()->setTrackNumber(trackInfo.trackNumber ? *trackInfo.trackNumber : 0);
+	track.modify()->setDiscNumber(trackInfo.discNumber ? *trackInfo.discNumber : 0);
+	track.modify()->setTotalTrack(trackInfo.totalTrack);
+	track.modify()->setTotalDisc(trackInfo.totalDisc);
+	track.modify()->setDiscSubtitle(trackInfo.discSubtitle);
+	track.modify()->setDate(trackInfo.date);
+	track.modify()->setOriginalDate(trackInfo.originalDate);
 
 	// If a file has an OriginalYear but no Year, set it to ease filtering
-	if (!trackInfo->date.isValid() && trackInfo->originalDate.isValid())
-		track.modify()->setDate(trackInfo->originalDate);
+	if (!trackInfo.date.isValid() && trackInfo.originalDate.isValid())
+		track.modify()->setDate(trackInfo.originalDate);
 
-	track.modify()->setRecordingMBID(trackInfo->recordingMBID);
-	track.modify()->setTrackMBID(trackInfo->trackMBID);
+	track.modify()->setRecordingMBID(trackInfo.recordingMBID);
+	track.modify()->setTrackMBID(trackInfo.trackMBID);
 	if (auto trackFeatures {TrackFeatures::find(_dbSession, track->getId())})
 		trackFeatures.remove(); // TODO: only if MBID changed?
-	track.modify()->setHasCover(trackInfo->hasCover);
-	track.modify()->setCopyright(trackInfo->copyright);
-	track.modify()->setCopyrightURL(trackInfo->copyrightURL);
-	track.modify()->setTrackReplayGain(trackInfo->trackReplayGain);
-	track.modify()->setReleaseReplayGain(trackInfo->albumReplayGain);
+	track.modify()->setHasCover(trackInfo.hasCover);
+	track.modify()->setCoverSource({}); // resolved later
+	track.modify()->setCopyright(trackInfo.copyright);
+	track.modify()->setCopyrightURL(trackInfo.copyrightURL);
+	track.modify()->setTrackReplayGain(trackInfo.trackReplayGain);
+	track.modify()->setReleaseReplayGain(trackInfo.albumReplayGain);
 }
 
 void
@@ -913,8 +1096,15 @@ ScannerService::scanMediaDirectory(const std::filesystem::path& mediaDirectory,
 	notifyInProgress(stepStats);
 }
 
+enum class FileCheckResult
+{
+	Ok,
+	Missing,	// may have been moved
+	Invalid,
+};
+
 // Check if a file exists and is still in a media directory
-static bool
+static FileCheckResult
 checkFile(const std::filesystem::path& p, const std::filesystem::path& mediaDirectory, const std::vector<std::filesystem::path>& extensions)
 {
 	try
@@ -924,28 +1114,27 @@ checkFile(const std::filesystem::path& p, const std::filesystem::path& mediaDire
 		if (!std::filesystem::exists( p )
 			|| !std::filesystem::is_regular_file( p ) )
 		{
-			LMS_LOG(DBUPDATER, INFO) << "Removing '" << p.string() << "': missing";
-			return false;
+			return FileCheckResult::Missing;
 		}
 
 		if (!isPathInMediaDirectory(p, mediaDirectory))
 		{
 			LMS_LOG(DBUPDATER, INFO) << "Removing '" << p.string() << "': out of media directory";
-			return false;
+			return FileCheckResult::Invalid;
 		}
 
 		if (!isFileSupported(p, extensions))
 		{
 			LMS_LOG(DBUPDATER, INFO) << "Removing '" << p.string() << "': file format no longer handled";
-			return false;
+			return FileCheckResult::Invalid;
 		}
 
-		return true;
+		return FileCheckResult::Ok;
 	}
 	catch (std::filesystem::filesystem_error& e)
 	{
 		LMS_LOG(DBUPDATER, ERROR) << "Caught exception while checking file '" << p.string() << "': " << e.what();
-		return false;
+		return FileCheckResult::Invalid;
 	}
 }
 
@@ -971,6 +1160,9 @@ ScannerService::removeMissingTracks(ScanStats& stats)
 	RangeResults<Track::PathResult> trackPaths;
 	std::vector<TrackId> tracksToRemove;
 
+	// Missing tracks are kept until the end of the media directory scan, in case they have just been moved
+	_missingTracks.clear();
+
 	for (std::size_t i {trackCount < batchSize ? 0 : trackCount - batchSize}; ; i -= (i > batchSize ? batchSize : i))
 	{
 		tracksToRemove.clear();
@@ -985,8 +1177,32 @@ ScannerService::removeMissingTracks(ScanStats& stats)
 			if (_abortScan)
 				return;
 
-			if (!checkFile(trackPath.path, _mediaDirectory, _fileExtensions))
-				tracksToRemove.push_back(trackPath.trackId);
+			switch (checkFile(trackPath.path, _mediaDirectory, _fileExtensions))
+			{
+				case FileCheckResult::Ok:
+					break;
+
+				case FileCheckResult::Missing:
+				{
+					auto transaction {_dbSession.createSharedTransaction()};
+
+					const Track::pointer track {Track::find(_dbSession, trackPath.trackId)};
+					if (track && track->getFingerprint() != 0)
+					{
+						_missingTracks.add(trackPath.trackId, trackPath.path, track->getFileSize(), track->getFingerprint());
+					}
+					else
+					{
+						LMS_LOG(DBUPDATER, INFO) << "Removing '" << trackPath.path.string() << "': missing";
+						tracksToRemove.push_back(trackPath.trackId);
+					}
+					break;
+				}
+
+				case FileCheckResult::Invalid:
+					tracksToRemove.push_back(trackPath.trackId);
+					break;
+			}
 
 			stepStats.processedElems++;
 		}
@@ -1015,6 +1231,39 @@ ScannerService::removeMissingTracks(ScanStats& stats)
 	LMS_LOG(DBUPDATER, DEBUG) << trackCount << " tracks checked!";
 }
 
+void
+ScannerService::removeUnmatchedMissingTracks(ScanStats& stats)
+{
+	static constexpr std::size_t batchSize {50};
+
+	if (_missingTracks.empty())
+		return;
+
+	LMS_LOG(DBUPDATER, DEBUG) << "Removing missing tracks...";
+
+	const std::vector<TrackId> trackIds {_missingTracks.getTrackIds()};
+	_missingTracks.clear();
+
+	for (std::size_t i {}; i < trackIds.size(); i += batchSize)
+	{
+		if (_abortScan)
+			return;
+
+		auto transaction {_dbSession.createUniqueTransaction()};
+
+		for (std::size_t j {i}; j < std::min(i + batchSize, trackIds.size()); ++j)
+		{
+			Track::pointer track {Track::find(_dbSession, trackIds[j])};
+			if (track)
+			{
+				LMS_LOG(DBUPDATER, INFO) << "Removing '" << track->getPath().string() << "': missing";
+				track.remove();
+				stats.deletions++;
+			}
+		}
+	}
+}
+
 void
 ScannerService::removeOrphanEntries()
 {
@@ -1058,6 +1307,18 @@ ScannerService::removeOrphanEntries()
 		}
 	}
 
+	LMS_LOG(DBUPDATER, DEBUG) << "Checking orphan tag cache entries...";
+	{
+		auto transaction {_dbSession.createUniqueTransaction()};
+
+		auto tagCacheEntryIds {TagCacheEntry::findOrphans(_dbSession, Range {})};
+		for (const TagCacheEntryId tagCacheEntryId : tagCacheEntryIds.results)
+		{
+			if (TagCacheEntry::pointer tagCacheEntry {TagCacheEntry::find(_dbSession, tagCacheEntryId)})
+				tagCacheEntry.remove();
+		}
+	}
+
 	LMS_LOG(DBUPDATER, INFO) << "Check audio files done!";
 }
 
@@ -1082,6 +1343,317 @@ ScannerService::checkDuplicatedAudioFiles(ScanStats& stats)
 	LMS_LOG(DBUPDATER, INFO) << "Checking duplicated audio files done!";
 }
 
+void
+ScannerService::resolveCoverSources(ScanStats& stats)
+{
+	static constexpr std::size_t batchSize {50};
+
+	ScanStepStats stepStats {stats.startTime, ScanProgressStep::ResolvingCovers};
+
+	LMS_LOG(DBUPDATER, INFO) << "Resolving cover sources...";
+
+	// Cover files may be added or removed without any change on tracks: only the directories changed since the last complete scan need to be checked again
+	std::optional<Wt::WDateTime> lastScanTime;
+	{
+		std::shared_lock lock {_statusMutex};
+		if (_lastCompleteScanStats)
+			lastScanTime = _lastCompleteScanStats->startTime;
+	}
+
+	std::map<std::filesystem::path, bool> changedDirectories;
+	auto hasDirectoryChanged {[&](const std::filesystem::path& directory)
+	{
+		if (!lastScanTime)
+			return true;
+
+		auto it {changedDirectories.find(directory)};
+		if (it == std::cend(changedDirectories))
+		{
+			bool changed {true};
+			try
+			{
+				changed = getLastWriteTime(directory) >= *lastScanTime;
+			}
+			catch (const LmsException& e)
+			{
+				LMS_LOG(DBUPDATER, ERROR) << e.what();
+			}
+
+			it = changedDirectories.emplace(directory, changed).first;
+		}
+
+		return it->second;
+	}};
+
+	// Resolved tracks: resolved again if a same named cover file may have been added, or if their cover file changed
+	// Their cover may change without any change on the track: count it to invalidate the clients caches
+	if (lastScanTime)
+	{
+		std::vector<TrackId> trackIds;
+		{
+			auto transaction {_dbSession.createSharedTransaction()};
+			trackIds = Track::findWithCoverSourceType(_dbSession, CoverSourceType::None, Range {}).results;
+
+			const RangeResults<TrackId> externalFileTrackIds {Track::findWithCoverSourceType(_dbSession, CoverSourceType::ExternalFile, Range {})};
+			trackIds.insert(std::end(trackIds), std::cbegin(externalFileTrackIds.results), std::cend(externalFileTrackIds.results));
+		}
+
+		struct ResolvedTrackCoverInfo
+		{
+			TrackId					trackId;
+			std::filesystem::path	path;
+			bool					hasCover;
+			CoverSource				coverSource;
+		};
+		std::vector<ResolvedTrackCoverInfo> outdatedTrackCoverInfos;
+
+		for (std::size_t offset {}; offset < trackIds.size() && !_abortScan; offset += batchSize)
+		{
+			outdatedTrackCoverInfos.clear();
+			{
+				auto transaction {_dbSession.createSharedTransaction()};
+
+				for (std::size_t i {offset}; i < std::min(offset + batchSize, trackIds.size()); ++i)
+				{
+					const Track::pointer track {Track::find(_dbSession, trackIds[i])};
+					if (!track)
+						continue;
+
+					CoverSource coverSource {track->getCoverSource()};
+					const bool outdated {coverSource.type == CoverSourceType::None ? hasDirectoryChanged(track->getPath().parent_path()) : !_coverSourceResolver->isCoverSourceUpToDate(coverSource)};
+					if (outdated)
+						outdatedTrackCoverInfos.push_back(ResolvedTrackCoverInfo {trackIds[i], track->getPath(), track->hasCover(), std::move(coverSource)});
+				}
+			}
+
+			std::vector<std::pair<TrackId, CoverSource>> changedCoverSources;
+			for (const ResolvedTrackCoverInfo& trackCoverInfo : outdatedTrackCoverInfos)
+			{
+				CoverSource coverSource {_coverSourceResolver->resolveTrackCoverSource(trackCoverInfo.path, trackCoverInfo.hasCover)};
+				if (coverSource != trackCoverInfo.coverSource)
+					changedCoverSources.emplace_back(trackCoverInfo.trackId, std::move(coverSource));
+			}
+
+			if (changedCoverSources.empty())
+				continue;
+
+			auto transaction {_dbSession.createUniqueTransaction()};
+			for (const auto& [trackId, coverSource] : changedCoverSources)
+			{
+				if (Track::pointer track {Track::find(_dbSession, trackId)})
+					track.modify()->setCoverSource(coverSource);
+			}
+			stats.coverChanges += changedCoverSources.size();
+		}
+	}
+
+	{
+		auto transaction {_dbSession.createSharedTransaction()};
+
+		stepStats.totalElems = Track::findWithCoverSourceType(_dbSession, CoverSourceType::Unknown, Range {}).results.size() + Release::getCount(_dbSession);
+	}
+	notifyInProgress(stepStats);
+
+	// Tracks: only the ones that have been scanned (or never resolved)
+	struct TrackCoverInfo
+	{
+		TrackId					trackId;
+		std::filesystem::path	path;
+		bool					hasCover;
+		CoverSource				coverSource;
+	};
+	std::vector<TrackCoverInfo> trackCoverInfos;
+
+	while (!_abortScan)
+	{
+		trackCoverInfos.clear();
+
+		{
+			auto transaction {_dbSession.createSharedTransaction()};
+
+			// resolved tracks are no longer returned
+			const RangeResults<TrackId> trackIds {Track::findWithCoverSourceType(_dbSession, CoverSourceType::Unknown, Range {0, batchSize})};
+			for (const TrackId trackId : trackIds.results)
+			{
+				const Track::pointer track {Track::find(_dbSession, trackId)};
+				trackCoverInfos.push_back(TrackCoverInfo {trackId, track->getPath(), track->hasCover(), {}});
+			}
+		}
+
+		if (trackCoverInfos.empty())
+			break;
+
+		for (TrackCoverInfo& trackCoverInfo : trackCoverInfos)
+			trackCoverInfo.coverSource = _coverSourceResolver->resolveTrackCoverSource(trackCoverInfo.path, trackCoverInfo.hasCover);
+
+		{
+			auto transaction {_dbSession.createUniqueTransaction()};
+
+			for (const TrackCoverInfo& trackCoverInfo : trackCoverInfos)
+			{
+				if (Track::pointer track {Track::find(_dbSession, trackCoverInfo.trackId)})
+					track.modify()->setCoverSource(trackCoverInfo.coverSource);
+			}
+		}
+
+		stepStats.processedElems += trackCoverInfos.size();
+		notifyInProgressIfNeeded(stepStats);
+	}
+
+	// Releases: checked again if their directories or first track changed, or if the cover file changed
+	struct ReleaseCoverInfo
+	{
+		ReleaseId				releaseId;
+		std::filesystem::path	firstTrackPath;
+		bool					firstTrackHasCover;
+		Wt::WDateTime			firstTrackLastWriteTime;
+		bool					isMultiDisc;
+		CoverSource				coverSource;
+	};
+
+	auto isReleaseCoverSourceUpToDate {[&](const ReleaseCoverInfo& releaseCoverInfo)
+	{
+		if (!lastScanTime || releaseCoverInfo.firstTrackLastWriteTime >= *lastScanTime)
+			return false;
+
+		const std::filesystem::path directory {releaseCoverInfo.firstTrackPath.parent_path()};
+		if (hasDirectoryChanged(directory))
+			return false;
+
+		if (releaseCoverInfo.isMultiDisc && directory.has_parent_path() && hasDirectoryChanged(directory.parent_path()))
+			return false;
+
+		return _coverSourceResolver->isCoverSourceUpToDate(releaseCoverInfo.coverSource);
+	}};
+	std::vector<ReleaseCoverInfo> releaseCoverInfos;
+
+	for (std::size_t offset {}; !_abortScan; offset += batchSize)
+	{
+		releaseCoverInfos.clear();
+
+		bool moreResults {};
+		{
+			auto transaction {_dbSession.createSharedTransaction()};
+
+			const RangeResults<ReleaseId> releaseIds {Release::find(_dbSession, Release::FindParameters {}.setRange(Range {offset, batchSize}))};
+			moreResults = releaseIds.moreResults;
+
+			for (const ReleaseId releaseId : releaseIds.results)
+			{
+				const Release::pointer release {Release::find(_dbSession, releaseId)};
+				const auto tracks {Track::find(_dbSession, Track::FindParameters {}.setRelease(releaseId).setRange({0, 1}).setSortMethod(TrackSortMethod::Release))};
+				if (tracks.results.empty())
+					continue;
+
+				const Track::pointer firstTrack {Track::find(_dbSession, tracks.results.front())};
+				releaseCoverInfos.push_back(ReleaseCoverInfo {releaseId, firstTrack->getPath(), firstTrack->hasCover(), firstTrack->getLastWriteTime(), release->getTotalDisc() > 1, release->getCoverSource()});
+			}
+		}
+
+		std::vector<std::pair<ReleaseId, CoverSource>> changedCoverSources;
+		for (const ReleaseCoverInfo& releaseCoverInfo : releaseCoverInfos)
+		{
+			if (isReleaseCoverSourceUpToDate(releaseCoverInfo))
+				continue;
+
+			CoverSource coverSource {_coverSourceResolver->resolveReleaseCoverSource(releaseCoverInfo.firstTrackPath, releaseCoverInfo.firstTrackHasCover, releaseCoverInfo.isMultiDisc)};
+			if (coverSource != releaseCoverInfo.coverSource)
+				changedCoverSources.emplace_back(releaseCoverInfo.releaseId, std::move(coverSource));
+		}
+
+		if (!changedCoverSources.empty())
+		{
+			auto transaction {_dbSession.createUniqueTransaction()};
+
+			for (const auto& [releaseId, coverSource] : changedCoverSources)
+			{
+				if (Release::pointer release {Release::find(_dbSession, releaseId)})
+					release.modify()->setCoverSource(coverSource);
+			}
+			stats.coverChanges += changedCoverSources.size();
+		}
+
+		stepStats.processedElems += releaseCoverInfos.size();
+		notifyInProgressIfNeeded(stepStats);
+
+		if (!moreResults)
+			break;
+	}
+
+	notifyInProgress(stepStats);
+	LMS_LOG(DBUPDATER, INFO) << "Cover sources resolved!";
+}
+
+void
+ScannerService::generateCoverThumbnails(ScanStats& stats)
+{
+	static constexpr std::size_t batchSize {50};
+
+	Cover::ICoverService* coverService {Service<Cover::ICoverService>::get()};
+	if (!coverService || !coverService->isThumbnailGenerationEnabled())
+		return;
+
+	ScanStepStats stepStats {stats.startTime, ScanProgressStep::GeneratingThumbnails};
+
+	LMS_LOG(DBUPDATER, INFO) << "Generating cover thumbnails...";
+
+	{
+		auto transaction {_dbSession.createSharedTransaction()};
+
+		stepStats.totalElems = Release::getCount(_dbSession);
+	}
+	notifyInProgress(stepStats);
+
+	// Only release covers: this is what the UI and the Subsonic clients ask for most of the time
+	// Tracks sharing the cover of their release also benefit from it, since thumbnails are keyed by cover source
+	std::vector<CoverSource> activeCoverSources;
+	for (std::size_t offset {}; !_abortScan; offset += batchSize)
+	{
+		std::vector<CoverSource> coverSources;
+
+		bool moreResults {};
+		std::size_t releaseCount {};
+		{
+			auto transaction {_dbSession.createSharedTransaction()};
+
+			const RangeResults<ReleaseId> releaseIds {Release::find(_dbSession, Release::FindParameters {}.setRange(Range {offset, batchSize}))};
+			moreResults = releaseIds.moreResults;
+			releaseCount = releaseIds.results.size();
+
+			for (const ReleaseId releaseId : releaseIds.results)
+			{
+				const Release::pointer release {Release::find(_dbSession, releaseId)};
+				CoverSource coverSource {release->getCoverSource()};
+				if (coverSource.type == CoverSourceType::Embedded || coverSource.type == CoverSourceType::ExternalFile)
+					coverSources.push_back(std::move(coverSource));
+			}
+		}
+
+		for (const CoverSource& coverSource : coverSources)
+		{
+			if (_abortScan)
+				break;
+
+			coverService->generateThumbnails(coverSource);
+		}
+
+		activeCoverSources.insert(std::end(activeCoverSources), std::make_move_iterator(std::begin(coverSources)), std::make_move_iterator(std::end(coverSources)));
+
+		stepStats.processedElems += releaseCount;
+		notifyInProgressIfNeeded(stepStats);
+
+		if (!moreResults)
+			break;
+	}
+
+	// Partial pass: we do not know what is outdated
+	if (!_abortScan)
+		coverService->removeOutdatedThumbnails(activeCoverSources);
+
+	notifyInProgress(stepStats);
+	LMS_LOG(DBUPDATER, INFO) << "Cover thumbnails generated!";
+}
+
 void
 ScannerService::reloadSimilarityEngine(ScanStats& stats)
 {
@@ -1099,4 +1671,27 @@ ScannerService::reloadSimilarityEngine(ScanStats& stats)
 	notifyInProgress(stepStats);
 }
 
+void
+ScannerService::updateLibraryGeneration(const ScanStats& stats)
+{
+	if (stats.nbChanges() == 0 && stats.coverChanges == 0)
+		return;
+
+	LibraryGeneration libraryGeneration;
+	{
+		auto transaction {_dbSession.createUniqueTransaction()};
+
+		ScanSettings::pointer scanSettings {ScanSettings::get(_dbSession)};
+		scanSettings.modify()->incLibraryGeneration();
+
+		libraryGeneration.value = scanSettings->getLibraryGeneration();
+		libraryGeneration.lastModified = scanSettings->getLibraryLastModified();
+	}
+
+	LMS_LOG(DBUPDATER, DEBUG) << "Library generation is now " << libraryGeneration.value;
+
+	std::unique_lock lock {_statusMutex};
+	_libraryGeneration = libraryGeneration;
+}
+
 } // namespace Scanner
@@ -20,8 +20,10 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <shared_mutex>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include <Wt/WDateTime.h>
@@ -34,11 +36,18 @@
 #include "services/database/ScanSettings.hpp"
 #include "services/database/Session.hpp"
 #include "metadata/IParser.hpp"
+#include "services/cover/ICoverSourceResolver.hpp"
 #include "services/scanner/IScannerService.hpp"
 #include "utils/Path.hpp"
+#include "MissingTracks.hpp"
 
 class UUID;
 
+namespace AcousticBrainz
+{
+	struct RecordingFeatures;
+}
+
 namespace Recommendation
 {
 	class IRecommendationService;
@@ -61,6 +70,7 @@ namespace Scanner
 			void requestImmediateScan(bool force) override;
 
 			Status	getStatus() const override;
+			LibraryGeneration getLibraryGeneration() const override;
 			Events&	getEvents() override { return _events; }
 
 		private:
@@ -77,20 +87,26 @@ namespace Scanner
 			void scan(bool force);
 
 			void scanMediaDirectory( const std::filesystem::path& mediaDirectory, bool forceScan, ScanStats& stats);
-			bool fetchTrackFeatures(Database::TrackId trackId, const UUID& MBID);
 			void fetchTrackFeatures(ScanStats& stats);
+			void storeTrackFeatures(const std::unordered_map<std::string, std::vector<Database::TrackId>>& tracksByRecordingMBID, const std::vector<AcousticBrainz::RecordingFeatures>& features, ScanStats& stats);
 
 			// Helpers
 			void refreshScanSettings();
 
 			void countAllFiles(ScanStats& stats);
 			void removeMissingTracks(ScanStats& stats);
+			void removeUnmatchedMissingTracks(ScanStats& stats);
 			void removeOrphanEntries();
 			void checkDuplicatedAudioFiles(ScanStats& stats);
+			void resolveCoverSources(ScanStats& stats);
+			void generateCoverThumbnails(ScanStats& stats);
+			std::optional<MetaData::RawTrack> getCachedRawTrack(const std::filesystem::path& file, std::uintmax_t fileSize, const Wt::WDateTime& lastWriteTime);
+			bool reconcileMovedTrack(const std::filesystem::path& file, std::uintmax_t fileSize, std::uint64_t fingerprint, const Wt::WDateTime& lastWriteTime);
 			void scanAudioFile(const std::filesystem::path& file, bool forceScan, ScanStats& stats);
 			void notifyInProgressIfNeeded(const ScanStepStats& stats);
 			void notifyInProgress(const ScanStepStats& stats);
 			void reloadSimilarityEngine(ScanStats& stats);
+			void updateLibraryGeneration(const ScanStats& stats);
 
 			Recommendation::IRecommendationService&	_recommendationService;
 
@@ -103,12 +119,16 @@ namespace Scanner
 			std::chrono::system_clock::time_point	_lastScanInProgressEmit {};
 			Database::Session						_dbSession;
 			std::unique_ptr<MetaData::IParser>		_metadataParser;
+			std::unique_ptr<Cover::ICoverSourceResolver>	_coverSourceResolver;
 
 			mutable std::shared_mutex			_statusMutex;
 			State								_curState {State::NotScheduled};
 			std::optional<ScanStats> 			_lastCompleteScanStats;
 			std::optional<ScanStepStats> 		_currentScanStepStats;
 			Wt::WDateTime						_nextScheduledScan;
+			LibraryGeneration					_libraryGeneration;
+
+			MissingTracks							_missingTracks;
 
 			// Current scan settings
 			std::size_t				_scanVersion {};
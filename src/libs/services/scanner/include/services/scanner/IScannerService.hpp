@@ -63,6 +63,15 @@ namespace Scanner
 
 			virtual Status getStatus() const = 0;
 
+			// Incremented each time a scan changes the library contents
+			struct LibraryGeneration
+			{
+				std::size_t		value {};
+				Wt::WDateTime	lastModified;
+			};
+
+			virtual LibraryGeneration getLibraryGeneration() const = 0;
+
 			virtual Events& getEvents() = 0;
 	};
 
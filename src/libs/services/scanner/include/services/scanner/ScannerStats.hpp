@@ -62,10 +62,12 @@ namespace Scanner
 		ChekingForMissingFiles = 0,
 		DiscoveringFiles,
 		ScanningFiles,
+		ResolvingCovers,
+		GeneratingThumbnails,
 		FetchingTrackFeatures,
 		ReloadingSimilarityEngine,
 	};
-	static inline constexpr unsigned ScanProgressStepCount {5};
+	static inline constexpr unsigned ScanProgressStepCount {7};
 
 	// reduced scan stats
 	struct ScanStepStats
@@ -95,6 +97,7 @@ namespace Scanner
 		std::size_t	updates {};			// updated file in DB
 
 		std::size_t	featuresFetched {};	// features fetched in DB
+		std::size_t	coverChanges {};	// release cover sources changed in DB
 
 		std::vector<ScanError>		errors;
 		std::vector<ScanDuplicate>	duplicates;
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "MissingTracks.hpp"
+
+using namespace Scanner;
+using namespace Database;
+
+namespace
+{
+	class ScopedFile
+	{
+		public:
+			ScopedFile(const std::string& content)
+				: _path {std::tmpnam(nullptr)}
+			{
+				write(content);
+			}
+
+			~ScopedFile()
+			{
+				std::filesystem::remove(_path);
+			}
+
+			ScopedFile(const ScopedFile&) = delete;
+			ScopedFile& operator=(const ScopedFile&) = delete;
+
+			void write(const std::string& content)
+			{
+				std::ofstream ofs {_path, std::ios::binary | std::ios::trunc};
+				ofs << content;
+			}
+
+			const std::filesystem::path& getPath() const { return _path; }
+			std::uint64_t getFingerprint() const { return computeFingerprint(_path, std::filesystem::file_size(_path)).value(); }
+
+		private:
+			std::filesystem::path _path;
+	};
+
+	std::string generateContent(std::size_t size, unsigned seed)
+	{
+		std::string content(size, '\0');
+		for (std::size_t i {}; i < size; ++i)
+			content[i] = static_cast<char>((i * 31 + seed) % 251);
+
+		return content;
+	}
+}
+
+TEST(Fingerprint, sameContent)
+{
+	const std::string content {generateContent(256 * 1024, 0)};
+	ScopedFile file1 {content};
+	ScopedFile file2 {content};
+
+	EXPECT_EQ(file1.getFingerprint(), file2.getFingerprint());
+	EXPECT_NE(file1.getFingerprint(), 0);
+}
+
+TEST(Fingerprint, modifiedContent)
+{
+	const std::string content {generateContent(256 * 1024, 0)};
+	ScopedFile file {content};
+	const std::uint64_t fingerprint {file.getFingerprint()};
+
+	// Modify a byte in the middle of the file, sampled by the fingerprint
+	std::string modifiedContent {content};
+	modifiedContent[content.size() / 2] ^= 0xFF;
+	file.write(modifiedContent);
+	EXPECT_NE(file.getFingerprint(), fingerprint);
+
+	// Same sampled blocks, but different size (ex: tags rewritten)
+	file.write(content + "TAG");
+	EXPECT_NE(file.getFingerprint(), fingerprint);
+}
+
+TEST(Fingerprint, smallFiles)
+{
+	ScopedFile emptyFile {""};
+	ScopedFile smallFile1 {"abc"};
+	ScopedFile smallFile2 {"abd"};
+
+	EXPECT_NE(emptyFile.getFingerprint(), 0);
+	EXPECT_NE(smallFile1.getFingerprint(), smallFile2.getFingerprint());
+}
+
+TEST(Fingerprint, missingFile)
+{
+	EXPECT_FALSE(computeFingerprint("/this/file/does/not/exist.mp3", 1024));
+}
+
+TEST(MissingTracks, sameFileMoved)
+{
+	const std::string content {generateContent(128 * 1024, 0)};
+	ScopedFile file {content};
+	const std::uintmax_t fileSize {content.size()};
+
+	MissingTracks missingTracks;
+	missingTracks.add(TrackId {1}, "/music/Artist/Album/01 - Track.mp3", fileSize, file.getFingerprint());
+	EXPECT_FALSE(missingTracks.empty());
+
+	const std::optional<TrackId> trackId {missingTracks.match("/music/Other/Album/01 - Track.mp3", fileSize, file.getFingerprint())};
+	ASSERT_TRUE(trackId);
+	EXPECT_EQ(*trackId, TrackId {1});
+	EXPECT_TRUE(missingTracks.empty());
+
+	// Already matched
+	EXPECT_FALSE(missingTracks.match("/music/Other2/Album/01 - Track.mp3", fileSize, file.getFingerprint()));
+}
+
+TEST(MissingTracks, fileModifiedWhileMoved)
+{
+	const std::string content {generateContent(128 * 1024, 0)};
+	ScopedFile file {content};
+	const std::uint64_t fingerprint {file.getFingerprint()};
+
+	MissingTracks missingTracks;
+	missingTracks.add(TrackId {1}, "/music/Artist/Album/01 - Track.mp3", content.size(), fingerprint);
+
+	{
+		std::string modifiedContent {content};
+		modifiedContent[content.size() / 4] ^= 0xFF;
+		file.write(modifiedContent);
+
+		EXPECT_FALSE(missingTracks.match("/music/Other/Album/01 - Track.mp3", modifiedContent.size(), file.getFingerprint()));
+	}
+
+	{
+		const std::string modifiedContent {content + "TAG"};
+		file.write(modifiedContent);
+
+		EXPECT_FALSE(missingTracks.match("/music/Other/Album/01 - Track.mp3", modifiedContent.size(), file.getFingerprint()));
+	}
+
+	EXPECT_EQ(missingTracks.getTrackIds(), std::vector<TrackId> {TrackId {1}});
+}
+
+TEST(MissingTracks, identicalFiles)
+{
+	const std::string content {generateContent(128 * 1024, 0)};
+	ScopedFile file {content};
+	const std::uintmax_t fileSize {content.size()};
+	const std::uint64_t fingerprint {file.getFingerprint()};
+
+	// Whatever the insertion and scan orders, each moved file keeps its own id
+	for (const bool reverseInsertion : {false, true})
+	{
+		MissingTracks missingTracks;
+		if (!reverseInsertion)
+		{
+			missingTracks.add(TrackId {1}, "/music/Album1/Silence.mp3", fileSize, fingerprint);
+			missingTracks.add(TrackId {2}, "/music/Album2/Silence.mp3", fileSize, fingerprint);
+			missingTracks.add(TrackId {3}, "/music/Album3/Intro.mp3", fileSize, fingerprint);
+		}
+		else
+		{
+			missingTracks.add(TrackId {3}, "/music/Album3/Intro.mp3", fileSize, fingerprint);
+			missingTracks.add(TrackId {2}, "/music/Album2/Silence.mp3", fileSize, fingerprint);
+			missingTracks.add(TrackId {1}, "/music/Album1/Silence.mp3", fileSize, fingerprint);
+		}
+		EXPECT_EQ(missingTracks.getTrackIds(), (std::vector<TrackId> {TrackId {1}, TrackId {2}, TrackId {3}}));
+
+		EXPECT_EQ(missingTracks.match("/music/Artist/Album2/Silence.mp3", fileSize, fingerprint), TrackId {2});
+		EXPECT_EQ(missingTracks.match("/music/Artist/Album3/Intro.mp3", fileSize, fingerprint), TrackId {3});
+		EXPECT_EQ(missingTracks.match("/music/Artist/Album1/Silence.mp3", fileSize, fingerprint), TrackId {1});
+		EXPECT_TRUE(missingTracks.empty());
+	}
+
+	// No name in common: lowest id first
+	for (const bool reverseInsertion : {false, true})
+	{
+		MissingTracks missingTracks;
+		missingTracks.add(TrackId {reverseInsertion ? 2 : 1}, "/music/Album/Silence.mp3", fileSize, fingerprint);
+		missingTracks.add(TrackId {reverseInsertion ? 1 : 2}, "/music/Album/Silence.mp3", fileSize, fingerprint);
+
+		EXPECT_EQ(missingTracks.match("/other/Foo.mp3", fileSize, fingerprint), TrackId {1});
+		EXPECT_EQ(missingTracks.match("/other/Bar.mp3", fileSize, fingerprint), TrackId {2});
+	}
+}
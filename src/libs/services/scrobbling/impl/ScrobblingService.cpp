@@ -30,7 +30,9 @@
 #include "services/database/StarredTrack.hpp"
 #include "services/database/Track.hpp"
 #include "services/database/User.hpp"
+#include "utils/IConfig.hpp"
 #include "utils/Logger.hpp"
+#include "utils/Service.hpp"
 
 #include "internal/InternalScrobbler.hpp"
 #include "listenbrainz/ListenBrainzScrobbler.hpp"
@@ -47,9 +49,10 @@ namespace Scrobbling
 
 	ScrobblingService::ScrobblingService(boost::asio::io_context& ioContext, Db& db)
 		: _db {db}
+		, _internalScrobbleQueue {ioContext, db, Service<IConfig>::get()->getPath("working-dir") / "scrobble.journal"}
 	{
 		LMS_LOG(SCROBBLING, INFO) << "Starting service...";
-		_scrobblers.emplace(Scrobbler::Internal, std::make_unique<InternalScrobbler>(_db));
+		_scrobblers.emplace(Scrobbler::Internal, std::make_unique<InternalScrobbler>(_db, _internalScrobbleQueue));
 		_scrobblers.emplace(Scrobbler::ListenBrainz, std::make_unique<ListenBrainz::Scrobbler>(ioContext, _db));
 		LMS_LOG(SCROBBLING, INFO) << "Service started!";
 	}
@@ -85,10 +88,9 @@ namespace Scrobbling
 	{
 		std::optional<Scrobbler> scrobbler;
 
-		Session& session {_db.getTLSSession()};
-		auto transaction {session.createSharedTransaction()};
-		if (const User::pointer user {User::find(session, userId)})
-			scrobbler = user->getScrobbler();
+		const auto users {_db.getTLSSession().getUserSettingsSnapshot()};
+		if (const UserSettings* user {users->find(userId)})
+			scrobbler = user->scrobbler;
 
 		return scrobbler;
 	}
@@ -208,6 +210,39 @@ namespace Scrobbling
 		return isStarred<Artist, ArtistId, StarredArtist>(userId, artistId);
 	}
 
+	std::unordered_set<ArtistId>
+	ScrobblingService::findStarredArtists(UserId userId, const std::vector<ArtistId>& artistIds)
+	{
+		auto scrobbler {getUserScrobbler(userId)};
+		if (!scrobbler)
+			return {};
+
+		std::unordered_set<ArtistId> res;
+		{
+			Session& session {_db.getTLSSession()};
+			auto transaction {session.createSharedTransaction()};
+
+			const std::vector<ArtistId> starredArtistIds {StarredArtist::findStarredArtists(session, artistIds, userId, *scrobbler)};
+			res.insert(std::cbegin(starredArtistIds), std::cend(starredArtistIds));
+		}
+
+		if (*scrobbler == Scrobbler::Internal)
+		{
+			for (const ArtistId artistId : artistIds)
+			{
+				if (const std::optional<bool> pendingStarred {_internalScrobbleQueue.getPendingStarred(userId, artistId)})
+				{
+					if (*pendingStarred)
+						res.insert(artistId);
+					else
+						res.erase(artistId);
+				}
+			}
+		}
+
+		return res;
+	}
+
 	ScrobblingService::ArtistContainer
 	ScrobblingService::getStarredArtists(UserId userId, const std::vector<ClusterId>& clusterIds,
 										std::optional<TrackArtistLinkType> linkType,
@@ -25,6 +25,7 @@
 
 #include "services/scrobbling/IScrobblingService.hpp"
 #include "IScrobbler.hpp"
+#include "internal/ScrobbleQueue.hpp"
 
 namespace Scrobbling
 {
@@ -68,6 +69,7 @@ namespace Scrobbling
 			void star(Database::UserId userId, Database::ArtistId artistId) override;
 			void unstar(Database::UserId userId, Database::ArtistId artistId) override;
 			bool isStarred(Database::UserId userId, Database::ArtistId artistId) override;
+			std::unordered_set<Database::ArtistId> findStarredArtists(Database::UserId userId, const std::vector<Database::ArtistId>& artistIds) override;
 			ArtistContainer	getStarredArtists(Database::UserId userId,
 														const std::vector<Database::ClusterId>& clusterIds,
 														std::optional<Database::TrackArtistLinkType> linkType,
@@ -94,6 +96,7 @@ namespace Scrobbling
 			bool isStarred(Database::UserId userId, ObjIdType id);
 
 			Database::Db& _db;
+			ScrobbleQueue _internalScrobbleQueue; // must outlive the scrobblers
 			std::unordered_map<Database::Scrobbler, std::unique_ptr<IScrobbler>> _scrobblers;
 	};
 
@@ -35,6 +35,12 @@ namespace Scrobbling
 		if (!scrobbler)
 			return;
 
+		if (*scrobbler == Scrobbler::Internal)
+		{
+			_internalScrobbleQueue.setStarred(userId, objId, true);
+			return;
+		}
+
 		typename StarredObjType::IdType starredObjId;
 		{
 			Session& session {_db.getTLSSession()};
@@ -67,6 +73,12 @@ namespace Scrobbling
 		if (!scrobbler)
 			return;
 
+		if (*scrobbler == Scrobbler::Internal)
+		{
+			_internalScrobbleQueue.setStarred(userId, objId, false);
+			return;
+		}
+
 		typename StarredObjType::IdType starredObjId;
 		{
 			Session& session {_db.getTLSSession()};
@@ -89,6 +101,12 @@ namespace Scrobbling
 		if (!scrobbler)
 			return false;
 
+		if (*scrobbler == Scrobbler::Internal)
+		{
+			if (const std::optional<bool> pendingStarred {_internalScrobbleQueue.getPendingStarred(userId, objId)})
+				return *pendingStarred;
+		}
+
 		Session& session {_db.getTLSSession()};
 		auto transaction {session.createSharedTransaction()};
 
@@ -27,6 +27,7 @@
 #include "services/database/StarredTrack.hpp"
 #include "services/database/Track.hpp"
 #include "services/database/User.hpp"
+#include "ScrobbleQueue.hpp"
 
 namespace
 {
@@ -51,8 +52,9 @@ namespace
 
 namespace Scrobbling
 {
-	InternalScrobbler::InternalScrobbler(Database::Db& db)
+	InternalScrobbler::InternalScrobbler(Database::Db& db, ScrobbleQueue& queue)
 		: _db {db}
+		, _queue {queue}
 	{}
 
 	void
@@ -74,22 +76,7 @@ namespace Scrobbling
 	void
 	InternalScrobbler::addTimedListen(const TimedListen& listen)
 	{
-		Database::Session& session {_db.getTLSSession()};
-		auto transaction {session.createUniqueTransaction()};
-
-		if (Database::Listen::find(session, listen.userId, listen.trackId, Database::Scrobbler::Internal, listen.listenedAt))
-			return;
-
-		const Database::User::pointer user {Database::User::find(session, listen.userId)};
-		if (!user)
-			return;
-
-		const Database::Track::pointer track {Database::Track::find(session, listen.trackId)};
-		if (!track)
-			return;
-
-		auto dbListen {session.create<Database::Listen>(user, track, Database::Scrobbler::Internal, listen.listenedAt)};
-		dbListen.modify()->setScrobblingState(Database::ScrobblingState::Synchronized);
+		_queue.addListen(listen.userId, listen.trackId, listen.listenedAt);
 	}
 
 	void
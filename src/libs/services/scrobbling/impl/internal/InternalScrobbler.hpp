@@ -28,10 +28,12 @@ namespace Database
 
 namespace Scrobbling
 {
+	class ScrobbleQueue;
+
 	class InternalScrobbler final : public IScrobbler
 	{
 		public:
-			InternalScrobbler(Database::Db&	db);
+			InternalScrobbler(Database::Db&	db, ScrobbleQueue& queue);
 
 		private:
 			// IScrobbler
@@ -47,6 +49,7 @@ namespace Scrobbling
  			void onUnstarred(Database::StarredTrackId) override;
 
 			Database::Db&			_db;
+			ScrobbleQueue&			_queue;
 	};
 } // Scrobbling
 
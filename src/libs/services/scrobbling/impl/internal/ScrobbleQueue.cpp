@@ -0,0 +1,547 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ScrobbleQueue.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <boost/asio/bind_executor.hpp>
+
+#include "services/database/Artist.hpp"
+#include "services/database/Db.hpp"
+#include "services/database/Listen.hpp"
+#include "services/database/Release.hpp"
+#include "services/database/Session.hpp"
+#include "services/database/StarredArtist.hpp"
+#include "services/database/StarredRelease.hpp"
+#include "services/database/StarredTrack.hpp"
+#include "services/database/Track.hpp"
+#include "services/database/User.hpp"
+#include "utils/Logger.hpp"
+#include "utils/String.hpp"
+
+namespace Scrobbling
+{
+	namespace
+	{
+		char
+		objectTypeToChar(ScrobbleQueue::ObjectType objectType)
+		{
+			switch (objectType)
+			{
+				case ScrobbleQueue::ObjectType::Artist: return 'a';
+				case ScrobbleQueue::ObjectType::Release: return 'r';
+				case ScrobbleQueue::ObjectType::Track: return 't';
+			}
+			return '?';
+		}
+
+		std::optional<ScrobbleQueue::ObjectType>
+		objectTypeFromString(std::string_view str)
+		{
+			if (str == "a")
+				return ScrobbleQueue::ObjectType::Artist;
+			if (str == "r")
+				return ScrobbleQueue::ObjectType::Release;
+			if (str == "t")
+				return ScrobbleQueue::ObjectType::Track;
+
+			return std::nullopt;
+		}
+
+		long long
+		dateTimeToMs(const Wt::WDateTime& dateTime)
+		{
+			return std::chrono::duration_cast<std::chrono::milliseconds>(dateTime.toTimePoint().time_since_epoch()).count();
+		}
+
+		Wt::WDateTime
+		dateTimeFromMs(long long ms)
+		{
+			return Wt::WDateTime::fromTimePoint(std::chrono::system_clock::time_point {std::chrono::milliseconds {ms}});
+		}
+
+		template <typename ObjType, typename StarredObjType>
+		void
+		writeStarEvent(Database::Session& session, const Database::User::pointer& user, const ScrobbleQueue::StarEvent& event)
+		{
+			using namespace Database;
+
+			const typename ObjType::IdType objId {event.objectId};
+			typename StarredObjType::pointer starredObj {StarredObjType::find(session, objId, user->getId(), Scrobbler::Internal)};
+
+			if (!event.starred)
+			{
+				if (starredObj)
+					starredObj.remove();
+				return;
+			}
+
+			if (!starredObj)
+			{
+				const typename ObjType::pointer obj {ObjType::find(session, objId)};
+				if (!obj)
+					return;
+
+				starredObj = session.create<StarredObjType>(obj, user, Scrobbler::Internal);
+			}
+			starredObj.modify()->setDateTime(event.dateTime);
+			starredObj.modify()->setScrobblingState(ScrobblingState::Synchronized);
+		}
+	}
+
+	ScrobbleQueue::ScrobbleQueue(boost::asio::io_context& ioContext, Database::Db& db, const std::filesystem::path& journalPath)
+		: _db {db}
+		, _strand {ioContext}
+		, _flushTimer {ioContext}
+		, _journalPath {journalPath}
+	{
+		loadJournal();
+
+		_journal.open(_journalPath, std::ios::app);
+		if (!_journal)
+			LMS_LOG(SCROBBLING, ERROR) << "Cannot open scrobble journal '" << _journalPath.string() << "': queued events will not survive a restart";
+
+		if (!_events.empty())
+		{
+			LMS_LOG(SCROBBLING, INFO) << "Replaying " << _events.size() << " events from scrobble journal";
+			std::scoped_lock lock {_mutex};
+			scheduleFlush();
+		}
+	}
+
+	ScrobbleQueue::~ScrobbleQueue()
+	{
+		{
+			// waits for any running timer handler
+			std::scoped_lock lifetimeLock {_lifetime->mutex};
+			_lifetime->alive = false;
+		}
+
+		{
+			std::scoped_lock lock {_mutex};
+			_flushTimer.cancel();
+		}
+
+		flush();
+	}
+
+	void
+	ScrobbleQueue::addListen(Database::UserId userId, Database::TrackId trackId, const Wt::WDateTime& dateTime)
+	{
+		enqueue(ListenEvent {userId, trackId, dateTime});
+	}
+
+	void
+	ScrobbleQueue::setStarred(Database::UserId userId, Database::ArtistId artistId, bool starred)
+	{
+		setStarred(ObjectType::Artist, userId, artistId.getValue(), starred);
+	}
+
+	void
+	ScrobbleQueue::setStarred(Database::UserId userId, Database::ReleaseId releaseId, bool starred)
+	{
+		setStarred(ObjectType::Release, userId, releaseId.getValue(), starred);
+	}
+
+	void
+	ScrobbleQueue::setStarred(Database::UserId userId, Database::TrackId trackId, bool starred)
+	{
+		setStarred(ObjectType::Track, userId, trackId.getValue(), starred);
+	}
+
+	void
+	ScrobbleQueue::setStarred(ObjectType objectType, Database::UserId userId, Database::IdType::ValueType objectId, bool starred)
+	{
+		enqueue(StarEvent {objectType, userId, objectId, starred, Wt::WDateTime::currentDateTime()});
+	}
+
+	std::optional<bool>
+	ScrobbleQueue::getPendingStarred(Database::UserId userId, Database::ArtistId artistId) const
+	{
+		return getPendingStarred(ObjectType::Artist, userId, artistId.getValue());
+	}
+
+	std::optional<bool>
+	ScrobbleQueue::getPendingStarred(Database::UserId userId, Database::ReleaseId releaseId) const
+	{
+		return getPendingStarred(ObjectType::Release, userId, releaseId.getValue());
+	}
+
+	std::optional<bool>
+	ScrobbleQueue::getPendingStarred(Database::UserId userId, Database::TrackId trackId) const
+	{
+		return getPendingStarred(ObjectType::Track, userId, trackId.getValue());
+	}
+
+	std::optional<bool>
+	ScrobbleQueue::getPendingStarred(ObjectType objectType, Database::UserId userId, Database::IdType::ValueType objectId) const
+	{
+		std::scoped_lock lock {_mutex};
+
+		const auto itPendingStar {_pendingStars.find(StarKey {objectType, userId.getValue(), objectId})};
+		if (itPendingStar == std::cend(_pendingStars))
+			return std::nullopt;
+
+		return itPendingStar->second.first;
+	}
+
+	void
+	ScrobbleQueue::enqueue(const Event& event)
+	{
+		std::scoped_lock lock {_mutex};
+
+		if (_journal)
+			_journal << eventToString(event) << std::endl;
+
+		_events.push_back(event);
+		_lastSeq++;
+		if (const StarEvent* starEvent {std::get_if<StarEvent>(&event)})
+			_pendingStars[StarKey {starEvent->objectType, starEvent->userId.getValue(), starEvent->objectId}] = {starEvent->starred, _lastSeq};
+
+		scheduleFlush();
+	}
+
+	void
+	ScrobbleQueue::scheduleFlush()
+	{
+		if (_flushScheduled)
+			return;
+
+		_flushScheduled = true;
+		_flushTimer.expires_after(getFlushDelay());
+		_flushTimer.async_wait(boost::asio::bind_executor(_strand, [this, lifetime = _lifetime](const boost::system::error_code& ec)
+		{
+			if (ec == boost::asio::error::operation_aborted)
+				return;
+
+			// cancel() does not prevent an already completed wait from running
+			std::scoped_lock lifetimeLock {lifetime->mutex};
+			if (!lifetime->alive)
+				return;
+
+			{
+				std::scoped_lock lock {_mutex};
+				_flushScheduled = false;
+			}
+			flush();
+		}));
+	}
+
+	std::chrono::seconds
+	ScrobbleQueue::getFlushDelay() const
+	{
+		std::chrono::seconds delay {_flushDelay};
+		for (std::size_t i {}; i < _failedFlushCount && delay < _maxFlushRetryDelay; ++i)
+			delay *= 2;
+
+		return std::min(delay, _maxFlushRetryDelay);
+	}
+
+	void
+	ScrobbleQueue::flush()
+	{
+		std::scoped_lock flushLock {_flushMutex};
+
+		std::vector<Event> events;
+		std::uint64_t flushedSeq;
+		{
+			std::scoped_lock lock {_mutex};
+			events.swap(_events);
+			flushedSeq = _lastSeq;
+		}
+
+		if (events.empty())
+			return;
+
+		try
+		{
+			writeEvents(events);
+		}
+		catch (const std::exception& e)
+		{
+			LMS_LOG(SCROBBLING, ERROR) << "Cannot write " << events.size() << " scrobble events: " << e.what();
+
+			std::size_t failedFlushCount;
+			{
+				std::scoped_lock lock {_mutex};
+				failedFlushCount = ++_failedFlushCount;
+			}
+
+			// Some events may never be written: do not let them block the others forever
+			std::vector<Event> rejectedEvents;
+			if (failedFlushCount >= _maxFailedFlushCount)
+				rejectedEvents = writeEventsOneByOne(events);
+
+			// Nothing can be written, the database itself is likely at fault: keep the events, and retry later
+			if (failedFlushCount < _maxFailedFlushCount || rejectedEvents.size() == events.size())
+			{
+				std::scoped_lock lock {_mutex};
+				_events.insert(std::begin(_events), std::cbegin(events), std::cend(events));
+				scheduleFlush();
+				return;
+			}
+
+			rejectEvents(rejectedEvents);
+		}
+
+		std::scoped_lock lock {_mutex};
+		_failedFlushCount = 0;
+
+		for (auto itPendingStar {std::begin(_pendingStars)}; itPendingStar != std::end(_pendingStars);)
+		{
+			if (itPendingStar->second.second <= flushedSeq)
+				itPendingStar = _pendingStars.erase(itPendingStar);
+			else
+				++itPendingStar;
+		}
+
+		// only keep the events queued during the write
+		rewriteJournal();
+	}
+
+	void
+	ScrobbleQueue::writeEvents(const std::vector<Event>& events)
+	{
+		using namespace Database;
+
+		// Coalesce: only the last star state per object matters
+		std::map<StarKey, const StarEvent*> lastStarEvents;
+		for (const Event& event : events)
+		{
+			if (const StarEvent* starEvent {std::get_if<StarEvent>(&event)})
+				lastStarEvents[StarKey {starEvent->objectType, starEvent->userId.getValue(), starEvent->objectId}] = starEvent;
+		}
+
+		// per user events, listens first
+		std::map<IdType::ValueType, std::vector<const Event*>> eventsByUser;
+		for (const Event& event : events)
+		{
+			if (const ListenEvent* listenEvent {std::get_if<ListenEvent>(&event)})
+				eventsByUser[listenEvent->userId.getValue()].push_back(&event);
+		}
+		for (const Event& event : events)
+		{
+			if (const StarEvent* starEvent {std::get_if<StarEvent>(&event)})
+			{
+				if (lastStarEvents[StarKey {starEvent->objectType, starEvent->userId.getValue(), starEvent->objectId}] == starEvent)
+					eventsByUser[starEvent->userId.getValue()].push_back(&event);
+			}
+		}
+
+		Session& session {_db.getTLSSession()};
+
+		for (const auto& [userId, userEvents] : eventsByUser)
+		{
+			// do not hold the writer lock too long
+			for (std::size_t offset {}; offset < userEvents.size(); offset += _maxBatchSize)
+			{
+				auto transaction {session.createUniqueTransaction()};
+
+				const User::pointer user {User::find(session, UserId {userId})};
+				if (!user)
+					break;
+
+				for (std::size_t i {offset}; i < std::min(offset + _maxBatchSize, userEvents.size()); ++i)
+				{
+					if (const ListenEvent* listenEvent {std::get_if<ListenEvent>(userEvents[i])})
+					{
+						if (Database::Listen::find(session, listenEvent->userId, listenEvent->trackId, Scrobbler::Internal, listenEvent->dateTime))
+							continue;
+
+						const Track::pointer track {Track::find(session, listenEvent->trackId)};
+						if (!track)
+							continue;
+
+						auto dbListen {session.create<Database::Listen>(user, track, Scrobbler::Internal, listenEvent->dateTime)};
+						dbListen.modify()->setScrobblingState(ScrobblingState::Synchronized);
+					}
+					else if (const StarEvent* starEvent {std::get_if<StarEvent>(userEvents[i])})
+					{
+						switch (starEvent->objectType)
+						{
+							case ObjectType::Artist:
+								writeStarEvent<Artist, StarredArtist>(session, user, *starEvent);
+								break;
+							case ObjectType::Release:
+								writeStarEvent<Release, StarredRelease>(session, user, *starEvent);
+								break;
+							case ObjectType::Track:
+								writeStarEvent<Track, StarredTrack>(session, user, *starEvent);
+								break;
+						}
+					}
+				}
+			}
+		}
+
+		LMS_LOG(SCROBBLING, DEBUG) << "Written " << events.size() << " scrobble events for " << eventsByUser.size() << " users";
+	}
+
+	std::vector<ScrobbleQueue::Event>
+	ScrobbleQueue::writeEventsOneByOne(const std::vector<Event>& events)
+	{
+		std::vector<Event> failedEvents;
+
+		for (const Event& event : events)
+		{
+			try
+			{
+				writeEvents({event});
+			}
+			catch (const std::exception& e)
+			{
+				LMS_LOG(SCROBBLING, DEBUG) << "Cannot write scrobble event '" << eventToString(event) << "': " << e.what();
+				failedEvents.push_back(event);
+			}
+		}
+
+		return failedEvents;
+	}
+
+	void
+	ScrobbleQueue::rejectEvents(const std::vector<Event>& events)
+	{
+		// Set aside, so that they can still be recovered by hand
+		std::filesystem::path rejectedJournalPath {_journalPath};
+		rejectedJournalPath += ".rejected";
+
+		std::ofstream rejectedJournal {rejectedJournalPath, std::ios::app};
+		for (const Event& event : events)
+		{
+			LMS_LOG(SCROBBLING, ERROR) << "Rejecting scrobble event '" << eventToString(event) << "', moved to '" << rejectedJournalPath.string() << "'";
+			rejectedJournal << eventToString(event) << '\n';
+		}
+
+		rejectedJournal.flush();
+		if (!rejectedJournal)
+			LMS_LOG(SCROBBLING, ERROR) << "Cannot write rejected scrobble journal '" << rejectedJournalPath.string() << "'";
+	}
+
+	void
+	ScrobbleQueue::loadJournal()
+	{
+		std::ifstream ifs {_journalPath};
+		if (!ifs)
+			return;
+
+		std::string line;
+		while (std::getline(ifs, line))
+		{
+			if (line.empty())
+				continue;
+
+			const std::optional<Event> event {eventFromString(line)};
+			if (!event)
+			{
+				LMS_LOG(SCROBBLING, ERROR) << "Skipping invalid scrobble journal entry '" << line << "'";
+				continue;
+			}
+
+			_events.push_back(*event);
+			_lastSeq++;
+			if (const StarEvent* starEvent {std::get_if<StarEvent>(&*event)})
+				_pendingStars[StarKey {starEvent->objectType, starEvent->userId.getValue(), starEvent->objectId}] = {starEvent->starred, _lastSeq};
+		}
+	}
+
+	void
+	ScrobbleQueue::rewriteJournal()
+	{
+		// Replace the journal at once: a crash must leave either the old or the new journal
+		std::filesystem::path tmpJournalPath {_journalPath};
+		tmpJournalPath += ".tmp";
+
+		{
+			std::ofstream tmpJournal {tmpJournalPath, std::ios::trunc};
+			for (const Event& event : _events)
+				tmpJournal << eventToString(event) << '\n';
+			tmpJournal.flush();
+
+			if (!tmpJournal)
+			{
+				LMS_LOG(SCROBBLING, ERROR) << "Cannot write scrobble journal '" << tmpJournalPath.string() << "'";
+				return;
+			}
+		}
+
+		std::error_code ec;
+		_journal.close();
+		std::filesystem::rename(tmpJournalPath, _journalPath, ec);
+		if (ec)
+			LMS_LOG(SCROBBLING, ERROR) << "Cannot replace scrobble journal '" << _journalPath.string() << "': " << ec.message();
+
+		_journal.open(_journalPath, std::ios::app);
+		if (!_journal)
+			LMS_LOG(SCROBBLING, ERROR) << "Cannot open scrobble journal '" << _journalPath.string() << "'";
+	}
+
+	std::string
+	ScrobbleQueue::eventToString(const Event& event)
+	{
+		std::ostringstream oss;
+
+		if (const ListenEvent* listenEvent {std::get_if<ListenEvent>(&event)})
+			oss << "L " << listenEvent->userId.getValue() << " " << listenEvent->trackId.getValue() << " " << dateTimeToMs(listenEvent->dateTime);
+		else if (const StarEvent* starEvent {std::get_if<StarEvent>(&event)})
+			oss << (starEvent->starred ? "S " : "U ") << objectTypeToChar(starEvent->objectType) << " " << starEvent->userId.getValue() << " " << starEvent->objectId << " " << dateTimeToMs(starEvent->dateTime);
+
+		return oss.str();
+	}
+
+	std::optional<ScrobbleQueue::Event>
+	ScrobbleQueue::eventFromString(std::string_view str)
+	{
+		const std::vector<std::string_view> values {StringUtils::splitString(str, " ")};
+
+		auto readId {[](std::string_view value) -> std::optional<Database::IdType::ValueType>
+		{
+			const std::optional<Database::IdType::ValueType> id {StringUtils::readAs<Database::IdType::ValueType>(value)};
+			if (!id || *id == Wt::Dbo::dbo_default_traits::invalidId())
+				return std::nullopt;
+			return id;
+		}};
+
+		if (values.size() == 4 && values[0] == "L")
+		{
+			const auto userId {readId(values[1])};
+			const auto trackId {readId(values[2])};
+			const auto ms {StringUtils::readAs<long long>(values[3])};
+			if (!userId || !trackId || !ms)
+				return std::nullopt;
+
+			return ListenEvent {*userId, *trackId, dateTimeFromMs(*ms)};
+		}
+
+		if (values.size() == 5 && (values[0] == "S" || values[0] == "U"))
+		{
+			const auto objectType {objectTypeFromString(values[1])};
+			const auto userId {readId(values[2])};
+			const auto objectId {readId(values[3])};
+			const auto ms {StringUtils::readAs<long long>(values[4])};
+			if (!objectType || !userId || !objectId || !ms)
+				return std::nullopt;
+
+			return StarEvent {*objectType, *userId, *objectId, values[0] == "S", dateTimeFromMs(*ms)};
+		}
+
+		return std::nullopt;
+	}
+} // Scrobbling
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/io_context_strand.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <Wt/WDateTime.h>
+
+#include "services/database/ArtistId.hpp"
+#include "services/database/ReleaseId.hpp"
+#include "services/database/TrackId.hpp"
+#include "services/database/UserId.hpp"
+
+namespace Database
+{
+	class Db;
+}
+
+namespace Scrobbling
+{
+	// Write-behind queue for the internal scrobbler
+	// Events are acknowledged as soon as they are journaled, and written to the database in batches on a background strand
+	class ScrobbleQueue
+	{
+		public:
+			enum class ObjectType
+			{
+				Artist,
+				Release,
+				Track,
+			};
+
+			struct ListenEvent
+			{
+				Database::UserId	userId;
+				Database::TrackId	trackId;
+				Wt::WDateTime		dateTime;
+			};
+
+			struct StarEvent
+			{
+				ObjectType					objectType;
+				Database::UserId			userId;
+				Database::IdType::ValueType	objectId;
+				bool						starred {};
+				Wt::WDateTime				dateTime;
+			};
+
+			using Event = std::variant<ListenEvent, StarEvent>;
+
+			ScrobbleQueue(boost::asio::io_context& ioContext, Database::Db& db, const std::filesystem::path& journalPath);
+			~ScrobbleQueue();
+
+			ScrobbleQueue(const ScrobbleQueue&) = delete;
+			ScrobbleQueue& operator=(const ScrobbleQueue&) = delete;
+
+			void addListen(Database::UserId userId, Database::TrackId trackId, const Wt::WDateTime& dateTime);
+
+			void setStarred(Database::UserId userId, Database::ArtistId artistId, bool starred);
+			void setStarred(Database::UserId userId, Database::ReleaseId releaseId, bool starred);
+			void setStarred(Database::UserId userId, Database::TrackId trackId, bool starred);
+
+			// Starred state not written to the database yet
+			std::optional<bool> getPendingStarred(Database::UserId userId, Database::ArtistId artistId) const;
+			std::optional<bool> getPendingStarred(Database::UserId userId, Database::ReleaseId releaseId) const;
+			std::optional<bool> getPendingStarred(Database::UserId userId, Database::TrackId trackId) const;
+
+			// Synchronously write the queued events
+			void flush();
+
+			// Journal format, one event per line
+			static std::string			eventToString(const Event& event);
+			static std::optional<Event>	eventFromString(std::string_view str);
+
+		private:
+			using StarKey = std::tuple<ObjectType, Database::IdType::ValueType, Database::IdType::ValueType>; // type, user, object
+
+			void enqueue(const Event& event);
+			void setStarred(ObjectType objectType, Database::UserId userId, Database::IdType::ValueType objectId, bool starred);
+			std::optional<bool> getPendingStarred(ObjectType objectType, Database::UserId userId, Database::IdType::ValueType objectId) const;
+			void loadJournal();
+			void rewriteJournal();
+			void scheduleFlush();
+			std::chrono::seconds getFlushDelay() const;
+			void writeEvents(const std::vector<Event>& events);
+			std::vector<Event> writeEventsOneByOne(const std::vector<Event>& events); // returns the events that cannot be written
+			void rejectEvents(const std::vector<Event>& events);
+
+			static constexpr std::chrono::seconds	_flushDelay {1};
+			static constexpr std::chrono::seconds	_maxFlushRetryDelay {60};
+			static constexpr std::size_t			_maxBatchSize {256};
+			static constexpr std::size_t			_maxFailedFlushCount {5}; // then look for the events that cannot be written
+
+			// Timer handlers may still be queued on the strand once the queue is destroyed
+			struct Lifetime
+			{
+				std::mutex	mutex;
+				bool		alive {true};
+			};
+
+			Database::Db&						_db;
+			const std::shared_ptr<Lifetime>		_lifetime {std::make_shared<Lifetime>()};
+			boost::asio::io_context::strand		_strand;
+			boost::asio::steady_timer			_flushTimer;
+			const std::filesystem::path			_journalPath;
+
+			std::mutex							_flushMutex; // only one flush at a time, held before _mutex
+
+			mutable std::mutex					_mutex;
+			std::ofstream						_journal;
+			std::vector<Event>					_events;
+			std::uint64_t						_lastSeq {}; // sequence number of the last queued event
+			std::map<StarKey, std::pair<bool, std::uint64_t>>	_pendingStars; // starred, seq
+			bool								_flushScheduled {};
+			std::size_t							_failedFlushCount {}; // consecutive, to back off
+	};
+} // Scrobbling
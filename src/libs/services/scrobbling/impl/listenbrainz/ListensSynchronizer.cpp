@@ -45,6 +45,9 @@ namespace
 {
 	using namespace Scrobbling::ListenBrainz;
 
+	// listens fetched per request, matched and saved at once
+	constexpr std::size_t listensPageSize {100};
+
 	std::optional<Wt::Json::Object>
 	listenToJsonPayload(Database::Session& session, const Scrobbling::Listen& listen, const Wt::WDateTime& timePoint)
 	{
@@ -142,57 +145,6 @@ namespace
 			return std::nullopt;
 		}
 	}
-
-	Database::TrackId
-	tryGetMatchingTrack(Database::Session& session, const Listen& listen)
-	{
-		using namespace Database;
-
-		auto transaction {session.createSharedTransaction()};
-
-		// first try to match using recording MBID, and then fallback on possibly ambiguous info
-		if (listen.recordingMBID)
-		{
-			const auto tracks {Track::findByRecordingMBID(session, *listen.recordingMBID)};
-			// if duplicated files, do not record it (let the user correct its database)
-			if (tracks.size() == 1)
-			{
-				LOG(DEBUG) << "Matched listen '" << listen << "' using recording MBID";
-				return tracks.front()->getId();
-			}
-			else if (tracks.size() > 1)
-			{
-				LOG(DEBUG) << "Too many matches for listen '" << listen << "' using recording MBID!";
-				return {};
-			}
-		}
-
-		assert(!listen.trackName.empty() && !listen.artistName.empty());
-
-		// TODO check release MBID?
-		Track::FindParameters params;
-		params.setName(listen.trackName);
-		params.setReleaseName(listen.releaseName);
-		params.setArtistName(listen.artistName);
-		if (listen.trackNumber)
-			params.setTrackNumber(*listen.trackNumber);
-
-		const auto tracks {Track::find(session, params)};
-		// conservative behavior: in case of multiple matches: reject
-		if (tracks.results.size() == 1)
-		{
-			LOG(DEBUG) << "Matched listen '" << listen << "' using metadata";
-			return tracks.results.front();
-		}
-		else if (tracks.results.size() > 1)
-		{
-			LOG(DEBUG) << "Too many matches for listen '" << listen << "' using metadata";
-			return {};
-		}
-
-		LOG(DEBUG) << "No match for listen '" << listen << "'";
-		return {};
-	}
 }
 
 namespace Scrobbling::ListenBrainz
@@ -310,6 +262,48 @@ namespace Scrobbling::ListenBrainz
 		return true;
 	}
 
+	std::size_t
+	ListensSynchronizer::saveListens(const std::vector<TimedListen>& listens, Database::ScrobblingState scrobblingState)
+	{
+		using namespace Database;
+
+		if (listens.empty())
+			return 0;
+
+		std::size_t savedCount {};
+
+		Session& session {_db.getTLSSession()};
+		auto transaction {session.createUniqueTransaction()};
+
+		const User::pointer user {User::find(session, listens.front().userId)};
+		if (!user)
+			return 0;
+
+		for (const TimedListen& listen : listens)
+		{
+			assert(listen.userId == user->getId());
+
+			Database::Listen::pointer dbListen {Database::Listen::find(session, listen.userId, listen.trackId, Database::Scrobbler::ListenBrainz, listen.listenedAt)};
+			if (!dbListen)
+			{
+				const Track::pointer track {Track::find(session, listen.trackId)};
+				if (!track)
+					continue;
+
+				dbListen = session.create<Database::Listen>(user, track, Database::Scrobbler::ListenBrainz, listen.listenedAt);
+				dbListen.modify()->setScrobblingState(scrobblingState);
+				savedCount++;
+			}
+			else if (dbListen->getScrobblingState() != scrobblingState)
+			{
+				dbListen.modify()->setScrobblingState(scrobblingState);
+				savedCount++;
+			}
+		}
+
+		return savedCount;
+	}
+
 	void
 	ListensSynchronizer::enquePendingListens()
 	{
@@ -401,6 +395,9 @@ namespace Scrobbling::ListenBrainz
 
 		assert(!isSyncing());
 
+		// the library may have changed since the last sync
+		_trackMatchingIndex.reset();
+
 		enquePendingListens();
 
 		Database::RangeResults<Database::UserId> userIds;
@@ -439,7 +436,10 @@ namespace Scrobbling::ListenBrainz
 			context.syncing = false;
 
 			if (!isSyncing())
+			{
+				_trackMatchingIndex.reset();
 				scheduleSync(_syncListensPeriod);
+			}
 		});
 	}
 
@@ -520,18 +520,21 @@ namespace Scrobbling::ListenBrainz
 		assert(!context.listenBrainzUserName.empty());
 
 		Http::ClientGETRequestParameters request;
-		request.relativeUrl = "/1/user/" + context.listenBrainzUserName + "/listens?max_ts=" + std::to_string(context.maxDateTime.toTime_t());
+		request.relativeUrl = "/1/user/" + context.listenBrainzUserName + "/listens?max_ts=" + std::to_string(context.maxDateTime.toTime_t()) + "&count=" + std::to_string(listensPageSize);
 		request.priority = Http::ClientRequestParameters::Priority::Low;
 		request.onSuccessFunc = [=, &context] (std::string_view msgBody)
 			{
-				processGetListensResponse(msgBody, context);
-				if (context.fetchedListenCount >= _maxSyncListenCount || !context.maxDateTime.isValid())
+				_strand.dispatch([=, &context, body = std::string {msgBody}]
 				{
-					onSyncEnded(context);
-					return;
-				}
+					processGetListensResponse(body, context);
+					if (context.fetchedListenCount >= _maxSyncListenCount || !context.maxDateTime.isValid())
+					{
+						onSyncEnded(context);
+						return;
+					}
 
-				enqueGetListens(context);
+					enqueGetListens(context);
+				});
 			};
 		request.onFailureFunc = [=, &context]
 			{
@@ -541,15 +544,29 @@ namespace Scrobbling::ListenBrainz
 		_client.sendGETRequest(std::move(request));
 	}
 
+	const TrackMatchingIndex&
+	ListensSynchronizer::getTrackMatchingIndex()
+	{
+		assert(_strand.running_in_this_thread());
+
+		if (!_trackMatchingIndex)
+			_trackMatchingIndex = std::make_unique<TrackMatchingIndex>(_db.getTLSSession());
+
+		return *_trackMatchingIndex;
+	}
+
 	void
 	ListensSynchronizer::processGetListensResponse(std::string_view msgBody, UserContext& context)
 	{
-		Database::Session& session {_db.getTLSSession()};
-
 		context.maxDateTime = {}; // invalidate to break in case no more listens are fetched
 		ListensParser::Result result {ListensParser::parse(msgBody)};
 		context.fetchedListenCount += result.listenCount;
 
+		// match the whole page in memory, then save it at once
+		const TrackMatchingIndex& trackMatchingIndex {getTrackMatchingIndex()};
+		std::vector<TimedListen> matchedListens;
+		matchedListens.reserve(result.listens.size());
+
 		for (const Listen& parsedListen : result.listens)
 		{
 			// update oldest listen for the next query
@@ -562,14 +579,11 @@ namespace Scrobbling::ListenBrainz
 			if (!context.maxDateTime.isValid() || context.maxDateTime > parsedListen.listenedAt)
 				context.maxDateTime = parsedListen.listenedAt;
 
-			if (const Database::TrackId trackId {tryGetMatchingTrack(session, parsedListen)}; trackId.isValid())
-			{
-				context.matchedListenCount++;
-
-				const Scrobbling::TimedListen listen {{context.userId, trackId}, parsedListen.listenedAt};
-				if (saveListen(listen, Database::ScrobblingState::Synchronized))
-					context.importedListenCount++;
-			}
+			if (const Database::TrackId trackId {trackMatchingIndex.find(parsedListen)}; trackId.isValid())
+				matchedListens.push_back(TimedListen {{context.userId, trackId}, parsedListen.listenedAt});
 		}
+
+		context.matchedListenCount += matchedListens.size();
+		context.importedListenCount += saveListens(matchedListens, Database::ScrobblingState::Synchronized);
 	}
 } // namespace Scrobbling::ListenBrainz
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <unordered_map>
 #include <boost/asio/io_context.hpp>
@@ -29,6 +30,7 @@
 #include "services/database/UserId.hpp"
 
 #include "services/scrobbling/Listen.hpp"
+#include "TrackMatchingIndex.hpp"
 
 namespace Database
 {
@@ -53,6 +55,7 @@ namespace Scrobbling::ListenBrainz
 		private:
 			void enqueListen(const Listen& listen, const Wt::WDateTime& timePoint);
 			bool saveListen(const TimedListen& listen, Database::ScrobblingState scrobblinState);
+			std::size_t saveListens(const std::vector<TimedListen>& listens, Database::ScrobblingState scrobblingState);
 
 			void enquePendingListens();
 
@@ -87,6 +90,7 @@ namespace Scrobbling::ListenBrainz
 			void enqueGetListenCount(UserContext& context);
 			void enqueGetListens(UserContext& context);
 			void processGetListensResponse(std::string_view body, UserContext& context);
+			const TrackMatchingIndex& getTrackMatchingIndex();
 
 			boost::asio::io_context&		_ioContext;
 			boost::asio::io_context::strand	_strand {_ioContext};
@@ -95,6 +99,7 @@ namespace Scrobbling::ListenBrainz
 			Http::IClient&					_client;
 
 			std::unordered_map<Database::UserId, UserContext> _userContexts;
+			std::unique_ptr<TrackMatchingIndex>	_trackMatchingIndex; // built on demand, shared by all the users during a sync
 
 			const std::size_t			_maxSyncListenCount;
 			const std::chrono::hours	_syncListensPeriod;
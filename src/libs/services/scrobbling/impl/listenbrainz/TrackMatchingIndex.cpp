@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TrackMatchingIndex.hpp"
+
+#include "services/database/Session.hpp"
+#include "utils/String.hpp"
+#include "Utils.hpp"
+
+namespace Scrobbling::ListenBrainz
+{
+	namespace
+	{
+		std::string
+		normalize(std::string_view str)
+		{
+			return StringUtils::stringToLower(StringUtils::stringTrim(str));
+		}
+
+		std::string
+		makeKey(std::string_view artistName, std::string_view name)
+		{
+			return normalize(artistName) + '\x1f' + normalize(name);
+		}
+
+		std::string
+		makeKey(std::string_view artistName, std::string_view releaseName, std::string_view name)
+		{
+			return normalize(artistName) + '\x1f' + normalize(releaseName) + '\x1f' + normalize(name);
+		}
+	}
+
+	TrackMatchingIndex::TrackMatchingIndex(Database::Session& session)
+	{
+		using namespace Database;
+
+		static constexpr std::size_t batchSize {10000};
+
+		// Results are ordered by track: entries of the same track are contiguous
+		for (std::size_t offset {};; offset += batchSize)
+		{
+			RangeResults<Track::MatchingInfoResult> results;
+			{
+				auto transaction {session.createSharedTransaction()};
+				results = Track::findMatchingInfos(session, Range {offset, batchSize});
+			}
+
+			for (const Track::MatchingInfoResult& result : results.results)
+				add(result);
+
+			if (!results.moreResults)
+				break;
+		}
+
+		LOG(DEBUG) << "Track matching index loaded: " << _trackCount << " tracks";
+	}
+
+	void
+	TrackMatchingIndex::addEntry(EntryMap& entries, const std::string& key, const Entry& entry)
+	{
+		std::vector<Entry>& keyEntries {entries[key]};
+
+		// same track linked several times to the same artist
+		if (!keyEntries.empty() && keyEntries.back().trackId == entry.trackId)
+			return;
+
+		keyEntries.push_back(entry);
+	}
+
+	void
+	TrackMatchingIndex::add(const Database::Track::MatchingInfoResult& info)
+	{
+		const Entry entry {info.trackId, info.trackNumber};
+
+		if (info.trackId != _lastTrackId)
+		{
+			_lastTrackId = info.trackId;
+			_trackCount++;
+
+			if (!info.recordingMBID.empty())
+				addEntry(_byRecordingMBID, normalize(info.recordingMBID), entry);
+		}
+
+		if (info.artistName.empty())
+			return;
+
+		addEntry(_byArtistName, makeKey(info.artistName, info.name), entry);
+		if (!info.releaseName.empty())
+			addEntry(_byArtistReleaseName, makeKey(info.artistName, info.releaseName, info.name), entry);
+	}
+
+	Database::TrackId
+	TrackMatchingIndex::find(const Listen& listen) const
+	{
+		// first try to match using recording MBID, and then fallback on possibly ambiguous info
+		if (listen.recordingMBID)
+		{
+			const auto itEntries {_byRecordingMBID.find(normalize(listen.recordingMBID->getAsString()))};
+			if (itEntries != std::cend(_byRecordingMBID))
+			{
+				// if duplicated files, do not record it (let the user correct its database)
+				if (itEntries->second.size() == 1)
+				{
+					LOG(DEBUG) << "Matched listen '" << listen << "' using recording MBID";
+					return itEntries->second.front().trackId;
+				}
+
+				LOG(DEBUG) << "Too many matches for listen '" << listen << "' using recording MBID!";
+				return {};
+			}
+		}
+
+		if (listen.artistName.empty() || listen.trackName.empty())
+			return {};
+
+		// TODO check release MBID?
+		const EntryMap& entries {listen.releaseName.empty() ? _byArtistName : _byArtistReleaseName};
+		const auto itEntries {entries.find(listen.releaseName.empty() ? makeKey(listen.artistName, listen.trackName) : makeKey(listen.artistName, listen.releaseName, listen.trackName))};
+		if (itEntries == std::cend(entries))
+		{
+			LOG(DEBUG) << "No match for listen '" << listen << "'";
+			return {};
+		}
+
+		// conservative behavior: in case of multiple matches: reject
+		Database::TrackId match;
+		for (const Entry& entry : itEntries->second)
+		{
+			if (listen.trackNumber && static_cast<int>(*listen.trackNumber) != entry.trackNumber)
+				continue;
+
+			if (match.isValid())
+			{
+				LOG(DEBUG) << "Too many matches for listen '" << listen << "' using metadata";
+				return {};
+			}
+			match = entry.trackId;
+		}
+
+		if (match.isValid())
+			LOG(DEBUG) << "Matched listen '" << listen << "' using metadata";
+		else
+			LOG(DEBUG) << "No match for listen '" << listen << "'";
+
+		return match;
+	}
+} // Scrobbling::ListenBrainz
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "services/database/Track.hpp"
+#include "services/database/TrackId.hpp"
+#include "ListenTypes.hpp"
+
+namespace Database
+{
+	class Session;
+}
+
+namespace Scrobbling::ListenBrainz
+{
+	// In-memory index used to match a lot of listens without querying the database for each one
+	class TrackMatchingIndex
+	{
+		public:
+			TrackMatchingIndex() = default;
+			TrackMatchingIndex(Database::Session& session);
+
+			TrackMatchingIndex(const TrackMatchingIndex&) = delete;
+			TrackMatchingIndex& operator=(const TrackMatchingIndex&) = delete;
+
+			// entries of the same track must be added contiguously
+			void add(const Database::Track::MatchingInfoResult& info);
+
+			// invalid if no match or too many matches
+			Database::TrackId find(const Listen& listen) const;
+
+			std::size_t getTrackCount() const { return _trackCount; }
+
+		private:
+			struct Entry
+			{
+				Database::TrackId	trackId;
+				int					trackNumber {};
+			};
+			using EntryMap = std::unordered_map<std::string, std::vector<Entry>>;
+
+			static void addEntry(EntryMap& entries, const std::string& key, const Entry& entry);
+
+			EntryMap			_byRecordingMBID;
+			EntryMap			_byArtistReleaseName;	// normalized (artist, release, name)
+			EntryMap			_byArtistName;			// normalized (artist, name)
+			Database::TrackId	_lastTrackId;
+			std::size_t			_trackCount {};
+	};
+} // Scrobbling::ListenBrainz
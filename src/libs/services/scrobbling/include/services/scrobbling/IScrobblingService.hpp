@@ -24,6 +24,8 @@
 #include <chrono>
 #include <memory>
 #include <optional>
+#include <unordered_set>
+#include <vector>
 
 #include "services/scrobbling/Listen.hpp"
 #include "services/database/ArtistId.hpp"
@@ -87,6 +89,7 @@ namespace Scrobbling
 			virtual void 			star(Database::UserId userId, Database::ArtistId artistId) = 0;
 			virtual void 			unstar(Database::UserId userId, Database::ArtistId artistId) = 0;
 			virtual bool 			isStarred(Database::UserId userId, Database::ArtistId artistId) = 0;
+			virtual std::unordered_set<Database::ArtistId> findStarredArtists(Database::UserId userId, const std::vector<Database::ArtistId>& artistIds) = 0; // same as isStarred, for many artists at once
 			virtual ArtistContainer	getStarredArtists(Database::UserId userId,
 														const std::vector<Database::ClusterId>& clusterIds,
 														std::optional<Database::TrackArtistLinkType> linkType,
@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 
 #include "listenbrainz/ListensParser.hpp"
+#include "listenbrainz/TrackMatchingIndex.hpp"
 
 using namespace Scrobbling::ListenBrainz;
 
@@ -121,3 +122,45 @@ TEST(Listenbrainz, parseListens_minPayload)
 	EXPECT_FALSE(result.listens[0].recordingMBID.has_value());
 	EXPECT_FALSE(result.listens[0].releaseMBID.has_value());
 }
+
+TEST(Listenbrainz, trackMatchingIndex)
+{
+	using Database::Track;
+	using Database::TrackId;
+
+	const std::string recordingMBID {"46ae879f-2dbe-46d3-99ad-05c116f97a30"};
+
+	TrackMatchingIndex index;
+	index.add(Track::MatchingInfoResult {TrackId {1}, recordingMBID, "Juparo", 5, "Petal", "Broke For Free"});
+	index.add(Track::MatchingInfoResult {TrackId {2}, "", "Melt", 4, "Petal", "Broke For Free"});
+	index.add(Track::MatchingInfoResult {TrackId {2}, "", "Melt", 4, "Petal", "Broke For Free"}); // same artist, other link type
+	index.add(Track::MatchingInfoResult {TrackId {3}, "", "Melt", 1, "Another Release", "Broke For Free"});
+	index.add(Track::MatchingInfoResult {TrackId {4}, "", "Untitled", 0, "", ""});
+	EXPECT_EQ(index.getTrackCount(), 4);
+
+	Listen listen;
+	listen.recordingMBID = UUID::fromString(recordingMBID);
+	EXPECT_EQ(index.find(listen), TrackId {1});
+
+	listen = {};
+	listen.artistName = "broke for free ";
+	listen.releaseName = "PETAL";
+	listen.trackName = "Melt";
+	EXPECT_EQ(index.find(listen), TrackId {2});
+
+	listen.trackNumber = 3;
+	EXPECT_FALSE(index.find(listen).isValid());
+
+	// ambiguous without release
+	listen = {};
+	listen.artistName = "Broke For Free";
+	listen.trackName = "Melt";
+	EXPECT_FALSE(index.find(listen).isValid());
+
+	listen.trackNumber = 1;
+	EXPECT_EQ(index.find(listen), TrackId {3});
+
+	listen = {};
+	listen.trackName = "Untitled";
+	EXPECT_FALSE(index.find(listen).isValid());
+}
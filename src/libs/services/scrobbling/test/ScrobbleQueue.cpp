@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "services/database/Db.hpp"
+#include "services/database/Listen.hpp"
+#include "services/database/Session.hpp"
+#include "services/database/StarredTrack.hpp"
+#include "services/database/Track.hpp"
+#include "services/database/User.hpp"
+#include "internal/ScrobbleQueue.hpp"
+
+using namespace Scrobbling;
+
+namespace
+{
+	// The io context is never run: events are only written by explicit flushes
+	// The database is shared by all the tests as sessions are cached per thread
+	class ScrobbleQueueTest : public ::testing::Test
+	{
+		public:
+			static void SetUpTestSuite()
+			{
+				_dbPath = std::tmpnam(nullptr);
+				_db = std::make_unique<Database::Db>(_dbPath);
+
+				Database::Session session {*_db};
+				session.prepareTables();
+
+				auto transaction {session.createUniqueTransaction()};
+				_userId = session.create<Database::User>("MyUser")->getId();
+			}
+
+			static void TearDownTestSuite()
+			{
+				_db.reset();
+				std::filesystem::remove(_dbPath);
+			}
+
+		protected:
+			ScrobbleQueueTest()
+				: _journalPath {std::tmpnam(nullptr)}
+				, _session {*_db}
+			{
+				static std::size_t trackCount {};
+
+				{
+					auto transaction {_session.createUniqueTransaction()};
+					_trackId = _session.create<Database::Track>("/tmp/MyTrack" + std::to_string(trackCount++) + ".mp3")->getId();
+				}
+
+				_initialListenCount = getUserListenCount();
+			}
+
+			~ScrobbleQueueTest() override
+			{
+				std::filesystem::remove(_journalPath);
+			}
+
+			// written during this test only
+			std::size_t getListenCount()
+			{
+				return getUserListenCount() - _initialListenCount;
+			}
+
+			std::size_t getUserListenCount()
+			{
+				auto transaction {_session.createSharedTransaction()};
+				return Database::Listen::find(_session, Database::Listen::FindParameters {}.setUser(_userId)).results.size();
+			}
+
+			bool isStarred()
+			{
+				auto transaction {_session.createSharedTransaction()};
+				return Database::StarredTrack::find(_session, _trackId, _userId, Database::Scrobbler::Internal);
+			}
+
+			std::size_t getJournalEntryCount() const
+			{
+				std::ifstream ifs {_journalPath};
+				std::size_t count {};
+				for (std::string line; std::getline(ifs, line);)
+					count += !line.empty();
+
+				return count;
+			}
+
+			static inline std::filesystem::path _dbPath;
+			static inline std::unique_ptr<Database::Db> _db;
+			static inline Database::UserId _userId;
+
+			const std::filesystem::path _journalPath;
+			Database::Session _session;
+			boost::asio::io_context _ioContext;
+			Database::TrackId _trackId;
+			std::size_t _initialListenCount {};
+	};
+}
+
+TEST_F(ScrobbleQueueTest, starPending)
+{
+	ScrobbleQueue queue {_ioContext, *_db, _journalPath};
+	EXPECT_FALSE(queue.getPendingStarred(_userId, _trackId).has_value());
+
+	queue.setStarred(_userId, _trackId, true);
+	EXPECT_EQ(queue.getPendingStarred(_userId, _trackId), true);
+	EXPECT_FALSE(isStarred());
+
+	queue.flush();
+	EXPECT_FALSE(queue.getPendingStarred(_userId, _trackId).has_value());
+	EXPECT_TRUE(isStarred());
+
+	queue.setStarred(_userId, _trackId, false);
+	EXPECT_EQ(queue.getPendingStarred(_userId, _trackId), false);
+	EXPECT_TRUE(isStarred());
+
+	queue.flush();
+	EXPECT_FALSE(queue.getPendingStarred(_userId, _trackId).has_value());
+	EXPECT_FALSE(isStarred());
+}
+
+TEST_F(ScrobbleQueueTest, starLastStateWins)
+{
+	ScrobbleQueue queue {_ioContext, *_db, _journalPath};
+
+	queue.setStarred(_userId, _trackId, true);
+	queue.setStarred(_userId, _trackId, false);
+	EXPECT_EQ(queue.getPendingStarred(_userId, _trackId), false);
+	queue.flush();
+	EXPECT_FALSE(isStarred());
+
+	queue.setStarred(_userId, _trackId, false);
+	queue.setStarred(_userId, _trackId, true);
+	EXPECT_EQ(queue.getPendingStarred(_userId, _trackId), true);
+	queue.flush();
+	EXPECT_TRUE(isStarred());
+}
+
+TEST_F(ScrobbleQueueTest, listenDedup)
+{
+	const Wt::WDateTime dateTime {Wt::WDate {2022, 10, 2}, Wt::WTime {12, 34, 56}};
+
+	ScrobbleQueue queue {_ioContext, *_db, _journalPath};
+
+	queue.addListen(_userId, _trackId, dateTime);
+	queue.addListen(_userId, _trackId, dateTime);
+	EXPECT_EQ(getListenCount(), 0);
+
+	queue.flush();
+	EXPECT_EQ(getListenCount(), 1);
+
+	// already written
+	queue.addListen(_userId, _trackId, dateTime);
+	queue.flush();
+	EXPECT_EQ(getListenCount(), 1);
+
+	queue.addListen(_userId, _trackId, dateTime.addSecs(60));
+	queue.flush();
+	EXPECT_EQ(getListenCount(), 2);
+}
+
+TEST_F(ScrobbleQueueTest, journal)
+{
+	const Wt::WDateTime dateTime {Wt::WDate {2022, 10, 2}, Wt::WTime {12, 34, 56}};
+
+	ScrobbleQueue queue {_ioContext, *_db, _journalPath};
+
+	queue.addListen(_userId, _trackId, dateTime);
+	queue.setStarred(_userId, _trackId, true);
+	EXPECT_EQ(getJournalEntryCount(), 2);
+
+	// acknowledged events are removed from the journal
+	queue.flush();
+	EXPECT_EQ(getJournalEntryCount(), 0);
+	EXPECT_FALSE(std::filesystem::exists(std::filesystem::path {_journalPath.string() + ".tmp"}));
+
+	queue.setStarred(_userId, _trackId, false);
+	EXPECT_EQ(getJournalEntryCount(), 1);
+}
+
+TEST_F(ScrobbleQueueTest, journalReplay)
+{
+	const Wt::WDateTime dateTime {Wt::WDate {2022, 10, 2}, Wt::WTime {12, 34, 56}};
+
+	// events journaled before a crash
+	{
+		std::ofstream journal {_journalPath};
+		journal << ScrobbleQueue::eventToString(ScrobbleQueue::ListenEvent {_userId, _trackId, dateTime}) << '\n';
+		journal << "garbage\n";
+		journal << ScrobbleQueue::eventToString(ScrobbleQueue::StarEvent {ScrobbleQueue::ObjectType::Track, _userId, _trackId.getValue(), true, dateTime}) << '\n';
+	}
+
+	ScrobbleQueue queue {_ioContext, *_db, _journalPath};
+	EXPECT_EQ(queue.getPendingStarred(_userId, _trackId), true);
+	EXPECT_EQ(getListenCount(), 0);
+
+	queue.flush();
+	EXPECT_EQ(getListenCount(), 1);
+	EXPECT_TRUE(isStarred());
+	EXPECT_EQ(getJournalEntryCount(), 0);
+}
+
+TEST_F(ScrobbleQueueTest, flushOnDestruction)
+{
+	{
+		ScrobbleQueue queue {_ioContext, *_db, _journalPath};
+		queue.addListen(_userId, _trackId, Wt::WDateTime {Wt::WDate {2022, 10, 2}, Wt::WTime {12, 34, 56}});
+	}
+
+	EXPECT_EQ(getListenCount(), 1);
+	EXPECT_EQ(getJournalEntryCount(), 0);
+
+	// pending timer handlers must not run on the destroyed queue
+	_ioContext.run();
+}
+
+TEST(ScrobbleQueue, journal_listen)
+{
+	const Wt::WDateTime dateTime {Wt::WDate {2022, 10, 2}, Wt::WTime {12, 34, 56, 789}};
+	const ScrobbleQueue::ListenEvent listen {Database::UserId {1}, Database::TrackId {42}, dateTime};
+
+	const std::string str {ScrobbleQueue::eventToString(listen)};
+	const std::optional<ScrobbleQueue::Event> event {ScrobbleQueue::eventFromString(str)};
+	ASSERT_TRUE(event.has_value());
+
+	const ScrobbleQueue::ListenEvent* parsedListen {std::get_if<ScrobbleQueue::ListenEvent>(&*event)};
+	ASSERT_NE(parsedListen, nullptr);
+	EXPECT_EQ(parsedListen->userId, listen.userId);
+	EXPECT_EQ(parsedListen->trackId, listen.trackId);
+	EXPECT_EQ(parsedListen->dateTime, dateTime);
+}
+
+TEST(ScrobbleQueue, journal_star)
+{
+	const Wt::WDateTime dateTime {Wt::WDate {2022, 10, 2}, Wt::WTime {12, 34, 56}};
+
+	for (const bool starred : {true, false})
+	{
+		const ScrobbleQueue::StarEvent star {ScrobbleQueue::ObjectType::Release, Database::UserId {3}, 7, starred, dateTime};
+
+		const std::optional<ScrobbleQueue::Event> event {ScrobbleQueue::eventFromString(ScrobbleQueue::eventToString(star))};
+		ASSERT_TRUE(event.has_value());
+
+		const ScrobbleQueue::StarEvent* parsedStar {std::get_if<ScrobbleQueue::StarEvent>(&*event)};
+		ASSERT_NE(parsedStar, nullptr);
+		EXPECT_EQ(parsedStar->objectType, ScrobbleQueue::ObjectType::Release);
+		EXPECT_EQ(parsedStar->userId, star.userId);
+		EXPECT_EQ(parsedStar->objectId, 7);
+		EXPECT_EQ(parsedStar->starred, starred);
+		EXPECT_EQ(parsedStar->dateTime, dateTime);
+	}
+}
+
+TEST(ScrobbleQueue, journal_invalid)
+{
+	EXPECT_FALSE(ScrobbleQueue::eventFromString("").has_value());
+	EXPECT_FALSE(ScrobbleQueue::eventFromString("L 1 2").has_value());
+	EXPECT_FALSE(ScrobbleQueue::eventFromString("L 1 foo 1664714096000").has_value());
+	EXPECT_FALSE(ScrobbleQueue::eventFromString("S x 1 2 1664714096000").has_value());
+	EXPECT_FALSE(ScrobbleQueue::eventFromString("X 1 2 3").has_value());
+}
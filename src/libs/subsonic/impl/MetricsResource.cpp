@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MetricsResource.hpp"
+
+#include <string_view>
+
+#include <boost/asio/ip/address.hpp>
+
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+#include "av/ITranscodeScheduler.hpp"
+#include "utils/IConfig.hpp"
+#include "utils/IJobScheduler.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Service.hpp"
+
+namespace API::Subsonic
+{
+	namespace
+	{
+		bool isLocalAddress(const std::string& address)
+		{
+			boost::system::error_code ec;
+			const boost::asio::ip::address ipAddress {boost::asio::ip::make_address(address, ec)};
+			if (ec)
+				return false;
+
+			if (ipAddress.is_v6() && ipAddress.to_v6().is_v4_mapped())
+				return boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, ipAddress.to_v6()).is_loopback();
+
+			return ipAddress.is_loopback();
+		}
+
+		bool isForwarded(const Wt::Http::Request& request)
+		{
+			for (const char* header : {"X-Forwarded-For", "Forwarded", "X-Real-IP"})
+			{
+				if (!request.headerValue(header).empty())
+					return true;
+			}
+
+			return false;
+		}
+
+		// Constant time, not to leak the token through timings
+		bool isSameToken(std::string_view token1, std::string_view token2)
+		{
+			if (token1.size() != token2.size())
+				return false;
+
+			unsigned char diff {};
+			for (std::size_t i {}; i < token1.size(); ++i)
+				diff |= static_cast<unsigned char>(token1[i] ^ token2[i]);
+
+			return diff == 0;
+		}
+
+		void writeJobPoolMetrics(const IJobScheduler& jobScheduler, std::ostream& os)
+		{
+			static constexpr std::pair<IJobScheduler::Pool, std::string_view> pools[] {{IJobScheduler::Pool::CPU, "cpu"}, {IJobScheduler::Pool::IO, "io"}};
+
+			auto writeMetric {[&](std::string_view name, std::string_view type, std::string_view help, auto getValue)
+			{
+				os << "# HELP " << name << " " << help << "\n";
+				os << "# TYPE " << name << " " << type << "\n";
+				for (const auto& [pool, poolName] : pools)
+					os << name << "{pool=\"" << poolName << "\"} " << getValue(jobScheduler.getStats(pool)) << "\n";
+			}};
+
+			using PoolStats = IJobScheduler::PoolStats;
+			writeMetric("lms_job_pool_threads", "gauge", "Job pool thread count", [](const PoolStats& stats) { return stats.threadCount; });
+			writeMetric("lms_job_pool_queue_size", "gauge", "Jobs waiting to be executed", [](const PoolStats& stats) { return stats.queueSize; });
+			writeMetric("lms_job_pool_running_jobs", "gauge", "Jobs being executed", [](const PoolStats& stats) { return stats.runningJobCount; });
+			writeMetric("lms_job_pool_jobs_total", "counter", "Executed jobs", [](const PoolStats& stats) { return stats.executedJobCount; });
+			writeMetric("lms_job_pool_rejected_jobs_total", "counter", "Jobs rejected because the queue was full (run inline instead)", [](const PoolStats& stats) { return stats.rejectedJobCount; });
+			writeMetric("lms_job_pool_wait_seconds_total", "counter", "Time spent by jobs waiting in the queue", [](const PoolStats& stats) { return stats.totalWaitDuration.count() / 1000000.; });
+			writeMetric("lms_job_pool_max_wait_seconds", "gauge", "Longest time spent by a job waiting in the queue", [](const PoolStats& stats) { return stats.maxWaitDuration.count() / 1000000.; });
+		}
+
+		void writeTranscodeMetrics(const Av::ITranscodeScheduler& transcodeScheduler, std::ostream& os)
+		{
+			const Av::ITranscodeScheduler::Stats stats {transcodeScheduler.getStats()};
+
+			auto writeMetric {[&](std::string_view name, std::string_view type, std::string_view help, auto value)
+			{
+				os << "# HELP " << name << " " << help << "\n";
+				os << "# TYPE " << name << " " << type << "\n";
+				os << name << " " << value << "\n";
+			}};
+
+			writeMetric("lms_transcode_max_running", "gauge", "Max transcodes running at once", stats.maxRunningCount);
+			writeMetric("lms_transcode_max_running_per_user", "gauge", "Max transcodes running at once per user", stats.maxRunningCountPerUser);
+			writeMetric("lms_transcode_running", "gauge", "Transcodes being run", stats.runningCount);
+			writeMetric("lms_transcode_queue_size", "gauge", "Transcodes waiting for a slot", stats.queueSize);
+			writeMetric("lms_transcode_admitted_total", "counter", "Admitted transcodes", stats.admittedCount);
+			writeMetric("lms_transcode_rejected_total", "counter", "Transcodes rejected because the queue was full", stats.rejectedCount);
+			writeMetric("lms_transcode_superseded_total", "counter", "Transcodes cancelled by a newer request of the same client", stats.supersededCount);
+			writeMetric("lms_transcode_wait_seconds_total", "counter", "Time spent by transcodes waiting for a slot", stats.totalWaitDuration.count() / 1000000.);
+			writeMetric("lms_transcode_max_wait_seconds", "gauge", "Longest time spent by a transcode waiting for a slot", stats.maxWaitDuration.count() / 1000000.);
+		}
+	}
+
+	MetricsResource::MetricsResource(const RequestMetrics& metrics)
+		: _metrics {metrics}
+		, _token {Service<IConfig>::get()->getString("api-subsonic-metrics-token", "")}
+		, _behindReverseProxy {Service<IConfig>::get()->getBool("behind-reverse-proxy", false)}
+	{
+	}
+
+	MetricsResource::~MetricsResource()
+	{
+		beingDeleted();
+	}
+
+	void
+	MetricsResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response)
+	{
+		if (!isAuthorized(request))
+		{
+			LMS_LOG(API_SUBSONIC, DEBUG) << "Rejecting metrics request from '" << request.clientAddress() << "'";
+			response.setStatus(403);
+			return;
+		}
+
+		response.setMimeType("text/plain; version=0.0.4");
+		_metrics.writePrometheusText(response.out());
+
+		if (const IJobScheduler* jobScheduler {Service<IJobScheduler>::get()})
+			writeJobPoolMetrics(*jobScheduler, response.out());
+
+		if (const Av::ITranscodeScheduler* transcodeScheduler {Service<Av::ITranscodeScheduler>::get()})
+			writeTranscodeMetrics(*transcodeScheduler, response.out());
+	}
+
+	bool
+	MetricsResource::isAuthorized(const Wt::Http::Request& request) const
+	{
+		if (!_token.empty())
+		{
+			static constexpr std::string_view bearerPrefix {"Bearer "};
+
+			const std::string authorization {request.headerValue("Authorization")};
+			return authorization.size() > bearerPrefix.size()
+				&& authorization.compare(0, bearerPrefix.size(), bearerPrefix) == 0
+				&& isSameToken(std::string_view {authorization}.substr(bearerPrefix.size()), _token);
+		}
+
+		// Behind a reverse proxy, all the requests come from the proxy
+		if (_behindReverseProxy || isForwarded(request))
+			return false;
+
+		return isLocalAddress(request.clientAddress());
+	}
+} // namespace API::Subsonic
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <Wt/WResource.h>
+
+#include "RequestMetrics.hpp"
+
+namespace API::Subsonic
+{
+	// Serves the request metrics in the Prometheus text format
+	// Access requires the configured token, or else a direct local client
+	class MetricsResource final : public Wt::WResource
+	{
+		public:
+			MetricsResource(const RequestMetrics& metrics);
+			~MetricsResource() override;
+
+		private:
+			void handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response) override;
+			bool isAuthorized(const Wt::Http::Request& request) const;
+
+			const RequestMetrics& _metrics;
+			const std::string _token;
+			const bool _behindReverseProxy;
+	};
+} // namespace API::Subsonic
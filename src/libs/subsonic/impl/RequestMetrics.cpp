@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RequestMetrics.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "utils/Logger.hpp"
+
+namespace API::Subsonic
+{
+	namespace
+	{
+		double toSeconds(std::chrono::microseconds duration)
+		{
+			return std::chrono::duration<double> {duration}.count();
+		}
+	}
+
+	RequestMetrics::RequestMetrics(std::chrono::seconds summaryPeriod)
+		: _summaryPeriod {summaryPeriod}
+		, _lastSummaryTime {std::chrono::steady_clock::now()}
+	{
+	}
+
+	void
+	RequestMetrics::record(std::string_view endpoint, const RequestStats& stats)
+	{
+		bool summaryNeeded {};
+
+		{
+			std::scoped_lock lock {_mutex};
+
+			auto itEndpoint {_endpointMetrics.find(endpoint)};
+			if (itEndpoint == std::cend(_endpointMetrics))
+				itEndpoint = _endpointMetrics.emplace(std::string {endpoint}, EndpointMetrics {}).first;
+
+			EndpointMetrics& metrics {itEndpoint->second};
+			metrics.requestCount++;
+			metrics.totalDuration += stats.duration;
+			metrics.maxDuration = std::max(metrics.maxDuration, stats.duration);
+			metrics.responseBytes += stats.responseBytes;
+			metrics.dbTransactionCount += stats.dbTransactionCount;
+			metrics.dbStatementCount += stats.dbStatementCount;
+			metrics.dbLockWaitDuration += stats.dbLockWaitDuration;
+			if (stats.errorCode)
+				metrics.errorCounts[*stats.errorCode]++;
+
+			const auto itBucket {std::find_if(std::cbegin(latencyBuckets), std::cend(latencyBuckets), [&](unsigned bucket) { return stats.duration <= std::chrono::milliseconds {bucket}; })};
+			if (itBucket != std::cend(latencyBuckets))
+				metrics.latencyBucketCounts[std::distance(std::cbegin(latencyBuckets), itBucket)]++;
+
+			if (_summaryPeriod.count() > 0)
+			{
+				const auto now {std::chrono::steady_clock::now()};
+				if (now - _lastSummaryTime >= _summaryPeriod)
+				{
+					_lastSummaryTime = now;
+					summaryNeeded = true;
+				}
+			}
+		}
+
+		if (summaryNeeded)
+			logSummary();
+	}
+
+	void
+	RequestMetrics::writePrometheusText(std::ostream& os) const
+	{
+		std::scoped_lock lock {_mutex};
+
+		os << "# HELP lms_subsonic_request_duration_seconds Subsonic API request duration\n";
+		os << "# TYPE lms_subsonic_request_duration_seconds histogram\n";
+		for (const auto& [endpoint, metrics] : _endpointMetrics)
+		{
+			std::size_t cumulativeCount {};
+			for (std::size_t i {}; i < latencyBuckets.size(); ++i)
+			{
+				cumulativeCount += metrics.latencyBucketCounts[i];
+				os << "lms_subsonic_request_duration_seconds_bucket{endpoint=\"" << endpoint << "\",le=\"" << latencyBuckets[i] / 1000. << "\"} " << cumulativeCount << "\n";
+			}
+			os << "lms_subsonic_request_duration_seconds_bucket{endpoint=\"" << endpoint << "\",le=\"+Inf\"} " << metrics.requestCount << "\n";
+			os << "lms_subsonic_request_duration_seconds_sum{endpoint=\"" << endpoint << "\"} " << toSeconds(metrics.totalDuration) << "\n";
+			os << "lms_subsonic_request_duration_seconds_count{endpoint=\"" << endpoint << "\"} " << metrics.requestCount << "\n";
+		}
+
+		os << "# HELP lms_subsonic_request_errors_total Subsonic API requests answered with an error, by Subsonic error code\n";
+		os << "# TYPE lms_subsonic_request_errors_total counter\n";
+		for (const auto& [endpoint, metrics] : _endpointMetrics)
+		{
+			for (const auto& [errorCode, count] : metrics.errorCounts)
+				os << "lms_subsonic_request_errors_total{endpoint=\"" << endpoint << "\",code=\"" << errorCode << "\"} " << count << "\n";
+		}
+
+		os << "# HELP lms_subsonic_response_bytes_total Subsonic API response bytes (media retrieval excluded)\n";
+		os << "# TYPE lms_subsonic_response_bytes_total counter\n";
+		for (const auto& [endpoint, metrics] : _endpointMetrics)
+			os << "lms_subsonic_response_bytes_total{endpoint=\"" << endpoint << "\"} " << metrics.responseBytes << "\n";
+
+		os << "# HELP lms_subsonic_db_transactions_total Database transactions made while handling Subsonic API requests\n";
+		os << "# TYPE lms_subsonic_db_transactions_total counter\n";
+		for (const auto& [endpoint, metrics] : _endpointMetrics)
+			os << "lms_subsonic_db_transactions_total{endpoint=\"" << endpoint << "\"} " << metrics.dbTransactionCount << "\n";
+
+		os << "# HELP lms_subsonic_db_statements_total Database statements executed while handling Subsonic API requests\n";
+		os << "# TYPE lms_subsonic_db_statements_total counter\n";
+		for (const auto& [endpoint, metrics] : _endpointMetrics)
+			os << "lms_subsonic_db_statements_total{endpoint=\"" << endpoint << "\"} " << metrics.dbStatementCount << "\n";
+
+		os << "# HELP lms_subsonic_db_lock_wait_seconds_total Time spent waiting for the database lock while handling Subsonic API requests\n";
+		os << "# TYPE lms_subsonic_db_lock_wait_seconds_total counter\n";
+		for (const auto& [endpoint, metrics] : _endpointMetrics)
+			os << "lms_subsonic_db_lock_wait_seconds_total{endpoint=\"" << endpoint << "\"} " << toSeconds(metrics.dbLockWaitDuration) << "\n";
+	}
+
+	void
+	RequestMetrics::logSummary() const
+	{
+		static constexpr std::size_t maxLoggedEndpoints {10};
+
+		std::vector<std::pair<std::string, EndpointMetrics>> endpointMetrics;
+		{
+			std::scoped_lock lock {_mutex};
+			endpointMetrics.assign(std::cbegin(_endpointMetrics), std::cend(_endpointMetrics));
+		}
+
+		// Most time consuming endpoints first
+		std::sort(std::begin(endpointMetrics), std::end(endpointMetrics), [](const auto& a, const auto& b) { return a.second.totalDuration > b.second.totalDuration; });
+		if (endpointMetrics.size() > maxLoggedEndpoints)
+			endpointMetrics.resize(maxLoggedEndpoints);
+
+		LMS_LOG(API_SUBSONIC, INFO) << "Request summary (top " << endpointMetrics.size() << " endpoints by total time):";
+		for (const auto& [endpoint, metrics] : endpointMetrics)
+		{
+			std::size_t errorCount {};
+			for (const auto& [errorCode, count] : metrics.errorCounts)
+				errorCount += count;
+
+			LMS_LOG(API_SUBSONIC, INFO) << endpoint << ": count = " << metrics.requestCount
+				<< ", total = " << metrics.totalDuration.count() / 1000 << " ms"
+				<< ", avg = " << metrics.totalDuration.count() / 1000 / metrics.requestCount << " ms"
+				<< ", max = " << metrics.maxDuration.count() / 1000 << " ms"
+				<< ", errors = " << errorCount
+				<< ", bytes = " << metrics.responseBytes
+				<< ", db transactions = " << metrics.dbTransactionCount
+				<< ", db statements = " << metrics.dbStatementCount
+				<< ", db lock wait = " << metrics.dbLockWaitDuration.count() / 1000 << " ms";
+		}
+	}
+} // namespace API::Subsonic
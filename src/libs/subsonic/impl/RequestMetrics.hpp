@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace API::Subsonic
+{
+	// Per endpoint request statistics, updated by the request threads
+	class RequestMetrics
+	{
+		public:
+			RequestMetrics(std::chrono::seconds summaryPeriod); // 0 means no periodic log summary
+
+			struct RequestStats
+			{
+				std::chrono::microseconds	duration {};
+				std::size_t					responseBytes {};
+				std::optional<int>			errorCode;
+				std::size_t					dbTransactionCount {};
+				std::size_t					dbStatementCount {};
+				std::chrono::microseconds	dbLockWaitDuration {};
+			};
+			void record(std::string_view endpoint, const RequestStats& stats);
+
+			void writePrometheusText(std::ostream& os) const;
+
+		private:
+			// Upper bounds, in milliseconds
+			static constexpr std::array<unsigned, 12> latencyBuckets {1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+
+			struct EndpointMetrics
+			{
+				std::size_t									requestCount {};
+				std::array<std::size_t, latencyBuckets.size()>	latencyBucketCounts {}; // not cumulative
+				std::chrono::microseconds					totalDuration {};
+				std::chrono::microseconds					maxDuration {};
+				std::size_t									responseBytes {};
+				std::map<int, std::size_t>					errorCounts;
+				std::size_t									dbTransactionCount {};
+				std::size_t									dbStatementCount {};
+				std::chrono::microseconds					dbLockWaitDuration {};
+			};
+
+			void logSummary() const;
+
+			const std::chrono::seconds			_summaryPeriod;
+			mutable std::mutex					_mutex;
+			std::map<std::string, EndpointMetrics, std::less<>> _endpointMetrics;
+			std::chrono::steady_clock::time_point	_lastSummaryTime;
+	};
+} // namespace API::Subsonic
@@ -19,6 +19,7 @@
 
 #include "Stream.hpp"
 
+#include "av/ITranscodeScheduler.hpp"
 #include "av/TranscodeParameters.hpp"
 #include "av/TranscodeResourceHandlerCreator.hpp"
 #include "av/Types.hpp"
@@ -54,6 +55,7 @@ userTranscodeFormatToAvFormat(AudioFormat format)
 
 struct StreamParameters
 {
+	TrackId trackId;
 	Av::InputFileParameters inputFileParameters;
 	std::optional<Av::TranscodeParameters> transcodeParameters;
 	bool estimateContentLength {};
@@ -73,6 +75,7 @@ getStreamParameters(RequestContext& context)
 
 	StreamParameters parameters;
 
+	parameters.trackId = id;
 	parameters.estimateContentLength = estimateContentLength;
 
 	auto transaction {context.dbSession.createSharedTransaction()};
@@ -114,6 +117,24 @@ getStreamParameters(RequestContext& context)
 	return parameters;
 }
 
+static
+Av::ITranscodeScheduler::Request
+getTranscodeSchedulingRequest(const RequestContext& context, const StreamParameters& streamParameters)
+{
+	Av::ITranscodeScheduler::Request request;
+
+	request.user = context.userId.toString();
+	request.client = context.userId.toString() + "/" + context.clientInfo.name;
+	// Clients retry or seek by requesting the same track again
+	// Unlike the web player, they may cache the next tracks while playing: a new track must not cancel the playing one
+	request.supersedeKey = streamParameters.trackId.toString();
+
+	// The most recent request of the client is the one being played
+	request.priority = Av::ITranscodeScheduler::Priority::Playing;
+
+	return request;
+}
+
 void
 handleDownload(RequestContext& context, const Wt::Http::Request& request, Wt::Http::Response& response)
 {
@@ -160,7 +181,7 @@ handleStream(RequestContext& context, const Wt::Http::Request& request, Wt::Http
 		{
 			StreamParameters streamParameters {getStreamParameters(context)};
 			if (streamParameters.transcodeParameters)
-				resourceHandler = Av::createTranscodeResourceHandler(streamParameters.inputFileParameters, *streamParameters.transcodeParameters, streamParameters.estimateContentLength);
+				resourceHandler = Av::createTranscodeResourceHandler(streamParameters.inputFileParameters, *streamParameters.transcodeParameters, getTranscodeSchedulingRequest(context, streamParameters), streamParameters.estimateContentLength);
 			else
 				resourceHandler = createFileResourceHandler(streamParameters.inputFileParameters.trackPath);
 		}
@@ -19,13 +19,19 @@
 
 #include "SubsonicResource.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <map>
+#include <mutex>
+#include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <Wt/WLocalDateTime.h>
+#include <Wt/Http/ResponseContinuation.h>
 
 #include "services/auth/IPasswordService.hpp"
 #include "services/auth/IEnvService.hpp"
@@ -39,14 +45,19 @@
 #include "services/database/TrackList.hpp"
 #include "services/database/User.hpp"
 #include "services/recommendation/IRecommendationService.hpp"
+#include "services/scanner/IScannerService.hpp"
 #include "services/scrobbling/IScrobblingService.hpp"
 #include "services/cover/ICoverService.hpp"
+#include "utils/Compression.hpp"
 #include "utils/IConfig.hpp"
 #include "utils/Logger.hpp"
 #include "utils/Random.hpp"
 #include "utils/Service.hpp"
 #include "utils/String.hpp"
 #include "utils/Utils.hpp"
+#include "utils/http/CacheValidators.hpp"
+#include "utils/http/DeferredResponse.hpp"
+#include "MetricsResource.hpp"
 #include "ParameterParsing.hpp"
 #include "ProtocolVersion.hpp"
 #include "RequestContext.hpp"
@@ -74,6 +85,12 @@ createSubsonicResource(Database::Db& db)
 	return std::make_unique<SubsonicResource>(db);
 }
 
+std::unique_ptr<Wt::WResource>
+createSubsonicMetricsResource(const Wt::WResource& subsonicResource)
+{
+	return std::make_unique<MetricsResource>(dynamic_cast<const SubsonicResource&>(subsonicResource).getMetrics());
+}
+
 static
 void
 checkSetPasswordImplemented()
@@ -124,6 +141,10 @@ readConfigProtocolVersions()
 SubsonicResource::SubsonicResource(Db& db)
 : _serverProtocolVersionsByClient {readConfigProtocolVersions()}
 , _db {db}
+, _metricsEnabled {Service<IConfig>::get()->getBool("api-subsonic-metrics", false)}
+, _metrics {std::chrono::minutes {Service<IConfig>::get()->getULong("api-subsonic-metrics-log-period", 60)}}
+, _compressResponses {Service<IConfig>::get()->getBool("api-subsonic-compression", true)}
+, _compressionMinSize {Service<IConfig>::get()->getULong("api-subsonic-compression-min-size", 1024)}
 {
 }
 
@@ -164,11 +185,12 @@ static
 void
 checkUserIsMySelfOrAdmin(RequestContext& context, const std::string& username)
 {
-	User::pointer currentUser {User::find(context.dbSession, context.userId)};
+	const auto users {context.dbSession.getUserSettingsSnapshot()};
+	const UserSettings* currentUser {users->find(context.userId)};
 	if (!currentUser)
 		throw RequestedDataNotFoundError {};
 
-	if (currentUser->getLoginName() != username	&& !currentUser->isAdmin())
+	if (currentUser->loginName != username && currentUser->type != UserType::ADMIN)
 		throw UserNotAuthorizedError {};
 }
 
@@ -176,13 +198,12 @@ static
 void
 checkUserTypeIsAllowed(RequestContext& context, EnumSet<Database::UserType> allowedUserTypes)
 {
-	auto transaction {context.dbSession.createSharedTransaction()};
-
-	User::pointer currentUser {User::find(context.dbSession, context.userId)};
+	const auto users {context.dbSession.getUserSettingsSnapshot()};
+	const UserSettings* currentUser {users->find(context.userId)};
 	if (!currentUser)
 		throw RequestedDataNotFoundError {};
 
-	if (!allowedUserTypes.contains(currentUser->getType()))
+	if (!allowedUserTypes.contains(currentUser->type))
 		throw UserNotAuthorizedError {};
 }
 
@@ -327,10 +348,10 @@ trackToResponseNode(const Track::pointer& track, Session& dbSession, const User:
 		trackResponse.setAttribute("starred", reportedStarredDate);
 
 	// Report the first GENRE for this track
-	ClusterType::pointer clusterType {ClusterType::find(dbSession, genreClusterName)};
-	if (clusterType)
+	const ClusterTypeId clusterTypeId {dbSession.getClusterTypesSnapshot()->find(genreClusterName)};
+	if (clusterTypeId.isValid())
 	{
-		auto clusters {track->getClusterGroups({clusterType}, 1)};
+		auto clusters {track->getClusterGroups(std::vector<ClusterTypeId> {clusterTypeId}, 1)};
 		if (!clusters.empty() && !clusters.front().empty())
 			trackResponse.setAttribute("genre", clusters.front().front()->getName());
 	}
@@ -405,10 +426,10 @@ releaseToResponseNode(const Release::pointer& release, Session& dbSession, const
 	if (id3)
 	{
 		// Report the first GENRE for this track
-		ClusterType::pointer clusterType {ClusterType::find(dbSession, genreClusterName)};
-		if (clusterType)
+		const ClusterTypeId clusterTypeId {dbSession.getClusterTypesSnapshot()->find(genreClusterName)};
+		if (clusterTypeId.isValid())
 		{
-			auto clusters {release->getClusterGroups({clusterType}, 1)};
+			auto clusters {release->getClusterGroups(std::vector<ClusterTypeId> {clusterTypeId}, 1)};
 			if (!clusters.empty() && !clusters.front().empty())
 				albumNode.setAttribute("genre", clusters.front().front()->getName());
 		}
@@ -422,25 +443,35 @@ releaseToResponseNode(const Release::pointer& release, Session& dbSession, const
 
 static
 Response::Node
-artistToResponseNode(const Artist::pointer& artist, Session& session, const User::pointer& user, bool id3)
+artistToResponseNode(ArtistId artistId, std::string_view artistName, std::optional<std::size_t> albumCount, bool starred)
 {
 	Response::Node artistNode;
 
-	artistNode.setAttribute("id", idToString(artist->getId()));
-	artistNode.setAttribute("name", artist->getName());
+	artistNode.setAttribute("id", idToString(artistId));
+	artistNode.setAttribute("name", artistName);
 
-	if (id3)
-	{
-		const auto releases {Release::find(session, Release::FindParameters {}.setArtist(artist->getId()))};
-		artistNode.setAttribute("albumCount", releases.results.size());
-	}
+	if (albumCount)
+		artistNode.setAttribute("albumCount", *albumCount);
 
-	if (Service<Scrobbling::IScrobblingService>::get()->isStarred(user->getId(), artist->getId()))
+	if (starred)
 		artistNode.setAttribute("starred", reportedStarredDate);
 
 	return artistNode;
 }
 
+static
+Response::Node
+artistToResponseNode(const Artist::pointer& artist, Session& session, const User::pointer& user, bool id3)
+{
+	std::optional<std::size_t> albumCount;
+	if (id3)
+		albumCount = Release::find(session, Release::FindParameters {}.setArtist(artist->getId())).results.size();
+
+	const bool starred {Service<Scrobbling::IScrobblingService>::get()->isStarred(user->getId(), artist->getId())};
+
+	return artistToResponseNode(artist->getId(), artist->getName(), albumCount, starred);
+}
+
 static
 Response::Node
 clusterToResponseNode(const Cluster::pointer& cluster)
@@ -717,6 +748,47 @@ handleGetRandomSongsRequest(RequestContext& context)
 	return response;
 }
 
+// Subsonic does not provide any seed to paginate random lists: keep one per user and client,
+// renewed each time the first page is requested
+// Client names are free: only the most recently used seeds are kept
+static
+std::uint32_t
+getRandomSeed(const RequestContext& context, std::size_t offset)
+{
+	static constexpr std::size_t maxRandomSeedCount {1024};
+
+	struct RandomSeed
+	{
+		std::uint32_t							seed {};
+		std::chrono::steady_clock::time_point	lastUsed;
+	};
+
+	static std::mutex mutex;
+	static std::map<std::pair<UserId, std::string>, RandomSeed> randomSeeds;
+
+	std::scoped_lock lock {mutex};
+
+	auto itSeed {randomSeeds.find({context.userId, context.clientInfo.name})};
+	if (itSeed == std::end(randomSeeds))
+	{
+		if (randomSeeds.size() >= maxRandomSeedCount)
+		{
+			const auto itLeastRecentlyUsed {std::min_element(std::cbegin(randomSeeds), std::cend(randomSeeds),
+					[](const auto& seed1, const auto& seed2) { return seed1.second.lastUsed < seed2.second.lastUsed; })};
+			randomSeeds.erase(itLeastRecentlyUsed);
+		}
+
+		itSeed = randomSeeds.try_emplace({context.userId, context.clientInfo.name}).first;
+		offset = 0;
+	}
+
+	if (offset == 0)
+		itSeed->second.seed = static_cast<std::uint32_t>(Random::getRandGenerator()());
+	itSeed->second.lastUsed = std::chrono::steady_clock::now();
+
+	return itSeed->second.seed;
+}
+
 static
 Response
 handleGetAlbumListRequestCommon(const RequestContext& context, bool id3)
@@ -795,11 +867,10 @@ handleGetAlbumListRequestCommon(const RequestContext& context, bool id3)
 	}
 	else if (type == "random")
 	{
-		// Random results are paginated, but there is no acceptable way to handle the pagination params without repeating some albums
-		// (no seed provided by subsonic, ot it would require to store some kind of context for each user/client when iterating over the random albums)
 		Release::FindParameters params;
 		params.setSortMethod(ReleaseSortMethod::Random);
-		params.setRange({0, size});
+		params.setRandomSeed(getRandomSeed(context, offset));
+		params.setRange(range);
 
 		releases = Release::find(context.dbSession, params);
 	}
@@ -1074,24 +1145,145 @@ handleGetMusicFoldersRequest(RequestContext& context)
 }
 
 static
-Response
+unsigned long long
+getLibraryLastModified()
+{
+	const Wt::WDateTime lastModified {Service<Scanner::IScannerService>::get()->getLibraryGeneration().lastModified};
+	if (!lastModified.isValid())
+		return reportedDummyDateULong;
+
+	return static_cast<unsigned long long>(lastModified.toTime_t()) * 1000;
+}
+
+namespace
+{
+	// Whole response, written at once
+	class SingleResponseStream final : public IResponseStream
+	{
+		public:
+			SingleResponseStream(Response response) : _response {std::move(response)} {}
+
+		private:
+			bool writeNext(Session&, std::ostream& os, ResponseFormat format) override
+			{
+				_response.write(os, format);
+				return false;
+			}
+
+			Response _response;
+	};
+
+	// One index per sort name initial, the non letter one first
+	// Each index is read in its own transaction, and written as soon as it is complete
+	class ArtistIndexesStream final : public IResponseStream
+	{
+		public:
+			ArtistIndexesStream(Response response, UserId userId, const Artist::FindParameters& parameters, bool id3)
+				: _response {std::move(response)}
+				, _userId {userId}
+				, _parameters {parameters}
+				, _id3 {id3}
+			{}
+
+		private:
+			static constexpr std::string_view indexNames {"?ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+
+			bool writeNext(Session& session, std::ostream& os, ResponseFormat format) override
+			{
+				if (_nextIndex == 0)
+					_response.writeStreamBegin(os, format, "index");
+
+				// Empty indexes are not reported
+				while (_nextIndex < indexNames.size())
+				{
+					if (writeIndex(session, os, format, indexNames[_nextIndex++]))
+						return true;
+				}
+
+				_response.writeStreamEnd(os, format);
+				return false;
+			}
+
+			bool writeIndex(Session& session, std::ostream& os, ResponseFormat format, char indexName)
+			{
+				std::vector<Artist::NameResult> artists;
+				std::vector<ArtistId> artistIds;
+				std::unordered_map<ArtistId, std::size_t> releaseCounts;
+				{
+					auto transaction {session.createSharedTransaction()};
+
+					Artist::find(session, Artist::FindParameters {_parameters}.setSortNameInitial(indexName), [&](const Artist::NameResult& artist)
+					{
+						artists.push_back(artist);
+						artistIds.push_back(artist.id);
+					});
+
+					if (artists.empty())
+						return false;
+
+					if (_id3)
+						releaseCounts = Artist::getReleaseCounts(session, artistIds);
+				}
+
+				const std::unordered_set<ArtistId> starredArtists {Service<Scrobbling::IScrobblingService>::get()->findStarredArtists(_userId, artistIds)};
+
+				Response::Node indexNode;
+				indexNode.setAttribute("name", std::string {indexName});
+				for (const Artist::NameResult& artist : artists)
+				{
+					std::optional<std::size_t> albumCount;
+					if (_id3)
+					{
+						const auto itReleaseCount {releaseCounts.find(artist.id)};
+						albumCount = itReleaseCount != std::cend(releaseCounts) ? itReleaseCount->second : 0;
+					}
+
+					indexNode.addArrayChild("artist", artistToResponseNode(artist.id, artist.name, albumCount, starredArtists.find(artist.id) != std::cend(starredArtists)));
+				}
+
+				Response::writeStreamArrayChild(os, format, "index", indexNode, !_hasWrittenIndex);
+				_hasWrittenIndex = true;
+
+				return true;
+			}
+
+			Response						_response;
+			const UserId					_userId;
+			const Artist::FindParameters	_parameters;
+			const bool						_id3;
+			std::size_t						_nextIndex {};
+			bool							_hasWrittenIndex {};
+	};
+}
+
+static
+std::unique_ptr<IResponseStream>
 handleGetArtistsRequestCommon(RequestContext& context, bool id3)
 {
 	Response response {Response::createOkResponse(context.serverProtocolVersion)};
 
+	const unsigned long long lastModified {getLibraryLastModified()};
+
 	Response::Node& artistsNode {response.createNode(id3 ? "artists" : "indexes")};
 	artistsNode.setAttribute("ignoredArticles", "");
-	artistsNode.setAttribute("lastModified", reportedDummyDateULong);
+	artistsNode.setAttribute("lastModified", lastModified);
 
-	auto transaction {context.dbSession.createSharedTransaction()};
+	// Only report the contents if the library changed since the client last asked
+	if (!id3)
+	{
+		const std::optional<unsigned long long> ifModifiedSince {getParameterAs<unsigned long long>(context.parameters, "ifModifiedSince")};
+		if (ifModifiedSince && lastModified <= *ifModifiedSince)
+			return std::make_unique<SingleResponseStream>(std::move(response));
+	}
 
-	User::pointer user {User::find(context.dbSession, context.userId)};
+	const auto users {context.dbSession.getUserSettingsSnapshot()};
+	const UserSettings* user {users->find(context.userId)};
 	if (!user)
 		throw UserNotAuthorizedError {};
 
 	Artist::FindParameters parameters;
 	parameters.setSortMethod(ArtistSortMethod::BySortName);
-	switch (user->getSubsonicArtistListMode())
+	switch (user->subsonicArtistListMode)
 	{
 		case SubsonicArtistListMode::AllArtists:
 			break;
@@ -1103,37 +1295,11 @@ handleGetArtistsRequestCommon(RequestContext& context, bool id3)
 			break;
 	}
 
-	std::map<char, std::vector<Artist::pointer>> artistsSortedByFirstChar;
-	const RangeResults<ArtistId> artists {Artist::find(context.dbSession, parameters)};
-	for (const ArtistId artistId : artists.results)
-	{
-		const Artist::pointer artist {Artist::find(context.dbSession, artistId)};
-		const std::string& sortName {artist->getSortName()};
-
-		char sortChar;
-		if (sortName.empty() || !std::isalpha(sortName[0]))
-			sortChar = '?';
-		else
-			sortChar = std::toupper(sortName[0]);
-
-		artistsSortedByFirstChar[sortChar].push_back(artist);
-	}
-
-
-	for (const auto& [sortChar, artists] : artistsSortedByFirstChar)
-	{
-		Response::Node& indexNode {artistsNode.createArrayChild("index")};
-		indexNode.setAttribute("name", std::string {sortChar});
-
-		for (const Artist::pointer& artist :artists)
-			indexNode.addArrayChild("artist", artistToResponseNode(artist, context.dbSession, user, id3));
-	}
-
-	return response;
+	return std::make_unique<ArtistIndexesStream>(std::move(response), context.userId, parameters, id3);
 }
 
 static
-Response
+std::unique_ptr<IResponseStream>
 handleGetIndexesRequest(RequestContext& context)
 {
 	return handleGetArtistsRequestCommon(context, false /* no id3 */);
@@ -1162,7 +1328,7 @@ handleGetGenresRequest(RequestContext& context)
 }
 
 static
-Response
+std::unique_ptr<IResponseStream>
 handleGetArtistsRequest(RequestContext& context)
 {
 	return handleGetArtistsRequestCommon(context, true /* id3 */);
@@ -1872,9 +2038,20 @@ handleNotImplemented(RequestContext&)
 	throw NotImplementedGenericError {};
 }
 
+using CoverResult = std::shared_ptr<std::shared_ptr<Image::IEncodedImage>>;
+
 static
 void
-handleGetCoverArt(RequestContext& context, const Wt::Http::Request& /*request*/, Wt::Http::Response& response)
+completeGetCoverArt(const CoverResult& result, Wt::Http::Response& response)
+{
+	const std::shared_ptr<Image::IEncodedImage> cover {*result};
+	if (cover)
+		response.out().write(reinterpret_cast<const char*>(cover->getData()), cover->getDataSize());
+}
+
+static
+void
+handleGetCoverArt(RequestContext& context, const Wt::Http::Request& request, Wt::Http::Response& response)
 {
 	// Mandatory params
 	const auto trackId {getParameterAs<TrackId>(context.parameters, "id")};
@@ -1886,17 +2063,32 @@ handleGetCoverArt(RequestContext& context, const Wt::Http::Request& /*request*/,
 	std::size_t size {getParameterAs<std::size_t>(context.parameters, "size").value_or(256)};
 	size = Utils::clamp(size, std::size_t {32}, std::size_t {1024});
 
-	std::shared_ptr<Image::IEncodedImage> cover;
-	if (trackId)
-		cover = Service<Cover::ICoverService>::get()->getFromTrack(*trackId, size);
-	else if (releaseId)
-		cover = Service<Cover::ICoverService>::get()->getFromRelease(*releaseId, size);
+	// Covers can only change when the scanner updates the library, or if they are encoded differently
+	{
+		const Scanner::IScannerService::LibraryGeneration libraryGeneration {Service<Scanner::IScannerService>::get()->getLibraryGeneration()};
 
-	response.out().write(reinterpret_cast<const char*>(cover->getData()), cover->getDataSize());
-	response.setMimeType(std::string {cover->getMimeType()});
+		Http::CacheValidators validators;
+		validators.etag = "\"" + std::to_string(libraryGeneration.value) + "-" + std::to_string(size) + "-q" + std::to_string(Service<Cover::ICoverService>::get()->getJpegQuality()) + "\"";
+		if (libraryGeneration.lastModified.isValid())
+			validators.lastModified = libraryGeneration.lastModified.toTime_t();
+		validators.cacheControl = "private, no-cache";
+
+		if (Http::handleConditionalRequest(request, response, validators))
+			return;
+	}
+
+	response.setMimeType("image/jpeg");
+
+	const CoverResult cover {std::make_shared<std::shared_ptr<Image::IEncodedImage>>()};
+	Http::deferResponse(response, cover, IJobScheduler::Pool::CPU, IJobScheduler::Priority::Normal, [=]
+	{
+		if (trackId)
+			*cover = Service<Cover::ICoverService>::get()->getFromTrack(*trackId, size);
+		else if (releaseId)
+			*cover = Service<Cover::ICoverService>::get()->getFromRelease(*releaseId, size);
+	});
 }
 
-using RequestHandlerFunc = std::function<Response(RequestContext& context)>;
 using CheckImplementedFunc = std::function<void()>;
 struct RequestEntryPointInfo
 {
@@ -1913,10 +2105,8 @@ static const std::unordered_map<std::string, RequestEntryPointInfo> requestEntry
 
 	// Browsing
 	{"/getMusicFolders",	{handleGetMusicFoldersRequest}},
-	{"/getIndexes",		{handleGetIndexesRequest}},
 	{"/getMusicDirectory",	{handleGetMusicDirectoryRequest}},
 	{"/getGenres",		{handleGetGenresRequest}},
-	{"/getArtists",		{handleGetArtistsRequest}},
 	{"/getArtist",		{handleGetArtistRequest}},
 	{"/getAlbum",		{handleGetAlbumRequest}},
 	{"/getSong",		{handleGetSongRequest}},
@@ -2010,6 +2200,80 @@ static const std::unordered_map<std::string, RequestEntryPointInfo> requestEntry
 	{"/startScan",		{Scan::handleStartScan,			{UserType::ADMIN}}},
 };
 
+// Responses written in several parts, out of the server threads
+static const std::unordered_map<std::string, StreamedRequestHandlerFunc> streamedEntryPoints
+{
+	{"/getIndexes",		handleGetIndexesRequest},
+	{"/getArtists",		handleGetArtistsRequest},
+};
+
+// Database heavy requests, processed out of the server threads
+static const std::unordered_set<std::string_view> ioBoundEntryPoints
+{
+	"/getArtistInfo",
+	"/getArtistInfo2",
+	"/getSimilarSongs",
+	"/getSimilarSongs2",
+	"/getAlbumList",
+	"/getAlbumList2",
+	"/getRandomSongs",
+	"/getSongsByGenre",
+	"/getStarred",
+	"/getStarred2",
+	"/search2",
+	"/search3",
+	"/getPlaylist",
+};
+
+struct DeferredRequest
+{
+	std::size_t										requestId;
+	std::string_view								endpoint;
+	std::chrono::steady_clock::time_point			startTime;
+	Wt::Http::ParameterMap							parameters;	// the request is not available from the job
+	ResponseFormat									format;
+	std::unique_ptr<IResponseStream>				stream;		// set by the first job
+	bool											complete {};
+	std::ostringstream								pendingOutput;	// encoded, not sent yet
+	std::unique_ptr<Compression::EncodingStreamBuffer>	encoder;	// writes to pendingOutput
+	RequestMetrics::RequestStats					stats;
+};
+
+static
+void
+writeDeferredResponsePart(DeferredRequest& deferredRequest, Session& session)
+{
+	const Session::ThreadStats dbStatsBefore {Session::getThreadStats()};
+
+	try
+	{
+		std::ostream os {deferredRequest.encoder.get()};
+		os.exceptions(std::ios::badbit); // do not swallow encoding errors
+		deferredRequest.complete = !deferredRequest.stream->writeNext(session, os, deferredRequest.format);
+	}
+	catch (const Error& e)
+	{
+		// Some parts may have already been sent: just end the response
+		LMS_LOG(API_SUBSONIC, ERROR) << "Error while writing response " << deferredRequest.requestId << " '" << deferredRequest.endpoint << "'"
+			<< ", code = " << static_cast<int>(e.getCode()) << ", msg = '" << e.getMessage() << "'";
+		deferredRequest.stats.errorCode = static_cast<int>(e.getCode());
+		deferredRequest.complete = true;
+	}
+	catch (const std::exception& e)
+	{
+		LMS_LOG(API_SUBSONIC, ERROR) << "Exception while writing response " << deferredRequest.requestId << " '" << deferredRequest.endpoint << "': " << e.what();
+		deferredRequest.complete = true;
+	}
+
+	if (deferredRequest.complete)
+		deferredRequest.encoder->finish();
+
+	const Session::ThreadStats dbStatsAfter {Session::getThreadStats()};
+	deferredRequest.stats.dbTransactionCount += dbStatsAfter.transactionCount - dbStatsBefore.transactionCount;
+	deferredRequest.stats.dbStatementCount += dbStatsAfter.statementCount - dbStatsBefore.statementCount;
+	deferredRequest.stats.dbLockWaitDuration += dbStatsAfter.lockWaitDuration - dbStatsBefore.lockWaitDuration;
+}
+
 using MediaRetrievalHandlerFunc = std::function<void(RequestContext&, const Wt::Http::Request&, Wt::Http::Response&)>;
 static std::unordered_map<std::string, MediaRetrievalHandlerFunc> mediaRetrievalHandlers
 {
@@ -2022,6 +2286,67 @@ static std::unordered_map<std::string, MediaRetrievalHandlerFunc> mediaRetrieval
 
 void
 SubsonicResource::handleRequest(const Wt::Http::Request &request, Wt::Http::Response &response)
+{
+	// Deferred requests are resumed once processed, the user has already been authenticated
+	if (Wt::Http::ResponseContinuation* continuation {request.continuation()})
+	{
+		if (continuation->data().type() == typeid(std::shared_ptr<DeferredRequest>))
+		{
+			completeDeferredRequest(Wt::cpp17::any_cast<std::shared_ptr<DeferredRequest>>(continuation->data()), response);
+			return;
+		}
+
+		if (continuation->data().type() == typeid(CoverResult))
+		{
+			completeGetCoverArt(Wt::cpp17::any_cast<CoverResult>(continuation->data()), response);
+			return;
+		}
+	}
+
+	std::string_view endpoint {"unknown"};
+	RequestMetrics::RequestStats stats;
+
+	if (!_metricsEnabled)
+	{
+		processRequest(request, response, endpoint, stats);
+		return;
+	}
+
+	const auto startTime {std::chrono::steady_clock::now()};
+	const Session::ThreadStats dbStatsBefore {Session::getThreadStats()};
+	bool deferred {};
+
+	auto recordMetrics {[&]
+	{
+		// Continuations of media retrieval requests are not accounted
+		// Deferred requests are accounted once completed
+		if (request.continuation() || deferred)
+			return;
+
+		const Session::ThreadStats dbStatsAfter {Session::getThreadStats()};
+
+		stats.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+		stats.dbTransactionCount = dbStatsAfter.transactionCount - dbStatsBefore.transactionCount;
+		stats.dbStatementCount = dbStatsAfter.statementCount - dbStatsBefore.statementCount;
+		stats.dbLockWaitDuration = dbStatsAfter.lockWaitDuration - dbStatsBefore.lockWaitDuration;
+		_metrics.record(endpoint, stats);
+	}};
+
+	try
+	{
+		deferred = processRequest(request, response, endpoint, stats);
+	}
+	catch (...)
+	{
+		recordMetrics();
+		throw;
+	}
+
+	recordMetrics();
+}
+
+bool
+SubsonicResource::processRequest(const Wt::Http::Request& request, Wt::Http::Response& response, std::string_view& endpoint, RequestMetrics::RequestStats& stats)
 {
 	static std::atomic<std::size_t> curRequestId {};
 
@@ -2033,6 +2358,14 @@ SubsonicResource::handleRequest(const Wt::Http::Request &request, Wt::Http::Resp
 	if (StringUtils::stringEndsWith(requestPath, ".view"))
 		requestPath.resize(requestPath.length() - 5);
 
+	// Known endpoints only, to keep the metrics bounded
+	if (auto itEntryPoint {requestEntryPoints.find(requestPath)}; itEntryPoint != std::cend(requestEntryPoints))
+		endpoint = itEntryPoint->first;
+	else if (auto itStreamedEntryPoint {streamedEntryPoints.find(requestPath)}; itStreamedEntryPoint != std::cend(streamedEntryPoints))
+		endpoint = itStreamedEntryPoint->first;
+	else if (auto itStreamHandler {mediaRetrievalHandlers.find(requestPath)}; itStreamHandler != std::cend(mediaRetrievalHandlers))
+		endpoint = itStreamHandler->first;
+
 	// Optional parameters
 	const ResponseFormat format {getParameterAs<std::string>(request.getParameterMap(), "f").value_or("xml") == "json" ? ResponseFormat::json : ResponseFormat::xml};
 
@@ -2052,13 +2385,27 @@ SubsonicResource::handleRequest(const Wt::Http::Request &request, Wt::Http::Resp
 
 			checkUserTypeIsAllowed(requestContext, itEntryPoint->second.allowedUserTypes);
 
+			if (ioBoundEntryPoints.find(requestPath) != std::cend(ioBoundEntryPoints))
+			{
+				deferRequest(requestId, endpoint, format, [func = itEntryPoint->second.func](RequestContext& context)
+				{
+					return std::make_unique<SingleResponseStream>(func(context));
+				}, requestContext, request, response);
+				return true;
+			}
+
 			Response resp {(itEntryPoint->second.func)(requestContext)};
 
-			resp.write(response.out(), format);
-			response.setMimeType(ResponseFormatToMimeType(format));
+			stats.responseBytes = writeResponse(resp, format, request, response);
 
 			LMS_LOG(API_SUBSONIC, DEBUG) << "Request " << requestId << " '" << requestPath << "' handled!";
-			return;
+			return false;
+		}
+
+		if (auto itStreamedEntryPoint {streamedEntryPoints.find(requestPath)}; itStreamedEntryPoint != std::cend(streamedEntryPoints))
+		{
+			deferRequest(requestId, endpoint, format, itStreamedEntryPoint->second, requestContext, request, response);
+			return true;
 		}
 
 		auto itStreamHandler {mediaRetrievalHandlers.find(requestPath)};
@@ -2066,7 +2413,7 @@ SubsonicResource::handleRequest(const Wt::Http::Request &request, Wt::Http::Resp
 		{
 			itStreamHandler->second(requestContext, request, response);
 			LMS_LOG(API_SUBSONIC, DEBUG) << "Request " << requestId  << " '" << requestPath << "' handled!";
-			return;
+			return false;
 		}
 
 		LMS_LOG(API_SUBSONIC, ERROR) << "Unhandled command '" << requestPath << "'";
@@ -2078,9 +2425,123 @@ SubsonicResource::handleRequest(const Wt::Http::Request &request, Wt::Http::Resp
 			<< ", params = [" << parameterMapToDebugString(request.getParameterMap()) << "]"
 			<< ", code = " << static_cast<int>(e.getCode()) << ", msg = '" << e.getMessage() << "'";
 		Response resp {Response::createFailedResponse(protocolVersion, e)};
-		resp.write(response.out(), format);
-		response.setMimeType(ResponseFormatToMimeType(format));
+		stats.errorCode = static_cast<int>(e.getCode());
+		stats.responseBytes = writeResponse(resp, format, request, response);
+	}
+
+	return false;
+}
+
+void
+SubsonicResource::deferRequest(std::size_t requestId, std::string_view endpoint, ResponseFormat format, const StreamedRequestHandlerFunc& func, const RequestContext& requestContext, const Wt::Http::Request& request, Wt::Http::Response& response)
+{
+	auto deferredRequest {std::make_shared<DeferredRequest>()};
+	deferredRequest->requestId = requestId;
+	deferredRequest->endpoint = endpoint;
+	deferredRequest->startTime = std::chrono::steady_clock::now();
+	deferredRequest->parameters = request.getParameterMap();
+	deferredRequest->format = format;
+	// The response size is not known yet
+	deferredRequest->encoder = std::make_unique<Compression::EncodingStreamBuffer>(deferredRequest->pendingOutput, setResponseHeaders(format, std::nullopt, request, response));
+
+	Http::deferResponse(response, deferredRequest, IJobScheduler::Pool::IO, IJobScheduler::Priority::Normal,
+		[deferredRequest, func, &db = _db, userId = requestContext.userId, clientInfo = requestContext.clientInfo, serverProtocolVersion = requestContext.serverProtocolVersion]
+		{
+			RequestContext requestContext {deferredRequest->parameters, db.getTLSSession(), userId, clientInfo, serverProtocolVersion};
+			try
+			{
+				deferredRequest->stream = func(requestContext);
+			}
+			catch (const Error& e)
+			{
+				LMS_LOG(API_SUBSONIC, ERROR) << "Error while processing request " << deferredRequest->requestId << " '" << deferredRequest->endpoint << "'"
+					<< ", code = " << static_cast<int>(e.getCode()) << ", msg = '" << e.getMessage() << "'";
+				deferredRequest->stream = std::make_unique<SingleResponseStream>(Response::createFailedResponse(serverProtocolVersion, e));
+				deferredRequest->stats.errorCode = static_cast<int>(e.getCode());
+			}
+
+			writeDeferredResponsePart(*deferredRequest, requestContext.dbSession);
+		});
+}
+
+void
+SubsonicResource::completeDeferredRequest(const std::shared_ptr<DeferredRequest>& deferredRequest, Wt::Http::Response& response)
+{
+	const std::string output {deferredRequest->pendingOutput.str()};
+	response.out().write(output.data(), output.size());
+	deferredRequest->pendingOutput.str("");
+	deferredRequest->stats.responseBytes += output.size();
+
+	if (deferredRequest->stream && !deferredRequest->complete)
+	{
+		Http::deferResponse(response, deferredRequest, IJobScheduler::Pool::IO, IJobScheduler::Priority::Normal, [deferredRequest, &db = _db]
+		{
+			writeDeferredResponsePart(*deferredRequest, db.getTLSSession());
+		});
+		return;
 	}
+
+	if (deferredRequest->stream)
+	{
+		const Compression::EncodingStreamBuffer& encoder {*deferredRequest->encoder};
+		if (encoder.getEncoding() != Compression::Encoding::Identity)
+			LMS_LOG(API_SUBSONIC, DEBUG) << "Response compressed using " << Compression::encodingToString(encoder.getEncoding()) << ": " << encoder.getInputSize() << " -> " << encoder.getOutputSize() << " bytes";
+
+		LMS_LOG(API_SUBSONIC, DEBUG) << "Request " << deferredRequest->requestId << " '" << deferredRequest->endpoint << "' handled!";
+	}
+
+	if (_metricsEnabled)
+	{
+		deferredRequest->stats.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - deferredRequest->startTime);
+		_metrics.record(deferredRequest->endpoint, deferredRequest->stats);
+	}
+}
+
+std::size_t
+SubsonicResource::writeResponse(Response& resp, ResponseFormat format, const Wt::Http::Request& request, Wt::Http::Response& response) const
+{
+	// Only small responses are fully buffered, their size decides whether they are compressed
+	Compression::EncodingStreamBuffer streamBuffer {response.out(), _compressionMinSize, [&](std::optional<std::size_t> bodySize)
+	{
+		return setResponseHeaders(format, bodySize, request, response);
+	}};
+
+	return writeResponseBody(resp, format, streamBuffer);
+}
+
+Compression::Encoding
+SubsonicResource::setResponseHeaders(ResponseFormat format, std::optional<std::size_t> bodySize, const Wt::Http::Request& request, Wt::Http::Response& response) const
+{
+	response.setMimeType(ResponseFormatToMimeType(format));
+
+	Compression::Encoding encoding {Compression::Encoding::Identity};
+	if (_compressResponses)
+	{
+		response.addHeader("Vary", "Accept-Encoding");
+
+		// Small responses are not worth the CPU time
+		if (!bodySize || *bodySize >= _compressionMinSize)
+			encoding = Compression::selectEncoding(request.headerValue("Accept-Encoding"));
+	}
+
+	if (encoding != Compression::Encoding::Identity)
+		response.addHeader("Content-Encoding", std::string {Compression::encodingToString(encoding)});
+
+	return encoding;
+}
+
+std::size_t
+SubsonicResource::writeResponseBody(Response& resp, ResponseFormat format, Compression::EncodingStreamBuffer& streamBuffer)
+{
+	std::ostream os {&streamBuffer};
+	os.exceptions(std::ios::badbit); // do not swallow encoding errors
+	resp.write(os, format);
+	streamBuffer.finish();
+
+	if (streamBuffer.getEncoding() != Compression::Encoding::Identity)
+		LMS_LOG(API_SUBSONIC, DEBUG) << "Response compressed using " << Compression::encodingToString(streamBuffer.getEncoding()) << ": " << streamBuffer.getInputSize() << " -> " << streamBuffer.getOutputSize() << " bytes";
+
+	return streamBuffer.getOutputSize();
 }
 
 ProtocolVersion
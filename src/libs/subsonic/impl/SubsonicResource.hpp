@@ -18,31 +18,64 @@
  */
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include <Wt/WResource.h>
 #include <Wt/Http/Response.h>
 
 #include "services/database/Types.hpp"
+#include "utils/Compression.hpp"
 #include "ClientInfo.hpp"
 #include "RequestContext.hpp"
+#include "RequestMetrics.hpp"
+#include "SubsonicResponse.hpp"
 
 namespace Database
 {
 	class Db;
+	class Session;
 }
 
 namespace API::Subsonic
 {
+	using RequestHandlerFunc = std::function<Response(RequestContext& context)>;
+
+	// Responses too large to be built at once: written in several parts, each one produced by its own job
+	class IResponseStream
+	{
+		public:
+			virtual ~IResponseStream() = default;
+
+			// Returns false once the response is complete
+			virtual bool writeNext(Database::Session& session, std::ostream& os, ResponseFormat format) = 0;
+	};
+	using StreamedRequestHandlerFunc = std::function<std::unique_ptr<IResponseStream>(RequestContext& context)>;
+
+	struct DeferredRequest;
 
 	class SubsonicResource final : public Wt::WResource
 	{
 		public:
 			SubsonicResource(Database::Db& db);
 
+			const RequestMetrics& getMetrics() const { return _metrics; }
+
 		private:
 			void handleRequest(const Wt::Http::Request &request, Wt::Http::Response &response) override;
+			// Returns true if the request is deferred: its metrics are recorded once completed
+			bool processRequest(const Wt::Http::Request& request, Wt::Http::Response& response, std::string_view& endpoint, RequestMetrics::RequestStats& stats);
+			void deferRequest(std::size_t requestId, std::string_view endpoint, ResponseFormat format, const StreamedRequestHandlerFunc& func, const RequestContext& requestContext, const Wt::Http::Request& request, Wt::Http::Response& response);
+			// Sends the parts written so far, and schedules the next one if any
+			void completeDeferredRequest(const std::shared_ptr<DeferredRequest>& deferredRequest, Wt::Http::Response& response);
+			std::size_t writeResponse(Response& resp, ResponseFormat format, const Wt::Http::Request& request, Wt::Http::Response& response) const;
+			Compression::Encoding setResponseHeaders(ResponseFormat format, std::optional<std::size_t> bodySize, const Wt::Http::Request& request, Wt::Http::Response& response) const;
+			static std::size_t writeResponseBody(Response& resp, ResponseFormat format, Compression::EncodingStreamBuffer& streamBuffer);
 			ProtocolVersion getServerProtocolVersion(const std::string& clientName) const;
 
 			static void checkProtocolVersion(ProtocolVersion client, ProtocolVersion server);
@@ -52,6 +85,10 @@ namespace API::Subsonic
 
 			const std::unordered_map<std::string, ProtocolVersion> _serverProtocolVersionsByClient;
 			Database::Db& _db;
+			const bool _metricsEnabled;
+			RequestMetrics _metrics; // only fed if metrics are enabled
+			const bool _compressResponses;
+			const std::size_t _compressionMinSize;
 	};
 
 } // namespace
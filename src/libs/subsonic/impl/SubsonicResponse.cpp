@@ -19,13 +19,8 @@
 
 #include "SubsonicResponse.hpp"
 
-#include <Wt/Json/Array.h>
-#include <Wt/Json/Object.h>
-#include <Wt/Json/Value.h>
-#include <Wt/Json/Serializer.h>
-
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/property_tree/xml_parser.hpp>
+#include <cassert>
+#include <ostream>
 
 #include "utils/Exception.hpp"
 #include "utils/String.hpp"
@@ -171,112 +166,274 @@ Response::write(std::ostream& os, ResponseFormat format)
 	}
 }
 
-void
-Response::writeXML(std::ostream& os)
+namespace
 {
-	std::function<boost::property_tree::ptree(const Response::Node&)> nodeToPropertyTree = [&] (const Response::Node& node)
+	void
+	writeEscapedXML(std::ostream& os, std::string_view str)
 	{
-		boost::property_tree::ptree res;
-
-		for (auto itAttribute : node._attributes)
-		{
-			if (std::holds_alternative<std::string>(itAttribute.second))
-				res.put("<xmlattr>." + itAttribute.first, std::get<std::string>(itAttribute.second));
-			else if (std::holds_alternative<bool>(itAttribute.second))
-				res.put("<xmlattr>." + itAttribute.first, std::get<bool>(itAttribute.second));
-			else if (std::holds_alternative<long long>(itAttribute.second))
-				res.put("<xmlattr>." + itAttribute.first, std::get<long long>(itAttribute.second));
-		}
-
-		if (node._value)
+		for (const char c : str)
 		{
-			const auto& value {*node._value};
-
-			if (std::holds_alternative<std::string>(value))
-				res.put_value(std::get<std::string>(value));
-			else if (std::holds_alternative<bool>(value))
-				res.put_value(std::get<bool>(value));
-			else if (std::holds_alternative<long long>(value))
-				res.put_value(std::get<long long>(value));
-		}
-		else
-		{
-			for (auto itChildNode : node._children)
+			switch (c)
 			{
-				for (const Response::Node& childNode : itChildNode.second)
-					res.add_child(itChildNode.first, nodeToPropertyTree(childNode));
+				case '&':	os << "&amp;"; break;
+				case '<':	os << "&lt;"; break;
+				case '>':	os << "&gt;"; break;
+				case '"':	os << "&quot;"; break;
+				case '\'':	os << "&apos;"; break;
+				case '\n':	os << "&#10;"; break; // preserved in attribute values
+				case '\r':	os << "&#13;"; break;
+				case '\t':	os << "&#9;"; break;
+				default:	os.put(c);
 			}
+		}
+	}
 
-			for (auto itChildArrayNode : node._childrenArrays)
+	void
+	writeEscapedJSON(std::ostream& os, std::string_view str)
+	{
+		os.put('"');
+		for (const char c : str)
+		{
+			switch (c)
 			{
-				const std::vector<Response::Node>& childArrayNodes {itChildArrayNode.second};
-
-				for (const Response::Node& childNode : childArrayNodes )
-					res.add_child(itChildArrayNode.first, nodeToPropertyTree(childNode));
+				case '"':	os << "\\\""; break;
+				case '\\':	os << "\\\\"; break;
+				case '\b':	os << "\\b"; break;
+				case '\f':	os << "\\f"; break;
+				case '\n':	os << "\\n"; break;
+				case '\r':	os << "\\r"; break;
+				case '\t':	os << "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						constexpr std::string_view hexDigits {"0123456789abcdef"};
+						os << "\\u00" << hexDigits[(c >> 4) & 0xF] << hexDigits[c & 0xF];
+					}
+					else
+						os.put(c);
 			}
 		}
+		os.put('"');
+	}
+}
 
-		return res;
-	};
+void
+Response::Node::writeXMLValue(std::ostream& os, const ValueType& value)
+{
+	if (std::holds_alternative<std::string>(value))
+		writeEscapedXML(os, std::get<std::string>(value));
+	else if (std::holds_alternative<bool>(value))
+		os << (std::get<bool>(value) ? "true" : "false");
+	else if (std::holds_alternative<long long>(value))
+		os << std::get<long long>(value);
+}
 
-	boost::property_tree::ptree root {nodeToPropertyTree(_root)};
-	boost::property_tree::write_xml(os, root);
+void
+Response::Node::writeJSONValue(std::ostream& os, const ValueType& value)
+{
+	if (std::holds_alternative<std::string>(value))
+		writeEscapedJSON(os, std::get<std::string>(value));
+	else if (std::holds_alternative<bool>(value))
+		os << (std::get<bool>(value) ? "true" : "false");
+	else if (std::holds_alternative<long long>(value))
+		os << std::get<long long>(value);
 }
 
 void
-Response::writeJSON(std::ostream& os)
+Response::Node::writeXMLStartTag(std::ostream& os, std::string_view name) const
+{
+	os << '<' << name;
+	for (const auto& [key, value] : _attributes)
+	{
+		os << ' ' << key << "=\"";
+		writeXMLValue(os, value);
+		os << '"';
+	}
+}
+
+void
+Response::Node::writeXML(std::ostream& os, std::string_view name) const
 {
-	namespace Json = Wt::Json;
+	writeXMLStartTag(os, name);
 
-	std::function<Json::Object(const Response::Node&)> nodeToJsonObject = [&] (const Response::Node& node)
+	if (!_value && _children.empty() && _childrenArrays.empty())
 	{
-		Json::Object res;
+		os << "/>";
+		return;
+	}
 
-		auto valueToJsonValue {[](const Node::ValueType& value) -> Json::Value
+	os << '>';
+	if (_value)
+	{
+		writeXMLValue(os, *_value);
+	}
+	else
+	{
+		for (const auto& [key, childNodes] : _children)
 		{
-			if (std::holds_alternative<std::string>(value))
-				return Json::Value {std::get<std::string>(value)};
-			else if (std::holds_alternative<bool>(value))
-				return Json::Value {std::get<bool>(value)};
-			else if (std::holds_alternative<long long>(value))
-				return Json::Value {std::get<long long>(value)};
+			for (const Node& childNode : childNodes)
+				childNode.writeXML(os, key);
+		}
 
-			throw LmsException("Unexpected value type");
-		}};
+		for (const auto& [key, childNodes] : _childrenArrays)
+		{
+			for (const Node& childNode : childNodes)
+				childNode.writeXML(os, key);
+		}
+	}
+	os << "</" << name << '>';
+}
 
-		for (auto itAttribute : node._attributes)
-			res[itAttribute.first] = valueToJsonValue(itAttribute.second);
+bool
+Response::Node::writeJSONAttributes(std::ostream& os) const
+{
+	bool first {true};
+	for (const auto& [key, value] : _attributes)
+	{
+		if (!first)
+			os.put(',');
+		first = false;
 
-		if (node._value)
+		writeEscapedJSON(os, key);
+		os.put(':');
+		writeJSONValue(os, value);
+	}
+
+	return !first;
+}
+
+void
+Response::Node::writeJSON(std::ostream& os) const
+{
+	os.put('{');
+
+	bool first {!writeJSONAttributes(os)};
+	auto writeKey {[&](std::string_view key)
+	{
+		if (!first)
+			os.put(',');
+		first = false;
+
+		writeEscapedJSON(os, key);
+		os.put(':');
+	}};
+
+	if (_value)
+	{
+		writeKey("value");
+		writeJSONValue(os, *_value);
+	}
+	else
+	{
+		// Single children: only the last one is reported
+		for (const auto& [key, childNodes] : _children)
 		{
-			res["value"] = valueToJsonValue(*node._value);
+			if (childNodes.empty())
+				continue;
+
+			writeKey(key);
+			childNodes.back().writeJSON(os);
 		}
-		else
+
+		for (const auto& [key, childNodes] : _childrenArrays)
 		{
-			for (auto itChildNode : node._children)
+			writeKey(key);
+			os.put('[');
+			for (std::size_t i {}; i < childNodes.size(); ++i)
 			{
-				for (const Response::Node& childNode : itChildNode.second)
-					res[itChildNode.first] = nodeToJsonObject(childNode);
+				if (i > 0)
+					os.put(',');
+				childNodes[i].writeJSON(os);
 			}
+			os.put(']');
+		}
+	}
+	os.put('}');
+}
 
-			for (auto itChildArrayNode : node._childrenArrays)
-			{
-				const std::vector<Response::Node>& childArrayNodes {itChildArrayNode .second};
+void
+Response::writeXML(std::ostream& os)
+{
+	os << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+	for (const auto& [key, childNodes] : _root._children)
+	{
+		for (const Node& childNode : childNodes)
+			childNode.writeXML(os, key);
+	}
+}
 
-				Json::Array array;
-				for (const Response::Node& childNode : childArrayNodes )
-					array.emplace_back(nodeToJsonObject(childNode));
+void
+Response::writeJSON(std::ostream& os)
+{
+	_root.writeJSON(os);
+}
 
-				res[itChildArrayNode.first] = std::move(array);
-			}
-		}
+void
+Response::writeStreamBegin(std::ostream& os, ResponseFormat format, std::string_view arrayKey) const
+{
+	const Node& responseNode {_root._children.at("subsonic-response").front()};
+	assert(responseNode._children.size() == 1 && responseNode._childrenArrays.empty());
+	const auto& [nodeKey, nodes] {*responseNode._children.begin()};
+	const Node& node {nodes.back()};
+	assert(node._children.empty() && node._childrenArrays.empty() && !node._value);
 
-		return res;
-	};
+	switch (format)
+	{
+		case ResponseFormat::xml:
+			os << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+			responseNode.writeXMLStartTag(os, "subsonic-response");
+			os.put('>');
+			node.writeXMLStartTag(os, nodeKey);
+			os.put('>');
+			break;
 
-	Json::Object root {nodeToJsonObject(_root)};
-	os << Json::serialize(root);
+		case ResponseFormat::json:
+			os << "{\"subsonic-response\":{";
+			if (responseNode.writeJSONAttributes(os))
+				os.put(',');
+			writeEscapedJSON(os, nodeKey);
+			os << ":{";
+			if (node.writeJSONAttributes(os))
+				os.put(',');
+			writeEscapedJSON(os, arrayKey);
+			os << ":[";
+			break;
+	}
 }
 
-} // namespace
+void
+Response::writeStreamArrayChild(std::ostream& os, ResponseFormat format, std::string_view arrayKey, const Node& node, bool first)
+{
+	switch (format)
+	{
+		case ResponseFormat::xml:
+			node.writeXML(os, arrayKey);
+			break;
+
+		case ResponseFormat::json:
+			if (!first)
+				os.put(',');
+			node.writeJSON(os);
+			break;
+	}
+}
+
+void
+Response::writeStreamEnd(std::ostream& os, ResponseFormat format) const
+{
+	const Node& responseNode {_root._children.at("subsonic-response").front()};
+	const std::string& nodeKey {responseNode._children.begin()->first};
+
+	switch (format)
+	{
+		case ResponseFormat::xml:
+			os << "</" << nodeKey << "></subsonic-response>";
+			break;
 
+		case ResponseFormat::json:
+			os << "]}}}";
+			break;
+	}
+}
+
+} // namespace
@@ -214,8 +214,17 @@ class Response
 			private:
 				void setVersionAttribute(ProtocolVersion version);
 
-				friend class Response;
 				using ValueType = std::variant<std::string, bool, long long>;
+
+				// Written straight to the stream, no intermediate document
+				void writeXML(std::ostream& os, std::string_view name) const;
+				void writeXMLStartTag(std::ostream& os, std::string_view name) const; // without the closing '>'
+				void writeJSON(std::ostream& os) const;
+				bool writeJSONAttributes(std::ostream& os) const; // returns true if anything has been written
+				static void writeXMLValue(std::ostream& os, const ValueType& value);
+				static void writeJSONValue(std::ostream& os, const ValueType& value);
+
+				friend class Response;
 				std::map<std::string, ValueType> _attributes;
 				std::optional<ValueType> _value;
 				std::map<std::string, std::vector<Node>> _children;
@@ -237,6 +246,12 @@ class Response
 
 		void write(std::ostream& os, ResponseFormat format);
 
+		// Responses too large to be built at once: the array children of the response node are written as they are produced
+		// The response must have a single node, without children
+		void writeStreamBegin(std::ostream& os, ResponseFormat format, std::string_view arrayKey) const;
+		static void writeStreamArrayChild(std::ostream& os, ResponseFormat format, std::string_view arrayKey, const Node& node, bool first);
+		void writeStreamEnd(std::ostream& os, ResponseFormat format) const;
+
 	private:
 		void writeJSON(std::ostream& os);
 		void writeXML(std::ostream& os);
@@ -30,4 +30,8 @@ namespace Database
 namespace API::Subsonic
 {
 	std::unique_ptr<Wt::WResource> createSubsonicResource(Database::Db& db);
+
+	// Per endpoint request metrics (Prometheus text format, local clients only)
+	// subsonicResource must have been created using createSubsonicResource
+	std::unique_ptr<Wt::WResource> createSubsonicMetricsResource(const Wt::WResource& subsonicResource);
 } // namespace
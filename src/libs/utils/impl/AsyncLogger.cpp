@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/AsyncLogger.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+AsyncLogger::AsyncLogger(std::unique_ptr<Logger> logger, std::size_t maxPendingMessages)
+: _logger {std::move(logger)}
+, _entries(std::max<std::size_t>(1, maxPendingMessages))
+, _thread {[this] { run(); }}
+{
+	assert(_logger);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+	{
+		std::scoped_lock lock {_mutex};
+		_stop = true;
+	}
+	_cond.notify_one();
+
+	_thread.join();
+}
+
+void
+AsyncLogger::processLog(const Log& log)
+{
+	std::string message {log.getMessage()};
+
+	{
+		std::scoped_lock lock {_mutex};
+
+		if (_entryCount == _entries.size())
+		{
+			// overwrite the oldest one
+			_firstEntry = (_firstEntry + 1) % _entries.size();
+			_entryCount--;
+			_droppedCount++;
+		}
+
+		Entry& entry {_entries[(_firstEntry + _entryCount) % _entries.size()]};
+		entry.module = log.getModule();
+		entry.severity = log.getSeverity();
+		entry.message = std::move(message);
+		_entryCount++;
+	}
+
+	_cond.notify_one();
+}
+
+void
+AsyncLogger::run()
+{
+	std::vector<Entry> entries;
+	entries.reserve(_entries.size());
+
+	while (true)
+	{
+		std::size_t droppedCount {};
+		bool stop {};
+
+		{
+			std::unique_lock lock {_mutex};
+			_cond.wait(lock, [this] { return _entryCount > 0 || _stop; });
+
+			for (; _entryCount > 0; _entryCount--)
+			{
+				entries.push_back(std::move(_entries[_firstEntry]));
+				_firstEntry = (_firstEntry + 1) % _entries.size();
+			}
+
+			droppedCount = _droppedCount;
+			_droppedCount = 0;
+			stop = _stop;
+		}
+
+		if (droppedCount > 0)
+		{
+			Log log {nullptr, Module::UTILS, Severity::WARNING};
+			log.getOstream() << "Log queue full: " << droppedCount << " messages dropped";
+			_logger->processLog(log);
+		}
+
+		for (const Entry& entry : entries)
+		{
+			Log log {nullptr, entry.module, entry.severity};
+			log.getOstream() << entry.message;
+			_logger->processLog(log);
+		}
+		entries.clear();
+
+		// pending entries have been written
+		if (stop)
+			break;
+	}
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/Compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+#include <zlib.h>
+#ifdef LMS_SUPPORT_ZSTD
+#include <zstd.h>
+#endif
+
+#include "utils/String.hpp"
+
+namespace Compression
+{
+	namespace
+	{
+		constexpr std::size_t chunkSize {16384};
+
+		class IdentityCompressor final : public IStreamCompressor
+		{
+			public:
+				IdentityCompressor(std::ostream& os) : _os {os} {}
+
+			private:
+				void write(const char* data, std::size_t size) override
+				{
+					_os.write(data, size);
+					_outputSize += size;
+				}
+
+				void finish() override {}
+				std::size_t getOutputSize() const override { return _outputSize; }
+
+				std::ostream& _os;
+				std::size_t _outputSize {};
+		};
+
+		class GzipCompressor final : public IStreamCompressor
+		{
+			public:
+				GzipCompressor(std::ostream& os, int level)
+					: _os {os}
+				{
+					// 15 + 16: max window with gzip header and trailer
+					if (deflateInit2(&_stream, level ? level : Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+						throw CompressionException {"Cannot init gzip encoder"};
+				}
+
+				~GzipCompressor()
+				{
+					deflateEnd(&_stream);
+				}
+
+				GzipCompressor(const GzipCompressor&) = delete;
+				GzipCompressor& operator=(const GzipCompressor&) = delete;
+
+			private:
+				void write(const char* data, std::size_t size) override
+				{
+					_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+					_stream.avail_in = static_cast<uInt>(size);
+					deflateSome(Z_NO_FLUSH);
+				}
+
+				void finish() override
+				{
+					_stream.next_in = nullptr;
+					_stream.avail_in = 0;
+					deflateSome(Z_FINISH);
+				}
+
+				std::size_t getOutputSize() const override { return _stream.total_out; }
+
+				void deflateSome(int flush)
+				{
+					do
+					{
+						_stream.next_out = reinterpret_cast<Bytef*>(_buffer.data());
+						_stream.avail_out = static_cast<uInt>(_buffer.size());
+
+						if (deflate(&_stream, flush) == Z_STREAM_ERROR)
+							throw CompressionException {"gzip encoding failed"};
+
+						_os.write(_buffer.data(), _buffer.size() - _stream.avail_out);
+					} while (_stream.avail_out == 0);
+				}
+
+				std::ostream& _os;
+				z_stream _stream {};
+				std::array<char, chunkSize> _buffer;
+		};
+
+#ifdef LMS_SUPPORT_ZSTD
+		class ZstdCompressor final : public IStreamCompressor
+		{
+			public:
+				ZstdCompressor(std::ostream& os, int level)
+					: _os {os}
+					, _context {ZSTD_createCCtx(), ZSTD_freeCCtx}
+				{
+					if (!_context)
+						throw CompressionException {"Cannot init zstd encoder"};
+
+					ZSTD_CCtx_setParameter(_context.get(), ZSTD_c_compressionLevel, level ? level : ZSTD_CLEVEL_DEFAULT);
+				}
+
+			private:
+				void write(const char* data, std::size_t size) override
+				{
+					ZSTD_inBuffer input {data, size, 0};
+					while (input.pos < input.size)
+						compressSome(input, ZSTD_e_continue);
+				}
+
+				void finish() override
+				{
+					ZSTD_inBuffer input {nullptr, 0, 0};
+					while (compressSome(input, ZSTD_e_end) != 0)
+						;
+				}
+
+				std::size_t getOutputSize() const override { return _outputSize; }
+
+				std::size_t compressSome(ZSTD_inBuffer& input, ZSTD_EndDirective directive)
+				{
+					ZSTD_outBuffer output {_buffer.data(), _buffer.size(), 0};
+
+					const std::size_t remaining {ZSTD_compressStream2(_context.get(), &output, &input, directive)};
+					if (ZSTD_isError(remaining))
+						throw CompressionException {std::string {"zstd encoding failed: "} + ZSTD_getErrorName(remaining)};
+
+					_os.write(_buffer.data(), output.pos);
+					_outputSize += output.pos;
+
+					return remaining;
+				}
+
+				std::ostream& _os;
+				std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> _context;
+				std::array<char, chunkSize> _buffer;
+				std::size_t _outputSize {};
+		};
+#endif // LMS_SUPPORT_ZSTD
+
+		std::optional<Encoding> encodingFromString(std::string_view str)
+		{
+			const std::string encoding {StringUtils::stringToLower(str)};
+
+			if (encoding == "identity")
+				return Encoding::Identity;
+			if (encoding == "gzip" || encoding == "x-gzip")
+				return Encoding::Gzip;
+			if (encoding == "zstd")
+				return Encoding::Zstd;
+
+			return std::nullopt;
+		}
+	}
+
+	bool
+	isEncodingSupported(Encoding encoding)
+	{
+		switch (encoding)
+		{
+			case Encoding::Identity:
+			case Encoding::Gzip:
+				return true;
+
+			case Encoding::Zstd:
+#ifdef LMS_SUPPORT_ZSTD
+				return true;
+#else
+				return false;
+#endif
+		}
+
+		return false;
+	}
+
+	std::string_view
+	encodingToString(Encoding encoding)
+	{
+		switch (encoding)
+		{
+			case Encoding::Identity:	return "identity";
+			case Encoding::Gzip:		return "gzip";
+			case Encoding::Zstd:		return "zstd";
+		}
+
+		return "";
+	}
+
+	Encoding
+	selectEncoding(std::string_view acceptEncoding)
+	{
+		// Preferred encodings first, in case of equal q-values
+		static constexpr std::array<Encoding, 2> candidates {Encoding::Zstd, Encoding::Gzip};
+		std::array<std::optional<float>, 2> qValues;
+		std::optional<float> wildcardQValue;
+
+		for (std::string_view entry : StringUtils::splitString(acceptEncoding, ","))
+		{
+			const std::vector<std::string_view> params {StringUtils::splitString(entry, ";")};
+			const std::string_view name {StringUtils::stringTrim(params.front())};
+
+			float qValue {1};
+			for (std::size_t i {1}; i < params.size(); ++i)
+			{
+				const std::string_view param {StringUtils::stringTrim(params[i])};
+				if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+					qValue = StringUtils::readAs<float>(param.substr(2)).value_or(0);
+			}
+
+			if (name == "*")
+			{
+				wildcardQValue = qValue;
+				continue;
+			}
+
+			const std::optional<Encoding> encoding {encodingFromString(name)};
+			for (std::size_t i {}; i < candidates.size(); ++i)
+			{
+				if (encoding == candidates[i])
+					qValues[i] = qValue;
+			}
+		}
+
+		Encoding bestEncoding {Encoding::Identity};
+		float bestQValue {};
+		for (std::size_t i {}; i < candidates.size(); ++i)
+		{
+			if (!isEncodingSupported(candidates[i]))
+				continue;
+
+			const float qValue {qValues[i].value_or(wildcardQValue.value_or(0))};
+			if (qValue > bestQValue)
+			{
+				bestEncoding = candidates[i];
+				bestQValue = qValue;
+			}
+		}
+
+		return bestEncoding;
+	}
+
+	std::unique_ptr<IStreamCompressor>
+	createStreamCompressor(Encoding encoding, std::ostream& os, int level)
+	{
+		switch (encoding)
+		{
+			case Encoding::Identity:
+				return std::make_unique<IdentityCompressor>(os);
+
+			case Encoding::Gzip:
+				return std::make_unique<GzipCompressor>(os, level);
+
+			case Encoding::Zstd:
+#ifdef LMS_SUPPORT_ZSTD
+				return std::make_unique<ZstdCompressor>(os, level);
+#else
+				break;
+#endif
+		}
+
+		throw CompressionException {"Unsupported encoding '" + std::string {encodingToString(encoding)} + "'"};
+	}
+
+	EncodingStreamBuffer::EncodingStreamBuffer(std::ostream& os, std::size_t bufferSize, EncodingSelector encodingSelector)
+		: _os {os}
+		, _buffer(std::max(bufferSize, chunkSize))
+		, _encodingSelector {std::move(encodingSelector)}
+	{
+		setp(_buffer.data(), _buffer.data() + _buffer.size());
+	}
+
+	EncodingStreamBuffer::EncodingStreamBuffer(std::ostream& os, Encoding encoding)
+		: EncodingStreamBuffer {os, chunkSize, [=](std::optional<std::size_t>) { return encoding; }}
+	{
+	}
+
+	void
+	EncodingStreamBuffer::finish()
+	{
+		flushBuffer(true);
+		_compressor->finish();
+	}
+
+	std::size_t
+	EncodingStreamBuffer::getOutputSize() const
+	{
+		return _compressor ? _compressor->getOutputSize() : 0;
+	}
+
+	EncodingStreamBuffer::int_type
+	EncodingStreamBuffer::overflow(int_type ch)
+	{
+		flushBuffer(false);
+
+		if (!traits_type::eq_int_type(ch, traits_type::eof()))
+		{
+			*pptr() = traits_type::to_char_type(ch);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(ch);
+	}
+
+	int
+	EncodingStreamBuffer::sync()
+	{
+		// data is pushed on buffer overflow or on finish only: sync does not force the encoding selection
+		return 0;
+	}
+
+	void
+	EncodingStreamBuffer::flushBuffer(bool finished)
+	{
+		const std::size_t size {static_cast<std::size_t>(pptr() - pbase())};
+
+		if (!_compressor)
+		{
+			_encoding = _encodingSelector(finished ? std::make_optional(size) : std::nullopt);
+			_compressor = createStreamCompressor(_encoding, _os);
+		}
+
+		_compressor->write(pbase(), size);
+		_inputSize += size;
+
+		setp(_buffer.data(), _buffer.data() + _buffer.size());
+	}
+} // namespace Compression
+
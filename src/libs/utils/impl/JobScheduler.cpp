@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JobScheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "utils/Logger.hpp"
+
+std::unique_ptr<IJobScheduler>
+createJobScheduler(std::size_t cpuThreadCount, std::size_t ioThreadCount, std::size_t maxQueueSize)
+{
+	return std::make_unique<JobScheduler>(cpuThreadCount, ioThreadCount, maxQueueSize);
+}
+
+JobPool::JobPool(std::string_view name, std::size_t threadCount, std::size_t maxQueueSize)
+: _name {name}
+, _maxQueueSize {maxQueueSize}
+{
+	assert(threadCount > 0);
+
+	_stats.threadCount = threadCount;
+	_stats.maxQueueSize = maxQueueSize;
+
+	LMS_LOG(UTILS, INFO) << "Starting " << _name << " job pool with " << threadCount << " threads, max queue size = " << _maxQueueSize;
+	for (std::size_t i {}; i < threadCount; ++i)
+		_threads.emplace_back([this] { run(); });
+}
+
+JobPool::~JobPool()
+{
+	std::size_t droppedJobCount {};
+	{
+		std::scoped_lock lock {_mutex};
+		_stopping = true;
+		droppedJobCount = _queueSize;
+	}
+	_cv.notify_all();
+
+	for (std::thread& t : _threads)
+		t.join();
+
+	if (droppedJobCount > 0)
+		LMS_LOG(UTILS, DEBUG) << "Dropped " << droppedJobCount << " pending jobs from " << _name << " job pool";
+}
+
+bool
+JobPool::push(IJobScheduler::Priority priority, IJobScheduler::Job job)
+{
+	{
+		std::scoped_lock lock {_mutex};
+
+		if (_queueSize >= _maxQueueSize)
+		{
+			_stats.rejectedJobCount++;
+			return false;
+		}
+
+		_queues[static_cast<std::size_t>(priority)].push_back(QueuedJob {std::move(job), std::chrono::steady_clock::now()});
+		_queueSize++;
+	}
+
+	_cv.notify_one();
+	return true;
+}
+
+IJobScheduler::PoolStats
+JobPool::getStats() const
+{
+	std::scoped_lock lock {_mutex};
+
+	IJobScheduler::PoolStats stats {_stats};
+	stats.queueSize = _queueSize;
+
+	return stats;
+}
+
+void
+JobPool::run()
+{
+	while (true)
+	{
+		QueuedJob queuedJob;
+
+		{
+			std::unique_lock lock {_mutex};
+			_cv.wait(lock, [this] { return _stopping || _queueSize > 0; });
+			if (_stopping)
+				return;
+
+			// highest priority first, FIFO within a priority
+			auto itQueue {std::find_if(std::begin(_queues), std::end(_queues), [](const auto& queue) { return !queue.empty(); })};
+			assert(itQueue != std::end(_queues));
+
+			queuedJob = std::move(itQueue->front());
+			itQueue->pop_front();
+			_queueSize--;
+
+			const auto waitDuration {std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queuedJob.queuedTime)};
+			_stats.totalWaitDuration += waitDuration;
+			_stats.maxWaitDuration = std::max(_stats.maxWaitDuration, waitDuration);
+			_stats.runningJobCount++;
+		}
+
+		try
+		{
+			queuedJob.job();
+		}
+		catch (const std::exception& e)
+		{
+			LMS_LOG(UTILS, ERROR) << "Exception caught in " << _name << " job: " << e.what();
+		}
+
+		{
+			std::scoped_lock lock {_mutex};
+			_stats.runningJobCount--;
+			_stats.executedJobCount++;
+		}
+	}
+}
+
+JobScheduler::JobScheduler(std::size_t cpuThreadCount, std::size_t ioThreadCount, std::size_t maxQueueSize)
+: _cpuPool {"CPU", cpuThreadCount, maxQueueSize}
+, _ioPool {"IO", ioThreadCount, maxQueueSize}
+{
+}
+
+bool
+JobScheduler::schedule(Pool pool, Priority priority, Job job)
+{
+	return getPool(pool).push(priority, std::move(job));
+}
+
+IJobScheduler::PoolStats
+JobScheduler::getStats(Pool pool) const
+{
+	return getPool(pool).getStats();
+}
+
+JobPool&
+JobScheduler::getPool(Pool pool)
+{
+	return pool == Pool::CPU ? _cpuPool : _ioPool;
+}
+
+const JobPool&
+JobScheduler::getPool(Pool pool) const
+{
+	return pool == Pool::CPU ? _cpuPool : _ioPool;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/IJobScheduler.hpp"
+
+class JobPool
+{
+	public:
+		JobPool(std::string_view name, std::size_t threadCount, std::size_t maxQueueSize);
+		~JobPool();
+
+		JobPool(const JobPool&) = delete;
+		JobPool(JobPool&&) = delete;
+		JobPool& operator=(const JobPool&) = delete;
+		JobPool& operator=(JobPool&&) = delete;
+
+		bool push(IJobScheduler::Priority priority, IJobScheduler::Job job);
+		IJobScheduler::PoolStats getStats() const;
+
+	private:
+		void run();
+
+		struct QueuedJob
+		{
+			IJobScheduler::Job						job;
+			std::chrono::steady_clock::time_point	queuedTime;
+		};
+
+		static constexpr std::size_t priorityCount {3};
+
+		const std::string			_name;
+		const std::size_t			_maxQueueSize;
+
+		mutable std::mutex			_mutex;
+		std::condition_variable		_cv;
+		bool						_stopping {};
+		std::array<std::deque<QueuedJob>, priorityCount>	_queues; // indexed by priority
+		std::size_t					_queueSize {};
+		IJobScheduler::PoolStats	_stats;
+
+		std::vector<std::thread>	_threads;
+};
+
+class JobScheduler : public IJobScheduler
+{
+	public:
+		JobScheduler(std::size_t cpuThreadCount, std::size_t ioThreadCount, std::size_t maxQueueSize);
+		~JobScheduler() = default;
+
+		JobScheduler(const JobScheduler&) = delete;
+		JobScheduler(JobScheduler&&) = delete;
+		JobScheduler& operator=(const JobScheduler&) = delete;
+		JobScheduler& operator=(JobScheduler&&) = delete;
+
+	private:
+		bool schedule(Pool pool, Priority priority, Job job) override;
+		PoolStats getStats(Pool pool) const override;
+
+		JobPool& getPool(Pool pool);
+		const JobPool& getPool(Pool pool) const;
+
+		JobPool		_cpuPool;
+		JobPool		_ioPool;
+};
@@ -19,6 +19,8 @@
 
 #include "utils/Logger.hpp"
 
+static_assert(static_cast<unsigned>(Module::UTILS) + 1 == ModuleCount, "ModuleCount must be updated");
+
 const char* getModuleName(Module mod)
 {
 	switch (mod)
@@ -58,6 +60,24 @@ const char* getSeverityName(Severity sev)
 	return "";
 }
 
+Logger::Logger(EnumSet<Severity> severities)
+{
+	setSeverities(severities);
+}
+
+void
+Logger::setSeverities(EnumSet<Severity> severities)
+{
+	for (unsigned module {}; module < ModuleCount; ++module)
+		setSeverities(static_cast<Module>(module), severities);
+}
+
+void
+Logger::setSeverities(Module module, EnumSet<Severity> severities)
+{
+	_severities[static_cast<std::size_t>(module)].store(severities, std::memory_order_relaxed);
+}
+
 Log::Log(Logger* logger, Module module, Severity severity)
 	: _module {module},
 	_severity {severity},
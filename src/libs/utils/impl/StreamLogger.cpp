@@ -20,15 +20,14 @@
 #include "utils/StreamLogger.hpp"
 
 StreamLogger::StreamLogger(std::ostream& os, EnumSet<Severity> severities)
-: _os {os}
-, _severities {severities}
+: Logger {severities}
+, _os {os}
 {
 }
 
 void
 StreamLogger::processLog(const Log& log)
 {
-	if (_severities.contains(log.getSeverity()))
-		_os << "[" << getSeverityName(log.getSeverity()) << "] [" << getModuleName(log.getModule()) << "] " << log.getMessage() << std::endl;
+	_os << "[" << getSeverityName(log.getSeverity()) << "] [" << getModuleName(log.getModule()) << "] " << log.getMessage() << std::endl;
 }
 
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/http/CacheValidators.hpp"
+
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+#include "utils/String.hpp"
+
+namespace Http
+{
+	namespace
+	{
+		// RFC 7231 IMF-fixdate, always in the classic locale
+		constexpr const char* httpDateFormat {"%a, %d %b %Y %H:%M:%S GMT"};
+
+		std::string_view stripWeakIndicator(std::string_view etag)
+		{
+			if (etag.size() >= 2 && etag.substr(0, 2) == "W/")
+				etag.remove_prefix(2);
+
+			return etag;
+		}
+	}
+
+	std::string
+	formatHttpDate(std::time_t time)
+	{
+		std::tm tm {};
+		::gmtime_r(&time, &tm);
+
+		std::ostringstream oss;
+		oss.imbue(std::locale::classic());
+		oss << std::put_time(&tm, httpDateFormat);
+
+		return oss.str();
+	}
+
+	std::optional<std::time_t>
+	parseHttpDate(std::string_view date)
+	{
+		std::tm tm {};
+
+		std::istringstream iss {std::string {StringUtils::stringTrim(date)}};
+		iss.imbue(std::locale::classic());
+		iss >> std::get_time(&tm, httpDateFormat);
+		if (iss.fail())
+			return std::nullopt;
+
+		return ::timegm(&tm);
+	}
+
+	bool
+	isETagMatching(std::string_view ifNoneMatch, std::string_view etag)
+	{
+		if (etag.empty())
+			return false;
+
+		// Weak comparison, as required for If-None-Match
+		for (std::string_view candidate : StringUtils::splitString(ifNoneMatch, ","))
+		{
+			candidate = StringUtils::stringTrim(candidate);
+			if (candidate == "*" || stripWeakIndicator(candidate) == stripWeakIndicator(etag))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool
+	handleConditionalRequest(const Wt::Http::Request& request, Wt::Http::Response& response, const CacheValidators& validators)
+	{
+		if (!validators.etag.empty())
+			response.addHeader("ETag", validators.etag);
+		if (validators.lastModified)
+			response.addHeader("Last-Modified", formatHttpDate(*validators.lastModified));
+		if (!validators.cacheControl.empty())
+			response.addHeader("Cache-Control", validators.cacheControl);
+
+		bool notModified {};
+
+		// If-None-Match takes precedence over If-Modified-Since
+		if (const std::string ifNoneMatch {request.headerValue("If-None-Match")}; !ifNoneMatch.empty())
+		{
+			notModified = isETagMatching(ifNoneMatch, validators.etag);
+		}
+		else if (const std::string ifModifiedSince {request.headerValue("If-Modified-Since")}; !ifModifiedSince.empty() && validators.lastModified)
+		{
+			const std::optional<std::time_t> since {parseHttpDate(ifModifiedSince)};
+			notModified = since && *validators.lastModified <= *since;
+		}
+
+		if (notModified)
+			response.setStatus(304);
+
+		return notModified;
+	}
+} // namespace Http
+
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/http/DeferredResponse.hpp"
+
+#include <Wt/Http/Response.h>
+#include <Wt/Http/ResponseContinuation.h>
+
+#include "utils/Logger.hpp"
+#include "utils/Service.hpp"
+
+namespace Http
+{
+	Wt::Http::ResponseContinuation*
+	deferResponse(Wt::Http::Response& response, Wt::cpp17::any data, IJobScheduler::Pool pool, IJobScheduler::Priority priority, IJobScheduler::Job job)
+	{
+		Wt::Http::ResponseContinuation* continuation {response.createContinuation()};
+		continuation->setData(std::move(data));
+		continuation->waitForMoreData();
+
+		// the request must be resumed whatever happens, the job result is checked there
+		// hold the continuation: it may be cancelled and released by Wt if the client goes away meanwhile
+		auto resumingJob {[continuation {continuation->shared_from_this()}, job {std::move(job)}]
+		{
+			try
+			{
+				job();
+			}
+			catch (const std::exception& e)
+			{
+				LMS_LOG(HTTP, ERROR) << "Exception caught in deferred response job: " << e.what();
+			}
+
+			if (!continuation->isWaitingForMoreData())
+			{
+				LMS_LOG(HTTP, DEBUG) << "Deferred response cancelled, not resuming";
+				return;
+			}
+
+			continuation->haveMoreData();
+		}};
+
+		IJobScheduler* scheduler {Service<IJobScheduler>::get()};
+		if (!scheduler || !scheduler->schedule(pool, priority, resumingJob))
+		{
+			if (scheduler)
+				LMS_LOG(HTTP, DEBUG) << "Job pool saturated, running job inline";
+
+			resumingJob();
+		}
+
+		return continuation;
+	}
+} // namespace Http
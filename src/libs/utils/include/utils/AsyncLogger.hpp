@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/Logger.hpp"
+
+// Hands the messages over to a dedicated thread that feeds the wrapped logger, so that callers never wait on IO
+// Messages are stored in a fixed size ring buffer: if the writer cannot keep up, the oldest ones are dropped
+class AsyncLogger final : public Logger
+{
+	public:
+		static constexpr std::size_t defaultMaxPendingMessages {4096};
+
+		AsyncLogger(std::unique_ptr<Logger> logger, std::size_t maxPendingMessages = defaultMaxPendingMessages);
+		~AsyncLogger() override;
+
+		AsyncLogger(const AsyncLogger&) = delete;
+		AsyncLogger& operator=(const AsyncLogger&) = delete;
+		AsyncLogger(AsyncLogger&&) = delete;
+		AsyncLogger& operator=(AsyncLogger&&) = delete;
+
+		void processLog(const Log& log) override;
+
+	private:
+		struct Entry
+		{
+			Module		module;
+			Severity	severity;
+			std::string	message;
+		};
+
+		void run();
+
+		const std::unique_ptr<Logger>	_logger;
+
+		std::mutex						_mutex;
+		std::condition_variable			_cond;
+		std::vector<Entry>				_entries; // ring buffer
+		std::size_t						_firstEntry {};
+		std::size_t						_entryCount {};
+		std::size_t						_droppedCount {};
+		bool							_stop {};
+
+		std::thread						_thread;
+};
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+#include "utils/Exception.hpp"
+
+namespace Compression
+{
+	class CompressionException : public LmsException
+	{
+		using LmsException::LmsException;
+	};
+
+	enum class Encoding
+	{
+		Identity,
+		Gzip,
+		Zstd,
+	};
+
+	bool isEncodingSupported(Encoding encoding);
+	std::string_view encodingToString(Encoding encoding); // HTTP content-coding token
+
+	// Picks the best supported encoding acceptable by the client (q-values are honoured)
+	Encoding selectEncoding(std::string_view acceptEncoding);
+
+	// Streaming encoder: compressed data is written to the output stream as it is produced
+	class IStreamCompressor
+	{
+		public:
+			virtual ~IStreamCompressor() = default;
+
+			virtual void write(const char* data, std::size_t size) = 0;
+			virtual void finish() = 0; // flush remaining data, no more writes allowed
+
+			// compressed bytes written so far
+			virtual std::size_t getOutputSize() const = 0;
+	};
+
+	// level: 0 means the default level of the encoding
+	std::unique_ptr<IStreamCompressor> createStreamCompressor(Encoding encoding, std::ostream& os, int level = 0);
+
+	// Stream buffer encoding what is written into the output stream, with no full copy of the data
+	// The encoding is selected once the buffer (at least bufferSize bytes) is full, or on finish with the total size if there is less data
+	class EncodingStreamBuffer final : public std::streambuf
+	{
+		public:
+			using EncodingSelector = std::function<Encoding(std::optional<std::size_t> totalSize)>;
+
+			EncodingStreamBuffer(std::ostream& os, std::size_t bufferSize, EncodingSelector encodingSelector);
+			EncodingStreamBuffer(std::ostream& os, Encoding encoding);
+
+			EncodingStreamBuffer(const EncodingStreamBuffer&) = delete;
+			EncodingStreamBuffer& operator=(const EncodingStreamBuffer&) = delete;
+
+			void finish(); // no more writes allowed
+
+			Encoding getEncoding() const { return _encoding; } // only valid once selected
+			std::size_t getInputSize() const { return _inputSize; }
+			std::size_t getOutputSize() const; // bytes written to the output stream so far
+
+		private:
+			int_type overflow(int_type ch) override;
+			int sync() override;
+
+			void flushBuffer(bool finished);
+
+			std::ostream&						_os;
+			std::vector<char>					_buffer;
+			EncodingSelector					_encodingSelector;
+			Encoding							_encoding {Encoding::Identity};
+			std::unique_ptr<IStreamCompressor>	_compressor; // created once the encoding is selected
+			std::size_t							_inputSize {};
+	};
+} // namespace Compression
+
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+// Runs blocking or CPU intensive work out of the HTTP server threads
+// Each pool has its own threads and its own bounded queue
+class IJobScheduler
+{
+	public:
+		enum class Pool
+		{
+			CPU,	// decoding, hashing, compression
+			IO,		// blocking reads, database heavy queries
+		};
+
+		enum class Priority
+		{
+			High,
+			Normal,
+			Low,
+		};
+
+		using Job = std::function<void()>;
+
+		struct PoolStats
+		{
+			std::size_t					threadCount {};
+			std::size_t					maxQueueSize {};
+			std::size_t					queueSize {};
+			std::size_t					runningJobCount {};
+			std::size_t					executedJobCount {};
+			std::size_t					rejectedJobCount {};
+			std::chrono::microseconds	totalWaitDuration {};
+			std::chrono::microseconds	maxWaitDuration {};
+		};
+
+		virtual ~IJobScheduler() = default;
+
+		// Returns false if the pool queue is full: the job is then not scheduled
+		[[nodiscard]] virtual bool schedule(Pool pool, Priority priority, Job job) = 0;
+
+		virtual PoolStats getStats(Pool pool) const = 0;
+};
+
+std::unique_ptr<IJobScheduler> createJobScheduler(std::size_t cpuThreadCount, std::size_t ioThreadCount, std::size_t maxQueueSize);
@@ -19,9 +19,12 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <string>
 #include <sstream>
 
+#include "EnumSet.hpp"
 #include "Service.hpp"
 
 enum class Severity
@@ -54,6 +57,7 @@ enum class Module
 	UI,
 	UTILS,
 };
+static inline constexpr unsigned ModuleCount {18};
 
 const char* getModuleName(Module mod);
 const char* getSeverityName(Severity sev);
@@ -81,10 +85,28 @@ class Log
 class Logger
 {
 	public:
+		static constexpr EnumSet<Severity> allSeverities {Severity::FATAL, Severity::ERROR, Severity::WARNING, Severity::INFO, Severity::DEBUG};
+
 		virtual ~Logger() = default;
 		virtual void processLog(const Log& log) = 0;
+
+		// Lock free, checked before anything is evaluated in LMS_LOG
+		bool isEnabled(Module module, Severity severity) const
+		{
+			return _severities[static_cast<std::size_t>(module)].load(std::memory_order_relaxed).contains(severity);
+		}
+
+		void setSeverities(EnumSet<Severity> severities); // all modules
+		void setSeverities(Module module, EnumSet<Severity> severities);
+
+	protected:
+		Logger(EnumSet<Severity> severities = allSeverities);
+
+	private:
+		std::array<std::atomic<EnumSet<Severity>>, ModuleCount> _severities;
 };
 
-#define LMS_LOG(module, severity)		Log(Service<Logger>::get(), Module::module, Severity::severity).getOstream()
-#define LMS_LOG_EX(module, severity)	Log(Service<Logger>::get(), module, severity).getOstream()
+// The stream arguments are not evaluated if the module/severity is disabled
+#define LMS_LOG(module, severity)		LMS_LOG_EX(Module::module, Severity::severity)
+#define LMS_LOG_EX(module, severity)	if (Logger* lmsLogger {Service<Logger>::get()}; !lmsLogger || !lmsLogger->isEnabled(module, severity)) {} else Log(lmsLogger, module, severity).getOstream()
 
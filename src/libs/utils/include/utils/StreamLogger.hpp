@@ -29,10 +29,10 @@ class StreamLogger final : public Logger
 
 		StreamLogger(std::ostream& oss, EnumSet<Severity> severities = defaultSeverities);
 
-		void processLog(const Log& log);
+		// Filtering is done by the base class, before the log is built
+		void processLog(const Log& log) override;
 
 	private:
 		std::ostream& _os;
-		const EnumSet<Severity> _severities;
 };
 
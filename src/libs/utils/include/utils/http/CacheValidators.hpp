@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Wt::Http
+{
+	class Request;
+	class Response;
+}
+
+namespace Http
+{
+	// Validators sent along with a cacheable response
+	struct CacheValidators
+	{
+		std::string					etag;			// full entity tag, including quotes
+		std::optional<std::time_t>	lastModified;
+		std::string					cacheControl;
+	};
+
+	// Sets the validator headers on the response
+	// Returns true if the client copy is still fresh: the response is then
+	// set to "304 Not Modified" and no body must be written
+	bool handleConditionalRequest(const Wt::Http::Request& request, Wt::Http::Response& response, const CacheValidators& validators);
+
+	// Helpers
+	std::string formatHttpDate(std::time_t time);
+	std::optional<std::time_t> parseHttpDate(std::string_view date);
+	bool isETagMatching(std::string_view ifNoneMatch, std::string_view etag);
+} // namespace Http
+
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <Wt/WAny.h>
+
+#include "utils/IJobScheduler.hpp"
+
+namespace Wt::Http
+{
+	class Response;
+	class ResponseContinuation;
+}
+
+namespace Http
+{
+	// Runs the job on a scheduler pool and resumes the request once done
+	// Headers must be set before: they are sent before the request is resumed
+	// The job is run inline if the pool queue is full
+	// The resumed request gets back the provided data through its continuation
+	// It is resumed even if the job throws, unless it has been cancelled meanwhile
+	Wt::Http::ResponseContinuation* deferResponse(Wt::Http::Response& response, Wt::cpp17::any data, IJobScheduler::Pool pool, IJobScheduler::Priority priority, IJobScheduler::Job job);
+} // namespace Http
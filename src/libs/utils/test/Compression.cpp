@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <sstream>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "utils/Compression.hpp"
+
+using namespace Compression;
+
+namespace
+{
+	std::string gunzip(const std::string& input)
+	{
+		z_stream stream {};
+		EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+
+		stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+		stream.avail_in = static_cast<uInt>(input.size());
+
+		std::string output;
+		std::array<char, 1024> buffer;
+		int res;
+		do
+		{
+			stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+			stream.avail_out = static_cast<uInt>(buffer.size());
+			res = inflate(&stream, Z_NO_FLUSH);
+			output.append(buffer.data(), buffer.size() - stream.avail_out);
+		} while (res == Z_OK);
+
+		EXPECT_EQ(res, Z_STREAM_END);
+		inflateEnd(&stream);
+
+		return output;
+	}
+}
+
+TEST(Compression, selectEncoding)
+{
+	EXPECT_EQ(selectEncoding(""), Encoding::Identity);
+	EXPECT_EQ(selectEncoding("identity"), Encoding::Identity);
+	EXPECT_EQ(selectEncoding("gzip"), Encoding::Gzip);
+	EXPECT_EQ(selectEncoding("deflate, gzip"), Encoding::Gzip);
+	EXPECT_EQ(selectEncoding("GZIP;q=0.5"), Encoding::Gzip);
+	EXPECT_EQ(selectEncoding("gzip;q=0"), Encoding::Identity);
+	EXPECT_EQ(selectEncoding("*"), isEncodingSupported(Encoding::Zstd) ? Encoding::Zstd : Encoding::Gzip);
+	EXPECT_EQ(selectEncoding("*, gzip;q=0, zstd;q=0"), Encoding::Identity);
+	EXPECT_EQ(selectEncoding("gzip;q=1, zstd;q=0.5"), Encoding::Gzip);
+	EXPECT_EQ(selectEncoding("gzip, zstd"), isEncodingSupported(Encoding::Zstd) ? Encoding::Zstd : Encoding::Gzip);
+}
+
+TEST(Compression, gzipRoundTrip)
+{
+	std::string input;
+	for (std::size_t i {}; i < 10000; ++i)
+		input += "<song id=\"tr-" + std::to_string(i) + "\" title=\"Title\" album=\"Album\"/>\n";
+
+	std::ostringstream oss;
+	auto compressor {createStreamCompressor(Encoding::Gzip, oss)};
+
+	// several writes, crossing the internal chunk size
+	constexpr std::size_t writeSize {1000};
+	for (std::size_t offset {}; offset < input.size(); offset += writeSize)
+		compressor->write(input.data() + offset, std::min(writeSize, input.size() - offset));
+	compressor->finish();
+
+	const std::string output {oss.str()};
+	EXPECT_EQ(compressor->getOutputSize(), output.size());
+	EXPECT_LT(output.size(), input.size() / 10);
+	EXPECT_EQ(gunzip(output), input);
+}
+
+TEST(Compression, gzipEmpty)
+{
+	std::ostringstream oss;
+	auto compressor {createStreamCompressor(Encoding::Gzip, oss)};
+	compressor->finish();
+
+	EXPECT_EQ(gunzip(oss.str()), "");
+}
+
+
+TEST(Compression, encodingStreamBuffer)
+{
+	std::string input;
+	for (std::size_t i {}; i < 10000; ++i)
+		input += "<song id=\"tr-" + std::to_string(i) + "\" title=\"Title\" album=\"Album\"/>\n";
+
+	std::ostringstream oss;
+	std::optional<std::optional<std::size_t>> selectedWithSize;
+	EncodingStreamBuffer streamBuffer {oss, 1024, [&](std::optional<std::size_t> totalSize)
+	{
+		EXPECT_FALSE(selectedWithSize);
+		// nothing written before the selection
+		EXPECT_TRUE(oss.str().empty());
+		selectedWithSize = totalSize;
+		return Encoding::Gzip;
+	}};
+
+	std::ostream os {&streamBuffer};
+	os << input << std::flush;
+	streamBuffer.finish();
+
+	ASSERT_TRUE(selectedWithSize);
+	EXPECT_FALSE(*selectedWithSize); // more than the buffer size: total size not known yet
+	EXPECT_EQ(streamBuffer.getEncoding(), Encoding::Gzip);
+	EXPECT_EQ(streamBuffer.getInputSize(), input.size());
+	EXPECT_EQ(streamBuffer.getOutputSize(), oss.str().size());
+	EXPECT_EQ(gunzip(oss.str()), input);
+}
+
+TEST(Compression, encodingStreamBufferSmall)
+{
+	const std::string input {"<ok/>"};
+
+	std::ostringstream oss;
+	std::optional<std::size_t> selectedWithSize;
+	EncodingStreamBuffer streamBuffer {oss, 1024, [&](std::optional<std::size_t> totalSize)
+	{
+		selectedWithSize = totalSize;
+		return Encoding::Identity;
+	}};
+
+	std::ostream os {&streamBuffer};
+	os << input;
+	streamBuffer.finish();
+
+	EXPECT_EQ(selectedWithSize, input.size());
+	EXPECT_EQ(streamBuffer.getOutputSize(), input.size());
+	EXPECT_EQ(oss.str(), input);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utils/http/CacheValidators.hpp"
+
+TEST(Http, httpDate)
+{
+	EXPECT_EQ(Http::formatHttpDate(784111777), "Sun, 06 Nov 1994 08:49:37 GMT");
+
+	const auto date {Http::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT")};
+	ASSERT_TRUE(date);
+	EXPECT_EQ(*date, 784111777);
+
+	EXPECT_FALSE(Http::parseHttpDate("foo"));
+	EXPECT_FALSE(Http::parseHttpDate(""));
+}
+
+TEST(Http, etagMatching)
+{
+	EXPECT_TRUE(Http::isETagMatching("\"12-256\"", "\"12-256\""));
+	EXPECT_TRUE(Http::isETagMatching("W/\"12-256\"", "\"12-256\""));
+	EXPECT_TRUE(Http::isETagMatching("\"11-256\", \"12-256\"", "\"12-256\""));
+	EXPECT_TRUE(Http::isETagMatching("*", "\"12-256\""));
+
+	EXPECT_FALSE(Http::isETagMatching("\"11-256\"", "\"12-256\""));
+	EXPECT_FALSE(Http::isETagMatching("", "\"12-256\""));
+	EXPECT_FALSE(Http::isETagMatching("\"12-256\"", ""));
+}
+
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/IJobScheduler.hpp"
+
+namespace
+{
+	class Gate
+	{
+		public:
+			void open()
+			{
+				{
+					std::scoped_lock lock {_mutex};
+					_opened = true;
+				}
+				_cv.notify_all();
+			}
+
+			void wait()
+			{
+				std::unique_lock lock {_mutex};
+				_cv.wait(lock, [this] { return _opened; });
+			}
+
+		private:
+			std::mutex _mutex;
+			std::condition_variable _cv;
+			bool _opened {};
+	};
+}
+
+TEST(JobScheduler, priorities)
+{
+	std::vector<int> executionOrder;
+	std::mutex executionOrderMutex;
+	Gate blockingJobStarted;
+	Gate unblock;
+	Gate done;
+
+	{
+		auto scheduler {createJobScheduler(1, 1, 10)};
+
+		ASSERT_TRUE(scheduler->schedule(IJobScheduler::Pool::CPU, IJobScheduler::Priority::Normal, [&] { blockingJobStarted.open(); unblock.wait(); }));
+		blockingJobStarted.wait();
+
+		auto addJob {[&](IJobScheduler::Priority priority, int value)
+		{
+			return scheduler->schedule(IJobScheduler::Pool::CPU, priority, [&, value]
+			{
+				std::scoped_lock lock {executionOrderMutex};
+				executionOrder.push_back(value);
+			});
+		}};
+
+		ASSERT_TRUE(addJob(IJobScheduler::Priority::Low, 3));
+		ASSERT_TRUE(addJob(IJobScheduler::Priority::Normal, 2));
+		ASSERT_TRUE(addJob(IJobScheduler::Priority::High, 0));
+		ASSERT_TRUE(addJob(IJobScheduler::Priority::High, 1));
+		ASSERT_TRUE(scheduler->schedule(IJobScheduler::Pool::CPU, IJobScheduler::Priority::Low, [&] { done.open(); }));
+
+		EXPECT_EQ(scheduler->getStats(IJobScheduler::Pool::CPU).queueSize, 5);
+		EXPECT_EQ(scheduler->getStats(IJobScheduler::Pool::CPU).runningJobCount, 1);
+
+		unblock.open();
+		done.wait();
+	}
+
+	EXPECT_EQ(executionOrder, (std::vector<int> {0, 1, 2, 3}));
+}
+
+TEST(JobScheduler, boundedQueue)
+{
+	Gate blockingJobStarted;
+	Gate unblock;
+	Gate done;
+
+	auto scheduler {createJobScheduler(1, 1, 2)};
+
+	ASSERT_TRUE(scheduler->schedule(IJobScheduler::Pool::IO, IJobScheduler::Priority::Normal, [&] { blockingJobStarted.open(); unblock.wait(); }));
+	blockingJobStarted.wait();
+
+	EXPECT_TRUE(scheduler->schedule(IJobScheduler::Pool::IO, IJobScheduler::Priority::Normal, [] {}));
+	EXPECT_TRUE(scheduler->schedule(IJobScheduler::Pool::IO, IJobScheduler::Priority::Normal, [&] { done.open(); }));
+	EXPECT_FALSE(scheduler->schedule(IJobScheduler::Pool::IO, IJobScheduler::Priority::High, [] {}));
+
+	// pools are independent
+	Gate cpuDone;
+	EXPECT_TRUE(scheduler->schedule(IJobScheduler::Pool::CPU, IJobScheduler::Priority::Normal, [&] { cpuDone.open(); }));
+	cpuDone.wait();
+
+	unblock.open();
+	done.wait();
+
+	const IJobScheduler::PoolStats stats {scheduler->getStats(IJobScheduler::Pool::IO)};
+	EXPECT_EQ(stats.threadCount, 1);
+	EXPECT_EQ(stats.maxQueueSize, 2);
+	EXPECT_EQ(stats.rejectedJobCount, 1);
+	EXPECT_EQ(stats.queueSize, 0);
+	EXPECT_GT(stats.maxWaitDuration.count(), 0);
+	EXPECT_GE(stats.totalWaitDuration, stats.maxWaitDuration);
+}
+
+TEST(JobScheduler, exceptionsDoNotStopPool)
+{
+	Gate done;
+
+	auto scheduler {createJobScheduler(1, 1, 10)};
+
+	ASSERT_TRUE(scheduler->schedule(IJobScheduler::Pool::CPU, IJobScheduler::Priority::Normal, [] { throw std::runtime_error {"failure"}; }));
+	ASSERT_TRUE(scheduler->schedule(IJobScheduler::Pool::CPU, IJobScheduler::Priority::Normal, [&] { done.open(); }));
+
+	done.wait();
+}
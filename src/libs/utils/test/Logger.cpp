@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2021 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/AsyncLogger.hpp"
+#include "utils/Logger.hpp"
+#include "utils/StreamLogger.hpp"
+
+namespace
+{
+	class TestLogger final : public Logger
+	{
+		public:
+			TestLogger(std::vector<std::string>& messages, EnumSet<Severity> severities = allSeverities)
+				: Logger {severities}
+				, _messages {messages}
+			{}
+
+			void processLog(const Log& log) override
+			{
+				_messages.push_back(log.getMessage());
+			}
+
+		private:
+			std::vector<std::string>& _messages;
+	};
+
+	int evaluate(unsigned& evaluationCount)
+	{
+		evaluationCount++;
+		return 42;
+	}
+}
+
+TEST(Logger, severities)
+{
+	std::vector<std::string> messages;
+	TestLogger logger {messages, EnumSet<Severity> {Severity::ERROR}};
+
+	EXPECT_TRUE(logger.isEnabled(Module::UI, Severity::ERROR));
+	EXPECT_FALSE(logger.isEnabled(Module::UI, Severity::DEBUG));
+
+	logger.setSeverities(Module::UI, EnumSet<Severity> {Severity::DEBUG});
+	EXPECT_FALSE(logger.isEnabled(Module::UI, Severity::ERROR));
+	EXPECT_TRUE(logger.isEnabled(Module::UI, Severity::DEBUG));
+	EXPECT_TRUE(logger.isEnabled(Module::AV, Severity::ERROR));
+
+	logger.setSeverities(Logger::allSeverities);
+	EXPECT_TRUE(logger.isEnabled(Module::UI, Severity::ERROR));
+	EXPECT_TRUE(logger.isEnabled(Module::AV, Severity::DEBUG));
+}
+
+TEST(Logger, disabledNotEvaluated)
+{
+	std::vector<std::string> messages;
+	Service<Logger> logger {std::make_unique<TestLogger>(messages, EnumSet<Severity> {Severity::ERROR})};
+
+	unsigned evaluationCount {};
+	LMS_LOG(UI, DEBUG) << "value = " << evaluate(evaluationCount);
+	EXPECT_EQ(evaluationCount, 0);
+	EXPECT_TRUE(messages.empty());
+
+	LMS_LOG(UI, ERROR) << "value = " << evaluate(evaluationCount);
+	EXPECT_EQ(evaluationCount, 1);
+	ASSERT_EQ(messages.size(), 1);
+	EXPECT_EQ(messages.front(), "value = 42");
+
+	// must behave as a single statement
+	bool elseTaken {};
+	if (evaluationCount == 0)
+		LMS_LOG(UI, ERROR) << "unexpected";
+	else
+		elseTaken = true;
+	EXPECT_TRUE(elseTaken);
+	EXPECT_EQ(messages.size(), 1);
+}
+
+TEST(AsyncLogger, allMessagesWritten)
+{
+	std::vector<std::string> messages;
+
+	constexpr std::size_t messageCount {1000};
+	{
+		AsyncLogger logger {std::make_unique<TestLogger>(messages), messageCount};
+
+		for (std::size_t i {}; i < messageCount; ++i)
+		{
+			Log log {&logger, Module::UI, Severity::INFO};
+			log.getOstream() << i;
+		}
+		// flushes on destruction
+	}
+
+	ASSERT_EQ(messages.size(), messageCount);
+	for (std::size_t i {}; i < messageCount; ++i)
+		EXPECT_EQ(messages[i], std::to_string(i));
+}
+
+TEST(StreamLogger, severities)
+{
+	std::ostringstream oss;
+	Service<Logger> logger {std::make_unique<StreamLogger>(oss, EnumSet<Severity> {Severity::ERROR})};
+
+	LMS_LOG(UI, DEBUG) << "hidden";
+	EXPECT_TRUE(oss.str().empty());
+
+	logger->setSeverities(Module::UI, EnumSet<Severity> {Severity::DEBUG});
+	LMS_LOG(UI, DEBUG) << "shown";
+	EXPECT_EQ(oss.str(), "[debug] [UI] shown\n");
+}
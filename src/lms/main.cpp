@@ -24,7 +24,9 @@
 
 #include <Wt/WServer.h>
 #include <Wt/WApplication.h>
+#include <Wt/WLogger.h>
 
+#include "av/ITranscodeScheduler.hpp"
 #include "image/IRawImage.hpp"
 #include "services/auth/IAuthTokenService.hpp"
 #include "services/auth/IPasswordService.hpp"
@@ -39,8 +41,11 @@
 #include "subsonic/SubsonicResource.hpp"
 #include "ui/LmsApplication.hpp"
 #include "ui/LmsApplicationManager.hpp"
+#include "ui/ViewModelCache.hpp"
+#include "utils/AsyncLogger.hpp"
 #include "utils/IChildProcessManager.hpp"
 #include "utils/IConfig.hpp"
+#include "utils/IJobScheduler.hpp"
 #include "utils/IOContextRunner.hpp"
 #include "utils/Service.hpp"
 #include "utils/String.hpp"
@@ -56,6 +61,29 @@ getThreadCount()
 	return configHttpServerThreadCount ? configHttpServerThreadCount : std::max<unsigned long>(2, std::thread::hardware_concurrency());
 }
 
+static
+std::size_t
+getJobPoolThreadCount(const std::string& configKey, std::size_t defaultThreadCount)
+{
+	const unsigned long configThreadCount {Service<IConfig>::get()->getULong(configKey, 0)};
+	return configThreadCount ? configThreadCount : defaultThreadCount;
+}
+
+static
+EnumSet<Severity>
+getWtLoggerSeverities(Wt::WServer& server)
+{
+	// No need to build messages the Wt logger would discard (see log-config)
+	EnumSet<Severity> severities;
+	for (const Severity severity : Logger::allSeverities)
+	{
+		if (server.logger().logging(getSeverityName(severity)))
+			severities.insert(severity);
+	}
+
+	return severities;
+}
+
 static
 std::vector<std::string>
 generateWtConfig(std::string execPath)
@@ -205,7 +233,7 @@ int main(int argc, char* argv[])
 		close(STDIN_FILENO);
 
 		Service<IConfig> config {createConfig(configFilePath)};
-		Service<Logger> logger {std::make_unique<WtLogger>()};
+		Service<Logger> logger {std::make_unique<AsyncLogger>(std::make_unique<WtLogger>())};
 
 		// Make sure the working directory exists
 		std::filesystem::create_directories(config->getPath("working-dir"));
@@ -224,11 +252,17 @@ int main(int argc, char* argv[])
 		boost::asio::io_context ioContext; // ioContext used to dispatch all the services that are out of the Wt event loop
 		Wt::WServer server {argv[0]};
 		server.setServerConfiguration(wtServerArgs.size(), const_cast<char**>(&wtArgv[0]));
+		logger->setSeverities(getWtLoggerSeverities(server));
 
 		IOContextRunner ioContextRunner {ioContext, getThreadCount()};
 
+		const std::size_t cpuJobThreadCount {getJobPoolThreadCount("job-pool-cpu-thread-count", std::max<unsigned>(1, std::thread::hardware_concurrency()))};
+		const std::size_t ioJobThreadCount {getJobPoolThreadCount("job-pool-io-thread-count", std::max<unsigned>(4, std::thread::hardware_concurrency()))};
+
 		// Initializing a connection pool to the database that will be shared along services
-		Database::Db database {config->getPath("working-dir") / "lms.db", getThreadCount()};
+		// IO jobs mostly run database queries: give them their own connections
+		Database::Db database {config->getPath("working-dir") / "lms.db", getThreadCount() + ioJobThreadCount};
+		database.getQueryProfiler().setEnabled(config->getBool("db-query-profiling", false));
 		{
 			Database::Session session {database};
 			session.prepareTables();
@@ -246,8 +280,8 @@ int main(int argc, char* argv[])
 		const std::string authenticationBackend {StringUtils::stringToLower(config->getString("authentication-backend", "internal"))};
 		if (authenticationBackend == "internal" || authenticationBackend == "pam")
 		{
-			authTokenService.assign(Auth::createAuthTokenService(database, config->getULong("login-throttler-max-entriees", 10000)));
-			authPasswordService.assign(Auth::createPasswordService(authenticationBackend, database, config->getULong("login-throttler-max-entriees", 10000), *authTokenService.get()));
+			authTokenService.assign(Auth::createAuthTokenService(database, config->getULong("login-throttler-max-entries", 10000)));
+			authPasswordService.assign(Auth::createPasswordService(authenticationBackend, database, config->getULong("login-throttler-max-entries", 10000), *authTokenService.get()));
 		}
 		else if (authenticationBackend == "http-headers")
 		{
@@ -270,14 +304,27 @@ int main(int argc, char* argv[])
 		});
 
 		Service<Scrobbling::IScrobblingService> scrobblingService {Scrobbling::createScrobblingService(ioContext, database)};
+		Service<UserInterface::ViewModelCache> viewModelCache {std::make_unique<UserInterface::ViewModelCache>(config->getULong("ui-view-model-cache-max-entries", 50000))};
+		const std::size_t transcodeMaxRunningCount {config->getULong("transcode-max-running", 0) ? config->getULong("transcode-max-running", 0) : std::max<unsigned>(1, std::thread::hardware_concurrency())};
+		Service<Av::ITranscodeScheduler> transcodeScheduler {Av::createTranscodeScheduler(transcodeMaxRunningCount, config->getULong("transcode-max-running-per-user", 2), config->getULong("transcode-max-queue-size", 32))};
+
+		// Created last so that pending jobs are dropped before the services they use
+		Service<IJobScheduler> jobScheduler {createJobScheduler(cpuJobThreadCount, ioJobThreadCount, config->getULong("job-pool-max-queue-size", 1000))};
 
 		std::unique_ptr<Wt::WResource> subsonicResource;
+		std::unique_ptr<Wt::WResource> subsonicMetricsResource;
 
 		// bind API resources
 		if (config->getBool("api-subsonic", true))
 		{
 			subsonicResource = API::Subsonic::createSubsonicResource(database);
 			server.addResource(subsonicResource.get(), "/rest");
+
+			if (config->getBool("api-subsonic-metrics", false))
+			{
+				subsonicMetricsResource = API::Subsonic::createSubsonicMetricsResource(*subsonicResource);
+				server.addResource(subsonicMetricsResource.get(), "/metrics/subsonic");
+			}
 		}
 
 		// bind UI entry point
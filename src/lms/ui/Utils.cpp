@@ -151,23 +151,35 @@ namespace UserInterface::Utils
 	Wt::WLink
 	createArtistLink(Database::Artist::pointer artist)
 	{
-		if (const auto mbid {artist->getMBID()})
-			return Wt::WLink {Wt::LinkType::InternalPath, "/artist/mbid/" + std::string {mbid->getAsString()}};
+		return createArtistLink(artist->getId(), artist->getMBID());
+	}
+
+	Wt::WLink
+	createArtistLink(Database::ArtistId artistId, const std::optional<UUID>& artistMBID)
+	{
+		if (artistMBID)
+			return Wt::WLink {Wt::LinkType::InternalPath, "/artist/mbid/" + std::string {artistMBID->getAsString()}};
 		else
-			return Wt::WLink {Wt::LinkType::InternalPath, "/artist/" + artist->getId().toString()};
+			return Wt::WLink {Wt::LinkType::InternalPath, "/artist/" + artistId.toString()};
 	}
 
 	std::unique_ptr<Wt::WAnchor>
 	createArtistAnchor(Database::Artist::pointer artist, bool setText)
 	{
-		auto res = std::make_unique<Wt::WAnchor>(createArtistLink(artist));
-
 		if (setText)
-		{
-			res->setTextFormat(Wt::TextFormat::Plain);
-			res->setText(Wt::WString::fromUTF8(artist->getName()));
-			res->setToolTip(Wt::WString::fromUTF8(artist->getName()), Wt::TextFormat::Plain);
-		}
+			return createArtistAnchor(artist->getId(), artist->getMBID(), artist->getName());
+
+		return std::make_unique<Wt::WAnchor>(createArtistLink(artist));
+	}
+
+	std::unique_ptr<Wt::WAnchor>
+	createArtistAnchor(Database::ArtistId artistId, const std::optional<UUID>& artistMBID, std::string_view name)
+	{
+		auto res = std::make_unique<Wt::WAnchor>(createArtistLink(artistId, artistMBID));
+
+		res->setTextFormat(Wt::TextFormat::Plain);
+		res->setText(Wt::WString::fromUTF8(std::string {name}));
+		res->setToolTip(Wt::WString::fromUTF8(std::string {name}), Wt::TextFormat::Plain);
 
 		return res;
 	}
@@ -175,23 +187,35 @@ namespace UserInterface::Utils
 	Wt::WLink
 	createReleaseLink(Database::Release::pointer release)
 	{
-		if (const auto mbid {release->getMBID()})
-			return Wt::WLink {Wt::LinkType::InternalPath, "/release/mbid/" + std::string {mbid->getAsString()}};
+		return createReleaseLink(release->getId(), release->getMBID());
+	}
+
+	Wt::WLink
+	createReleaseLink(Database::ReleaseId releaseId, const std::optional<UUID>& releaseMBID)
+	{
+		if (releaseMBID)
+			return Wt::WLink {Wt::LinkType::InternalPath, "/release/mbid/" + std::string {releaseMBID->getAsString()}};
 		else
-			return Wt::WLink {Wt::LinkType::InternalPath, "/release/" + release->getId().toString()};
+			return Wt::WLink {Wt::LinkType::InternalPath, "/release/" + releaseId.toString()};
 	}
 
 	std::unique_ptr<Wt::WAnchor>
 	createReleaseAnchor(Database::Release::pointer release, bool setText)
 	{
-		auto res = std::make_unique<Wt::WAnchor>(createReleaseLink(release));
-
 		if (setText)
-		{
-			res->setTextFormat(Wt::TextFormat::Plain);
-			res->setText(Wt::WString::fromUTF8(release->getName()));
-			res->setToolTip(Wt::WString::fromUTF8(release->getName()), Wt::TextFormat::Plain);
-		}
+			return createReleaseAnchor(release->getId(), release->getMBID(), release->getName());
+
+		return std::make_unique<Wt::WAnchor>(createReleaseLink(release));
+	}
+
+	std::unique_ptr<Wt::WAnchor>
+	createReleaseAnchor(Database::ReleaseId releaseId, const std::optional<UUID>& releaseMBID, std::string_view name)
+	{
+		auto res = std::make_unique<Wt::WAnchor>(createReleaseLink(releaseId, releaseMBID));
+
+		res->setTextFormat(Wt::TextFormat::Plain);
+		res->setText(Wt::WString::fromUTF8(std::string {name}));
+		res->setToolTip(Wt::WString::fromUTF8(std::string {name}), Wt::TextFormat::Plain);
 
 		return res;
 	}
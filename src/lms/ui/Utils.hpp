@@ -20,7 +20,9 @@
 #pragma once
 
 #include <chrono>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include <Wt/WContainerWidget.h>
 #include <Wt/WImage.h>
@@ -31,6 +33,7 @@
 #include "services/database/Object.hpp"
 #include "services/database/ReleaseId.hpp"
 #include "services/database/TrackId.hpp"
+#include "utils/UUID.hpp"
 
 #include "resource/CoverResource.hpp"
 
@@ -60,9 +63,13 @@ namespace UserInterface::Utils
 	std::unique_ptr<Wt::WContainerWidget> createArtistContainer(const std::vector<Database::ArtistId>& artists);
 
 	Wt::WLink createArtistLink(Database::ObjectPtr<Database::Artist> artist);
+	Wt::WLink createArtistLink(Database::ArtistId artistId, const std::optional<UUID>& artistMBID);
 	std::unique_ptr<Wt::WAnchor> createArtistAnchor(Database::ObjectPtr<Database::Artist> artist, bool setText = true);
+	std::unique_ptr<Wt::WAnchor> createArtistAnchor(Database::ArtistId artistId, const std::optional<UUID>& artistMBID, std::string_view name);
 	Wt::WLink createReleaseLink(Database::ObjectPtr<Database::Release> release);
+	Wt::WLink createReleaseLink(Database::ReleaseId releaseId, const std::optional<UUID>& releaseMBID);
 	std::unique_ptr<Wt::WAnchor> createReleaseAnchor(Database::ObjectPtr<Database::Release> release, bool setText = true);
+	std::unique_ptr<Wt::WAnchor> createReleaseAnchor(Database::ReleaseId releaseId, const std::optional<UUID>& releaseMBID, std::string_view name);
 	std::unique_ptr<Wt::WAnchor> createTrackListAnchor(Database::ObjectPtr<Database::TrackList> trackList, bool setText = true);
 
 	std::unique_ptr<Wt::WContainerWidget> createClustersForTrack(Database::ObjectPtr<Database::Track> track, Filters& filters);
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ViewModelCache.hpp"
+
+#include "services/database/Artist.hpp"
+#include "services/database/Release.hpp"
+#include "services/database/Session.hpp"
+#include "services/database/Track.hpp"
+#include "utils/Logger.hpp"
+
+namespace UserInterface
+{
+	namespace
+	{
+		ViewModelCache::ArtistViewModel
+		createArtistViewModel(const Database::Artist::pointer& artist)
+		{
+			return ViewModelCache::ArtistViewModel {artist->getId(), artist->getName(), artist->getMBID()};
+		}
+	}
+
+	ViewModelCache::ViewModelCache(std::size_t maxEntryCount)
+		: _maxEntryCount {maxEntryCount}
+	{
+	}
+
+	std::shared_ptr<const ViewModelCache::ArtistViewModel>
+	ViewModelCache::getArtist(Database::Session& session, Database::ArtistId artistId)
+	{
+		return get(_artists, artistId, [&]() -> std::shared_ptr<const ArtistViewModel>
+		{
+			const Database::Artist::pointer artist {Database::Artist::find(session, artistId)};
+			if (!artist)
+				return {};
+
+			return std::make_shared<const ArtistViewModel>(createArtistViewModel(artist));
+		});
+	}
+
+	std::shared_ptr<const ViewModelCache::ReleaseViewModel>
+	ViewModelCache::getRelease(Database::Session& session, Database::ReleaseId releaseId)
+	{
+		return get(_releases, releaseId, [&]() -> std::shared_ptr<const ReleaseViewModel>
+		{
+			const Database::Release::pointer release {Database::Release::find(session, releaseId)};
+			if (!release)
+				return {};
+
+			auto viewModel {std::make_shared<ReleaseViewModel>()};
+			viewModel->id = releaseId;
+			viewModel->name = release->getName();
+			viewModel->mbid = release->getMBID();
+
+			auto artists {release->getReleaseArtists()};
+			if (artists.empty())
+				artists = release->getArtists();
+
+			viewModel->artists.reserve(artists.size());
+			for (const Database::Artist::pointer& artist : artists)
+				viewModel->artists.push_back(createArtistViewModel(artist));
+
+			viewModel->year = release->getReleaseYear();
+			viewModel->originalYear = release->getReleaseYear(true);
+
+			return viewModel;
+		});
+	}
+
+	std::shared_ptr<const ViewModelCache::TrackViewModel>
+	ViewModelCache::getTrack(Database::Session& session, Database::TrackId trackId)
+	{
+		return get(_tracks, trackId, [&]() -> std::shared_ptr<const TrackViewModel>
+		{
+			const Database::Track::pointer track {Database::Track::find(session, trackId)};
+			if (!track)
+				return {};
+
+			auto viewModel {std::make_shared<TrackViewModel>()};
+			viewModel->id = trackId;
+			viewModel->name = track->getName();
+			viewModel->duration = track->getDuration();
+
+			if (const Database::Release::pointer release {track->getRelease()})
+				viewModel->release = TrackViewModel::Release {release->getId(), release->getName(), release->getMBID()};
+
+			return viewModel;
+		});
+	}
+
+	template <typename IdType, typename ViewModel, typename Loader>
+	std::shared_ptr<const ViewModel>
+	ViewModelCache::get(Entries<IdType, ViewModel>& entries, IdType id, Loader loader)
+	{
+		const std::size_t modificationCount {checkModificationCount()};
+
+		{
+			std::shared_lock lock {_mutex};
+
+			auto it {entries.find(id)};
+			if (it != std::cend(entries))
+				return it->second;
+		}
+
+		// load outside the lock: other sessions may render cached entries meanwhile
+		std::shared_ptr<const ViewModel> viewModel {loader()};
+		if (!viewModel)
+			return viewModel;
+
+		{
+			std::unique_lock lock {_mutex};
+
+			// do not cache data loaded before a database change
+			if (modificationCount != _modificationCount)
+				return viewModel;
+
+			if (entries.size() >= _maxEntryCount)
+			{
+				LMS_LOG(UI, DEBUG) << "View model cache full, flushing " << entries.size() << " entries";
+				entries.clear();
+			}
+
+			entries.emplace(id, viewModel);
+		}
+
+		return viewModel;
+	}
+
+	std::size_t
+	ViewModelCache::checkModificationCount()
+	{
+		// bumped by each scanner write, committed or about to be (the caller holds a transaction)
+		const std::size_t modificationCount {Database::Artist::getModificationCount()
+			+ Database::Release::getModificationCount()
+			+ Database::Track::getModificationCount()};
+
+		{
+			std::shared_lock lock {_mutex};
+			if (modificationCount == _modificationCount)
+				return modificationCount;
+		}
+
+		std::unique_lock lock {_mutex};
+		if (modificationCount != _modificationCount)
+		{
+			LMS_LOG(UI, DEBUG) << "Database modified, flushing view model cache";
+
+			_artists.clear();
+			_releases.clear();
+			_tracks.clear();
+			_modificationCount = modificationCount;
+		}
+
+		return modificationCount;
+	}
+} // namespace UserInterface
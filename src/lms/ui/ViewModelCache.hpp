@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "services/database/ArtistId.hpp"
+#include "services/database/ReleaseId.hpp"
+#include "services/database/TrackId.hpp"
+#include "utils/UUID.hpp"
+
+namespace Database
+{
+	class Session;
+}
+
+namespace UserInterface
+{
+	// Process-wide cache of the data needed to render entity entries
+	// Shared by all the sessions, flushed each time an artist, release or track is created, modified or removed
+	class ViewModelCache
+	{
+		public:
+			struct ArtistViewModel
+			{
+				Database::ArtistId		id;
+				std::string				name;
+				std::optional<UUID>		mbid;
+			};
+
+			struct ReleaseViewModel
+			{
+				Database::ReleaseId				id;
+				std::string						name;
+				std::optional<UUID>				mbid;
+				std::vector<ArtistViewModel>	artists;	// release artists, or track artists if none
+				std::optional<int>				year;
+				std::optional<int>				originalYear;
+			};
+
+			struct TrackViewModel
+			{
+				struct Release
+				{
+					Database::ReleaseId		id;
+					std::string				name;
+					std::optional<UUID>		mbid;
+				};
+
+				Database::TrackId			id;
+				std::string					name;
+				std::optional<Release>		release;
+				std::chrono::milliseconds	duration;
+			};
+
+			ViewModelCache(std::size_t maxEntryCount);
+
+			ViewModelCache(const ViewModelCache&) = delete;
+			ViewModelCache(ViewModelCache&&) = delete;
+			ViewModelCache& operator=(const ViewModelCache&) = delete;
+			ViewModelCache& operator=(ViewModelCache&&) = delete;
+
+			// Must be called within a transaction
+			// Returns nullptr if the entity does not exist
+			std::shared_ptr<const ArtistViewModel> getArtist(Database::Session& session, Database::ArtistId artistId);
+			std::shared_ptr<const ReleaseViewModel> getRelease(Database::Session& session, Database::ReleaseId releaseId);
+			std::shared_ptr<const TrackViewModel> getTrack(Database::Session& session, Database::TrackId trackId);
+
+		private:
+			template <typename IdType, typename ViewModel>
+			using Entries = std::unordered_map<IdType, std::shared_ptr<const ViewModel>>;
+
+			template <typename IdType, typename ViewModel, typename Loader>
+			std::shared_ptr<const ViewModel> get(Entries<IdType, ViewModel>& entries, IdType id, Loader loader);
+
+			std::size_t checkModificationCount();
+
+			const std::size_t							_maxEntryCount;
+
+			std::shared_mutex							_mutex;
+			std::size_t									_modificationCount {};
+			Entries<Database::ArtistId, ArtistViewModel>	_artists;
+			Entries<Database::ReleaseId, ReleaseViewModel>	_releases;
+			Entries<Database::TrackId, TrackViewModel>		_tracks;
+	};
+} // namespace UserInterface
@@ -254,6 +254,20 @@ ScannerController::refreshContents()
 						.arg(status.currentScanStepStats->progress()));
 					break;
 
+				case Scanner::ScanProgressStep::ResolvingCovers:
+					_stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-resolving-covers")
+						.arg(status.currentScanStepStats->processedElems)
+						.arg(status.currentScanStepStats->totalElems)
+						.arg(status.currentScanStepStats->progress()));
+					break;
+
+				case Scanner::ScanProgressStep::GeneratingThumbnails:
+					_stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-generating-thumbnails")
+						.arg(status.currentScanStepStats->processedElems)
+						.arg(status.currentScanStepStats->totalElems)
+						.arg(status.currentScanStepStats->progress()));
+					break;
+
 				case Scanner::ScanProgressStep::FetchingTrackFeatures:
 					_stepStatus->setText(Wt::WString::tr("Lms.Admin.ScannerController.step-fetching-track-features")
 						.arg(status.currentScanStepStats->processedElems)
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "VirtualScrollingContainer.hpp"
+
+#include <algorithm>
+
+#include "LoadingIndicator.hpp"
+
+namespace UserInterface
+{
+	VirtualScrollingContainer::VirtualScrollingContainer(std::size_t pageSize, std::size_t maxLoadedPageCount, const std::string& pageStyleClass, const Wt::WString& text)
+		: Wt::WTemplate {text}
+		, _pageSize {pageSize}
+		, _maxLoadedPageCount {std::max<std::size_t>(maxLoadedPageCount, 2)}
+		, _pageStyleClass {pageStyleClass}
+		, _pagesContainer {bindNew<Wt::WContainerWidget>("pages")}
+	{
+		setHasMore(false);
+	}
+
+	void
+	VirtualScrollingContainer::setPageLoader(PageLoader pageLoader)
+	{
+		_pageLoader = std::move(pageLoader);
+	}
+
+	void
+	VirtualScrollingContainer::reset()
+	{
+		_pages.clear();
+		_pagesContainer->clear();
+		setHasMore(false);
+
+		addPage();
+	}
+
+	void
+	VirtualScrollingContainer::addPage()
+	{
+		const std::size_t pageIndex {_pages.size()};
+
+		Wt::WContainerWidget* container {_pagesContainer->addNew<Wt::WContainerWidget>()};
+		container->setStyleClass(_pageStyleClass);
+		container->setScrollVisibilityMargin(500);
+		container->scrollVisibilityChanged().connect([this, pageIndex](bool visible)
+		{
+			if (visible)
+				loadPage(pageIndex);
+		});
+
+		_pages.push_back(Page {container, PageState::Unloaded});
+		loadPage(pageIndex);
+	}
+
+	void
+	VirtualScrollingContainer::loadPage(std::size_t pageIndex)
+	{
+		if (!_pageLoader || pageIndex >= _pages.size())
+			return;
+
+		Page& page {_pages[pageIndex]};
+		if (page.state == PageState::Loaded)
+			return;
+
+		// Heights frozen during a previous request have been applied by now: the contents can be safely removed
+		for (Page& otherPage : _pages)
+		{
+			if (&otherPage != &page && otherPage.state == PageState::Releasing)
+			{
+				otherPage.container->clear();
+				otherPage.state = PageState::Unloaded;
+			}
+		}
+
+		if (page.state == PageState::Unloaded)
+		{
+			const bool hasMore {_pageLoader(Database::Range {pageIndex * _pageSize, _pageSize}, *page.container)};
+			if (pageIndex == _pages.size() - 1)
+				setHasMore(hasMore);
+		}
+		page.state = PageState::Loaded;
+		doJavaScript(page.container->jsRef() + ".style.height='';");
+
+		releaseFarPages(pageIndex);
+	}
+
+	void
+	VirtualScrollingContainer::releaseFarPages(std::size_t pageIndex)
+	{
+		const std::size_t halfWindow {_maxLoadedPageCount / 2};
+
+		for (std::size_t i {}; i < _pages.size(); ++i)
+		{
+			Page& page {_pages[i]};
+			if (page.state != PageState::Loaded)
+				continue;
+
+			const std::size_t distance {i > pageIndex ? i - pageIndex : pageIndex - i};
+			if (distance <= halfWindow)
+				continue;
+
+			// keep the same height once emptied, so that the scroll position does not move
+			const std::string ref {page.container->jsRef()};
+			doJavaScript(ref + ".style.height=" + ref + ".offsetHeight+'px';");
+			page.state = PageState::Releasing;
+		}
+	}
+
+	void
+	VirtualScrollingContainer::setHasMore(bool hasMore)
+	{
+		if (!hasMore)
+		{
+			bindEmpty("loading-indicator");
+			return;
+		}
+
+		Wt::WTemplate* loadingIndicator {bindWidget<Wt::WTemplate>("loading-indicator", createLoadingIndicator())};
+		loadingIndicator->scrollVisibilityChanged().connect([this](bool visible)
+		{
+			if (!visible)
+				return;
+
+			addPage();
+		});
+	}
+}
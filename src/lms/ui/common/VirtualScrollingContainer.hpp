@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Wt/WContainerWidget.h>
+#include <Wt/WString.h>
+#include <Wt/WTemplate.h>
+
+#include "services/database/Types.hpp"
+
+namespace UserInterface
+{
+	// Infinite scrolling container that only keeps the pages around the last loaded one as widgets
+	// Pages out of this window are emptied but keep their height, and are reloaded by range when scrolled back into view
+	class VirtualScrollingContainer : public Wt::WTemplate
+	{
+		public:
+			// Fills the page with the elements of the given range, returns true if there are more elements after this range
+			using PageLoader = std::function<bool(Database::Range range, Wt::WContainerWidget& page)>;
+
+			// "text" must contain "pages" and "loading-indicator"
+			VirtualScrollingContainer(std::size_t pageSize, std::size_t maxLoadedPageCount, const std::string& pageStyleClass, const Wt::WString& text = Wt::WString::tr("Lms.virtual-scrolling-container.template"));
+
+			void setPageLoader(PageLoader pageLoader);
+
+			// Remove all the pages and load the first one
+			void reset();
+
+		private:
+			enum class PageState
+			{
+				Unloaded,
+				Loaded,
+				Releasing,	// height frozen on client side, content to be removed
+			};
+
+			struct Page
+			{
+				Wt::WContainerWidget*	container {};
+				PageState				state {PageState::Unloaded};
+			};
+
+			void addPage();
+			void loadPage(std::size_t pageIndex);
+			void releaseFarPages(std::size_t pageIndex);
+			void setHasMore(bool hasMore);
+
+			const std::size_t		_pageSize;
+			const std::size_t		_maxLoadedPageCount;
+			const std::string		_pageStyleClass;
+			PageLoader				_pageLoader;
+			Wt::WContainerWidget*	_pagesContainer {};
+			std::vector<Page>		_pages;
+	};
+}
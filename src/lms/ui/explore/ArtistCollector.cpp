@@ -43,8 +43,21 @@ namespace UserInterface
 		switch (getMode())
 		{
 			case Mode::Random:
-				artists = getRandomArtists(range);
+			{
+				// seeded random order: pages are consistent until the collector is reset
+				Artist::FindParameters params;
+				params.setClusters(getFilters().getClusterIds());
+				params.setLinkType(_linkType);
+				params.setSortMethod(ArtistSortMethod::Random);
+				params.setRandomSeed(getRandomSeed());
+				params.setRange(range);
+
+				{
+					auto transaction {LmsApp->getDbSession().createSharedTransaction()};
+					artists = Artist::find(LmsApp->getDbSession(), params);
+				}
 				break;
+			}
 
 			case Mode::Starred:
 				artists = scrobbling.getStarredArtists(LmsApp->getUserId(), getFilters().getClusterIds(), _linkType, ArtistSortMethod::StarredDateDesc, range);
@@ -109,27 +122,5 @@ namespace UserInterface
 
 		return artists;
 	}
-
-	RangeResults<Database::ArtistId>
-	ArtistCollector::getRandomArtists(Range range)
-	{
-		assert(getMode() == Mode::Random);
-
-		if (!_randomArtists)
-		{
-			Artist::FindParameters params;
-			params.setClusters(getFilters().getClusterIds());
-			params.setLinkType(_linkType);
-			params.setSortMethod(ArtistSortMethod::Random);
-			params.setRange(Range {0, getMaxCount()});
-
-			{
-				auto transaction {LmsApp->getDbSession().createSharedTransaction()};
-				_randomArtists = Artist::find(LmsApp->getDbSession(), params);
-			}
-		}
-
-		return _randomArtists->getSubRange(range);
-	}
 } // ns UserInterface
 
@@ -21,17 +21,30 @@
 #include <Wt/WAnchor.h>
 
 #include "services/database/Artist.hpp"
+#include "utils/Service.hpp"
+
+#include "LmsApplication.hpp"
 #include "Utils.hpp"
+#include "ViewModelCache.hpp"
 
 namespace UserInterface::ArtistListHelpers
 {
 	std::unique_ptr<Wt::WTemplate>
-	createEntry(const Database::ObjectPtr<Database::Artist>& artist)
+	createEntry(Database::ArtistId artistId)
 	{
+		const auto artist {Service<ViewModelCache>::get()->getArtist(LmsApp->getDbSession(), artistId)};
+		if (!artist)
+			return {};
+
 		auto res {std::make_unique<Wt::WTemplate>(Wt::WString::tr("Lms.Explore.Artists.template.entry"))};
-		res->bindWidget("name", Utils::createArtistAnchor(artist));
+		res->bindWidget("name", Utils::createArtistAnchor(artist->id, artist->mbid, artist->name));
 
 		return res;
 	}
-}
 
+	std::unique_ptr<Wt::WTemplate>
+	createEntry(const Database::ObjectPtr<Database::Artist>& artist)
+	{
+		return createEntry(artist->getId());
+	}
+}
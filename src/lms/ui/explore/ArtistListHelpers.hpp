@@ -23,6 +23,7 @@
 
 #include <Wt/WTemplate.h>
 
+#include "services/database/ArtistId.hpp"
 #include "services/database/Object.hpp"
 
 namespace Database
@@ -32,6 +33,7 @@ namespace Database
 
 namespace UserInterface::ArtistListHelpers
 {
+	std::unique_ptr<Wt::WTemplate> createEntry(Database::ArtistId artistId); // nullptr if the artist does not exist
 	std::unique_ptr<Wt::WTemplate> createEntry(const Database::ObjectPtr<Database::Artist>& artist);
 }
 
@@ -28,7 +28,7 @@
 #include "utils/Logger.hpp"
 
 #include "common/ValueStringModel.hpp"
-#include "common/InfiniteScrollingContainer.hpp"
+#include "common/VirtualScrollingContainer.hpp"
 #include "ArtistListHelpers.hpp"
 #include "Filters.hpp"
 #include "LmsApplication.hpp"
@@ -85,10 +85,10 @@ Artists::Artists(Filters& filters)
 			refreshArtistLinkTypes();
 	});
 
-	_container = bindNew<InfiniteScrollingContainer>("artists", Wt::WString::tr("Lms.Explore.Artists.template.container"));
-	_container->onRequestElements.connect([this]
+	_container = bindNew<VirtualScrollingContainer>("artists", _pageSize, _maxLoadedPageCount, "d-grid gap-3 mb-3");
+	_container->setPageLoader([this](Range range, Wt::WContainerWidget& page)
 	{
-		addSome();
+		return loadPage(range, page);
 	});
 
 	filters.updated().connect([this]
@@ -102,9 +102,8 @@ Artists::Artists(Filters& filters)
 void
 Artists::refreshView()
 {
-	_container->clear();
 	_artistCollector.reset();
-	addSome();
+	_container->reset();
 }
 
 void
@@ -157,22 +156,22 @@ Artists::refreshArtistLinkTypes()
 	addTypeIfUsed(TrackArtistLinkType::Remixer, "Lms.Explore.Artists.linktype-remixer");
 }
 
-void
-Artists::addSome()
+bool
+Artists::loadPage(Range range, Wt::WContainerWidget& page)
 {
-	const auto artistIds {_artistCollector.get(Range {static_cast<std::size_t>(_container->getCount()), _batchSize})};
+	const auto artistIds {_artistCollector.get(range)};
 
 	{
 		auto transaction {LmsApp->getDbSession().createSharedTransaction()};
 
 		for (const ArtistId artistId : artistIds.results)
 		{
-			if (const auto artist {Artist::find(LmsApp->getDbSession(), artistId)})
-				_container->add(ArtistListHelpers::createEntry(artist));
+			if (auto entry {ArtistListHelpers::createEntry(artistId)})
+				page.addWidget(std::move(entry));
 		}
 	}
 
-	_container->setHasMore(artistIds.moreResults);
+	return artistIds.moreResults;
 }
 
 } // namespace UserInterface
@@ -23,6 +23,7 @@
 #include <unordered_map>
 
 #include <Wt/WComboBox.h>
+#include <Wt/WContainerWidget.h>
 #include <Wt/WTemplate.h>
 
 #include "services/database/Types.hpp"
@@ -31,7 +32,7 @@
 namespace UserInterface
 {
 	class Filters;
-	class InfiniteScrollingContainer;
+	class VirtualScrollingContainer;
 
 	class Artists : public Wt::WTemplate
 	{
@@ -43,13 +44,14 @@ namespace UserInterface
 			void refreshView(ArtistCollector::Mode mode);
 			void refreshView(std::optional<Database::TrackArtistLinkType> linkType);
 			void refreshArtistLinkTypes();
-			void addSome();
+			bool loadPage(Database::Range range, Wt::WContainerWidget& page);
 
-			static constexpr std::size_t _batchSize {30};
+			static constexpr std::size_t _pageSize {30};
+			static constexpr std::size_t _maxLoadedPageCount {10};
 			static constexpr std::size_t _maxCount {8000};
 
 			Wt::WWidget*				_currentActiveItem {};
-			InfiniteScrollingContainer* _container {};
+			VirtualScrollingContainer*	_container {};
 			ArtistCollector				_artistCollector;
 			Wt::WComboBox*				_linkType {};
 			static constexpr ArtistCollector::Mode _defaultMode {ArtistCollector::Mode::Random};
@@ -19,6 +19,7 @@
 
 #include "DatabaseCollectorBase.hpp"
 
+#include "utils/Random.hpp"
 #include "utils/String.hpp"
 
 namespace UserInterface
@@ -27,9 +28,16 @@ namespace UserInterface
 		: _filters {filters}
 		, _mode {defaultMode}
 		, _maxCount {maxCount}
+		, _randomSeed {static_cast<std::uint32_t>(Random::getRandGenerator()())}
 	{
 	}
 
+	void
+	DatabaseCollectorBase::reset()
+	{
+		_randomSeed = static_cast<std::uint32_t>(Random::getRandGenerator()());
+	}
+
 	DatabaseCollectorBase::Range
 	DatabaseCollectorBase::getActualRange(Range range) const
 	{
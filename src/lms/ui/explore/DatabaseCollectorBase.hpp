@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -54,11 +55,13 @@ namespace UserInterface
 			Mode getMode() const { return _mode; }
 			void setMode(Mode mode) { _mode = mode; }
 			void setSearch(std::string_view search);
+			void reset(); // renew the random order
 
 		protected:
 			Range		getActualRange(Range range) const;
 			std::size_t	getMaxCount() const;
 			Filters&	getFilters() { return _filters; }
+			std::uint32_t getRandomSeed() const { return _randomSeed; }
 			const std::vector<std::string_view>& getSearchKeywords() const { return _searchKeywords; }
 
 		private:
@@ -67,6 +70,7 @@ namespace UserInterface
 			std::vector<std::string_view> _searchKeywords;
 			Mode		_mode;
 			std::size_t _maxCount;
+			std::uint32_t _randomSeed;
 	};
 } // ns UserInterface
 
@@ -45,8 +45,20 @@ namespace UserInterface
 		switch (getMode())
 		{
 			case Mode::Random:
-				releases = getRandomReleases(range);
+			{
+				// seeded random order: pages are consistent until the collector is reset
+				Release::FindParameters params;
+				params.setClusters(getFilters().getClusterIds());
+				params.setSortMethod(ReleaseSortMethod::Random);
+				params.setRandomSeed(getRandomSeed());
+				params.setRange(range);
+
+				{
+					auto transaction {LmsApp->getDbSession().createSharedTransaction()};
+					releases = Release::find(LmsApp->getDbSession(), params);
+				}
 				break;
+			}
 
 			case Mode::Starred:
 				releases = scrobbling.getStarredReleases(LmsApp->getUserId(), getFilters().getClusterIds(), range);
@@ -110,26 +122,5 @@ namespace UserInterface
 		return releases;
 	}
 
-	RangeResults<ReleaseId>
-	ReleaseCollector::getRandomReleases(Range range)
-	{
-		assert(getMode() == Mode::Random);
-
-		if (!_randomReleases)
-		{
-			Release::FindParameters params;
-			params.setClusters(getFilters().getClusterIds());
-			params.setSortMethod(ReleaseSortMethod::Random);
-			params.setRange({0, getMaxCount()});
-
-			{
-				auto transaction {LmsApp->getDbSession().createSharedTransaction()};
-				_randomReleases = Release::find(LmsApp->getDbSession(), params);
-			}
-		}
-
-		return _randomReleases->getSubRange(range);
-	}
-
 } // ns UserInterface
 
@@ -40,11 +40,6 @@ namespace UserInterface
 			using DatabaseCollectorBase::DatabaseCollectorBase;
 
 			Database::RangeResults<Database::ReleaseId>	get(Database::Range range);
-			void reset() { _randomReleases.reset(); }
-
-		private:
-			Database::RangeResults<Database::ReleaseId> getRandomReleases(Range range);
-			std::optional<Database::RangeResults<Database::ReleaseId>> _randomReleases;
 	};
 } // ns UserInterface
 
@@ -19,14 +19,19 @@
 
 #include "ReleaseListHelpers.hpp"
 
+#include <algorithm>
+
 #include <Wt/WAnchor.h>
 #include <Wt/WImage.h>
 #include <Wt/WText.h>
 
 #include "services/database/Artist.hpp"
 #include "services/database/Release.hpp"
+#include "utils/Service.hpp"
 
+#include "LmsApplication.hpp"
 #include "Utils.hpp"
+#include "ViewModelCache.hpp"
 
 using namespace Database;
 
@@ -34,25 +39,22 @@ namespace UserInterface::ReleaseListHelpers
 {
 	static
 	std::unique_ptr<Wt::WTemplate>
-	createEntryInternal(const Release::pointer& release, const std::string& templateKey, const Artist::pointer& artist, const bool showYear)
+	createEntryInternal(const ViewModelCache::ReleaseViewModel& release, const std::string& templateKey, std::optional<ArtistId> artistId, const bool showYear)
 	{
 		auto entry {std::make_unique<Wt::WTemplate>(Wt::WString::tr(templateKey))};
 
-		entry->bindWidget("release-name", Utils::createReleaseAnchor(release));
+		entry->bindWidget("release-name", Utils::createReleaseAnchor(release.id, release.mbid, release.name));
 		entry->addFunction("tr", &Wt::WTemplate::Functions::tr);
 
 		{
-			Wt::WAnchor* anchor {entry->bindWidget("cover", Utils::createReleaseAnchor(release, false))};
-			auto cover {Utils::createCover(release->getId(), CoverResource::Size::Large)};
+			Wt::WAnchor* anchor {entry->bindNew<Wt::WAnchor>("cover", Utils::createReleaseLink(release.id, release.mbid))};
+			auto cover {Utils::createCover(release.id, CoverResource::Size::Large)};
 			cover->addStyleClass("Lms-cover-release Lms-cover-anchor");
 			anchor->setImage(std::move(cover));
 		}
 
-		auto artists {release->getReleaseArtists()};
-		if (artists.empty())
-			artists = release->getArtists();
-
-		const bool isSameArtist {(std::find(std::cbegin(artists), std::cend(artists), artist) != artists.end())};
+		const auto& artists {release.artists};
+		const bool isSameArtist {artistId && std::any_of(std::cbegin(artists), std::cend(artists), [&](const ViewModelCache::ArtistViewModel& artist) { return artist.id == *artistId; })};
 
 		if (artists.size() > 1)
 		{
@@ -61,18 +63,18 @@ namespace UserInterface::ReleaseListHelpers
 		else if (artists.size() == 1 && !isSameArtist)
 		{
 			entry->setCondition("if-has-artist", true);
-			entry->bindWidget("artist-name", Utils::createArtistAnchor(artists.front()));
+			entry->bindWidget("artist-name", Utils::createArtistAnchor(artists.front().id, artists.front().mbid, artists.front().name));
 		}
 
 		if (showYear)
 		{
-			if (std::optional<int> year {release->getReleaseYear()})
+			if (const std::optional<int> year {release.year})
 			{
 				entry->setCondition("if-has-year", true);
 
 				std::string strYear {std::to_string(*year)};
 
-				std::optional<int> originalYear {release->getReleaseYear(true)};
+				const std::optional<int> originalYear {release.originalYear};
 				if (originalYear && *originalYear != *year)
 				{
 					strYear += " (" + std::to_string(*originalYear) + ")";
@@ -85,22 +87,32 @@ namespace UserInterface::ReleaseListHelpers
 		return entry;
 	}
 
+	static
 	std::unique_ptr<Wt::WTemplate>
-	createEntry(const Release::pointer& release, const Artist::pointer& artist, bool showYear)
+	createEntry(ReleaseId releaseId, std::optional<ArtistId> artistId, bool showYear)
 	{
-		return createEntryInternal(release, "Lms.Explore.Releases.template.entry-grid", artist, showYear);
+		const auto release {Service<ViewModelCache>::get()->getRelease(LmsApp->getDbSession(), releaseId)};
+		if (!release)
+			return {};
+
+		return createEntryInternal(*release, "Lms.Explore.Releases.template.entry-grid", artistId, showYear);
+	}
+
+	std::unique_ptr<Wt::WTemplate>
+	createEntry(ReleaseId releaseId)
+	{
+		return createEntry(releaseId, std::nullopt, false /*year*/);
 	}
 
 	std::unique_ptr<Wt::WTemplate>
 	createEntry(const Release::pointer& release)
 	{
-		return createEntry(release, Artist::pointer {}, false /*year*/);
+		return createEntry(release->getId());
 	}
 
 	std::unique_ptr<Wt::WTemplate>
 	createEntryForArtist(const Database::Release::pointer& release, const Database::Artist::pointer& artist)
 	{
-		return createEntry(release, artist, true);
+		return createEntry(release->getId(), artist->getId(), true);
 	}
 } // namespace UserInterface
-
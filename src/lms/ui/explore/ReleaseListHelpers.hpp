@@ -23,6 +23,7 @@
 
 #include <Wt/WTemplate.h>
 #include "services/database/Object.hpp"
+#include "services/database/ReleaseId.hpp"
 
 namespace Database
 {
@@ -32,6 +33,7 @@ namespace Database
 
 namespace UserInterface::ReleaseListHelpers
 {
+	std::unique_ptr<Wt::WTemplate> createEntry(Database::ReleaseId releaseId); // nullptr if the release does not exist
 	std::unique_ptr<Wt::WTemplate> createEntry(const Database::ObjectPtr<Database::Release>& release);
 	std::unique_ptr<Wt::WTemplate> createEntryForArtist(const Database::ObjectPtr<Database::Release>& release, const Database::ObjectPtr<Database::Artist>& artist);
 } // namespace UserInterface
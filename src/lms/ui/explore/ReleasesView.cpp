@@ -24,8 +24,8 @@
 #include "services/database/Release.hpp"
 #include "services/database/Session.hpp"
 
-#include "common/InfiniteScrollingContainer.hpp"
 #include "common/Template.hpp"
+#include "common/VirtualScrollingContainer.hpp"
 #include "explore/Filters.hpp"
 #include "explore/PlayQueueController.hpp"
 #include "explore/ReleaseListHelpers.hpp"
@@ -85,10 +85,10 @@ Releases::Releases(Filters& filters, PlayQueueController& playQueueController)
 			_playQueueController.processCommand(PlayQueueController::Command::PlayOrAddLast, getAllReleases());
 		});
 
-	_container = bindNew<InfiniteScrollingContainer>("releases", Wt::WString::tr("Lms.Explore.Releases.template.container"));
-	_container->onRequestElements.connect([this]
+	_container = bindNew<VirtualScrollingContainer>("releases", _pageSize, _maxLoadedPageCount, "row row-cols-2 row-cols-md-3 row-cols-lg-4 row-cols-xl-6 gx-2 gy-4 mb-4");
+	_container->setPageLoader([this](Range range, Wt::WContainerWidget& page)
 	{
-		addSome();
+		return loadPage(range, page);
 	});
 
 	filters.updated().connect([this]
@@ -102,9 +102,8 @@ Releases::Releases(Filters& filters, PlayQueueController& playQueueController)
 void
 Releases::refreshView()
 {
-	_container->clear();
 	_releaseCollector.reset();
-	addSome();
+	_container->reset();
 }
 
 void
@@ -114,22 +113,22 @@ Releases::refreshView(ReleaseCollector::Mode mode)
 	refreshView();
 }
 
-void
-Releases::addSome()
+bool
+Releases::loadPage(Range range, Wt::WContainerWidget& page)
 {
-	const auto releaseIds {_releaseCollector.get(Range {static_cast<std::size_t>(_container->getCount()), _batchSize})};
+	const auto releaseIds {_releaseCollector.get(range)};
 
 	{
 		auto transaction {LmsApp->getDbSession().createSharedTransaction()};
 
 		for (const ReleaseId releaseId : releaseIds.results)
 		{
-			if (const Release::pointer release {Release::find(LmsApp->getDbSession(), releaseId)})
-				_container->add(ReleaseListHelpers::createEntry(release));
+			if (auto entry {ReleaseListHelpers::createEntry(releaseId)})
+				page.addWidget(std::move(entry));
 		}
 	}
 
-	_container->setHasMore(releaseIds.moreResults);
+	return releaseIds.moreResults;
 }
 
 std::vector<ReleaseId>
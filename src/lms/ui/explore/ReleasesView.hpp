@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <Wt/WContainerWidget.h>
+
 #include "services/database/Types.hpp"
 
 #include "common/Template.hpp"
@@ -27,7 +29,7 @@
 namespace UserInterface
 {
 	class Filters;
-	class InfiniteScrollingContainer;
+	class VirtualScrollingContainer;
 	class PlayQueueController;
 
 	class Releases : public Template
@@ -39,16 +41,17 @@ namespace UserInterface
 			void refreshView();
 			void refreshView(ReleaseCollector::Mode mode);
 
-			void addSome();
+			bool loadPage(Database::Range range, Wt::WContainerWidget& page);
 			std::vector<Database::ReleaseId> getAllReleases();
 
 			static constexpr std::size_t _maxItemsPerLine {6};
-			static constexpr std::size_t _batchSize {_maxItemsPerLine};
+			static constexpr std::size_t _pageSize {_maxItemsPerLine * 4};
+			static constexpr std::size_t _maxLoadedPageCount {10};
 			static constexpr std::size_t _maxCount {_maxItemsPerLine * 500};
 
 			PlayQueueController&		_playQueueController;
 			Wt::WWidget*				_currentActiveItem {};
-			InfiniteScrollingContainer* _container {};
+			VirtualScrollingContainer*	_container {};
 			ReleaseCollector			_releaseCollector;
 			static constexpr ReleaseCollector::Mode _defaultMode {ReleaseCollector::Mode::Random};
 	};
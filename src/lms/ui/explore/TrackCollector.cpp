@@ -44,8 +44,20 @@ namespace UserInterface
 		switch (getMode())
 		{
 			case Mode::Random:
-				tracks = getRandomTracks(range);
+			{
+				// seeded random order: pages are consistent until the collector is reset
+				Track::FindParameters params;
+				params.setClusters(getFilters().getClusterIds());
+				params.setSortMethod(TrackSortMethod::Random);
+				params.setRandomSeed(getRandomSeed());
+				params.setRange(range);
+
+				{
+					auto transaction {LmsApp->getDbSession().createSharedTransaction()};
+					tracks = Track::find(LmsApp->getDbSession(), params);
+				}
 				break;
+			}
 
 			case Mode::Starred:
 				tracks = scrobbling.getStarredTracks(LmsApp->getUserId(), getFilters().getClusterIds(), range);
@@ -107,26 +119,5 @@ namespace UserInterface
 		return tracks;
 	}
 
-	RangeResults<TrackId>
-	TrackCollector::getRandomTracks(Range range)
-	{
-		assert(getMode() == Mode::Random);
-
-		if (!_randomTracks)
-		{
-			Track::FindParameters params;
-			params.setClusters(getFilters().getClusterIds());
-			params.setSortMethod(TrackSortMethod::Random);
-			params.setRange({0, getMaxCount()});
-
-			{
-				auto transaction {LmsApp->getDbSession().createSharedTransaction()};
-				_randomTracks = Track::find(LmsApp->getDbSession(), params);
-			}
-		}
-
-		return _randomTracks->getSubRange(range);
-	}
-
 } // ns UserInterface
 
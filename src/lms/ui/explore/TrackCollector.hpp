@@ -36,11 +36,6 @@ namespace UserInterface
 			using DatabaseCollectorBase::DatabaseCollectorBase;
 
 			Database::RangeResults<Database::TrackId>	get(Database::Range range);
-			void reset() { _randomTracks.reset(); }
-
-		private:
-			Database::RangeResults<Database::TrackId> getRandomTracks(Range range);
-			std::optional<Database::RangeResults<Database::TrackId>> _randomTracks;
 	};
 } // ns UserInterface
 
@@ -41,6 +41,7 @@
 #include "MediaPlayer.hpp"
 #include "ModalManager.hpp"
 #include "Utils.hpp"
+#include "ViewModelCache.hpp"
 
 using namespace Database;
 
@@ -152,20 +153,27 @@ namespace UserInterface::TrackListHelpers
 	std::unique_ptr<Wt::WWidget>
 	createEntry(const Database::ObjectPtr<Database::Track>& track, PlayQueueController& playQueueController, Filters& filters)
 	{
+		return createEntry(track->getId(), playQueueController, filters);
+	}
+
+	std::unique_ptr<Wt::WWidget>
+	createEntry(Database::TrackId trackId, PlayQueueController& playQueueController, Filters& filters)
+	{
+		const auto track {Service<ViewModelCache>::get()->getTrack(LmsApp->getDbSession(), trackId)};
+		if (!track)
+			return {};
+
 		auto entry {std::make_unique<Template>(Wt::WString::tr("Lms.Explore.Tracks.template.entry"))};
 		auto* entryPtr {entry.get()};
 
-		entry->bindString("name", Wt::WString::fromUTF8(track->getName()), Wt::TextFormat::Plain);
-
-		const Release::pointer release {track->getRelease()};
-		const TrackId trackId {track->getId()};
+		entry->bindString("name", Wt::WString::fromUTF8(track->name), Wt::TextFormat::Plain);
 
-		if (track->getRelease())
+		if (const auto& release {track->release})
 		{
 			entry->setCondition("if-has-release", true);
-			entry->bindWidget("release", Utils::createReleaseAnchor(track->getRelease()));
-			Wt::WAnchor* anchor {entry->bindWidget("cover", Utils::createReleaseAnchor(release, false))};
-			auto cover {Utils::createCover(release->getId(), CoverResource::Size::Small)};
+			entry->bindWidget("release", Utils::createReleaseAnchor(release->id, release->mbid, release->name));
+			Wt::WAnchor* anchor {entry->bindNew<Wt::WAnchor>("cover", Utils::createReleaseLink(release->id, release->mbid))};
+			auto cover {Utils::createCover(release->id, CoverResource::Size::Small)};
 			cover->addStyleClass("Lms-cover-track Lms-cover-anchor"); // HACK
 			anchor->setImage(std::move((cover)));
 		}
@@ -176,7 +184,7 @@ namespace UserInterface::TrackListHelpers
 			entry->bindWidget<Wt::WImage>("cover", std::move(cover));
 		}
 
-		entry->bindString("duration", Utils::durationToString(track->getDuration()), Wt::TextFormat::Plain);
+		entry->bindString("duration", Utils::durationToString(track->duration), Wt::TextFormat::Plain);
 
 		Wt::WPushButton* playBtn {entry->bindNew<Wt::WPushButton>("play-btn", Wt::WString::tr("Lms.template.play-btn"), Wt::TextFormat::XHTML)};
 		playBtn->clicked().connect([trackId, &playQueueController]
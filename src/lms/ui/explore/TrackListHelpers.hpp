@@ -39,6 +39,7 @@ namespace UserInterface
 namespace UserInterface::TrackListHelpers
 {
 	void showTrackInfoModal(Database::TrackId trackId, Filters& filters);
+	std::unique_ptr<Wt::WWidget> createEntry(Database::TrackId trackId, PlayQueueController& playQueueController, Filters& filters); // nullptr if the track does not exist
 	std::unique_ptr<Wt::WWidget> createEntry(const Database::ObjectPtr<Database::Track>& track, PlayQueueController& playQueueController, Filters& filters);
 } // namespace UserInterface
 
@@ -25,7 +25,7 @@
 #include "services/database/Track.hpp"
 #include "utils/Logger.hpp"
 
-#include "common/InfiniteScrollingContainer.hpp"
+#include "common/VirtualScrollingContainer.hpp"
 #include "explore/Filters.hpp"
 #include "explore/PlayQueueController.hpp"
 #include "explore/TrackListHelpers.hpp"
@@ -86,10 +86,10 @@ Tracks::Tracks(Filters& filters, PlayQueueController& playQueueController)
 			_playQueueController.processCommand(PlayQueueController::Command::PlayOrAddLast, getAllTracks());
 		});
 
-	_container = bindNew<InfiniteScrollingContainer>("tracks");
-	_container->onRequestElements.connect([this]
+	_container = bindNew<VirtualScrollingContainer>("tracks", _pageSize, _maxLoadedPageCount, "");
+	_container->setPageLoader([this](Range range, Wt::WContainerWidget& page)
 	{
-		addSome();
+		return loadPage(range, page);
 	});
 
 	filters.updated().connect([this]
@@ -103,9 +103,8 @@ Tracks::Tracks(Filters& filters, PlayQueueController& playQueueController)
 void
 Tracks::refreshView()
 {
-	_container->clear();
 	_trackCollector.reset();
-	addSome();
+	_container->reset();
 }
 
 void
@@ -115,20 +114,20 @@ Tracks::refreshView(TrackCollector::Mode mode)
 	refreshView();
 }
 
-void
-Tracks::addSome()
+bool
+Tracks::loadPage(Range range, Wt::WContainerWidget& page)
 {
 	auto transaction {LmsApp->getDbSession().createSharedTransaction()};
 
-	const auto trackIds {_trackCollector.get(Range {static_cast<std::size_t>(_container->getCount()), _batchSize})};
+	const auto trackIds {_trackCollector.get(range)};
 
 	for (const TrackId trackId : trackIds.results)
 	{
-		if (const Track::pointer track {Track::find(LmsApp->getDbSession(), trackId)})
-			_container->add(TrackListHelpers::createEntry(track, _playQueueController, _filters));
+		if (auto entry {TrackListHelpers::createEntry(trackId, _playQueueController, _filters)})
+			page.addWidget(std::move(entry));
 	}
 
-	_container->setHasMore(trackIds.moreResults);
+	return trackIds.moreResults;
 }
 
 std::vector<Database::TrackId>
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <Wt/WContainerWidget.h>
+
 #include "services/database/Types.hpp"
 
 #include "common/Template.hpp"
@@ -27,7 +29,7 @@
 namespace UserInterface
 {
 	class Filters;
-	class InfiniteScrollingContainer;
+	class VirtualScrollingContainer;
 	class PlayQueueController;
 
 	class Tracks : public Template
@@ -38,18 +40,19 @@ namespace UserInterface
 		private:
 			void refreshView();
 			void refreshView(TrackCollector::Mode mode);
-			void addSome();
+			bool loadPage(Database::Range range, Wt::WContainerWidget& page);
 
 			std::vector<Database::TrackId> getAllTracks();
 
 			static constexpr TrackCollector::Mode _defaultMode {TrackCollector::Mode::Random};
-			static constexpr std::size_t _batchSize {6};
+			static constexpr std::size_t _pageSize {20};
+			static constexpr std::size_t _maxLoadedPageCount {10};
 			static constexpr std::size_t _maxCount {8000};
 
 			Filters&					_filters;
 			PlayQueueController&		_playQueueController;
 			Wt::WWidget*				_currentActiveItem {};
-			InfiniteScrollingContainer* _container {};
+			VirtualScrollingContainer*	_container {};
 			TrackCollector				_trackCollector;
 	};
 } // namespace UserInterface
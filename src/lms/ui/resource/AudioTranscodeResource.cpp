@@ -189,7 +189,15 @@ AudioTranscodeResource::handleRequest(const Wt::Http::Request& request,
 		{
 			const std::optional<TranscodeParameters>& parameters {readTranscodeParameters(request)};
 			if (parameters)
-				resourceHandler = Av::createTranscodeResourceHandler(parameters->inputFileParameters, parameters->transcodeParameters, false /* estimate content length */);
+			{
+				// the web player plays one track at a time: any new transcode supersedes the previous ones of the session
+				Av::ITranscodeScheduler::Request schedulingRequest;
+				schedulingRequest.user = LmsApp->getUserId().toString();
+				schedulingRequest.client = LmsApp->sessionId();
+				schedulingRequest.priority = Av::ITranscodeScheduler::Priority::Playing;
+
+				resourceHandler = Av::createTranscodeResourceHandler(parameters->inputFileParameters, parameters->transcodeParameters, schedulingRequest, false /* estimate content length */);
+			}
 		}
 		else
 		{
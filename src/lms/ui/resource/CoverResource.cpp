@@ -21,13 +21,17 @@
 
 #include <Wt/WApplication.h>
 #include <Wt/Http/Response.h>
+#include <Wt/Http/ResponseContinuation.h>
 
 #include "services/cover/ICoverService.hpp"
 #include "services/database/Track.hpp"
+#include "services/scanner/IScannerService.hpp"
 #include "utils/Exception.hpp"
 #include "utils/Logger.hpp"
 #include "utils/Service.hpp"
 #include "utils/String.hpp"
+#include "utils/http/CacheValidators.hpp"
+#include "utils/http/DeferredResponse.hpp"
 
 #include "LmsApplication.hpp"
 
@@ -39,7 +43,7 @@ CoverResource::CoverResource()
 {
 	LmsApp->getScannerEvents().scanComplete.connect(this, [this](const Scanner::ScanStats& stats)
 	{
-		if (stats.nbChanges())
+		if (stats.nbChanges() || stats.coverChanges)
 			setChanged();
 	});
 }
@@ -61,9 +65,25 @@ CoverResource::getTrackUrl(Database::TrackId trackId, Size size) const
 	return url() + "&trackid=" + trackId.toString() + "&size=" + std::to_string(static_cast<std::size_t>(size));
 }
 
+namespace
+{
+	using CoverResult = std::shared_ptr<std::shared_ptr<Image::IEncodedImage>>;
+}
+
 void
 CoverResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response)
 {
+	// Resumed once the cover has been computed
+	if (Wt::Http::ResponseContinuation* continuation {request.continuation()})
+	{
+		const std::shared_ptr<Image::IEncodedImage> cover {*Wt::cpp17::any_cast<CoverResult>(continuation->data())};
+		if (!cover)
+			return;
+
+		response.out().write(reinterpret_cast<const char *>(cover->getData()), cover->getDataSize());
+		return;
+	}
+
 	// Retrieve parameters
 	const std::string *trackIdStr = request.getParameter("trackid");
 	const std::string *releaseIdStr = request.getParameter("releaseid");
@@ -83,30 +103,41 @@ CoverResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Respons
 		return;
 	}
 
-	std::shared_ptr<Image::IEncodedImage> cover;
+	// Covers can only change when the scanner updates the library, or if they are encoded differently
+	{
+		const Scanner::IScannerService::LibraryGeneration libraryGeneration {Service<Scanner::IScannerService>::get()->getLibraryGeneration()};
+
+		Http::CacheValidators validators;
+		validators.etag = "\"" + std::to_string(libraryGeneration.value) + "-q" + std::to_string(Service<Cover::ICoverService>::get()->getJpegQuality()) + "\"";
+		if (libraryGeneration.lastModified.isValid())
+			validators.lastModified = libraryGeneration.lastModified.toTime_t();
+		validators.cacheControl = "private, no-cache";
+
+		if (Http::handleConditionalRequest(request, response, validators))
+			return;
+	}
+
+	std::optional<Database::TrackId> trackId;
+	std::optional<Database::ReleaseId> releaseId;
 
 	if (trackIdStr)
 	{
 		LOG(DEBUG) << "Requested cover for track " << *trackIdStr << ", size = " << *size;
 
-		const std::optional<Database::TrackId> trackId {StringUtils::readAs<Database::TrackId::ValueType>(*trackIdStr)};
+		trackId = StringUtils::readAs<Database::TrackId::ValueType>(*trackIdStr);
 		if (!trackId)
 		{
 			LOG(DEBUG) << "track not found";
 			return;
 		}
-
-		cover = Service<Cover::ICoverService>::get()->getFromTrack(*trackId, *size);
 	}
 	else if (releaseIdStr)
 	{
 		LOG(DEBUG) << "Requested cover for release " << *releaseIdStr << ", size = " << *size;
 
-		const std::optional<Database::ReleaseId> releaseId {StringUtils::readAs<Database::ReleaseId::ValueType>(*releaseIdStr)};
+		releaseId = StringUtils::readAs<Database::ReleaseId::ValueType>(*releaseIdStr);
 		if (!releaseId)
 			return;
-
-		cover = Service<Cover::ICoverService>::get()->getFromRelease(*releaseId, *size);
 	}
 	else
 	{
@@ -114,9 +145,16 @@ CoverResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Respons
 		return;
 	}
 
-	response.setMimeType(std::string {cover->getMimeType()});
+	response.setMimeType("image/jpeg");
 
-	response.out().write(reinterpret_cast<const char *>(cover->getData()), cover->getDataSize());
+	const CoverResult cover {std::make_shared<std::shared_ptr<Image::IEncodedImage>>()};
+	Http::deferResponse(response, cover, IJobScheduler::Pool::CPU, IJobScheduler::Priority::Normal, [=, coverSize {*size}]
+	{
+		if (trackId)
+			*cover = Service<Cover::ICoverService>::get()->getFromTrack(*trackId, coverSize);
+		else
+			*cover = Service<Cover::ICoverService>::get()->getFromRelease(*releaseId, coverSize);
+	});
 }
 
 } // namespace UserInterface
@@ -24,6 +24,7 @@
 #include <iomanip>
 
 #include <Wt/Http/Response.h>
+#include <Wt/Http/ResponseContinuation.h>
 #include <Wt/WLocalDateTime.h>
 
 #include "services/database/Artist.hpp"
@@ -34,6 +35,7 @@
 #include "utils/Exception.hpp"
 #include "utils/Logger.hpp"
 #include "utils/Zipper.hpp"
+#include "utils/http/DeferredResponse.hpp"
 
 #include "LmsApplication.hpp"
 
@@ -46,37 +48,61 @@ DownloadResource::~DownloadResource()
 	beingDeleted();
 }
 
+namespace
+{
+	struct ZipState
+	{
+		std::shared_ptr<Zip::Zipper> zipper;
+		std::array<std::byte, DownloadResource::bufferSize> buffer;
+		Zip::SizeType bufferedSize {};
+		bool failed {};
+	};
+}
+
 void
 DownloadResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response)
 {
 	try
 	{
-		std::shared_ptr<Zip::Zipper> zipper;
+		std::shared_ptr<ZipState> state;
 
 		// First, see if this request is for a continuation
 		if (Wt::Http::ResponseContinuation *continuation {request.continuation()})
-			zipper = Wt::cpp17::any_cast<std::shared_ptr<Zip::Zipper>>(continuation->data());
+		{
+			state = Wt::cpp17::any_cast<std::shared_ptr<ZipState>>(continuation->data());
+
+			response.out().write(reinterpret_cast<const char *>(state->buffer.data()), state->bufferedSize);
+			if (state->failed || state->zipper->isComplete())
+				return;
+		}
 		else
 		{
-			zipper = createZipper();
+			std::shared_ptr<Zip::Zipper> zipper {createZipper()};
 			if (zipper)
 				response.setContentLength(zipper->getTotalZipFile());
 			response.setMimeType("application/zip");
-		}
 
-		if (!zipper)
-			return;
+			if (!zipper)
+				return;
 
-		std::array<std::byte, bufferSize> buffer;
-		Zip::SizeType nbWrittenBytes {zipper->writeSome(buffer.data(), buffer.size())};
-
-		response.out().write(reinterpret_cast<const char *>(buffer.data()), nbWrittenBytes);
+			state = std::make_shared<ZipState>();
+			state->zipper = std::move(zipper);
+		}
 
-		if (!zipper->isComplete())
+		// Reading the files and computing their CRC may block: keep it out of the server threads
+		Http::deferResponse(response, state, IJobScheduler::Pool::IO, IJobScheduler::Priority::Low, [state]
 		{
-			auto* continuation {response.createContinuation()};
-			continuation->setData(zipper);
-		}
+			try
+			{
+				state->bufferedSize = state->zipper->writeSome(state->buffer.data(), state->buffer.size());
+			}
+			catch (Zip::ZipperException& exception)
+			{
+				LOG(ERROR) << "Zipper exception: " << exception.what();
+				state->bufferedSize = 0;
+				state->failed = true;
+			}
+		});
 	}
 	catch (Zip::ZipperException& exception)
 	{
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2022 Emeric Poupon
+ *
+ * This file is part of LMS.
+ *
+ * LMS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LMS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "utils/Compression.hpp"
+
+struct Sample
+{
+	std::string	name;
+	std::string	data;
+};
+
+// Looks like a getAlbumList2/search3 response
+static
+std::string
+generateSyntheticResponse(std::size_t entryCount, bool json)
+{
+	static const char* const genres[] {"Rock", "Jazz", "Electronic", "Classical", "Hip-Hop"};
+
+	std::ostringstream oss;
+
+	if (json)
+		oss << R"({"subsonic-response":{"status":"ok","version":"1.16.0","albumList2":{"album":[)";
+	else
+		oss << R"(<?xml version="1.0" encoding="UTF-8"?><subsonic-response xmlns="http://subsonic.org/restapi" status="ok" version="1.16.0"><albumList2>)";
+
+	for (std::size_t i {}; i < entryCount; ++i)
+	{
+		const std::string id {"al-" + std::to_string(1000 + i * 7)};
+		const std::string artistId {"ar-" + std::to_string(100 + i / 10)};
+		const std::string name {"Album title number " + std::to_string(i)};
+		const std::string artist {"Artist name " + std::to_string(i / 10)};
+		const std::string genre {genres[i % std::size(genres)]};
+		const unsigned year {1960 + static_cast<unsigned>(i % 60)};
+
+		if (json)
+		{
+			oss << (i ? "," : "")
+				<< R"({"id":")" << id << R"(","name":")" << name << R"(","title":")" << name << R"(","album":")" << name
+				<< R"(","artist":")" << artist << R"(","artistId":")" << artistId << R"(","coverArt":")" << id
+				<< R"(","isDir":true,"songCount":)" << (8 + i % 10) << R"(,"duration":)" << (1800 + i % 1200)
+				<< R"(,"year":)" << year << R"(,"genre":")" << genre << R"(","created":"2000-01-01T00:00:00","playCount":)" << (i % 13) << "}";
+		}
+		else
+		{
+			oss << R"(<album id=")" << id << R"(" name=")" << name << R"(" title=")" << name << R"(" album=")" << name
+				<< R"(" artist=")" << artist << R"(" artistId=")" << artistId << R"(" coverArt=")" << id
+				<< R"(" isDir="true" songCount=")" << (8 + i % 10) << R"(" duration=")" << (1800 + i % 1200)
+				<< R"(" year=")" << year << R"(" genre=")" << genre << R"(" created="2000-01-01T00:00:00" playCount=")" << (i % 13) << R"("/>)";
+		}
+	}
+
+	if (json)
+		oss << "]}}}";
+	else
+		oss << "</albumList2></subsonic-response>";
+
+	return oss.str();
+}
+
+static
+void
+benchmark(const Sample& sample, Compression::Encoding encoding, int level, unsigned iterations)
+{
+	using Clock = std::chrono::steady_clock;
+	using Duration = std::chrono::duration<double, std::milli>;
+
+	std::size_t outputSize {};
+	Duration duration {};
+
+	for (unsigned i {}; i < iterations; ++i)
+	{
+		std::ostringstream oss;
+
+		const Clock::time_point start {Clock::now()};
+		auto compressor {Compression::createStreamCompressor(encoding, oss, level)};
+		compressor->write(sample.data.data(), sample.data.size());
+		compressor->finish();
+		duration += Clock::now() - start;
+
+		outputSize = compressor->getOutputSize();
+	}
+
+	const double avgDuration {duration.count() / iterations};
+	const double throughput {(sample.data.size() / (1024. * 1024.)) / (avgDuration / 1000)};
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "\t" << std::setw(8) << std::left << Compression::encodingToString(encoding) << " level " << std::setw(2) << level
+		<< ": " << std::setw(9) << std::right << outputSize << " bytes (ratio = " << (static_cast<double>(sample.data.size()) / outputSize)
+		<< ", saved = " << (sample.data.size() - outputSize) << " bytes), " << avgDuration << " ms, " << throughput << " MiB/s" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	try
+	{
+		namespace po = boost::program_options;
+
+		po::options_description desc{"Benchmark the CPU cost vs bytes saved of the Subsonic API response compression. Allowed options"};
+		desc.add_options()
+		("help,h", "print usage message")
+		("file,f", po::value<std::vector<std::string>>(), "captured response to compress (can be repeated), instead of synthetic responses")
+		("entries,e", po::value<std::vector<std::size_t>>()->multitoken()->default_value({10, 100, 500, 5000}, "10 100 500 5000"), "entry counts of the synthetic responses")
+		("iterations,i", po::value<unsigned>()->default_value(20), "iterations per measure")
+		;
+
+		po::variables_map vm;
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+
+		if (vm.count("help"))
+		{
+			std::cout << desc << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		std::vector<Sample> samples;
+		if (vm.count("file"))
+		{
+			for (const std::string& file : vm["file"].as<std::vector<std::string>>())
+			{
+				std::ifstream ifs {file, std::ios::binary};
+				if (!ifs)
+				{
+					std::cerr << "Cannot open file '" << file << "'" << std::endl;
+					return EXIT_FAILURE;
+				}
+				samples.push_back(Sample {file, std::string {std::istreambuf_iterator<char> {ifs}, std::istreambuf_iterator<char> {}}});
+			}
+		}
+		else
+		{
+			for (const std::size_t entryCount : vm["entries"].as<std::vector<std::size_t>>())
+			{
+				for (const bool json : {false, true})
+					samples.push_back(Sample {std::to_string(entryCount) + " entries, " + (json ? "json" : "xml"), generateSyntheticResponse(entryCount, json)});
+			}
+		}
+
+		const unsigned iterations {std::max(vm["iterations"].as<unsigned>(), 1U)};
+
+		struct EncodingLevel
+		{
+			Compression::Encoding encoding;
+			int level;
+		};
+		const EncodingLevel encodingLevels[]
+		{
+			{Compression::Encoding::Gzip, 1},
+			{Compression::Encoding::Gzip, 6}, // default
+			{Compression::Encoding::Gzip, 9},
+			{Compression::Encoding::Zstd, 1},
+			{Compression::Encoding::Zstd, 3}, // default
+			{Compression::Encoding::Zstd, 9},
+		};
+
+		for (const Sample& sample : samples)
+		{
+			std::cout << sample.name << ": " << sample.data.size() << " bytes" << std::endl;
+
+			for (const EncodingLevel& encodingLevel : encodingLevels)
+			{
+				if (Compression::isEncodingSupported(encodingLevel.encoding))
+					benchmark(sample, encodingLevel.encoding, encodingLevel.level, iterations);
+			}
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "Caught exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
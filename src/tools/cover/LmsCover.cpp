@@ -17,13 +17,23 @@
  * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 #include <stdlib.h>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
+#include "av/IAudioFile.hpp"
+#include "image/Exception.hpp"
+#include "image/IRawImage.hpp"
+
 #include "services/database/Db.hpp"
 #include "services/database/Release.hpp"
 #include "services/database/Session.hpp"
@@ -33,6 +43,7 @@
 #include "utils/Logger.hpp"
 #include "utils/Service.hpp"
 #include "utils/StreamLogger.hpp"
+#include "utils/String.hpp"
 
 static
 void
@@ -53,6 +64,118 @@ dumpTrackCovers(Database::Session& session, Image::ImageSize width)
 	}
 }
 
+struct EncodedCover
+{
+	std::filesystem::path	path;
+	std::vector<std::byte>	data;
+};
+
+static
+void
+loadCovers(const std::filesystem::path& path, std::vector<EncodedCover>& covers)
+{
+	const std::string extension {StringUtils::stringToLower(path.extension().string())};
+	if (extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp")
+	{
+		std::ifstream ifs {path, std::ios::binary};
+		const std::vector<char> data {std::istreambuf_iterator<char> {ifs}, std::istreambuf_iterator<char> {}};
+		if (!data.empty())
+			covers.push_back(EncodedCover {path, std::vector<std::byte> {reinterpret_cast<const std::byte*>(data.data()), reinterpret_cast<const std::byte*>(data.data()) + data.size()}});
+		return;
+	}
+
+	try
+	{
+		Av::parseAudioFile(path)->visitAttachedPictures([&](const Av::Picture& picture)
+		{
+			covers.push_back(EncodedCover {path, std::vector<std::byte> {picture.data, picture.data + picture.dataSize}});
+		});
+	}
+	catch (const Av::Exception&)
+	{
+		// not an audio file
+	}
+}
+
+static
+std::vector<EncodedCover>
+loadCovers(const std::filesystem::path& path)
+{
+	std::vector<EncodedCover> covers;
+
+	if (std::filesystem::is_directory(path))
+	{
+		for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator {path})
+		{
+			if (entry.is_regular_file())
+				loadCovers(entry.path(), covers);
+		}
+	}
+	else
+		loadCovers(path, covers);
+
+	return covers;
+}
+
+static
+void
+benchmarkCovers(const std::vector<EncodedCover>& covers, Image::ImageSize width, unsigned quality, unsigned iterations, bool reducedDecode)
+{
+	using Clock = std::chrono::steady_clock;
+	using Duration = std::chrono::duration<double, std::milli>;
+
+	Duration decodeDuration {};
+	Duration resizeDuration {};
+	Duration encodeDuration {};
+	std::vector<double> coverDurations; // ms
+	std::size_t errorCount {};
+
+	for (unsigned iteration {}; iteration < iterations; ++iteration)
+	{
+		for (const EncodedCover& cover : covers)
+		{
+			try
+			{
+				const Clock::time_point start {Clock::now()};
+				std::unique_ptr<Image::IRawImage> rawImage {Image::decodeImage(cover.data.data(), cover.data.size(), reducedDecode ? width : 0)};
+				const Clock::time_point decoded {Clock::now()};
+				rawImage->resize(width);
+				const Clock::time_point resized {Clock::now()};
+				const std::unique_ptr<Image::IEncodedImage> encodedImage {rawImage->encodeToJPEG(quality)};
+				const Clock::time_point encoded {Clock::now()};
+
+				decodeDuration += decoded - start;
+				resizeDuration += resized - decoded;
+				encodeDuration += encoded - resized;
+				coverDurations.push_back(Duration {encoded - start}.count());
+			}
+			catch (const Image::ImageException& e)
+			{
+				if (iteration == 0)
+					std::cerr << "Cannot process cover from '" << cover.path.string() << "': " << e.what() << std::endl;
+				errorCount++;
+			}
+		}
+	}
+
+	std::cout << (reducedDecode ? "Reduced scale decode" : "Full scale decode") << ":" << std::endl;
+	if (coverDurations.empty())
+	{
+		std::cout << "\tno cover processed" << std::endl;
+		return;
+	}
+
+	std::sort(std::begin(coverDurations), std::end(coverDurations));
+	auto percentile {[&](double p) { return coverDurations[static_cast<std::size_t>(p * (coverDurations.size() - 1))]; }};
+	const double totalDuration {(decodeDuration + resizeDuration + encodeDuration).count()};
+	const double count {static_cast<double>(coverDurations.size())};
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "\tcovers = " << coverDurations.size() << ", errors = " << errorCount << std::endl
+		<< "\ttotal = " << totalDuration << " ms, " << (count * 1000 / totalDuration) << " covers/s" << std::endl
+		<< "\tavg decode = " << decodeDuration.count() / count << " ms, avg resize = " << resizeDuration.count() / count << " ms, avg encode = " << encodeDuration.count() / count << " ms" << std::endl
+		<< "\tp50 = " << percentile(0.5) << " ms, p99 = " << percentile(0.99) << " ms, max = " << coverDurations.back() << " ms" << std::endl;
+}
 
 int main(int argc, char *argv[])
 {
@@ -72,6 +195,8 @@ int main(int argc, char *argv[])
         ("tracks,t", "dump covers for tracks")
 		("size,s", po::value<unsigned>()->default_value(512), "Requested cover size")
 		("quality,q", po::value<unsigned>()->default_value(75), "JPEG quality (1-100)")
+		("benchmark,b", po::value<std::string>(), "benchmark the image work on the covers found in a file or a directory (image files or attached pictures), no database needed")
+		("iterations,i", po::value<unsigned>()->default_value(1), "Benchmark iterations")
         ;
 
         po::variables_map vm;
@@ -83,6 +208,19 @@ int main(int argc, char *argv[])
             return EXIT_SUCCESS;
         }
 
+		if (vm.count("benchmark"))
+		{
+			Image::init(argv[0]);
+
+			const std::vector<EncodedCover> covers {loadCovers(vm["benchmark"].as<std::string>())};
+			std::cout << "Loaded " << covers.size() << " covers" << std::endl;
+
+			for (const bool reducedDecode : {false, true})
+				benchmarkCovers(covers, vm["size"].as<unsigned>(), vm["quality"].as<unsigned>(), vm["iterations"].as<unsigned>(), reducedDecode);
+
+			return EXIT_SUCCESS;
+		}
+
 		Service<IConfig> config {createConfig(vm["conf"].as<std::string>())};
 		Database::Db db {config->getPath("working-dir") / "lms.db"};
 		Service<Cover::ICoverService> coverArtService {Cover::createCoverService(db, argv[0], vm["default-cover"].as<std::string>())};
@@ -17,17 +17,27 @@
  * along with LMS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <map>
 #include <optional>
 #include <stdexcept>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
 #include <Wt/WDate.h>
 
 #include "metadata/IParser.hpp"
 #include "utils/StreamLogger.hpp"
+#include "utils/String.hpp"
 
 std::ostream& operator<<(std::ostream& os, const MetaData::Artist& artist)
 {
@@ -171,22 +181,251 @@ void parse(MetaData::IParser& parser, const std::filesystem::path& file)
 	std::cout << std::endl;
 }
 
-int main(int argc, char *argv[])
+static
+MetaData::ParserType
+parserTypeFromString(const std::string& str)
+{
+	if (str == "taglib")
+		return MetaData::ParserType::TagLib;
+	if (str == "avformat")
+		return MetaData::ParserType::AvFormat;
+
+	throw std::runtime_error {"Unknown parser '" + str + "'"};
+}
+
+static
+MetaData::ParserReadStyle
+readStyleFromString(const std::string& str)
+{
+	if (str == "fast")
+		return MetaData::ParserReadStyle::Fast;
+	if (str == "average")
+		return MetaData::ParserReadStyle::Average;
+	if (str == "accurate")
+		return MetaData::ParserReadStyle::Accurate;
+
+	throw std::runtime_error {"Unknown read style '" + str + "'"};
+}
+
+struct BenchmarkFile
+{
+	std::filesystem::path	path;
+	std::uintmax_t			size {};
+};
+
+struct BenchmarkResult
+{
+	std::string				container;	// lowercase file extension
+	std::uintmax_t			size {};
+	double					duration {}; // ms
+	bool					success {};
+};
+
+static
+std::vector<BenchmarkFile>
+findBenchmarkFiles(const std::filesystem::path& directory, const std::vector<std::string>& extensions)
 {
-	if (argc == 1)
+	std::vector<BenchmarkFile> files;
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator {directory, std::filesystem::directory_options::skip_permission_denied})
 	{
-		std::cerr << "Usage: <file> [<file> ...]" << std::endl;
-		return EXIT_FAILURE;
+		if (!entry.is_regular_file())
+			continue;
+
+		const std::string extension {StringUtils::stringToLower(entry.path().extension().string())};
+		if (std::find(std::cbegin(extensions), std::cend(extensions), extension) == std::cend(extensions))
+			continue;
+
+		std::error_code ec;
+		const std::uintmax_t size {entry.file_size(ec)};
+		if (!ec)
+			files.push_back(BenchmarkFile {entry.path(), size});
 	}
 
+	return files;
+}
+
+// Only drops clean pages: run 'sync' before benchmarking freshly written files
+static
+void
+dropFromPageCache(const std::filesystem::path& file)
+{
+	const int fd {::open(file.c_str(), O_RDONLY)};
+	if (fd < 0)
+		return;
+
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	::close(fd);
+}
+
+static
+void
+printBenchmarkStats(std::string_view name, std::vector<BenchmarkResult>& results)
+{
+	std::vector<double> durations;
+	durations.reserve(results.size());
+
+	std::size_t failureCount {};
+	std::uintmax_t totalSize {};
+	for (const BenchmarkResult& result : results)
+	{
+		durations.push_back(result.duration);
+		totalSize += result.size;
+		if (!result.success)
+			failureCount++;
+	}
+
+	std::sort(std::begin(durations), std::end(durations));
+	auto percentile {[&](double p) { return durations[static_cast<std::size_t>(p * (durations.size() - 1))]; }};
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "\t" << name << ": files = " << durations.size() << ", failures = " << failureCount << ", size = " << totalSize / (1024. * 1024.) << " MB"
+		<< ", p50 = " << percentile(0.5) << " ms, p99 = " << percentile(0.99) << " ms, max = " << durations.back() << " ms" << std::endl;
+}
+
+static
+void
+benchmarkParser(const std::vector<BenchmarkFile>& files, MetaData::ParserType parserType, MetaData::ParserReadStyle readStyle, unsigned threadCount, bool coldCache)
+{
+	using Clock = std::chrono::steady_clock;
+	using Duration = std::chrono::duration<double, std::milli>;
+
+	std::atomic<std::size_t> nextFileIndex {};
+	std::vector<std::vector<BenchmarkResult>> threadResults(threadCount);
+
+	auto worker {[&](std::vector<BenchmarkResult>& results)
+	{
+		// parsers are not thread safe
+		std::unique_ptr<MetaData::IParser> parser {MetaData::createParser(parserType, readStyle)};
+		parser->setClusterTypeNames( {"ALBUMMOOD", "MOOD", "ALBUMGROUPING", "ALBUMGENRE", "GENRE"} );
+
+		for (std::size_t i {nextFileIndex++}; i < files.size(); i = nextFileIndex++)
+		{
+			const BenchmarkFile& file {files[i]};
+			if (coldCache)
+				dropFromPageCache(file.path);
+
+			BenchmarkResult result;
+			result.container = StringUtils::stringToLower(file.path.extension().string());
+			result.size = file.size;
+
+			const Clock::time_point start {Clock::now()};
+			try
+			{
+				result.success = parser->parse(file.path).has_value();
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Cannot parse '" << file.path.string() << "': " << e.what() << std::endl;
+			}
+			result.duration = Duration {Clock::now() - start}.count();
+
+			results.push_back(std::move(result));
+		}
+	}};
+
+	const Clock::time_point start {Clock::now()};
+	{
+		std::vector<std::thread> threads;
+		for (std::vector<BenchmarkResult>& results : threadResults)
+			threads.emplace_back(worker, std::ref(results));
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+	const Duration totalDuration {Clock::now() - start};
+
+	std::vector<BenchmarkResult> allResults;
+	std::map<std::string, std::vector<BenchmarkResult>> resultsByContainer;
+	std::uintmax_t totalSize {};
+	for (const std::vector<BenchmarkResult>& results : threadResults)
+	{
+		for (const BenchmarkResult& result : results)
+		{
+			totalSize += result.size;
+			resultsByContainer[result.container].push_back(result);
+			allResults.push_back(result);
+		}
+	}
+
+	if (allResults.empty())
+	{
+		std::cout << "No file parsed" << std::endl;
+		return;
+	}
+
+	const double seconds {totalDuration.count() / 1000};
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Parsed " << allResults.size() << " files using " << threadCount << " thread(s) in " << seconds << " s"
+		<< ": " << (allResults.size() / seconds) << " files/s, " << (totalSize / (1024. * 1024.) / seconds) << " MB/s" << std::endl;
+
+	printBenchmarkStats("all", allResults);
+	for (auto& [container, results] : resultsByContainer)
+		printBenchmarkStats(container, results);
+}
+
+int main(int argc, char *argv[])
+{
 	try
 	{
+		namespace po = boost::program_options;
+
+		po::options_description desc{"Allowed options"};
+		desc.add_options()
+		("help,h", "print usage message")
+		("file,f", po::value<std::vector<std::string>>(), "file to parse with both parsers, all tags are displayed")
+		("benchmark,b", po::value<std::string>(), "benchmark the parser on all the audio files found in a directory")
+		("parser,p", po::value<std::string>()->default_value("taglib"), "Benchmark parser: taglib, avformat")
+		("read-style,r", po::value<std::string>()->default_value("average"), "Benchmark parser read style: fast, average, accurate")
+		("threads,t", po::value<unsigned>()->default_value(1), "Benchmark thread count")
+		("extensions,e", po::value<std::string>()->default_value(".alac .mp3 .ogg .oga .aac .m4a .m4b .flac .wav .wma .aif .aiff .ape .mpc .shn .opus .wv"), "Benchmark audio file extensions")
+		("cold-cache", "drop each file from the page cache before parsing it (posix_fadvise)")
+		;
+
+		po::positional_options_description positional;
+		positional.add("file", -1);
+
+		po::variables_map vm;
+		po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+
+		if (vm.count("help") || (!vm.count("file") && !vm.count("benchmark")))
+		{
+			std::cout << "Usage: " << argv[0] << " [options] <file> [<file> ...]" << std::endl << desc << std::endl;
+			return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		if (vm.count("benchmark"))
+		{
+			// only report errors, as the output would be flooded otherwise
+			Service<Logger> logger {std::make_unique<StreamLogger>(std::cerr, EnumSet<Severity> {Severity::FATAL, Severity::ERROR})};
+
+			std::vector<std::string> extensions;
+			for (std::string_view extension : StringUtils::splitString(vm["extensions"].as<std::string>(), " "))
+			{
+				if (!extension.empty())
+					extensions.push_back(StringUtils::stringToLower(extension));
+			}
+
+			const std::vector<BenchmarkFile> files {findBenchmarkFiles(vm["benchmark"].as<std::string>(), extensions)};
+			std::cout << "Found " << files.size() << " files" << std::endl;
+
+			const std::string parserName {vm["parser"].as<std::string>()};
+			const std::string readStyleName {vm["read-style"].as<std::string>()};
+			const unsigned threadCount {std::max(vm["threads"].as<unsigned>(), 1U)};
+			const bool coldCache {vm.count("cold-cache") > 0};
+
+			std::cout << "Parser = " << parserName << ", read style = " << readStyleName << ", cold cache = " << std::boolalpha << coldCache << std::endl;
+			benchmarkParser(files, parserTypeFromString(parserName), readStyleFromString(readStyleName), threadCount, coldCache);
+
+			return EXIT_SUCCESS;
+		}
+
 		// log to stdout
 		Service<Logger> logger {std::make_unique<StreamLogger>(std::cout)};
 
-		for (std::size_t  i {}; i < static_cast<std::size_t>(argc - 1); ++i)
+		for (const std::string& fileName : vm["file"].as<std::vector<std::string>>())
 		{
-			std::filesystem::path file {argv[i + 1]};
+			const std::filesystem::path file {fileName};
 
 			std::cout << "Parsing file '" << file << "'" << std::endl;
 